@@ -88,7 +88,7 @@ PoseGraphStub::GetTrajectoryNodes() const {
 
 mapping::MapById<mapping::NodeId, mapping::TrajectoryNodePose>
 PoseGraphStub::GetTrajectoryNodePoses() const {
-  google::protobuf::Empty request;
+  proto::GetTrajectoryNodePosesRequest request;
   async_grpc::Client<handlers::GetTrajectoryNodePosesSignature> client(
       client_channel_);
   CHECK(client.Write(request));
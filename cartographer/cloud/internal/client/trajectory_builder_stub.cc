@@ -147,6 +147,12 @@ void TrajectoryBuilderStub::AddLocalSlamResultData(
   LOG(FATAL) << "Not implemented";
 }
 
+absl::optional<transform::Rigid3d> TrajectoryBuilderStub::ExtrapolateLocalPose(
+    const common::Time time) const {
+  // Local SLAM runs on the server.
+  return absl::nullopt;
+}
+
 void TrajectoryBuilderStub::RunLocalSlamResultsReader(
     async_grpc::Client<handlers::ReceiveLocalSlamResultsSignature>* client,
     LocalSlamResultCallback local_slam_result_callback) {
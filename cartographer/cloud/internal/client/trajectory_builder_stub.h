@@ -58,6 +58,8 @@ class TrajectoryBuilderStub : public mapping::TrajectoryBuilderInterface {
                      const sensor::LandmarkData& landmark_data) override;
   void AddLocalSlamResultData(std::unique_ptr<mapping::LocalSlamResultData>
                                   local_slam_result_data) override;
+  absl::optional<transform::Rigid3d> ExtrapolateLocalPose(
+      common::Time time) const override;
 
  private:
   static void RunLocalSlamResultsReader(
@@ -20,35 +20,17 @@
 #include "async_grpc/rpc_handler.h"
 #include "cartographer/cloud/internal/map_builder_context_interface.h"
 #include "cartographer/cloud/proto/map_builder_service.pb.h"
-#include "cartographer/transform/transform.h"
-#include "google/protobuf/empty.pb.h"
 
 namespace cartographer {
 namespace cloud {
 namespace handlers {
 
 void GetTrajectoryNodePosesHandler::OnRequest(
-    const google::protobuf::Empty& request) {
-  auto node_poses = GetContext<MapBuilderContextInterface>()
-                        ->map_builder()
-                        .pose_graph()
-                        ->GetTrajectoryNodePoses();
-  auto response = absl::make_unique<proto::GetTrajectoryNodePosesResponse>();
-  for (const auto& node_id_pose : node_poses) {
-    auto* node_pose = response->add_node_poses();
-    node_id_pose.id.ToProto(node_pose->mutable_node_id());
-    *node_pose->mutable_global_pose() =
-        transform::ToProto(node_id_pose.data.global_pose);
-    if (node_id_pose.data.constant_pose_data.has_value()) {
-      node_pose->mutable_constant_pose_data()->set_timestamp(
-          common::ToUniversal(
-              node_id_pose.data.constant_pose_data.value().time));
-      *node_pose->mutable_constant_pose_data()->mutable_local_pose() =
-          transform::ToProto(
-              node_id_pose.data.constant_pose_data.value().local_pose);
-    }
-  }
-  Send(std::move(response));
+    const proto::GetTrajectoryNodePosesRequest& request) {
+  auto* context = GetUnsynchronizedContext<MapBuilderContextInterface>();
+  context->trajectory_node_poses_cache().UpdateIfNeeded(
+      *context->map_builder().pose_graph());
+  Send(context->trajectory_node_poses_cache().GetNodePoses(request));
 }
 
 }  // namespace handlers
@@ -19,21 +19,20 @@
 
 #include "async_grpc/rpc_handler.h"
 #include "cartographer/cloud/proto/map_builder_service.pb.h"
-#include "google/protobuf/empty.pb.h"
 
 namespace cartographer {
 namespace cloud {
 namespace handlers {
 
 DEFINE_HANDLER_SIGNATURE(
-    GetTrajectoryNodePosesSignature, google::protobuf::Empty,
+    GetTrajectoryNodePosesSignature, proto::GetTrajectoryNodePosesRequest,
     proto::GetTrajectoryNodePosesResponse,
     "/cartographer.cloud.proto.MapBuilderService/GetTrajectoryNodePoses")
 
 class GetTrajectoryNodePosesHandler
     : public async_grpc::RpcHandler<GetTrajectoryNodePosesSignature> {
  public:
-  void OnRequest(const google::protobuf::Empty& request) override;
+  void OnRequest(const proto::GetTrajectoryNodePosesRequest& request) override;
 };
 
 }  // namespace handlers
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/cloud/internal/handlers/get_trajectory_node_poses_handler.h"
+
+#include "cartographer/cloud/internal/testing/handler_test.h"
+#include "cartographer/cloud/internal/trajectory_node_poses_cache.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace cloud {
+namespace handlers {
+namespace {
+
+using ::testing::ReturnPointee;
+using ::testing::ReturnRef;
+using NodePoses =
+    mapping::MapById<mapping::NodeId, mapping::TrajectoryNodePose>;
+using TrajectoryState = mapping::PoseGraphInterface::TrajectoryState;
+
+mapping::TrajectoryNodePose NodePoseAt(const double x) {
+  return mapping::TrajectoryNodePose{
+      transform::Rigid3d::Translation(Eigen::Vector3d(x, 0., 0.)),
+      mapping::TrajectoryNodePose::ConstantPoseData{
+          common::FromUniversal(static_cast<int64>(x)),
+          transform::Rigid3d::Identity()}};
+}
+
+class GetTrajectoryNodePosesHandlerTest
+    : public testing::HandlerTest<GetTrajectoryNodePosesSignature,
+                                  GetTrajectoryNodePosesHandler> {
+ protected:
+  void SetUp() override {
+    testing::HandlerTest<GetTrajectoryNodePosesSignature,
+                         GetTrajectoryNodePosesHandler>::SetUp();
+    EXPECT_CALL(*mock_map_builder_context_, trajectory_node_poses_cache())
+        .WillRepeatedly(ReturnRef(cache_));
+    EXPECT_CALL(*mock_pose_graph_, GetTrajectoryStates())
+        .WillRepeatedly(ReturnPointee(&trajectory_states_));
+    EXPECT_CALL(*mock_pose_graph_, GetTrajectoryNodePoses())
+        .WillRepeatedly(ReturnPointee(&node_poses_));
+    trajectory_states_ = {{0, TrajectoryState::ACTIVE}};
+    node_poses_.Append(0, NodePoseAt(0.));
+    // State of the cache after the last optimization.
+    cache_.UpdateIfNeeded(*mock_pose_graph_);
+  }
+
+  TrajectoryNodePosesCache cache_;
+  std::map<int, TrajectoryState> trajectory_states_;
+  NodePoses node_poses_;
+};
+
+TEST_F(GetTrajectoryNodePosesHandlerTest, ReturnsNodesAddedAfterOptimization) {
+  node_poses_.Append(0, NodePoseAt(1.));
+  cache_.MarkOutdated();
+  test_server_->SendWrite(proto::GetTrajectoryNodePosesRequest());
+
+  const auto& response = test_server_->response();
+  ASSERT_EQ(response.node_poses_size(), 2);
+  EXPECT_EQ(response.node_poses(1).node_id().node_index(), 1);
+  EXPECT_EQ(response.node_poses(1).global_pose().translation().x(), 1.);
+}
+
+TEST_F(GetTrajectoryNodePosesHandlerTest, OmitsDeletedTrajectories) {
+  trajectory_states_.at(0) = TrajectoryState::DELETED;
+  node_poses_ = NodePoses();
+  test_server_->SendWrite(proto::GetTrajectoryNodePosesRequest());
+
+  EXPECT_TRUE(test_server_->response().full_snapshot());
+  EXPECT_EQ(test_server_->response().node_poses_size(), 0);
+}
+
+}  // namespace
+}  // namespace handlers
+}  // namespace cloud
+}  // namespace cartographer
@@ -37,6 +37,10 @@ void LoadStateFromFileHandler::OnRequest(
     GetContext<MapBuilderContextInterface>()->RegisterClientIdForTrajectory(
         request.client_id(), entry.second);
   }
+  // Loaded nodes are added without a local SLAM result.
+  GetContext<MapBuilderContextInterface>()
+      ->trajectory_node_poses_cache()
+      .MarkOutdated();
   auto response = absl::make_unique<proto::LoadStateFromFileResponse>();
   *response->mutable_trajectory_remapping() = ToProto(trajectory_remapping);
   Send(std::move(response));
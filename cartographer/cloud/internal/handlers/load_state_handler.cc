@@ -51,6 +51,10 @@ void LoadStateHandler::OnReadsDone() {
     GetContext<MapBuilderContextInterface>()->RegisterClientIdForTrajectory(
         client_id_, entry.second);
   }
+  // Loaded nodes are added without a local SLAM result.
+  GetContext<MapBuilderContextInterface>()
+      ->trajectory_node_poses_cache()
+      .MarkOutdated();
   auto response = absl::make_unique<proto::LoadStateResponse>();
   *response->mutable_trajectory_remapping() = ToProto(trajectory_remapping);
   Send(std::move(response));
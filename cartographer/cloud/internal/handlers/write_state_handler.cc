@@ -21,6 +21,8 @@
 #include "cartographer/cloud/internal/map_builder_server.h"
 #include "cartographer/cloud/proto/map_builder_service.pb.h"
 #include "cartographer/io/internal/in_memory_proto_stream.h"
+#include "cartographer/io/internal/mapping_state_serialization.h"
+#include "cartographer/mapping/pose_graph.h"
 
 namespace cartographer {
 namespace cloud {
@@ -48,8 +50,23 @@ void WriteStateHandler::OnRequest(const google::protobuf::Empty& request) {
         writer.Write(std::move(response));
         return true;
       });
-  GetContext<MapBuilderContextInterface>()->map_builder().SerializeState(
-      /*include_unfinished_submaps=*/false, &proto_stream_writer);
+  // Only the snapshot is taken under the synchronized context, since other
+  // handlers add to the trajectory builder options. Serializing it does not
+  // need the context, so SLAM and other handlers continue in the meantime.
+  io::MappingStateSnapshot snapshot;
+  common::ThreadPoolInterface* thread_pool;
+  {
+    auto context = GetContext<MapBuilderContextInterface>();
+    mapping::PoseGraphInterface* const pose_graph =
+        context->map_builder().pose_graph();
+    DCHECK(dynamic_cast<mapping::PoseGraph*>(pose_graph));
+    snapshot = io::TakeMappingStateSnapshot(
+        *static_cast<mapping::PoseGraph*>(pose_graph),
+        context->map_builder().GetAllTrajectoryBuilderOptions(),
+        /*include_unfinished_submaps=*/false);
+    thread_pool = context->thread_pool();
+  }
+  io::WritePbStream(snapshot, &proto_stream_writer, thread_pool);
   proto_stream_writer.Close();
 }
 
@@ -100,6 +100,17 @@ MapBuilderContext<SubmapType>::local_trajectory_uploader() {
   return map_builder_server_->local_trajectory_uploader_.get();
 }
 
+template <class SubmapType>
+TrajectoryNodePosesCache&
+MapBuilderContext<SubmapType>::trajectory_node_poses_cache() {
+  return map_builder_server_->trajectory_node_poses_cache_;
+}
+
+template <class SubmapType>
+common::ThreadPoolInterface* MapBuilderContext<SubmapType>::thread_pool() {
+  return &map_builder_server_->thread_pool_;
+}
+
 template <class SubmapType>
 void MapBuilderContext<SubmapType>::EnqueueSensorData(
     int trajectory_id, std::unique_ptr<sensor::Data> data) {
@@ -19,7 +19,9 @@
 
 #include "async_grpc/execution_context.h"
 #include "cartographer/cloud/internal/local_trajectory_uploader.h"
+#include "cartographer/cloud/internal/trajectory_node_poses_cache.h"
 #include "cartographer/common/blocking_queue.h"
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/mapping/map_builder_interface.h"
 #include "cartographer/mapping/pose_graph_interface.h"
 #include "cartographer/mapping/proto/serialization.pb.h"
@@ -87,6 +89,10 @@ class MapBuilderContextInterface : public async_grpc::ExecutionContext {
   virtual void UnsubscribeGlobalSlamOptimizations(int subscription_index) = 0;
   virtual void NotifyFinishTrajectory(int trajectory_id) = 0;
   virtual LocalTrajectoryUploaderInterface* local_trajectory_uploader() = 0;
+  virtual TrajectoryNodePosesCache& trajectory_node_poses_cache() = 0;
+  // Thread pool for work that runs outside of the synchronized context, e.g.
+  // serializing a snapshot of the mapping state.
+  virtual common::ThreadPoolInterface* thread_pool() = 0;
   virtual void EnqueueSensorData(int trajectory_id,
                                  std::unique_ptr<sensor::Data> data) = 0;
   virtual void EnqueueLocalSlamResultData(
@@ -58,7 +58,9 @@ const common::Duration kPopTimeout = common::FromMilliseconds(100);
 MapBuilderServer::MapBuilderServer(
     const proto::MapBuilderServerOptions& map_builder_server_options,
     std::unique_ptr<mapping::MapBuilderInterface> map_builder)
-    : map_builder_(std::move(map_builder)) {
+    : map_builder_(std::move(map_builder)),
+      thread_pool_(map_builder_server_options.map_builder_options()
+                       .num_background_threads()) {
   async_grpc::Server::Builder server_builder;
   server_builder.SetServerAddress(map_builder_server_options.server_address());
   server_builder.SetNumGrpcThreads(
@@ -180,6 +182,10 @@ void MapBuilderServer::OnLocalSlamResult(
     transform::Rigid3d local_pose, sensor::RangeData range_data,
     std::unique_ptr<const mapping::TrajectoryBuilderInterface::InsertionResult>
         insertion_result) {
+  if (insertion_result) {
+    // The node was added to the pose graph.
+    trajectory_node_poses_cache_.MarkOutdated();
+  }
   auto shared_range_data =
       std::make_shared<sensor::RangeData>(std::move(range_data));
 
@@ -229,6 +235,7 @@ void MapBuilderServer::OnLocalSlamResult(
 void MapBuilderServer::OnGlobalSlamOptimizations(
     const std::map<int, mapping::SubmapId>& last_optimized_submap_ids,
     const std::map<int, mapping::NodeId>& last_optimized_node_ids) {
+  trajectory_node_poses_cache_.MarkOutdated();
   absl::MutexLock locker(&subscriptions_lock_);
   for (auto& entry : global_slam_subscriptions_) {
     if (!entry.second(last_optimized_submap_ids, last_optimized_node_ids)) {
@@ -24,6 +24,7 @@
 #include "cartographer/cloud/map_builder_server_interface.h"
 #include "cartographer/cloud/proto/map_builder_server_options.pb.h"
 #include "cartographer/common/blocking_queue.h"
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/3d/submap_3d.h"
@@ -58,6 +59,8 @@ class MapBuilderContext : public MapBuilderContextInterface {
   void UnsubscribeGlobalSlamOptimizations(int subscription_index) override;
   void NotifyFinishTrajectory(int trajectory_id) override;
   LocalTrajectoryUploaderInterface* local_trajectory_uploader() override;
+  TrajectoryNodePosesCache& trajectory_node_poses_cache() override;
+  common::ThreadPoolInterface* thread_pool() override;
   void EnqueueSensorData(int trajectory_id,
                          std::unique_ptr<sensor::Data> data) override;
   void EnqueueLocalSlamResultData(int trajectory_id,
@@ -143,6 +146,8 @@ class MapBuilderServer : public MapBuilderServerInterface {
            MapBuilderContextInterface::GlobalSlamOptimizationCallback>
       global_slam_subscriptions_ GUARDED_BY(subscriptions_lock_);
   std::unique_ptr<LocalTrajectoryUploaderInterface> local_trajectory_uploader_;
+  TrajectoryNodePosesCache trajectory_node_poses_cache_;
+  common::ThreadPool thread_pool_;
   int starting_submap_index_ = 0;
 };
 
@@ -50,6 +50,8 @@ class MockMapBuilderContext : public MapBuilderContextInterface {
   MOCK_METHOD1(UnsubscribeGlobalSlamOptimizations, void(int));
   MOCK_METHOD1(NotifyFinishTrajectory, void(int));
   MOCK_METHOD0(local_trajectory_uploader, LocalTrajectoryUploaderInterface *());
+  MOCK_METHOD0(trajectory_node_poses_cache, TrajectoryNodePosesCache &());
+  MOCK_METHOD0(thread_pool, common::ThreadPoolInterface *());
 
   MOCK_METHOD2(DoEnqueueSensorData, void(int, sensor::Data *));
   void EnqueueSensorData(int trajectory_id,
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/cloud/internal/trajectory_node_poses_cache.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "cartographer/transform/transform.h"
+
+namespace cartographer {
+namespace cloud {
+namespace {
+
+bool IsEqual(const transform::Rigid3d& lhs, const transform::Rigid3d& rhs) {
+  return lhs.translation() == rhs.translation() &&
+         lhs.rotation().coeffs() == rhs.rotation().coeffs();
+}
+
+proto::TrajectoryNodePose ToProto(
+    const mapping::NodeId& node_id,
+    const mapping::TrajectoryNodePose& trajectory_node_pose) {
+  proto::TrajectoryNodePose node_pose;
+  node_id.ToProto(node_pose.mutable_node_id());
+  *node_pose.mutable_global_pose() =
+      transform::ToProto(trajectory_node_pose.global_pose);
+  if (trajectory_node_pose.constant_pose_data.has_value()) {
+    node_pose.mutable_constant_pose_data()->set_timestamp(common::ToUniversal(
+        trajectory_node_pose.constant_pose_data.value().time));
+    *node_pose.mutable_constant_pose_data()->mutable_local_pose() =
+        transform::ToProto(
+            trajectory_node_pose.constant_pose_data.value().local_pose);
+  }
+  return node_pose;
+}
+
+bool HasFilter(const proto::GetTrajectoryNodePosesRequest& request) {
+  return request.has_time_window() || request.has_bounding_box();
+}
+
+bool MatchesFilter(const proto::GetTrajectoryNodePosesRequest& request,
+                   const proto::TrajectoryNodePose& node_pose) {
+  if (request.has_time_window()) {
+    if (!node_pose.has_constant_pose_data()) {
+      return false;
+    }
+    const int64 timestamp = node_pose.constant_pose_data().timestamp();
+    if (timestamp < request.time_window().start_timestamp() ||
+        timestamp > request.time_window().end_timestamp()) {
+      return false;
+    }
+  }
+  if (request.has_bounding_box()) {
+    const Eigen::Vector3d translation =
+        transform::ToEigen(node_pose.global_pose().translation());
+    const Eigen::Vector3d min =
+        transform::ToEigen(request.bounding_box().min());
+    const Eigen::Vector3d max =
+        transform::ToEigen(request.bounding_box().max());
+    if ((translation.array() < min.array()).any() ||
+        (translation.array() > max.array()).any()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<proto::GetTrajectoryNodePosesResponse>
+TrajectoryNodePosesCache::GetNodePoses(
+    const proto::GetTrajectoryNodePosesRequest& request) {
+  auto response = absl::make_unique<proto::GetTrajectoryNodePosesResponse>();
+  std::shared_ptr<const proto::GetTrajectoryNodePosesResponse> snapshot;
+  {
+    absl::MutexLock locker(&mutex_);
+    if (request.since_version() >= oldest_delta_version_ &&
+        request.since_version() <= version_) {
+      for (auto it = changes_.upper_bound(request.since_version());
+           it != changes_.end(); ++it) {
+        for (const mapping::NodeId& node_id : it->second) {
+          const auto node_it = node_poses_.find(node_id);
+          // Only the last change of a node is reported.
+          if (node_it == node_poses_.end() ||
+              node_it->data.version != it->first ||
+              !MatchesFilter(request, node_it->data.node_pose)) {
+            continue;
+          }
+          *response->add_node_poses() = node_it->data.node_pose;
+        }
+      }
+      response->set_version(version_);
+      return response;
+    }
+    if (HasFilter(request)) {
+      for (const auto& node_id_data : node_poses_) {
+        if (MatchesFilter(request, node_id_data.data.node_pose)) {
+          *response->add_node_poses() = node_id_data.data.node_pose;
+        }
+      }
+      response->set_version(version_);
+      response->set_full_snapshot(true);
+      return response;
+    }
+    snapshot = snapshot_;
+  }
+  // Copying all node poses is the expensive part, so it happens without
+  // holding the lock.
+  *response = *snapshot;
+  response->set_full_snapshot(true);
+  return response;
+}
+
+void TrajectoryNodePosesCache::MarkOutdated() { outdated_ = true; }
+
+void TrajectoryNodePosesCache::UpdateIfNeeded(
+    const mapping::PoseGraphInterface& pose_graph) {
+  absl::MutexLock locker(&update_mutex_);
+  // Trimming and deleting trajectories happens after the optimization which
+  // marked the cache outdated, so the trajectory states are compared as well.
+  auto trajectory_states = pose_graph.GetTrajectoryStates();
+  if (!outdated_.exchange(false) && trajectory_states == trajectory_states_) {
+    return;
+  }
+  trajectory_states_ = std::move(trajectory_states);
+  Update(pose_graph.GetTrajectoryNodePoses());
+}
+
+void TrajectoryNodePosesCache::Update(
+    const mapping::MapById<mapping::NodeId, mapping::TrajectoryNodePose>&
+        node_poses) {
+  absl::MutexLock locker(&mutex_);
+  const int64 next_version = version_ + 1;
+  std::vector<mapping::NodeId> changed_node_ids;
+  for (const auto& node_id_data : node_poses) {
+    const mapping::TrajectoryNodePose& node_pose = node_id_data.data;
+    const bool has_constant_pose_data =
+        node_pose.constant_pose_data.has_value();
+    const CachedNodePose cached_node_pose{
+        node_pose.global_pose, has_constant_pose_data, next_version,
+        proto::TrajectoryNodePose()};
+    if (node_poses_.find(node_id_data.id) == node_poses_.end()) {
+      node_poses_.Insert(node_id_data.id, cached_node_pose);
+    } else {
+      const CachedNodePose& cached = node_poses_.at(node_id_data.id);
+      if (IsEqual(cached.global_pose, node_pose.global_pose) &&
+          cached.has_constant_pose_data == has_constant_pose_data) {
+        continue;
+      }
+      node_poses_.at(node_id_data.id) = cached_node_pose;
+    }
+    node_poses_.at(node_id_data.id).node_pose =
+        ToProto(node_id_data.id, node_pose);
+    changed_node_ids.push_back(node_id_data.id);
+  }
+
+  // All nodes of 'node_poses' are cached now, so any additional cached node
+  // was trimmed from the pose graph. Since removals are not part of the
+  // changes, clients need to fetch all node poses again.
+  bool trimmed_nodes = false;
+  if (node_poses_.size() > node_poses.size()) {
+    std::vector<mapping::NodeId> trimmed_node_ids;
+    for (const auto& node_id_data : node_poses_) {
+      if (node_poses.find(node_id_data.id) == node_poses.end()) {
+        trimmed_node_ids.push_back(node_id_data.id);
+      }
+    }
+    for (const mapping::NodeId& node_id : trimmed_node_ids) {
+      node_poses_.Trim(node_id);
+    }
+    trimmed_nodes = true;
+    oldest_delta_version_ = next_version;
+  }
+
+  if (changed_node_ids.empty() && !trimmed_nodes) {
+    return;
+  }
+  version_ = next_version;
+  num_changes_ += changed_node_ids.size();
+  changes_.emplace(version_, std::move(changed_node_ids));
+  TrimChanges();
+
+  auto snapshot = std::make_shared<proto::GetTrajectoryNodePosesResponse>();
+  for (const auto& node_id_data : node_poses_) {
+    *snapshot->add_node_poses() = node_id_data.data.node_pose;
+  }
+  snapshot->set_version(version_);
+  snapshot_ = std::move(snapshot);
+}
+
+void TrajectoryNodePosesCache::TrimChanges() {
+  // Once the changes cover twice as many entries as there are nodes, a client
+  // which is that far behind is better served with all node poses.
+  while (changes_.size() > 1 && num_changes_ > 2 * node_poses_.size()) {
+    num_changes_ -= changes_.begin()->second.size();
+    oldest_delta_version_ =
+        std::max(oldest_delta_version_, changes_.begin()->first);
+    changes_.erase(changes_.begin());
+  }
+}
+
+}  // namespace cloud
+}  // namespace cartographer
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_CLOUD_INTERNAL_TRAJECTORY_NODE_POSES_CACHE_H
+#define CARTOGRAPHER_CLOUD_INTERNAL_TRAJECTORY_NODE_POSES_CACHE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "cartographer/cloud/proto/map_builder_service.pb.h"
+#include "cartographer/common/port.h"
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_interface.h"
+#include "cartographer/mapping/trajectory_node.h"
+
+namespace cartographer {
+namespace cloud {
+
+// Keeps the node poses served to clients of 'GetTrajectoryNodePoses' in their
+// proto form. The cache is only updated from the pose graph when a request
+// comes in after the node poses changed, i.e. after nodes were added,
+// optimized, loaded or deleted. Every update which changes, adds or trims node
+// poses results in a new version. Clients can ask for the node poses that
+// changed since the version they know about, and requests for all node poses
+// are answered from a snapshot that is built once per version.
+class TrajectoryNodePosesCache {
+ public:
+  TrajectoryNodePosesCache() = default;
+
+  TrajectoryNodePosesCache(const TrajectoryNodePosesCache&) = delete;
+  TrajectoryNodePosesCache& operator=(const TrajectoryNodePosesCache&) =
+      delete;
+
+  // Marks the cached node poses as outdated because nodes were added, loaded
+  // or optimized. Cheap, so it can be called for every change.
+  void MarkOutdated();
+
+  // Updates the cache from 'pose_graph' if it was marked outdated or the
+  // trajectory states changed, e.g. because a trajectory was deleted.
+  void UpdateIfNeeded(const mapping::PoseGraphInterface& pose_graph)
+      LOCKS_EXCLUDED(update_mutex_, mutex_);
+
+  // Updates the cache with the current 'node_poses' of the pose graph.
+  void Update(const mapping::MapById<mapping::NodeId,
+                                     mapping::TrajectoryNodePose>& node_poses)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Returns the response to 'request' from the node poses of the last update.
+  std::unique_ptr<proto::GetTrajectoryNodePosesResponse> GetNodePoses(
+      const proto::GetTrajectoryNodePosesRequest& request)
+      LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct CachedNodePose {
+    transform::Rigid3d global_pose;
+    bool has_constant_pose_data;
+    // The version in which this node pose last changed.
+    int64 version;
+    proto::TrajectoryNodePose node_pose;
+  };
+
+  // Drops the oldest entries of 'changes_' once they make up more than twice
+  // the number of cached node poses.
+  void TrimChanges() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Set when the node poses of the pose graph may have changed since the last
+  // update. Cleared before updating, so that no change is missed.
+  std::atomic<bool> outdated_{true};
+  // Serializes updates from the pose graph. Acquired before 'mutex_'.
+  absl::Mutex update_mutex_;
+  // The trajectory states at the last update from the pose graph.
+  std::map<int, mapping::PoseGraphInterface::TrajectoryState>
+      trajectory_states_ GUARDED_BY(update_mutex_);
+
+  absl::Mutex mutex_;
+  mapping::MapById<mapping::NodeId, CachedNodePose> node_poses_
+      GUARDED_BY(mutex_);
+  int64 version_ GUARDED_BY(mutex_) = 0;
+  // The node IDs which changed in each version.
+  std::map<int64 /* version */, std::vector<mapping::NodeId>> changes_
+      GUARDED_BY(mutex_);
+  size_t num_changes_ GUARDED_BY(mutex_) = 0;
+  // Changes since versions older than this one are not available anymore,
+  // either because nodes were trimmed or because 'changes_' was trimmed.
+  int64 oldest_delta_version_ GUARDED_BY(mutex_) = 1;
+  // All node poses at 'version_'. It is shared with requests being answered,
+  // so it is replaced rather than modified.
+  std::shared_ptr<const proto::GetTrajectoryNodePosesResponse> snapshot_
+      GUARDED_BY(mutex_) =
+          std::make_shared<proto::GetTrajectoryNodePosesResponse>();
+};
+
+}  // namespace cloud
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_CLOUD_INTERNAL_TRAJECTORY_NODE_POSES_CACHE_H
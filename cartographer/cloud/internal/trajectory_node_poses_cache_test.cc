@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/cloud/internal/trajectory_node_poses_cache.h"
+
+#include "cartographer/mapping/internal/testing/mock_pose_graph.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace cloud {
+namespace {
+
+using NodePoses =
+    mapping::MapById<mapping::NodeId, mapping::TrajectoryNodePose>;
+
+mapping::TrajectoryNodePose NodePoseAt(const double x) {
+  return mapping::TrajectoryNodePose{
+      transform::Rigid3d::Translation(Eigen::Vector3d(x, 0., 0.)),
+      mapping::TrajectoryNodePose::ConstantPoseData{
+          common::FromUniversal(static_cast<int64>(x)),
+          transform::Rigid3d::Identity()}};
+}
+
+std::vector<int> NodeIndices(
+    const proto::GetTrajectoryNodePosesResponse& response) {
+  std::vector<int> node_indices;
+  for (const auto& node_pose : response.node_poses()) {
+    node_indices.push_back(node_pose.node_id().node_index());
+  }
+  return node_indices;
+}
+
+TEST(TrajectoryNodePosesCacheTest, ReturnsOnlyChangedNodePoses) {
+  TrajectoryNodePosesCache cache;
+  NodePoses node_poses;
+  for (int i = 0; i < 3; ++i) {
+    node_poses.Append(0, NodePoseAt(i));
+  }
+  cache.Update(node_poses);
+  proto::GetTrajectoryNodePosesRequest request;
+  auto response = cache.GetNodePoses(request);
+  EXPECT_TRUE(response->full_snapshot());
+  EXPECT_THAT(NodeIndices(*response), ::testing::ElementsAre(0, 1, 2));
+
+  request.set_since_version(response->version());
+  cache.Update(node_poses);
+  response = cache.GetNodePoses(request);
+  EXPECT_FALSE(response->full_snapshot());
+  EXPECT_EQ(response->version(), request.since_version());
+  EXPECT_EQ(response->node_poses_size(), 0);
+
+  node_poses.Append(0, NodePoseAt(3));
+  node_poses.at(mapping::NodeId{0, 1}).global_pose =
+      transform::Rigid3d::Translation(Eigen::Vector3d(1.5, 0., 0.));
+  cache.Update(node_poses);
+  response = cache.GetNodePoses(request);
+  EXPECT_FALSE(response->full_snapshot());
+  EXPECT_GT(response->version(), request.since_version());
+  EXPECT_THAT(NodeIndices(*response), ::testing::ElementsAre(1, 3));
+  EXPECT_EQ(response->node_poses(0).global_pose().translation().x(), 1.5);
+}
+
+TEST(TrajectoryNodePosesCacheTest, ServesNodePosesOfLastUpdate) {
+  TrajectoryNodePosesCache cache;
+  proto::GetTrajectoryNodePosesRequest request;
+  auto response = cache.GetNodePoses(request);
+  EXPECT_TRUE(response->full_snapshot());
+  EXPECT_EQ(response->version(), 0);
+  EXPECT_EQ(response->node_poses_size(), 0);
+
+  NodePoses node_poses;
+  node_poses.Append(0, NodePoseAt(0));
+  cache.Update(node_poses);
+  node_poses.Append(0, NodePoseAt(1));
+  response = cache.GetNodePoses(request);
+  EXPECT_THAT(NodeIndices(*response), ::testing::ElementsAre(0));
+
+  const int64 version = response->version();
+  EXPECT_EQ(cache.GetNodePoses(request)->version(), version);
+  cache.Update(node_poses);
+  response = cache.GetNodePoses(request);
+  EXPECT_GT(response->version(), version);
+  EXPECT_THAT(NodeIndices(*response), ::testing::ElementsAre(0, 1));
+}
+
+TEST(TrajectoryNodePosesCacheTest, UpdatesFromPoseGraphOnlyWhenNeeded) {
+  using TrajectoryState = mapping::PoseGraphInterface::TrajectoryState;
+  mapping::testing::MockPoseGraph pose_graph;
+  std::map<int, TrajectoryState> trajectory_states = {
+      {0, TrajectoryState::ACTIVE}};
+  NodePoses node_poses;
+  node_poses.Append(0, NodePoseAt(0));
+  EXPECT_CALL(pose_graph, GetTrajectoryStates())
+      .WillRepeatedly(::testing::ReturnPointee(&trajectory_states));
+  EXPECT_CALL(pose_graph, GetTrajectoryNodePoses())
+      .Times(3)
+      .WillRepeatedly(::testing::ReturnPointee(&node_poses));
+  TrajectoryNodePosesCache cache;
+  const proto::GetTrajectoryNodePosesRequest request;
+  cache.UpdateIfNeeded(pose_graph);
+  EXPECT_THAT(NodeIndices(*cache.GetNodePoses(request)),
+              ::testing::ElementsAre(0));
+  // Nothing changed, so the pose graph is not asked again.
+  cache.UpdateIfNeeded(pose_graph);
+
+  // A node was added without an optimization.
+  node_poses.Append(0, NodePoseAt(1));
+  cache.MarkOutdated();
+  cache.UpdateIfNeeded(pose_graph);
+  EXPECT_THAT(NodeIndices(*cache.GetNodePoses(request)),
+              ::testing::ElementsAre(0, 1));
+
+  // The trajectory was deleted after the last optimization.
+  trajectory_states.at(0) = TrajectoryState::DELETED;
+  node_poses = NodePoses();
+  cache.UpdateIfNeeded(pose_graph);
+  EXPECT_EQ(cache.GetNodePoses(request)->node_poses_size(), 0);
+}
+
+TEST(TrajectoryNodePosesCacheTest, ReturnsAllNodePosesAfterTrimming) {
+  TrajectoryNodePosesCache cache;
+  NodePoses node_poses;
+  for (int i = 0; i < 3; ++i) {
+    node_poses.Append(0, NodePoseAt(i));
+  }
+  cache.Update(node_poses);
+  proto::GetTrajectoryNodePosesRequest request;
+  request.set_since_version(cache.GetNodePoses(request)->version());
+  node_poses.Trim(mapping::NodeId{0, 1});
+  cache.Update(node_poses);
+  const auto response = cache.GetNodePoses(request);
+  EXPECT_TRUE(response->full_snapshot());
+  EXPECT_THAT(NodeIndices(*response), ::testing::ElementsAre(0, 2));
+}
+
+TEST(TrajectoryNodePosesCacheTest, FiltersByTimeAndBoundingBox) {
+  TrajectoryNodePosesCache cache;
+  NodePoses node_poses;
+  for (int i = 0; i < 10; ++i) {
+    node_poses.Append(0, NodePoseAt(i));
+  }
+  cache.Update(node_poses);
+  proto::GetTrajectoryNodePosesRequest request;
+  request.mutable_time_window()->set_start_timestamp(2);
+  request.mutable_time_window()->set_end_timestamp(7);
+  EXPECT_THAT(NodeIndices(*cache.GetNodePoses(request)),
+              ::testing::ElementsAre(2, 3, 4, 5, 6, 7));
+
+  request.mutable_bounding_box()->mutable_min()->set_x(4.5);
+  request.mutable_bounding_box()->mutable_max()->set_x(100.);
+  EXPECT_THAT(NodeIndices(*cache.GetNodePoses(request)),
+              ::testing::ElementsAre(5, 6, 7));
+}
+
+}  // namespace
+}  // namespace cloud
+}  // namespace cartographer
@@ -32,12 +32,16 @@ DEFINE_string(configuration_directory, "",
 DEFINE_string(configuration_basename, "",
               "Basename, i.e. not containing any directory prefix, of the "
               "configuration file.");
+DEFINE_string(configuration_cache_directory, "",
+              "If set, an existing directory in which the options compiled "
+              "from the configuration are cached to speed up later starts.");
 
 namespace cartographer {
 namespace cloud {
 
 void Run(const std::string& configuration_directory,
-         const std::string& configuration_basename) {
+         const std::string& configuration_basename,
+         const std::string& configuration_cache_directory) {
 #if USE_PROMETHEUS
   metrics::prometheus::FamilyFactory registry;
   ::cartographer::metrics::RegisterAllMetrics(&registry);
@@ -47,9 +51,18 @@ void Run(const std::string& configuration_directory,
   LOG(INFO) << "Exposing metrics at http://localhost:9100/metrics";
 #endif
 
-  proto::MapBuilderServerOptions map_builder_server_options =
-      LoadMapBuilderServerOptions(configuration_directory,
-                                  configuration_basename);
+  proto::MapBuilderServerOptions map_builder_server_options;
+  if (configuration_cache_directory.empty()) {
+    map_builder_server_options = LoadMapBuilderServerOptions(
+        configuration_directory, configuration_basename);
+  } else {
+    common::ConfigurationCache configuration_cache(
+        configuration_cache_directory);
+    map_builder_server_options =
+        LoadMapBuilderServerOptions(configuration_directory,
+                                    configuration_basename,
+                                    &configuration_cache);
+  }
   auto map_builder = absl::make_unique<mapping::MapBuilder>(
       map_builder_server_options.map_builder_options());
   std::unique_ptr<MapBuilderServerInterface> map_builder_server =
@@ -75,5 +88,6 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
   cartographer::cloud::Run(FLAGS_configuration_directory,
-                           FLAGS_configuration_basename);
+                           FLAGS_configuration_basename,
+                           FLAGS_configuration_cache_directory);
 }
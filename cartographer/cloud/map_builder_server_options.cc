@@ -58,5 +58,18 @@ proto::MapBuilderServerOptions LoadMapBuilderServerOptions(
   return CreateMapBuilderServerOptions(&lua_parameter_dictionary);
 }
 
+proto::MapBuilderServerOptions LoadMapBuilderServerOptions(
+    const std::string& configuration_directory,
+    const std::string& configuration_basename,
+    common::ConfigurationCache* configuration_cache) {
+  auto file_resolver = absl::make_unique<common::ConfigurationFileResolver>(
+      std::vector<std::string>{configuration_directory});
+  const std::string code =
+      file_resolver->GetFileContentOrDie(configuration_basename);
+  return configuration_cache
+      ->LoadOrCreateOptions<proto::MapBuilderServerOptions>(
+          code, std::move(file_resolver), &CreateMapBuilderServerOptions);
+}
+
 }  // namespace cloud
 }  // namespace cartographer
@@ -20,6 +20,7 @@
 #include <string>
 
 #include "cartographer/cloud/proto/map_builder_server_options.pb.h"
+#include "cartographer/common/configuration_cache.h"
 #include "cartographer/common/lua_parameter_dictionary.h"
 
 namespace cartographer {
@@ -32,6 +33,13 @@ proto::MapBuilderServerOptions LoadMapBuilderServerOptions(
     const std::string& configuration_directory,
     const std::string& configuration_basename);
 
+// Like above, but reuses the options compiled by an earlier run if they are
+// still up to date in 'configuration_cache'.
+proto::MapBuilderServerOptions LoadMapBuilderServerOptions(
+    const std::string& configuration_directory,
+    const std::string& configuration_basename,
+    common::ConfigurationCache* configuration_cache);
+
 }  // namespace cloud
 }  // namespace cartographer
 
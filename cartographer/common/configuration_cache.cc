@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/common/configuration_cache.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "cartographer/common/proto/compiled_configuration.pb.h"
+
+namespace cartographer {
+namespace common {
+namespace {
+
+// Forwards to 'file_resolver' and remembers the content of all files read.
+class RecordingFileResolver : public FileResolver {
+ public:
+  explicit RecordingFileResolver(std::unique_ptr<FileResolver> file_resolver)
+      : file_resolver_(std::move(file_resolver)) {}
+
+  std::string GetFullPathOrDie(const std::string& basename) override {
+    return file_resolver_->GetFullPathOrDie(basename);
+  }
+
+  std::string GetFileContentOrDie(const std::string& basename) override {
+    std::string content = file_resolver_->GetFileContentOrDie(basename);
+    proto::CompiledConfiguration::Source source;
+    source.set_basename(basename);
+    source.set_content(content);
+    sources_.push_back(std::move(source));
+    return content;
+  }
+
+  bool GetFileContent(const std::string& basename,
+                      std::string* content) override {
+    return file_resolver_->GetFileContent(basename, content);
+  }
+
+  const std::vector<proto::CompiledConfiguration::Source>& sources() const {
+    return sources_;
+  }
+
+ private:
+  std::unique_ptr<FileResolver> file_resolver_;
+  std::vector<proto::CompiledConfiguration::Source> sources_;
+};
+
+// 64-bit FNV-1a hash, which unlike std::hash is stable across runs.
+uint64_t Fingerprint(const std::string& data, uint64_t hash) {
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211u;
+  }
+  return hash;
+}
+
+std::string CacheFilename(const std::string& code,
+                          const std::string& options_type) {
+  constexpr uint64_t kFnvOffsetBasis = 14695981039346656037u;
+  const uint64_t hash =
+      Fingerprint(code, Fingerprint(options_type + '\0', kFnvOffsetBasis));
+  return absl::StrCat(absl::Hex(hash, absl::kZeroPad16), ".pbconfig");
+}
+
+bool ReadCompiledConfiguration(
+    const std::string& filename,
+    proto::CompiledConfiguration* compiled_configuration) {
+  std::ifstream stream(filename, std::ios::binary);
+  return stream.good() && compiled_configuration->ParseFromIstream(&stream);
+}
+
+bool IsUpToDate(const proto::CompiledConfiguration& compiled_configuration,
+                const std::string& code, const std::string& options_type,
+                FileResolver* file_resolver) {
+  if (compiled_configuration.code() != code ||
+      compiled_configuration.options_type() != options_type) {
+    return false;
+  }
+  std::string content;
+  for (const auto& source : compiled_configuration.sources()) {
+    if (!file_resolver->GetFileContent(source.basename(), &content) ||
+        content != source.content()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Writes to a uniquely named temporary file first, so that concurrent readers
+// never see a partially written entry and concurrent writers of the same entry
+// do not interfere.
+void WriteCompiledConfiguration(
+    const std::string& filename,
+    const proto::CompiledConfiguration& compiled_configuration) {
+  std::string temporary_filename = filename + ".XXXXXX";
+  const int fd = mkstemp(&temporary_filename[0]);
+  if (fd == -1) {
+    LOG(WARNING) << "Failed to create a temporary file for '" << filename
+                 << "'.";
+    return;
+  }
+  close(fd);
+  {
+    std::ofstream stream(temporary_filename,
+                         std::ios::binary | std::ios::trunc);
+    if (!compiled_configuration.SerializeToOstream(&stream) ||
+        !stream.good()) {
+      LOG(WARNING) << "Failed to write '" << temporary_filename << "'.";
+      std::remove(temporary_filename.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+    LOG(WARNING) << "Failed to rename '" << temporary_filename << "' to '"
+                 << filename << "'.";
+    std::remove(temporary_filename.c_str());
+  }
+}
+
+}  // namespace
+
+ConfigurationCache::ConfigurationCache(const std::string& cache_directory)
+    : cache_directory_(cache_directory) {}
+
+std::string ConfigurationCache::LoadOrCreateSerializedOptions(
+    const std::string& code, const std::string& options_type,
+    std::unique_ptr<FileResolver> file_resolver,
+    const std::function<std::string(LuaParameterDictionary*)>&
+        create_serialized_options) {
+  const std::string filename =
+      cache_directory_ + "/" + CacheFilename(code, options_type);
+  proto::CompiledConfiguration compiled_configuration;
+  if (ReadCompiledConfiguration(filename, &compiled_configuration) &&
+      IsUpToDate(compiled_configuration, code, options_type,
+                 file_resolver.get())) {
+    return compiled_configuration.options();
+  }
+
+  auto recording_file_resolver =
+      absl::make_unique<RecordingFileResolver>(std::move(file_resolver));
+  const RecordingFileResolver* const sources = recording_file_resolver.get();
+  LuaParameterDictionary parameter_dictionary(
+      code, std::move(recording_file_resolver));
+  compiled_configuration.Clear();
+  compiled_configuration.set_code(code);
+  compiled_configuration.set_options_type(options_type);
+  compiled_configuration.set_options(
+      create_serialized_options(&parameter_dictionary));
+  for (const auto& source : sources->sources()) {
+    *compiled_configuration.add_sources() = source;
+  }
+  WriteCompiledConfiguration(filename, compiled_configuration);
+  return compiled_configuration.options();
+}
+
+}  // namespace common
+}  // namespace cartographer
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_COMMON_CONFIGURATION_CACHE_H_
+#define CARTOGRAPHER_COMMON_CONFIGURATION_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "cartographer/common/lua_parameter_dictionary.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace common {
+
+// Caches options protos compiled from Lua configurations on disk, so that
+// short-lived processes do not need to run Lua and build the options again on
+// every startup. An entry is keyed on the Lua code and the options type, and
+// is only used if all files read while compiling it through the
+// 'FileResolver' still have the same content.
+class ConfigurationCache {
+ public:
+  // The 'cache_directory' has to exist.
+  explicit ConfigurationCache(const std::string& cache_directory);
+
+  // Returns the options for 'code' from the cache if possible. Otherwise the
+  // code is run and 'create_options' is called on the resulting dictionary,
+  // and the options are added to the cache.
+  template <typename OptionsType>
+  OptionsType LoadOrCreateOptions(
+      const std::string& code, std::unique_ptr<FileResolver> file_resolver,
+      const std::function<OptionsType(LuaParameterDictionary*)>&
+          create_options) {
+    OptionsType options;
+    CHECK(options.ParseFromString(LoadOrCreateSerializedOptions(
+        code, OptionsType::descriptor()->full_name(), std::move(file_resolver),
+        [&create_options](LuaParameterDictionary* parameter_dictionary) {
+          return create_options(parameter_dictionary).SerializeAsString();
+        })));
+    return options;
+  }
+
+ private:
+  std::string LoadOrCreateSerializedOptions(
+      const std::string& code, const std::string& options_type,
+      std::unique_ptr<FileResolver> file_resolver,
+      const std::function<std::string(LuaParameterDictionary*)>&
+          create_serialized_options);
+
+  const std::string cache_directory_;
+};
+
+}  // namespace common
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_COMMON_CONFIGURATION_CACHE_H_
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/common/configuration_cache.h"
+
+#include <dirent.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "cartographer/common/ceres_solver_options.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace common {
+namespace {
+
+class MapFileResolver : public FileResolver {
+ public:
+  MapFileResolver(const std::map<std::string, std::string>* files,
+                  const std::set<std::string>* unreadable_files)
+      : files_(files), unreadable_files_(unreadable_files) {}
+
+  std::string GetFullPathOrDie(const std::string& basename) override {
+    CHECK(files_->count(basename)) << basename;
+    return basename;
+  }
+
+  std::string GetFileContentOrDie(const std::string& basename) override {
+    return files_->at(basename);
+  }
+
+  bool GetFileContent(const std::string& basename,
+                      std::string* content) override {
+    if (!files_->count(basename) || unreadable_files_->count(basename)) {
+      return false;
+    }
+    *content = files_->at(basename);
+    return true;
+  }
+
+ private:
+  const std::map<std::string, std::string>* const files_;
+  const std::set<std::string>* const unreadable_files_;
+};
+
+class ConfigurationCacheTest : public ::testing::Test {
+ protected:
+  ConfigurationCacheTest() {
+    cache_directory_ = ::testing::TempDir() + "/configuration_cache_XXXXXX";
+    CHECK(mkdtemp(&cache_directory_[0]) != nullptr);
+    cache_ = absl::make_unique<ConfigurationCache>(cache_directory_);
+    files_["solver.lua"] =
+        "SOLVER = { use_nonmonotonic_steps = false, max_num_iterations = 10, "
+        "num_threads = 1 }";
+  }
+
+  proto::CeresSolverOptions LoadOrCreateOptions() {
+    return cache_->LoadOrCreateOptions<proto::CeresSolverOptions>(
+        "include \"solver.lua\"\nreturn SOLVER",
+        absl::make_unique<MapFileResolver>(&files_, &unreadable_files_),
+        [this](LuaParameterDictionary* parameter_dictionary) {
+          ++num_compilations_;
+          return CreateCeresSolverOptionsProto(parameter_dictionary);
+        });
+  }
+
+  std::string cache_directory_;
+  std::unique_ptr<ConfigurationCache> cache_;
+  std::map<std::string, std::string> files_;
+  std::set<std::string> unreadable_files_;
+  std::atomic<int> num_compilations_{0};
+};
+
+TEST_F(ConfigurationCacheTest, ReusesCompiledOptions) {
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  EXPECT_EQ(num_compilations_, 1);
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  EXPECT_EQ(num_compilations_, 1);
+}
+
+TEST_F(ConfigurationCacheTest, RecompilesWhenIncludedFileChanges) {
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  files_["solver.lua"] =
+      "SOLVER = { use_nonmonotonic_steps = false, max_num_iterations = 20, "
+      "num_threads = 1 }";
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 20);
+  EXPECT_EQ(num_compilations_, 2);
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 20);
+  EXPECT_EQ(num_compilations_, 2);
+}
+
+TEST_F(ConfigurationCacheTest, RecompilesWhenIncludedFileIsUnreadable) {
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  unreadable_files_.insert("solver.lua");
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  EXPECT_EQ(num_compilations_, 2);
+  unreadable_files_.clear();
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  EXPECT_EQ(num_compilations_, 2);
+}
+
+TEST_F(ConfigurationCacheTest, ConcurrentWritersOfTheSameEntry) {
+  constexpr int kNumThreads = 8;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([this]() {
+      EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  const int num_compilations = num_compilations_;
+  EXPECT_EQ(LoadOrCreateOptions().max_num_iterations(), 10);
+  EXPECT_EQ(num_compilations_, num_compilations);
+  // Only the cache entry itself is left behind.
+  DIR* const directory = opendir(cache_directory_.c_str());
+  ASSERT_NE(directory, nullptr);
+  int num_files = 0;
+  while (const dirent* const entry = readdir(directory)) {
+    if (entry->d_name[0] != '.') {
+      ++num_files;
+    }
+  }
+  closedir(directory);
+  EXPECT_EQ(num_files, 1);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace cartographer
@@ -32,8 +32,8 @@ ConfigurationFileResolver::ConfigurationFileResolver(
   configuration_files_directories_.push_back(kConfigurationFilesDirectory);
 }
 
-std::string ConfigurationFileResolver::GetFullPathOrDie(
-    const std::string& basename) {
+std::string ConfigurationFileResolver::GetFullPath(
+    const std::string& basename) const {
   for (const auto& path : configuration_files_directories_) {
     const std::string filename = path + "/" + basename;
     std::ifstream stream(filename.c_str());
@@ -42,7 +42,16 @@ std::string ConfigurationFileResolver::GetFullPathOrDie(
       return filename;
     }
   }
-  LOG(FATAL) << "File '" << basename << "' was not found.";
+  return "";
+}
+
+std::string ConfigurationFileResolver::GetFullPathOrDie(
+    const std::string& basename) {
+  const std::string filename = GetFullPath(basename);
+  if (filename.empty()) {
+    LOG(FATAL) << "File '" << basename << "' was not found.";
+  }
+  return filename;
 }
 
 std::string ConfigurationFileResolver::GetFileContentOrDie(
@@ -54,5 +63,20 @@ std::string ConfigurationFileResolver::GetFileContentOrDie(
                      std::istreambuf_iterator<char>());
 }
 
+bool ConfigurationFileResolver::GetFileContent(const std::string& basename,
+                                               std::string* content) {
+  if (basename.empty()) {
+    return false;
+  }
+  const std::string filename = GetFullPath(basename);
+  if (filename.empty()) {
+    return false;
+  }
+  std::ifstream stream(filename.c_str());
+  content->assign(std::istreambuf_iterator<char>(stream),
+                  std::istreambuf_iterator<char>());
+  return !stream.bad();
+}
+
 }  // namespace common
 }  // namespace cartographer
@@ -38,8 +38,13 @@ class ConfigurationFileResolver : public FileResolver {
 
   std::string GetFullPathOrDie(const std::string& basename) override;
   std::string GetFileContentOrDie(const std::string& basename) override;
+  bool GetFileContent(const std::string& basename,
+                      std::string* content) override;
 
  private:
+  // Returns the full path of 'basename', or an empty string if not found.
+  std::string GetFullPath(const std::string& basename) const;
+
   std::vector<std::string> configuration_files_directories_;
 };
 
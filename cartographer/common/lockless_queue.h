@@ -62,6 +62,10 @@ class LocklessQueue {
     if (data_list_head_ != nullptr) {
       Node* node = data_list_head_;
       data_list_head_ = data_list_head_->next;
+      if (data_list_head_ == nullptr) {
+        // The node is reused, so it must not stay the tail.
+        data_list_tail_ = nullptr;
+      }
       std::unique_ptr<T> data = std::move(node->data);
       PushNodeToList(&free_list_head_, node);
       return std::move(data);
@@ -21,6 +21,15 @@ TEST(LocklessQueueTest, PushAndPop) {
   EXPECT_EQ(queue.Pop(), nullptr);
 }
 
+TEST(LocklessQueueTest, PushAfterEmptied) {
+  LocklessQueue<int> queue;
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(absl::make_unique<int>(i));
+    EXPECT_EQ(*queue.Pop(), i);
+    EXPECT_EQ(queue.Pop(), nullptr);
+  }
+}
+
 }  // namespace
 }  // namespace common
 }  // namespace cartographer
\ No newline at end of file
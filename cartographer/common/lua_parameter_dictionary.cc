@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <functional>
 #include <memory>
 
@@ -145,6 +146,17 @@ void GetArrayValues(lua_State* L, const std::function<void()>& pop_value) {
 
 }  // namespace
 
+bool FileResolver::GetFileContent(const std::string& basename,
+                                  std::string* content) {
+  std::ifstream stream(GetFullPathOrDie(basename).c_str());
+  if (!stream.good()) {
+    return false;
+  }
+  content->assign(std::istreambuf_iterator<char>(stream),
+                  std::istreambuf_iterator<char>());
+  return !stream.bad();
+}
+
 std::unique_ptr<LuaParameterDictionary>
 LuaParameterDictionary::NonReferenceCounted(
     const std::string& code, std::unique_ptr<FileResolver> file_resolver) {
@@ -36,6 +36,11 @@ class FileResolver {
   virtual ~FileResolver() {}
   virtual std::string GetFullPathOrDie(const std::string& basename) = 0;
   virtual std::string GetFileContentOrDie(const std::string& basename) = 0;
+  // Like 'GetFileContentOrDie', but returns false if 'basename' cannot be
+  // read. The default implementation reads the file at 'GetFullPathOrDie', so
+  // it still dies if 'basename' cannot be found.
+  virtual bool GetFileContent(const std::string& basename,
+                              std::string* content);
 };
 
 // A parameter dictionary that gets loaded from Lua code.
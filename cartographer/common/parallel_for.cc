@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/common/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "cartographer/common/task.h"
+
+namespace cartographer {
+namespace common {
+namespace {
+
+// Shared between the calling thread and the helper tasks. Helper tasks may
+// start after the calling thread has returned, so they keep it alive through a
+// shared pointer and only touch 'next_index' once all items are claimed.
+struct ParallelForState {
+  ParallelForState(const int num_items, const int chunk_size,
+                   const std::function<void(int)>& function)
+      : num_items(num_items), chunk_size(chunk_size), function(function) {}
+
+  // Claims and runs chunks of items until there are none left. Only the
+  // thread completing the last item takes the mutex.
+  void Work() {
+    for (int begin = next_index.fetch_add(chunk_size); begin < num_items;
+         begin = next_index.fetch_add(chunk_size)) {
+      const int end = std::min(begin + chunk_size, num_items);
+      for (int index = begin; index != end; ++index) {
+        function(index);
+      }
+      if (num_completed.fetch_add(end - begin) + (end - begin) == num_items) {
+        absl::MutexLock locker(&mutex);
+        done = true;
+      }
+    }
+  }
+
+  const int num_items;
+  const int chunk_size;
+  const std::function<void(int)> function;
+  std::atomic<int> next_index{0};
+  std::atomic<int> num_completed{0};
+  absl::Mutex mutex;
+  bool done GUARDED_BY(mutex) = false;
+};
+
+}  // namespace
+
+void ParallelFor(ThreadPoolInterface* const thread_pool, const int num_items,
+                 const std::function<void(int)>& function) {
+  if (num_items <= 0) {
+    return;
+  }
+  if (thread_pool == nullptr || num_items == 1) {
+    for (int index = 0; index != num_items; ++index) {
+      function(index);
+    }
+    return;
+  }
+  const int num_helper_tasks =
+      std::min<int>(num_items - 1,
+                    std::max(1u, std::thread::hardware_concurrency()));
+  // A few chunks per thread keep the load balanced while claiming indices
+  // rarely.
+  constexpr int kNumChunksPerThread = 4;
+  const int chunk_size = std::max(
+      1, num_items / (kNumChunksPerThread * (num_helper_tasks + 1)));
+  const auto state =
+      std::make_shared<ParallelForState>(num_items, chunk_size, function);
+  for (int i = 0; i != num_helper_tasks; ++i) {
+    auto task = absl::make_unique<Task>();
+    task->SetWorkItem([state]() { state->Work(); });
+    thread_pool->Schedule(std::move(task));
+  }
+  state->Work();
+  const auto predicate = [&state]() EXCLUSIVE_LOCKS_REQUIRED(state->mutex) {
+    return state->done;
+  };
+  absl::MutexLock locker(&state->mutex);
+  state->mutex.Await(absl::Condition(&predicate));
+}
+
+}  // namespace common
+}  // namespace cartographer
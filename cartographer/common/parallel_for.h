@@ -0,0 +1,39 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_COMMON_PARALLEL_FOR_H_
+#define CARTOGRAPHER_COMMON_PARALLEL_FOR_H_
+
+#include <functional>
+
+#include "cartographer/common/thread_pool.h"
+
+namespace cartographer {
+namespace common {
+
+// Calls 'function' once for every index in [0, 'num_items') and blocks until
+// all calls have returned. The calls are distributed over 'thread_pool' and
+// the calling thread, which keeps claiming indices itself. This makes it safe
+// to call from within a task that is already running on 'thread_pool', even if
+// the pool has a single thread. If 'thread_pool' is nullptr, all calls happen
+// on the calling thread in increasing order.
+void ParallelFor(ThreadPoolInterface* thread_pool, int num_items,
+                 const std::function<void(int)>& function);
+
+}  // namespace common
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_COMMON_PARALLEL_FOR_H_
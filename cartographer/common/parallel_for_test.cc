@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/common/parallel_for.h"
+
+#include <atomic>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "cartographer/common/task.h"
+#include "cartographer/common/thread_pool.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace common {
+namespace {
+
+TEST(ParallelForTest, RunsEveryIndexOnceWithoutThreadPool) {
+  std::vector<int> calls(100, 0);
+  ParallelFor(nullptr, calls.size(), [&calls](int index) { ++calls[index]; });
+  EXPECT_EQ(calls, std::vector<int>(100, 1));
+}
+
+TEST(ParallelForTest, RunsEveryIndexOnceOnThreadPool) {
+  ThreadPool pool(4);
+  // Includes sizes which are not a multiple of the chunk size.
+  for (const int num_items : {2, 7, 1000, 1001}) {
+    std::vector<std::atomic<int>> calls(num_items);
+    for (auto& call : calls) call = 0;
+    ParallelFor(&pool, calls.size(), [&calls](int index) { ++calls[index]; });
+    for (const auto& call : calls) {
+      EXPECT_EQ(call, 1);
+    }
+  }
+}
+
+TEST(ParallelForTest, DoesNotDeadlockWhenCalledFromThreadPool) {
+  ThreadPool pool(1);
+  absl::Mutex mutex;
+  bool done = false;
+  std::atomic<int> sum{0};
+  auto task = absl::make_unique<Task>();
+  task->SetWorkItem([&]() {
+    ParallelFor(&pool, 10, [&sum](int index) { sum += index; });
+    absl::MutexLock locker(&mutex);
+    done = true;
+  });
+  pool.Schedule(std::move(task));
+  absl::MutexLock locker(&mutex);
+  mutex.Await(absl::Condition(&done));
+  EXPECT_EQ(sum, 45);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace cartographer
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_COMMON_SEQLOCK_H_
+#define CARTOGRAPHER_COMMON_SEQLOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "cartographer/common/port.h"
+
+namespace cartographer {
+namespace common {
+
+// Holds a value which a single writer updates and any number of readers copy
+// without locks. Readers retry if the value changed while they copied it, so
+// neither side ever waits for the other. Suited for small values which are
+// read much more often than they are written.
+//
+// The value is stored in relaxed atomic words and ordered by fences around a
+// sequence number as described in H.-J. Boehm, "Can seqlocks get along with
+// programming language memory models?".
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type.");
+
+ public:
+  // Initially holds a zero-initialized value.
+  SeqLock() : sequence_(0) {
+    for (auto& word : words_) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  // Must not be called concurrently with itself.
+  void Store(const T& value) {
+    std::array<uint64, kNumWords> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    const uint64 sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kNumWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Returns the value of the last completed 'Store()'.
+  T Load() const {
+    std::array<uint64, kNumWords> words;
+    uint64 sequence_before;
+    uint64 sequence_after;
+    do {
+      sequence_before = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kNumWords; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      sequence_after = sequence_.load(std::memory_order_relaxed);
+    } while ((sequence_before & 1) != 0 || sequence_before != sequence_after);
+    T value;
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr size_t kNumWords =
+      (sizeof(T) + sizeof(uint64) - 1) / sizeof(uint64);
+
+  // Odd while a 'Store()' is in progress.
+  std::atomic<uint64> sequence_;
+  std::array<std::atomic<uint64>, kNumWords> words_;
+};
+
+}  // namespace common
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_COMMON_SEQLOCK_H_
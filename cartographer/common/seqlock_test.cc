@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/common/seqlock.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace common {
+namespace {
+
+// All fields are equal for any stored value, so a torn read is detectable.
+struct Value {
+  int64 a;
+  int64 b;
+  double c;
+  int32 d;
+};
+
+TEST(SeqLockTest, InitiallyZero) {
+  SeqLock<Value> seqlock;
+  const Value value = seqlock.Load();
+  EXPECT_EQ(value.a, 0);
+  EXPECT_EQ(value.b, 0);
+  EXPECT_EQ(value.c, 0.);
+  EXPECT_EQ(value.d, 0);
+}
+
+TEST(SeqLockTest, StoreAndLoad) {
+  SeqLock<Value> seqlock;
+  seqlock.Store(Value{1, 2, 3., 4});
+  const Value value = seqlock.Load();
+  EXPECT_EQ(value.a, 1);
+  EXPECT_EQ(value.b, 2);
+  EXPECT_EQ(value.c, 3.);
+  EXPECT_EQ(value.d, 4);
+}
+
+TEST(SeqLockTest, ReadersNeverSeeTornValues) {
+  constexpr int kNumStores = 100000;
+  SeqLock<Value> seqlock;
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; ++i) {
+    readers.emplace_back([&seqlock, &done]() {
+      int64 last_a = 0;
+      while (!done) {
+        const Value value = seqlock.Load();
+        ASSERT_EQ(value.a, value.b);
+        ASSERT_EQ(static_cast<double>(value.a), value.c);
+        ASSERT_EQ(static_cast<int32>(value.a), value.d);
+        ASSERT_GE(value.a, last_a);
+        last_a = value.a;
+      }
+    });
+  }
+  for (int64 i = 1; i <= kNumStores; ++i) {
+    seqlock.Store(Value{i, i, static_cast<double>(i), static_cast<int32>(i)});
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(seqlock.Load().a, kNumStores);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace cartographer
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/types/optional.h"
+#include "cartographer/common/parallel_for.h"
 #include "cartographer/mapping/proto/trajectory.pb.h"
 #include "cartographer/transform/transform.h"
 #include "glog/logging.h"
@@ -70,12 +72,28 @@ std::vector<int> ComputeSubmapRepresentativeNode(
   return submap_to_node_index;
 }
 
+// Outcome of evaluating a single constraint as ground truth candidate.
+struct ConstraintEvaluation {
+  bool is_outlier = false;
+  absl::optional<proto::Relation> relation;
+};
+
 }  // namespace
 
 proto::GroundTruth GenerateGroundTruth(
     const mapping::proto::PoseGraph& pose_graph,
     const double min_covered_distance, const double outlier_threshold_meters,
     const double outlier_threshold_radians) {
+  return GenerateGroundTruth(pose_graph, min_covered_distance,
+                             outlier_threshold_meters,
+                             outlier_threshold_radians, nullptr);
+}
+
+proto::GroundTruth GenerateGroundTruth(
+    const mapping::proto::PoseGraph& pose_graph,
+    const double min_covered_distance, const double outlier_threshold_meters,
+    const double outlier_threshold_radians,
+    common::ThreadPoolInterface* const thread_pool) {
   const mapping::proto::Trajectory& trajectory = pose_graph.trajectory(0);
   const std::vector<double> covered_distance =
       ComputeCoveredDistance(trajectory);
@@ -83,66 +101,85 @@ proto::GroundTruth GenerateGroundTruth(
   const std::vector<int> submap_to_node_index =
       ComputeSubmapRepresentativeNode(pose_graph);
 
+  // Constraints are evaluated independently and collected in order below, so
+  // the result does not depend on how they are distributed over threads.
+  std::vector<ConstraintEvaluation> evaluations(pose_graph.constraint_size());
+  common::ParallelFor(
+      thread_pool, pose_graph.constraint_size(), [&](const int index) {
+        const auto& constraint = pose_graph.constraint(index);
+        ConstraintEvaluation& evaluation = evaluations[index];
+
+        // We're only interested in loop closure constraints.
+        if (constraint.tag() ==
+            mapping::proto::PoseGraph::Constraint::INTRA_SUBMAP) {
+          return;
+        }
+
+        // For some submaps at the very end, we have not chosen a
+        // representative node, but those should not be part of loop closure
+        // anyway.
+        CHECK_EQ(constraint.submap_id().trajectory_id(), 0);
+        CHECK_EQ(constraint.node_id().trajectory_id(), 0);
+        if (constraint.submap_id().submap_index() >=
+            static_cast<int>(submap_to_node_index.size())) {
+          return;
+        }
+        const int matched_node = constraint.node_id().node_index();
+        const int representative_node =
+            submap_to_node_index.at(constraint.submap_id().submap_index());
+
+        // Covered distance between the two should not be too small.
+        double covered_distance_in_constraint =
+            std::abs(covered_distance.at(matched_node) -
+                     covered_distance.at(representative_node));
+        if (covered_distance_in_constraint < min_covered_distance) {
+          return;
+        }
+
+        // Compute the transform between the nodes according to the solution
+        // and the constraint.
+        const transform::Rigid3d solution_pose1 =
+            transform::ToRigid3(trajectory.node(representative_node).pose());
+        const transform::Rigid3d solution_pose2 =
+            transform::ToRigid3(trajectory.node(matched_node).pose());
+        const transform::Rigid3d solution =
+            solution_pose1.inverse() * solution_pose2;
+
+        const transform::Rigid3d submap_solution = transform::ToRigid3(
+            trajectory.submap(constraint.submap_id().submap_index()).pose());
+        const transform::Rigid3d submap_solution_to_node_solution =
+            solution_pose1.inverse() * submap_solution;
+        const transform::Rigid3d node_to_submap_constraint =
+            transform::ToRigid3(constraint.relative_pose());
+        const transform::Rigid3d expected =
+            submap_solution_to_node_solution * node_to_submap_constraint;
+
+        const transform::Rigid3d error = solution * expected.inverse();
+
+        if (error.translation().norm() > outlier_threshold_meters ||
+            transform::GetAngle(error) > outlier_threshold_radians) {
+          evaluation.is_outlier = true;
+          return;
+        }
+        evaluation.relation = proto::Relation();
+        evaluation.relation->set_timestamp1(
+            trajectory.node(representative_node).timestamp());
+        evaluation.relation->set_timestamp2(
+            trajectory.node(matched_node).timestamp());
+        *evaluation.relation->mutable_expected() =
+            transform::ToProto(expected);
+        evaluation.relation->set_covered_distance(
+            covered_distance_in_constraint);
+      });
+
   int num_outliers = 0;
   proto::GroundTruth ground_truth;
-  for (const auto& constraint : pose_graph.constraint()) {
-    // We're only interested in loop closure constraints.
-    if (constraint.tag() ==
-        mapping::proto::PoseGraph::Constraint::INTRA_SUBMAP) {
-      continue;
-    }
-
-    // For some submaps at the very end, we have not chosen a representative
-    // node, but those should not be part of loop closure anyway.
-    CHECK_EQ(constraint.submap_id().trajectory_id(), 0);
-    CHECK_EQ(constraint.node_id().trajectory_id(), 0);
-    if (constraint.submap_id().submap_index() >=
-        static_cast<int>(submap_to_node_index.size())) {
-      continue;
-    }
-    const int matched_node = constraint.node_id().node_index();
-    const int representative_node =
-        submap_to_node_index.at(constraint.submap_id().submap_index());
-
-    // Covered distance between the two should not be too small.
-    double covered_distance_in_constraint =
-        std::abs(covered_distance.at(matched_node) -
-                 covered_distance.at(representative_node));
-    if (covered_distance_in_constraint < min_covered_distance) {
-      continue;
-    }
-
-    // Compute the transform between the nodes according to the solution and
-    // the constraint.
-    const transform::Rigid3d solution_pose1 =
-        transform::ToRigid3(trajectory.node(representative_node).pose());
-    const transform::Rigid3d solution_pose2 =
-        transform::ToRigid3(trajectory.node(matched_node).pose());
-    const transform::Rigid3d solution =
-        solution_pose1.inverse() * solution_pose2;
-
-    const transform::Rigid3d submap_solution = transform::ToRigid3(
-        trajectory.submap(constraint.submap_id().submap_index()).pose());
-    const transform::Rigid3d submap_solution_to_node_solution =
-        solution_pose1.inverse() * submap_solution;
-    const transform::Rigid3d node_to_submap_constraint =
-        transform::ToRigid3(constraint.relative_pose());
-    const transform::Rigid3d expected =
-        submap_solution_to_node_solution * node_to_submap_constraint;
-
-    const transform::Rigid3d error = solution * expected.inverse();
-
-    if (error.translation().norm() > outlier_threshold_meters ||
-        transform::GetAngle(error) > outlier_threshold_radians) {
+  for (ConstraintEvaluation& evaluation : evaluations) {
+    if (evaluation.is_outlier) {
       ++num_outliers;
-      continue;
+    } else if (evaluation.relation.has_value()) {
+      ground_truth.add_relation()->Swap(&evaluation.relation.value());
     }
-    auto* const new_relation = ground_truth.add_relation();
-    new_relation->set_timestamp1(
-        trajectory.node(representative_node).timestamp());
-    new_relation->set_timestamp2(trajectory.node(matched_node).timestamp());
-    *new_relation->mutable_expected() = transform::ToProto(expected);
-    new_relation->set_covered_distance(covered_distance_in_constraint);
   }
   LOG(INFO) << "Generated " << ground_truth.relation_size()
             << " relations and ignored " << num_outliers << " outliers.";
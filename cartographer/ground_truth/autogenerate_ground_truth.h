@@ -17,6 +17,7 @@
 #ifndef CARTOGRAPHER_GROUND_TRUTH_AUTOGENERATE_GROUND_TRUTH_H_
 #define CARTOGRAPHER_GROUND_TRUTH_AUTOGENERATE_GROUND_TRUTH_H_
 
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/ground_truth/proto/relations.pb.h"
 #include "cartographer/mapping/proto/pose_graph.pb.h"
 
@@ -31,6 +32,13 @@ proto::GroundTruth GenerateGroundTruth(
     const mapping::proto::PoseGraph& pose_graph, double min_covered_distance,
     double outlier_threshold_meters, double outlier_threshold_radians);
 
+// Like above, but evaluates the loop closure constraints on 'thread_pool'. The
+// generated relations are identical and in the same order.
+proto::GroundTruth GenerateGroundTruth(
+    const mapping::proto::PoseGraph& pose_graph, double min_covered_distance,
+    double outlier_threshold_meters, double outlier_threshold_radians,
+    common::ThreadPoolInterface* thread_pool);
+
 }  // namespace ground_truth
 }  // namespace cartographer
 
@@ -14,11 +14,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <string>
+#include <thread>
 
 #include "cartographer/common/port.h"
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/ground_truth/autogenerate_ground_truth.h"
 #include "cartographer/ground_truth/proto/relations.pb.h"
 #include "cartographer/io/proto_stream.h"
@@ -55,9 +58,11 @@ void Run(const std::string& pose_graph_filename,
       io::DeserializePoseGraphFromFile(pose_graph_filename);
 
   LOG(INFO) << "Autogenerating ground truth relations...";
-  const proto::GroundTruth ground_truth =
-      GenerateGroundTruth(pose_graph, min_covered_distance,
-                          outlier_threshold_meters, outlier_threshold_radians);
+  common::ThreadPool thread_pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  const proto::GroundTruth ground_truth = GenerateGroundTruth(
+      pose_graph, min_covered_distance, outlier_threshold_meters,
+      outlier_threshold_radians, &thread_pool);
   LOG(INFO) << "Writing " << ground_truth.relation_size() << " relations to '"
             << output_filename << "'.";
   {
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/ground_truth/autogenerate_ground_truth.h"
+
+#include <cmath>
+
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/transform/transform.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace ground_truth {
+namespace {
+
+constexpr int kNumNodes = 100;
+constexpr int kNodesPerSubmap = 5;
+
+transform::Rigid3d NodePose(const int node_index) {
+  const double angle = 0.1 * node_index;
+  return transform::Rigid3d(
+      Eigen::Vector3d(10. * std::cos(angle), 10. * std::sin(angle), 0.),
+      Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()));
+}
+
+void AddConstraint(const int submap_index, const int node_index,
+                   const mapping::proto::PoseGraph::Constraint::Tag tag,
+                   const transform::Rigid3d& relative_pose,
+                   mapping::proto::PoseGraph* pose_graph) {
+  auto* constraint = pose_graph->add_constraint();
+  constraint->mutable_submap_id()->set_submap_index(submap_index);
+  constraint->mutable_node_id()->set_node_index(node_index);
+  constraint->set_tag(tag);
+  *constraint->mutable_relative_pose() = transform::ToProto(relative_pose);
+}
+
+// A trajectory going around a circle several times, with loop closures of
+// every node to submaps of earlier rounds. Every third loop closure is off by
+// one meter.
+mapping::proto::PoseGraph CreatePoseGraph() {
+  mapping::proto::PoseGraph pose_graph;
+  auto* trajectory = pose_graph.add_trajectory();
+  for (int i = 0; i < kNumNodes; ++i) {
+    auto* node = trajectory->add_node();
+    node->set_node_index(i);
+    node->set_timestamp(100 * i);
+    *node->mutable_pose() = transform::ToProto(NodePose(i));
+  }
+  for (int i = 0; i < kNumNodes / kNodesPerSubmap; ++i) {
+    auto* submap = trajectory->add_submap();
+    submap->set_submap_index(i);
+    *submap->mutable_pose() =
+        transform::ToProto(NodePose(i * kNodesPerSubmap));
+  }
+  for (int i = 0; i < kNumNodes; ++i) {
+    const int submap_index = i / kNodesPerSubmap;
+    AddConstraint(submap_index, i,
+                  mapping::proto::PoseGraph::Constraint::INTRA_SUBMAP,
+                  NodePose(submap_index * kNodesPerSubmap).inverse() *
+                      NodePose(i),
+                  &pose_graph);
+  }
+  for (int i = 0; i < kNumNodes; ++i) {
+    for (int submap_index = 0; submap_index < i / kNodesPerSubmap;
+         submap_index += 3) {
+      const transform::Rigid3d error = transform::Rigid3d::Translation(
+          Eigen::Vector3d(i % 3 == 0 ? 1. : 0., 0., 0.));
+      AddConstraint(submap_index, i,
+                    mapping::proto::PoseGraph::Constraint::INTER_SUBMAP,
+                    NodePose(submap_index * kNodesPerSubmap).inverse() *
+                        NodePose(i) * error,
+                    &pose_graph);
+    }
+  }
+  return pose_graph;
+}
+
+TEST(AutogenerateGroundTruthTest, ThreadPoolGivesIdenticalResults) {
+  const mapping::proto::PoseGraph pose_graph = CreatePoseGraph();
+  const proto::GroundTruth expected_ground_truth =
+      GenerateGroundTruth(pose_graph, 5., 0.5, 0.1);
+  // Outliers and constraints covering too little distance are skipped.
+  ASSERT_GT(expected_ground_truth.relation_size(), 0);
+  int num_loop_closures = 0;
+  for (const auto& constraint : pose_graph.constraint()) {
+    if (constraint.tag() ==
+        mapping::proto::PoseGraph::Constraint::INTER_SUBMAP) {
+      ++num_loop_closures;
+    }
+  }
+  ASSERT_LT(expected_ground_truth.relation_size(), num_loop_closures);
+
+  common::ThreadPool thread_pool(4);
+  const proto::GroundTruth ground_truth =
+      GenerateGroundTruth(pose_graph, 5., 0.5, 0.1, &thread_pool);
+  EXPECT_EQ(ground_truth.SerializeAsString(),
+            expected_ground_truth.SerializeAsString());
+}
+
+}  // namespace
+}  // namespace ground_truth
+}  // namespace cartographer
@@ -21,18 +21,20 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "cartographer/common/math.h"
 #include "cartographer/common/port.h"
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/ground_truth/proto/relations.pb.h"
+#include "cartographer/ground_truth/relations_metrics.h"
 #include "cartographer/ground_truth/relations_text_file.h"
 #include "cartographer/io/proto_stream.h"
 #include "cartographer/io/proto_stream_deserializer.h"
 #include "cartographer/mapping/proto/pose_graph.pb.h"
 #include "cartographer/transform/rigid_transform.h"
 #include "cartographer/transform/transform.h"
-#include "cartographer/transform/transform_interpolation_buffer.h"
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 
@@ -52,25 +54,6 @@ namespace cartographer {
 namespace ground_truth {
 namespace {
 
-struct Error {
-  double translational_squared;
-  double rotational_squared;
-};
-
-// TODO(whess): This gives different results for the translational error if
-// 'pose1' and 'pose2' are swapped and 'expected' is inverted. Consider a
-// different way to compute translational error. Maybe just look at the
-// absolute difference in translation norms of each relative transform as a
-// lower bound of the translational error.
-Error ComputeError(const transform::Rigid3d& pose1,
-                   const transform::Rigid3d& pose2,
-                   const transform::Rigid3d& expected) {
-  const transform::Rigid3d error =
-      (pose1.inverse() * pose2) * expected.inverse();
-  return Error{error.translation().squaredNorm(),
-               common::Pow2(transform::GetAngle(error))};
-}
-
 std::string MeanAndStdDevString(const std::vector<double>& values) {
   CHECK_GE(values.size(), 2);
   const double mean =
@@ -87,12 +70,12 @@ std::string MeanAndStdDevString(const std::vector<double>& values) {
   return std::string(out.str());
 }
 
-std::string StatisticsString(const std::vector<Error>& errors) {
+std::string StatisticsString(const std::vector<RelationError>& errors) {
   std::vector<double> translational_errors;
   std::vector<double> squared_translational_errors;
   std::vector<double> rotational_errors_degrees;
   std::vector<double> squared_rotational_errors_degrees;
-  for (const Error& error : errors) {
+  for (const RelationError& error : errors) {
     translational_errors.push_back(std::sqrt(error.translational_squared));
     squared_translational_errors.push_back(error.translational_squared);
     rotational_errors_degrees.push_back(
@@ -113,7 +96,7 @@ std::string StatisticsString(const std::vector<Error>& errors) {
          MeanAndStdDevString(squared_rotational_errors_degrees) + " deg^2\n";
 }
 
-void WriteRelationMetricsToFile(const std::vector<Error>& errors,
+void WriteRelationMetricsToFile(const std::vector<RelationError>& errors,
                                 const proto::GroundTruth& ground_truth,
                                 const std::string& relation_metrics_filename) {
   std::ofstream relation_errors_file;
@@ -129,7 +112,7 @@ void WriteRelationMetricsToFile(const std::vector<Error>& errors,
          "expected_rotation_y,expected_rotation_z,covered_distance\n";
   for (int relation_index = 0; relation_index < ground_truth.relation_size();
        ++relation_index) {
-    const Error& error = errors[relation_index];
+    const RelationError& error = errors[relation_index];
     const proto::Relation& relation = ground_truth.relation(relation_index);
     double translational_error = std::sqrt(error.translational_squared);
     double squared_translational_error = error.translational_squared;
@@ -153,21 +136,6 @@ void WriteRelationMetricsToFile(const std::vector<Error>& errors,
   relation_errors_file.close();
 }
 
-transform::Rigid3d LookupTransform(
-    const transform::TransformInterpolationBuffer&
-        transform_interpolation_buffer,
-    const common::Time time) {
-  const common::Time earliest_time =
-      transform_interpolation_buffer.earliest_time();
-  if (transform_interpolation_buffer.Has(time)) {
-    return transform_interpolation_buffer.Lookup(time);
-  } else if (time < earliest_time) {
-    return transform_interpolation_buffer.Lookup(earliest_time);
-  }
-  return transform_interpolation_buffer.Lookup(
-      transform_interpolation_buffer.latest_time());
-}
-
 void Run(const std::string& pose_graph_filename,
          const std::string& relations_filename,
          const bool read_text_file_with_unix_timestamps,
@@ -176,9 +144,6 @@ void Run(const std::string& pose_graph_filename,
   mapping::proto::PoseGraph pose_graph =
       io::DeserializePoseGraphFromFile(pose_graph_filename);
 
-  const transform::TransformInterpolationBuffer transform_interpolation_buffer(
-      pose_graph.trajectory(0));
-
   proto::GroundTruth ground_truth;
   if (read_text_file_with_unix_timestamps) {
     LOG(INFO) << "Reading relations from '" << relations_filename << "'...";
@@ -190,18 +155,12 @@ void Run(const std::string& pose_graph_filename,
     CHECK(ground_truth.ParseFromIstream(&ground_truth_stream));
   }
 
-  std::vector<Error> errors;
-  for (const auto& relation : ground_truth.relation()) {
-    const auto pose1 =
-        LookupTransform(transform_interpolation_buffer,
-                        common::FromUniversal(relation.timestamp1()));
-    const auto pose2 =
-        LookupTransform(transform_interpolation_buffer,
-                        common::FromUniversal(relation.timestamp2()));
-    const transform::Rigid3d expected =
-        transform::ToRigid3(relation.expected());
-    errors.push_back(ComputeError(pose1, pose2, expected));
-  }
+  LOG(INFO) << "Computing errors of " << ground_truth.relation_size()
+            << " relations...";
+  common::ThreadPool thread_pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  const std::vector<RelationError> errors = ComputeRelationErrors(
+      pose_graph.trajectory(0), ground_truth, &thread_pool);
 
   const std::string relation_metrics_filename =
       pose_graph_filename + ".relation_metrics.csv";
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/ground_truth/relations_metrics.h"
+
+#include "cartographer/common/math.h"
+#include "cartographer/common/parallel_for.h"
+#include "cartographer/common/time.h"
+#include "cartographer/transform/transform.h"
+#include "cartographer/transform/transform_interpolation_buffer.h"
+
+namespace cartographer {
+namespace ground_truth {
+namespace {
+
+transform::Rigid3d LookupTransform(
+    const transform::TransformInterpolationBuffer&
+        transform_interpolation_buffer,
+    const common::Time time) {
+  const common::Time earliest_time =
+      transform_interpolation_buffer.earliest_time();
+  if (transform_interpolation_buffer.Has(time)) {
+    return transform_interpolation_buffer.Lookup(time);
+  } else if (time < earliest_time) {
+    return transform_interpolation_buffer.Lookup(earliest_time);
+  }
+  return transform_interpolation_buffer.Lookup(
+      transform_interpolation_buffer.latest_time());
+}
+
+}  // namespace
+
+RelationError ComputeRelationError(const transform::Rigid3d& pose1,
+                                   const transform::Rigid3d& pose2,
+                                   const transform::Rigid3d& expected) {
+  const transform::Rigid3d error =
+      (pose1.inverse() * pose2) * expected.inverse();
+  return RelationError{error.translation().squaredNorm(),
+                       common::Pow2(transform::GetAngle(error))};
+}
+
+std::vector<RelationError> ComputeRelationErrors(
+    const mapping::proto::Trajectory& trajectory,
+    const proto::GroundTruth& ground_truth,
+    common::ThreadPoolInterface* const thread_pool) {
+  const transform::TransformInterpolationBuffer transform_interpolation_buffer(
+      trajectory);
+  std::vector<RelationError> errors(ground_truth.relation_size());
+  common::ParallelFor(
+      thread_pool, ground_truth.relation_size(), [&](const int index) {
+        const proto::Relation& relation = ground_truth.relation(index);
+        const transform::Rigid3d pose1 =
+            LookupTransform(transform_interpolation_buffer,
+                            common::FromUniversal(relation.timestamp1()));
+        const transform::Rigid3d pose2 =
+            LookupTransform(transform_interpolation_buffer,
+                            common::FromUniversal(relation.timestamp2()));
+        errors[index] = ComputeRelationError(
+            pose1, pose2, transform::ToRigid3(relation.expected()));
+      });
+  return errors;
+}
+
+}  // namespace ground_truth
+}  // namespace cartographer
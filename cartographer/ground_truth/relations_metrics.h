@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_GROUND_TRUTH_RELATIONS_METRICS_H_
+#define CARTOGRAPHER_GROUND_TRUTH_RELATIONS_METRICS_H_
+
+#include <vector>
+
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/ground_truth/proto/relations.pb.h"
+#include "cartographer/mapping/proto/trajectory.pb.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace ground_truth {
+
+struct RelationError {
+  double translational_squared;
+  double rotational_squared;
+};
+
+// TODO(whess): This gives different results for the translational error if
+// 'pose1' and 'pose2' are swapped and 'expected' is inverted. Consider a
+// different way to compute translational error. Maybe just look at the
+// absolute difference in translation norms of each relative transform as a
+// lower bound of the translational error.
+RelationError ComputeRelationError(const transform::Rigid3d& pose1,
+                                   const transform::Rigid3d& pose2,
+                                   const transform::Rigid3d& expected);
+
+// Computes the error of every relation in 'ground_truth' with respect to the
+// poses of 'trajectory', interpolated at the relation timestamps and clamped
+// to the trajectory's time range. Relations are evaluated on 'thread_pool' if
+// it is not nullptr. The result is the same regardless of the thread pool and
+// in the order of the relations.
+std::vector<RelationError> ComputeRelationErrors(
+    const mapping::proto::Trajectory& trajectory,
+    const proto::GroundTruth& ground_truth,
+    common::ThreadPoolInterface* thread_pool);
+
+}  // namespace ground_truth
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_GROUND_TRUTH_RELATIONS_METRICS_H_
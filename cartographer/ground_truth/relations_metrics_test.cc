@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/ground_truth/relations_metrics.h"
+
+#include <cmath>
+#include <vector>
+
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/transform/transform.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace ground_truth {
+namespace {
+
+mapping::proto::Trajectory CreateTrajectory(const int num_nodes) {
+  mapping::proto::Trajectory trajectory;
+  for (int i = 0; i < num_nodes; ++i) {
+    auto* node = trajectory.add_node();
+    node->set_timestamp(100 * i);
+    *node->mutable_pose() = transform::ToProto(transform::Rigid3d(
+        Eigen::Vector3d(i, std::sin(i), 0.),
+        Eigen::AngleAxisd(0.1 * i, Eigen::Vector3d::UnitZ())));
+  }
+  return trajectory;
+}
+
+TEST(RelationsMetricsTest, ComputesErrorOfRelation) {
+  const mapping::proto::Trajectory trajectory = CreateTrajectory(3);
+  proto::GroundTruth ground_truth;
+  auto* relation = ground_truth.add_relation();
+  relation->set_timestamp1(0);
+  relation->set_timestamp2(200);
+  *relation->mutable_expected() = transform::ToProto(
+      transform::ToRigid3(trajectory.node(0).pose()).inverse() *
+      transform::ToRigid3(trajectory.node(2).pose()) *
+      transform::Rigid3d::Translation(Eigen::Vector3d(0., 0., 0.5)));
+  const std::vector<RelationError> errors =
+      ComputeRelationErrors(trajectory, ground_truth, nullptr);
+  ASSERT_EQ(errors.size(), 1);
+  EXPECT_NEAR(errors[0].translational_squared, 0.25, 1e-9);
+  EXPECT_NEAR(errors[0].rotational_squared, 0., 1e-9);
+}
+
+TEST(RelationsMetricsTest, ThreadPoolGivesIdenticalResults) {
+  const mapping::proto::Trajectory trajectory = CreateTrajectory(50);
+  proto::GroundTruth ground_truth;
+  for (int i = 0; i < 200; ++i) {
+    auto* relation = ground_truth.add_relation();
+    // Includes timestamps before and after the trajectory.
+    relation->set_timestamp1(37 * i - 100);
+    relation->set_timestamp2(29 * i);
+    *relation->mutable_expected() = transform::ToProto(transform::Rigid3d(
+        Eigen::Vector3d(0.01 * i, 0., 0.),
+        Eigen::AngleAxisd(0.02 * i, Eigen::Vector3d::UnitX())));
+  }
+  const std::vector<RelationError> expected_errors =
+      ComputeRelationErrors(trajectory, ground_truth, nullptr);
+  common::ThreadPool thread_pool(4);
+  const std::vector<RelationError> errors =
+      ComputeRelationErrors(trajectory, ground_truth, &thread_pool);
+  ASSERT_EQ(errors.size(), expected_errors.size());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    EXPECT_EQ(errors[i].translational_squared,
+              expected_errors[i].translational_squared);
+    EXPECT_EQ(errors[i].rotational_squared,
+              expected_errors[i].rotational_squared);
+  }
+}
+
+}  // namespace
+}  // namespace ground_truth
+}  // namespace cartographer
@@ -16,6 +16,10 @@
 
 #include "cartographer/io/internal/mapping_state_serialization.h"
 
+#include <algorithm>
+#include <functional>
+
+#include "cartographer/common/parallel_for.h"
 #include "cartographer/mapping/proto/serialization.pb.h"
 #include "cartographer/transform/transform.h"
 
@@ -29,6 +33,9 @@ using mapping::SubmapId;
 using mapping::TrajectoryNode;
 using mapping::proto::SerializedData;
 
+// Number of records which are serialized in parallel before being written.
+constexpr int kRecordsPerChunk = 64;
+
 mapping::proto::AllTrajectoryBuilderOptions
 CreateAllTrajectoryBuilderOptionsProto(
     const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
@@ -79,40 +86,79 @@ SerializedData SerializeTrajectoryBuilderOptions(
   return proto;
 }
 
+// Fills 'num_records' records using 'serialize' on 'thread_pool' and writes
+// them in order. Records are processed in chunks, so that only a bounded
+// number of serialized records is held in memory at any time.
+void SerializeInOrder(
+    const int num_records,
+    const std::function<void(int, SerializedData*)>& serialize,
+    common::ThreadPoolInterface* const thread_pool,
+    ProtoStreamWriterInterface* const writer) {
+  std::vector<SerializedData> chunk;
+  for (int chunk_start = 0; chunk_start < num_records;
+       chunk_start += kRecordsPerChunk) {
+    const int chunk_size =
+        std::min(kRecordsPerChunk, num_records - chunk_start);
+    chunk.clear();
+    chunk.resize(chunk_size);
+    common::ParallelFor(thread_pool, chunk_size,
+                        [&serialize, &chunk, chunk_start](int index) {
+                          serialize(chunk_start + index, &chunk[index]);
+                        });
+    for (const SerializedData& proto : chunk) {
+      writer->WriteProto(proto);
+    }
+  }
+}
+
 void SerializeSubmaps(
     const MapById<SubmapId, PoseGraphInterface::SubmapData>& submap_data,
-    bool include_unfinished_submaps, ProtoStreamWriterInterface* const writer) {
+    bool include_unfinished_submaps,
+    common::ThreadPoolInterface* const thread_pool,
+    ProtoStreamWriterInterface* const writer) {
   // Next serialize all submaps.
+  using SubmapIdData =
+      MapById<SubmapId, PoseGraphInterface::SubmapData>::IdDataReference;
+  std::vector<SubmapIdData> submaps;
   for (const auto& submap_id_data : submap_data) {
     if (!include_unfinished_submaps &&
         !submap_id_data.data.submap->insertion_finished()) {
       continue;
     }
-    SerializedData proto;
-    auto* const submap_proto = proto.mutable_submap();
-    *submap_proto = submap_id_data.data.submap->ToProto(
-        /*include_probability_grid_data=*/true);
-    submap_proto->mutable_submap_id()->set_trajectory_id(
-        submap_id_data.id.trajectory_id);
-    submap_proto->mutable_submap_id()->set_submap_index(
-        submap_id_data.id.submap_index);
-    writer->WriteProto(proto);
+    submaps.push_back(submap_id_data);
   }
+  SerializeInOrder(
+      submaps.size(),
+      [&submaps](int index, SerializedData* proto) {
+        auto* const submap_proto = proto->mutable_submap();
+        *submap_proto = submaps[index].data.submap->ToProto(
+            /*include_probability_grid_data=*/true);
+        submap_proto->mutable_submap_id()->set_trajectory_id(
+            submaps[index].id.trajectory_id);
+        submap_proto->mutable_submap_id()->set_submap_index(
+            submaps[index].id.submap_index);
+      },
+      thread_pool, writer);
 }
 
 void SerializeTrajectoryNodes(
     const MapById<NodeId, TrajectoryNode>& trajectory_nodes,
+    common::ThreadPoolInterface* const thread_pool,
     ProtoStreamWriterInterface* const writer) {
-  for (const auto& node_id_data : trajectory_nodes) {
-    SerializedData proto;
-    auto* const node_proto = proto.mutable_node();
-    node_proto->mutable_node_id()->set_trajectory_id(
-        node_id_data.id.trajectory_id);
-    node_proto->mutable_node_id()->set_node_index(node_id_data.id.node_index);
-    *node_proto->mutable_node_data() =
-        ToProto(*node_id_data.data.constant_data);
-    writer->WriteProto(proto);
-  }
+  const std::vector<MapById<NodeId, TrajectoryNode>::IdDataReference> nodes(
+      trajectory_nodes.begin(), trajectory_nodes.end());
+  SerializeInOrder(
+      nodes.size(),
+      [&nodes](int index, SerializedData* proto) {
+        auto* const node_proto = proto->mutable_node();
+        node_proto->mutable_node_id()->set_trajectory_id(
+            nodes[index].id.trajectory_id);
+        node_proto->mutable_node_id()->set_node_index(
+            nodes[index].id.node_index);
+        *node_proto->mutable_node_data() =
+            ToProto(*nodes[index].data.constant_data);
+      },
+      thread_pool, writer);
 }
 
 void SerializeTrajectoryData(
@@ -216,21 +262,60 @@ void WritePbStream(
     const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
         trajectory_builder_options,
     ProtoStreamWriterInterface* const writer, bool include_unfinished_submaps) {
-  writer->WriteProto(CreateHeader());
-  writer->WriteProto(
-      SerializePoseGraph(pose_graph, include_unfinished_submaps));
-  writer->WriteProto(SerializeTrajectoryBuilderOptions(
+  WritePbStream(pose_graph, trajectory_builder_options, writer,
+                include_unfinished_submaps, /*thread_pool=*/nullptr);
+}
+
+void WritePbStream(
+    const mapping::PoseGraph& pose_graph,
+    const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
+        trajectory_builder_options,
+    ProtoStreamWriterInterface* const writer, bool include_unfinished_submaps,
+    common::ThreadPoolInterface* const thread_pool) {
+  WritePbStream(TakeMappingStateSnapshot(pose_graph, trajectory_builder_options,
+                                         include_unfinished_submaps),
+                writer, thread_pool);
+}
+
+MappingStateSnapshot TakeMappingStateSnapshot(
+    const mapping::PoseGraph& pose_graph,
+    const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
+        trajectory_builder_options,
+    bool include_unfinished_submaps) {
+  // The pose graph is only locked while copying its data, so that SLAM can
+  // continue while the snapshot is serialized.
+  MappingStateSnapshot snapshot;
+  snapshot.include_unfinished_submaps = include_unfinished_submaps;
+  snapshot.pose_graph =
+      SerializePoseGraph(pose_graph, include_unfinished_submaps);
+  snapshot.trajectory_builder_options = SerializeTrajectoryBuilderOptions(
       trajectory_builder_options,
-      GetValidTrajectoryIds(pose_graph.GetTrajectoryStates())));
-
-  SerializeSubmaps(pose_graph.GetAllSubmapData(), include_unfinished_submaps,
-                   writer);
-  SerializeTrajectoryNodes(pose_graph.GetTrajectoryNodes(), writer);
-  SerializeTrajectoryData(pose_graph.GetTrajectoryData(), writer);
-  SerializeImuData(pose_graph.GetImuData(), writer);
-  SerializeOdometryData(pose_graph.GetOdometryData(), writer);
-  SerializeFixedFramePoseData(pose_graph.GetFixedFramePoseData(), writer);
-  SerializeLandmarkNodes(pose_graph.GetLandmarkNodes(), writer);
+      GetValidTrajectoryIds(pose_graph.GetTrajectoryStates()));
+  snapshot.submap_data = pose_graph.GetAllSubmapData();
+  snapshot.trajectory_nodes = pose_graph.GetTrajectoryNodes();
+  snapshot.trajectory_data = pose_graph.GetTrajectoryData();
+  snapshot.imu_data = pose_graph.GetImuData();
+  snapshot.odometry_data = pose_graph.GetOdometryData();
+  snapshot.fixed_frame_pose_data = pose_graph.GetFixedFramePoseData();
+  snapshot.landmark_nodes = pose_graph.GetLandmarkNodes();
+  return snapshot;
+}
+
+void WritePbStream(const MappingStateSnapshot& snapshot,
+                   ProtoStreamWriterInterface* const writer,
+                   common::ThreadPoolInterface* const thread_pool) {
+  writer->WriteProto(CreateHeader());
+  writer->WriteProto(snapshot.pose_graph);
+  writer->WriteProto(snapshot.trajectory_builder_options);
+
+  SerializeSubmaps(snapshot.submap_data, snapshot.include_unfinished_submaps,
+                   thread_pool, writer);
+  SerializeTrajectoryNodes(snapshot.trajectory_nodes, thread_pool, writer);
+  SerializeTrajectoryData(snapshot.trajectory_data, writer);
+  SerializeImuData(snapshot.imu_data, writer);
+  SerializeOdometryData(snapshot.odometry_data, writer);
+  SerializeFixedFramePoseData(snapshot.fixed_frame_pose_data, writer);
+  SerializeLandmarkNodes(snapshot.landmark_nodes, writer);
 }
 
 }  // namespace io
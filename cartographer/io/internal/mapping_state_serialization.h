@@ -17,15 +17,22 @@
 #ifndef CARTOGRAPHER_IO_INTERNAL_MAPPING_STATE_SERIALIZATION_H_
 #define CARTOGRAPHER_IO_INTERNAL_MAPPING_STATE_SERIALIZATION_H_
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/io/proto_stream_interface.h"
 #include "cartographer/mapping/pose_graph.h"
+#include "cartographer/mapping/proto/serialization.pb.h"
 #include "cartographer/mapping/proto/trajectory_builder_options.pb.h"
 
 namespace cartographer {
 namespace io {
 
 // The current serialization format version.
-static constexpr int kMappingStateSerializationFormatVersion = 2;
+static constexpr int kMappingStateSerializationFormatVersion = 3;
+static constexpr int kFormatVersionWithoutBlockEncodedHybridGrids = 2;
 static constexpr int kFormatVersionWithoutSubmapHistograms = 1;
 
 // Serialize mapping state to a pbstream.
@@ -35,6 +42,47 @@ void WritePbStream(
         builder_options,
     ProtoStreamWriterInterface* const writer, bool include_unfinished_submaps);
 
+// Same as above, but serializes submaps and trajectory nodes in parallel on
+// 'thread_pool'. The records are still written in the same order.
+void WritePbStream(
+    const mapping::PoseGraph& pose_graph,
+    const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
+        builder_options,
+    ProtoStreamWriterInterface* const writer, bool include_unfinished_submaps,
+    common::ThreadPoolInterface* thread_pool);
+
+// Copy of the mapping state which can be written without holding any lock on
+// the pose graph or on the trajectory builder options.
+struct MappingStateSnapshot {
+  bool include_unfinished_submaps = false;
+  mapping::proto::SerializedData pose_graph;
+  mapping::proto::SerializedData trajectory_builder_options;
+  mapping::MapById<mapping::SubmapId,
+                   mapping::PoseGraphInterface::SubmapData>
+      submap_data;
+  mapping::MapById<mapping::NodeId, mapping::TrajectoryNode> trajectory_nodes;
+  std::map<int, mapping::PoseGraphInterface::TrajectoryData> trajectory_data;
+  sensor::MapByTime<sensor::ImuData> imu_data;
+  sensor::MapByTime<sensor::OdometryData> odometry_data;
+  sensor::MapByTime<sensor::FixedFramePoseData> fixed_frame_pose_data;
+  std::map<std::string, mapping::PoseGraphInterface::LandmarkNode>
+      landmark_nodes;
+};
+
+// Copies the state to serialize from 'pose_graph' and 'builder_options'. The
+// caller has to synchronize this with changes to 'builder_options'.
+MappingStateSnapshot TakeMappingStateSnapshot(
+    const mapping::PoseGraph& pose_graph,
+    const std::vector<mapping::proto::TrajectoryBuilderOptionsWithSensorIds>&
+        builder_options,
+    bool include_unfinished_submaps);
+
+// Writes 'snapshot' as a pbstream, serializing submaps and trajectory nodes in
+// parallel on 'thread_pool' if it is not nullptr.
+void WritePbStream(const MappingStateSnapshot& snapshot,
+                   ProtoStreamWriterInterface* const writer,
+                   common::ThreadPoolInterface* thread_pool);
+
 }  // namespace io
 }  // namespace cartographer
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/io/internal/mapping_state_serialization.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/io/internal/in_memory_proto_stream.h"
+#include "cartographer/mapping/2d/submap_2d.h"
+#include "cartographer/transform/transform.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace io {
+namespace {
+
+constexpr int kNumCells = 8;
+
+// More records than are serialized in one chunk, so that the parallel writer
+// has to stitch several chunks together.
+constexpr int kNumSubmaps = 150;
+constexpr int kNumNodes = 200;
+
+MappingStateSnapshot CreateSnapshot(
+    mapping::ValueConversionTables* conversion_tables) {
+  MappingStateSnapshot snapshot;
+  for (int submap_index = 0; submap_index < kNumSubmaps; ++submap_index) {
+    mapping::proto::Submap2D submap_2d;
+    submap_2d.set_num_range_data(submap_index);
+    submap_2d.set_finished(true);
+    *submap_2d.mutable_local_pose() = transform::ToProto(
+        transform::Rigid3d::Translation(Eigen::Vector3d(submap_index, 0., 0.)));
+    auto* grid = submap_2d.mutable_grid();
+    for (int i = 0; i < kNumCells * kNumCells; ++i) {
+      grid->add_cells((i + submap_index) % 32767);
+    }
+    auto* map_limits = grid->mutable_limits();
+    map_limits->set_resolution(0.5);
+    *map_limits->mutable_max() =
+        transform::ToProto(Eigen::Vector2d(kNumCells, kNumCells));
+    map_limits->mutable_cell_limits()->set_num_x_cells(kNumCells);
+    map_limits->mutable_cell_limits()->set_num_y_cells(kNumCells);
+    grid->mutable_probability_grid_2d();
+    snapshot.submap_data.Insert(
+        mapping::SubmapId{0, submap_index},
+        {std::make_shared<const mapping::Submap2D>(submap_2d,
+                                                   conversion_tables),
+         transform::Rigid3d::Identity()});
+  }
+  for (int node_index = 0; node_index < kNumNodes; ++node_index) {
+    auto data = std::make_shared<mapping::TrajectoryNode::Data>();
+    data->time = common::FromUniversal(node_index);
+    data->gravity_alignment = Eigen::Quaterniond::Identity();
+    data->local_pose =
+        transform::Rigid3d::Translation(Eigen::Vector3d(0., node_index, 0.));
+    for (int i = 0; i < 10; ++i) {
+      data->filtered_gravity_aligned_point_cloud.push_back(
+          {Eigen::Vector3f(i, node_index, 0.f)});
+    }
+    snapshot.trajectory_nodes.Insert(
+        mapping::NodeId{0, node_index},
+        mapping::TrajectoryNode{data, transform::Rigid3d::Identity()});
+  }
+  return snapshot;
+}
+
+std::vector<std::string> Write(const MappingStateSnapshot& snapshot,
+                               common::ThreadPoolInterface* thread_pool) {
+  std::vector<std::string> records;
+  ForwardingProtoStreamWriter writer(
+      [&records](const google::protobuf::Message* proto) {
+        if (proto != nullptr) {
+          records.push_back(proto->SerializeAsString());
+        }
+        return true;
+      });
+  WritePbStream(snapshot, &writer, thread_pool);
+  writer.Close();
+  return records;
+}
+
+TEST(MappingStateSerializationTest, ParallelOutputMatchesSequentialOutput) {
+  mapping::ValueConversionTables conversion_tables;
+  const MappingStateSnapshot snapshot = CreateSnapshot(&conversion_tables);
+  const std::vector<std::string> sequential_records =
+      Write(snapshot, /*thread_pool=*/nullptr);
+  // Header, pose graph, trajectory builder options, submaps and nodes.
+  ASSERT_EQ(sequential_records.size(), 3 + kNumSubmaps + kNumNodes);
+  common::ThreadPool thread_pool(4);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(Write(snapshot, &thread_pool), sequential_records);
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace cartographer
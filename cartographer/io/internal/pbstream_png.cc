@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cartographer/io/internal/pbstream_png.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/io/file_writer.h"
+#include "cartographer/io/proto_stream.h"
+#include "cartographer/io/proto_stream_deserializer.h"
+#include "cartographer/io/submap_painter.h"
+#include "cartographer/mapping/value_conversion_tables.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DEFINE_double(png_resolution, 0.05, "Resolution in meters per pixel.");
+
+namespace cartographer {
+namespace io {
+namespace {
+
+// Size of the tiles the image is painted in. Only one row of tiles is kept in
+// memory at a time.
+constexpr int kTileSize = 256;
+
+}  // namespace
+
+int pbstream_png(int argc, char** argv) {
+  std::stringstream ss;
+  ss << "\n\nWrites the submaps of a pbstream as a single PNG image."
+     << "\nUsage: " << argv[0] << " " << argv[1]
+     << " <input_filename> <output_filename> [flags]";
+  google::SetUsageMessage(ss.str());
+
+  if (argc < 4) {
+    google::ShowUsageWithFlagsRestrict(argv[0], "pbstream_png");
+    return EXIT_FAILURE;
+  }
+  common::ThreadPool thread_pool(
+      std::max(1u, std::thread::hardware_concurrency()));
+  ProtoStreamReader reader(argv[2]);
+  ProtoStreamDeserializer deserializer(&reader);
+  LOG(INFO) << "Loading submaps from \"" << argv[2] << "\"";
+  std::map<mapping::SubmapId, SubmapSlice> submap_slices;
+  mapping::ValueConversionTables conversion_tables;
+  DeserializeAndFillSubmapSlices(&deserializer, &submap_slices,
+                                 &conversion_tables, &thread_pool);
+
+  LOG(INFO) << "Writing image to \"" << argv[3] << "\"";
+  StreamFileWriter file_writer(argv[3]);
+  const PaintSubmapSlicesTiledResult result =
+      WriteSubmapSlicesPng(submap_slices, FLAGS_png_resolution, kTileSize,
+                           &thread_pool, &file_writer);
+  CHECK(file_writer.Close());
+  LOG(INFO) << "Wrote " << result.size.x() << "x" << result.size.y()
+            << " pixels, the map origin is at pixel (" << result.origin.x()
+            << ", " << result.origin.y() << ").";
+  return EXIT_SUCCESS;
+}
+
+}  // namespace io
+}  // namespace cartographer
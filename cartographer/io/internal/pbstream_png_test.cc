@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cartographer/io/internal/pbstream_png.h"
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "cartographer/io/internal/mapping_state_serialization.h"
+#include "cartographer/io/proto_stream.h"
+#include "cartographer/io/testing/test_helpers.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace io {
+namespace {
+
+TEST(PbstreamPngTest, WritesPngOfPbstream) {
+  std::string directory = ::testing::TempDir() + "/pbstream_png_XXXXXX";
+  ASSERT_NE(mkdtemp(&directory[0]), nullptr);
+  const std::string pbstream_filename = directory + "/map.pbstream";
+  {
+    ProtoStreamWriter writer(pbstream_filename);
+    mapping::proto::SerializationHeader header;
+    header.set_format_version(kMappingStateSerializationFormatVersion);
+    writer.WriteProto(header);
+    for (const auto& data : testing::CreateFake2DSubmapsSerializedData(3)) {
+      writer.WriteProto(data);
+    }
+    ASSERT_TRUE(writer.Close());
+  }
+
+  const std::string png_filename = directory + "/map.png";
+  std::vector<std::string> args = {"pbstream", "png", pbstream_filename,
+                                   png_filename};
+  std::vector<char*> argv;
+  for (std::string& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  EXPECT_EQ(pbstream_png(argv.size(), argv.data()), EXIT_SUCCESS);
+  std::ifstream stream(png_filename, std::ios::binary);
+  const std::string content((std::istreambuf_iterator<char>(stream)),
+                            std::istreambuf_iterator<char>());
+  ASSERT_GT(content.size(), 8u);
+  EXPECT_EQ(content.substr(0, 8), "\x89PNG\r\n\x1a\n");
+  // The last chunk is an empty 'IEND' chunk followed by its CRC.
+  EXPECT_EQ(content.substr(content.size() - 8, 4), "IEND");
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace cartographer
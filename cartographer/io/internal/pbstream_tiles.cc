@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/io/internal/pbstream_tiles.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "absl/memory/memory.h"
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/io/file_writer.h"
+#include "cartographer/io/proto_stream.h"
+#include "cartographer/io/proto_stream_deserializer.h"
+#include "cartographer/io/submap_painter.h"
+#include "cartographer/mapping/value_conversion_tables.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DEFINE_double(tiles_resolution, 0.05,
+              "Resolution in meters per pixel of the highest zoom level.");
+DEFINE_int32(tile_size, 256, "Width and height of each tile in pixels.");
+
+namespace cartographer {
+namespace io {
+
+int pbstream_tiles(int argc, char** argv) {
+  std::stringstream ss;
+  ss << "\n\nWrites the submaps of a pbstream as a pyramid of PNG tiles "
+        "'<zoom>_<x>_<y>.png' into an existing output directory."
+     << "\nUsage: " << argv[0] << " " << argv[1]
+     << " <input_filename> <output_directory> [flags]";
+  google::SetUsageMessage(ss.str());
+
+  if (argc < 4) {
+    google::ShowUsageWithFlagsRestrict(argv[0], "pbstream_tiles");
+    return EXIT_FAILURE;
+  }
+  common::ThreadPool thread_pool(
+      std::max(1u, std::thread::hardware_concurrency()));
+  ProtoStreamReader reader(argv[2]);
+  ProtoStreamDeserializer deserializer(&reader);
+  LOG(INFO) << "Loading submaps from \"" << argv[2] << "\"";
+  std::map<mapping::SubmapId, SubmapSlice> submap_slices;
+  mapping::ValueConversionTables conversion_tables;
+  DeserializeAndFillSubmapSlices(&deserializer, &submap_slices,
+                                 &conversion_tables, &thread_pool);
+
+  const std::string output_directory = argv[3];
+  LOG(INFO) << "Writing tiles to \"" << output_directory << "\"";
+  const int max_zoom = WriteSubmapSlicesTilePyramid(
+      submap_slices, FLAGS_tiles_resolution, FLAGS_tile_size, &thread_pool,
+      [&output_directory](const std::string& filename) {
+        return absl::make_unique<StreamFileWriter>(output_directory + "/" +
+                                                   filename);
+      });
+  LOG(INFO) << "Wrote zoom levels 0 to " << max_zoom << ".";
+  return EXIT_SUCCESS;
+}
+
+}  // namespace io
+}  // namespace cartographer
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cartographer/io/internal/pbstream_tiles.h"
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cartographer/io/internal/mapping_state_serialization.h"
+#include "cartographer/io/proto_stream.h"
+#include "cartographer/io/testing/test_helpers.h"
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_int32(tile_size);
+
+namespace cartographer {
+namespace io {
+namespace {
+
+bool IsNonEmptyFile(const std::string& filename) {
+  std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+  return stream.good() && stream.tellg() > 0;
+}
+
+TEST(PbstreamTilesTest, WritesTilesOfPbstream) {
+  std::string directory = ::testing::TempDir() + "/pbstream_tiles_XXXXXX";
+  ASSERT_NE(mkdtemp(&directory[0]), nullptr);
+  const std::string pbstream_filename = directory + "/map.pbstream";
+  {
+    ProtoStreamWriter writer(pbstream_filename);
+    mapping::proto::SerializationHeader header;
+    header.set_format_version(kMappingStateSerializationFormatVersion);
+    writer.WriteProto(header);
+    for (const auto& data : testing::CreateFake2DSubmapsSerializedData(3)) {
+      writer.WriteProto(data);
+    }
+    ASSERT_TRUE(writer.Close());
+  }
+
+  const int tile_size = FLAGS_tile_size;
+  FLAGS_tile_size = 32;
+  std::vector<std::string> args = {"pbstream", "tiles", pbstream_filename,
+                                   directory};
+  std::vector<char*> argv;
+  for (std::string& arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  EXPECT_EQ(pbstream_tiles(argv.size(), argv.data()), EXIT_SUCCESS);
+  FLAGS_tile_size = tile_size;
+  // With tiles of 32 pixels, the submaps need zoom levels 0 to 2.
+  EXPECT_TRUE(IsNonEmptyFile(directory + "/0_0_0.png"));
+  EXPECT_TRUE(IsNonEmptyFile(directory + "/1_0_0.png"));
+  EXPECT_TRUE(IsNonEmptyFile(directory + "/2_0_0.png"));
+  EXPECT_FALSE(IsNonEmptyFile(directory + "/3_0_0.png"));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace cartographer
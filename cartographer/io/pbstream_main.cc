@@ -19,6 +19,8 @@
 #include "absl/container/flat_hash_set.h"
 #include "cartographer/io/internal/pbstream_info.h"
 #include "cartographer/io/internal/pbstream_migrate.h"
+#include "cartographer/io/internal/pbstream_png.h"
+#include "cartographer/io/internal/pbstream_tiles.h"
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 
@@ -30,7 +32,9 @@ int main(int argc, char** argv) {
       "Swiss Army knife for pbstreams.\n\n"
       "Currently supported subcommands are:\n"
       "\tinfo    - Prints summary of pbstream.\n"
-      "\tmigrate - Migrates old pbstream (w/o header) to new pbstream format.";
+      "\tmigrate - Migrates old pbstream (w/o header) to new pbstream format.\n"
+      "\tpng     - Writes the submaps as a single PNG image.\n"
+      "\ttiles   - Writes the submaps as a pyramid of PNG map tiles.";
   google::ParseCommandLineFlags(&argc, &argv, true);
 
   if (argc < 2) {
@@ -41,6 +45,10 @@ int main(int argc, char** argv) {
     return ::cartographer::io::pbstream_info(argc, argv);
   } else if (std::string(argv[1]) == "migrate") {
     return ::cartographer::io::pbstream_migrate(argc, argv);
+  } else if (std::string(argv[1]) == "png") {
+    return ::cartographer::io::pbstream_png(argc, argv);
+  } else if (std::string(argv[1]) == "tiles") {
+    return ::cartographer::io::pbstream_tiles(argc, argv);
   } else {
     LOG(INFO) << "Unknown subtool: \"" << argv[1];
     google::SetUsageMessage(usage_message);
@@ -32,6 +32,8 @@ mapping::proto::SerializationHeader ReadHeaderOrDie(
 
 bool IsVersionSupported(const mapping::proto::SerializationHeader& header) {
   return header.format_version() == kMappingStateSerializationFormatVersion ||
+         header.format_version() ==
+             kFormatVersionWithoutBlockEncodedHybridGrids ||
          header.format_version() == kFormatVersionWithoutSubmapHistograms;
 }
 
@@ -16,6 +16,18 @@
 
 #include "cartographer/io/submap_painter.h"
 
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "boost/iostreams/concepts.hpp"
+#include "boost/iostreams/filter/zlib.hpp"
+#include "boost/iostreams/filtering_stream.hpp"
+#include "cartographer/common/parallel_for.h"
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/3d/submap_3d.h"
 
@@ -23,10 +35,34 @@ namespace cartographer {
 namespace io {
 namespace {
 
+// Color painted where there is no submap.
+constexpr Uint8Color kBackgroundColor = {{128, 0, 0}};
+
 Eigen::Affine3d ToEigen(const ::cartographer::transform::Rigid3d& rigid3) {
   return Eigen::Translation3d(rigid3.translation()) * rigid3.rotation();
 }
 
+void CairoPaintSubmapSlice(
+    const SubmapSlice& submap_slice, cairo_t* cr,
+    const std::function<void(const SubmapSlice&)>& draw_callback) {
+  const Eigen::Matrix4d homo =
+      ToEigen(submap_slice.pose * submap_slice.slice_pose).matrix();
+
+  cairo_save(cr);
+  cairo_matrix_t matrix;
+  cairo_matrix_init(&matrix, homo(1, 0), homo(0, 0), -homo(1, 1), -homo(0, 1),
+                    homo(0, 3), -homo(1, 3));
+  cairo_transform(cr, &matrix);
+
+  const double submap_resolution = submap_slice.resolution;
+  cairo_scale(cr, submap_resolution, submap_resolution);
+
+  // Invokes caller's callback to utilize slice data in global cooridnate
+  // frame. e.g. finds bounding box, paints slices.
+  draw_callback(submap_slice);
+  cairo_restore(cr);
+}
+
 void CairoPaintSubmapSlices(
     const double scale,
     const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
@@ -38,23 +74,64 @@ void CairoPaintSubmapSlices(
     if (submap_slice.surface == nullptr) {
       return;
     }
-    const Eigen::Matrix4d homo =
-        ToEigen(submap_slice.pose * submap_slice.slice_pose).matrix();
+    CairoPaintSubmapSlice(submap_slice, cr, draw_callback);
+  }
+}
 
-    cairo_save(cr);
-    cairo_matrix_t matrix;
-    cairo_matrix_init(&matrix, homo(1, 0), homo(0, 0), -homo(1, 1), -homo(0, 1),
-                      homo(0, 3), -homo(1, 3));
-    cairo_transform(cr, &matrix);
+void PaintSlice(cairo_t* cr, const SubmapSlice& submap_slice) {
+  cairo_set_source_surface(cr, submap_slice.surface.get(), 0., 0.);
+  cairo_paint(cr);
+}
 
-    const double submap_resolution = submap_slice.resolution;
-    cairo_scale(cr, submap_resolution, submap_resolution);
+// A slice to paint together with its bounding box in pixels, relative to the
+// map origin.
+struct SliceBoundingBox {
+  const SubmapSlice* submap_slice;
+  Eigen::AlignedBox2f bounding_box;
+};
 
-    // Invokes caller's callback to utilize slice data in global cooridnate
-    // frame. e.g. finds bounding box, paints slices.
-    draw_callback(submap_slice);
-    cairo_restore(cr);
+// Computes the bounding boxes of all slices that 'PaintSubmapSlices' paints.
+std::vector<SliceBoundingBox> ComputeSliceBoundingBoxes(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    const double resolution) {
+  std::vector<SliceBoundingBox> slice_bounding_boxes;
+  auto surface =
+      MakeUniqueCairoSurfacePtr(cairo_image_surface_create(kCairoFormat, 1, 1));
+  auto cr = MakeUniqueCairoPtr(cairo_create(surface.get()));
+  CairoPaintSubmapSlices(
+      1. / resolution, submaps, cr.get(),
+      [&slice_bounding_boxes, &cr](const SubmapSlice& submap_slice) {
+        Eigen::AlignedBox2f bounding_box;
+        const auto update_bounding_box = [&bounding_box, &cr](double x,
+                                                              double y) {
+          cairo_user_to_device(cr.get(), &x, &y);
+          bounding_box.extend(Eigen::Vector2f(x, y));
+        };
+        update_bounding_box(0, 0);
+        update_bounding_box(submap_slice.width, 0);
+        update_bounding_box(0, submap_slice.height);
+        update_bounding_box(submap_slice.width, submap_slice.height);
+        slice_bounding_boxes.push_back(
+            SliceBoundingBox{&submap_slice, bounding_box});
+      });
+  return slice_bounding_boxes;
+}
+
+// Computes the 'size' of the image containing all slices with some padding
+// and the pixel 'origin' corresponding to the map frame origin.
+void ComputeImageSizeAndOrigin(
+    const std::vector<SliceBoundingBox>& slice_bounding_boxes,
+    Eigen::Array2i* const size, Eigen::Array2f* const origin) {
+  Eigen::AlignedBox2f bounding_box;
+  for (const SliceBoundingBox& slice_bounding_box : slice_bounding_boxes) {
+    bounding_box.extend(slice_bounding_box.bounding_box);
   }
+  const int kPaddingPixel = 5;
+  *size = Eigen::Array2i(
+      std::ceil(bounding_box.sizes().x()) + 2 * kPaddingPixel,
+      std::ceil(bounding_box.sizes().y()) + 2 * kPaddingPixel);
+  *origin = Eigen::Array2f(-bounding_box.min().x() + kPaddingPixel,
+                           -bounding_box.min().y() + kPaddingPixel);
 }
 
 bool Has2DGrid(const mapping::proto::Submap& submap) {
@@ -67,37 +144,299 @@ bool Has3DGrids(const mapping::proto::Submap& submap) {
          submap.submap_3d().has_high_resolution_hybrid_grid();
 }
 
+// Paints the pixels in ['offset', 'offset' + 'dimensions') of the image with
+// the given 'origin' from the slices which overlap them. Returns nullptr if no
+// slice overlaps the tile.
+UniqueCairoSurfacePtr PaintTile(
+    const std::vector<SliceBoundingBox>& slice_bounding_boxes,
+    const double resolution, const Eigen::Array2f& origin,
+    const Eigen::Array2i& offset, const Eigen::Array2i& dimensions) {
+  // The tile in the frame of the slice bounding boxes.
+  const Eigen::AlignedBox2f tile_box(
+      (offset.cast<float>() - origin).matrix(),
+      ((offset + dimensions).cast<float>() - origin).matrix());
+  if (std::all_of(slice_bounding_boxes.begin(), slice_bounding_boxes.end(),
+                  [&tile_box](const SliceBoundingBox& slice_bounding_box) {
+                    return tile_box.intersection(
+                                       slice_bounding_box.bounding_box)
+                        .isEmpty();
+                  })) {
+    return MakeUniqueCairoSurfacePtr(nullptr);
+  }
+  auto surface = MakeUniqueCairoSurfacePtr(cairo_image_surface_create(
+      kCairoFormat, dimensions.x(), dimensions.y()));
+  auto cr = MakeUniqueCairoPtr(cairo_create(surface.get()));
+  cairo_set_source_rgba(cr.get(), 0.5, 0.0, 0.0, 1.);
+  cairo_paint(cr.get());
+  cairo_translate(cr.get(), origin.x() - offset.x(), origin.y() - offset.y());
+  cairo_scale(cr.get(), 1. / resolution, 1. / resolution);
+  for (const SliceBoundingBox& slice_bounding_box : slice_bounding_boxes) {
+    if (tile_box.intersection(slice_bounding_box.bounding_box).isEmpty()) {
+      continue;
+    }
+    CairoPaintSubmapSlice(*slice_bounding_box.submap_slice, cr.get(),
+                          [&cr](const SubmapSlice& submap_slice) {
+                            PaintSlice(cr.get(), submap_slice);
+                          });
+  }
+  cairo_surface_flush(surface.get());
+  return surface;
+}
+
+// Paints the image of the given 'size' and 'origin' as tiles of at most
+// 'tile_size' x 'tile_size' pixels, one row of tiles at a time.
+void PaintTiles(const std::vector<SliceBoundingBox>& slice_bounding_boxes,
+                const double resolution, const Eigen::Array2i& size,
+                const Eigen::Array2f& origin, const int tile_size,
+                common::ThreadPoolInterface* const thread_pool,
+                const std::function<void(SubmapSlicesTile)>& tile_callback) {
+  CHECK_GT(tile_size, 0);
+  for (int y = 0; y < size.y(); y += tile_size) {
+    std::vector<SubmapSlicesTile> tiles;
+    for (int x = 0; x < size.x(); x += tile_size) {
+      const Eigen::Array2i offset(x, y);
+      tiles.push_back(SubmapSlicesTile{
+          offset, (size - offset).min(Eigen::Array2i::Constant(tile_size)),
+          MakeUniqueCairoSurfacePtr(nullptr)});
+    }
+    common::ParallelFor(thread_pool, tiles.size(), [&](const int index) {
+      tiles[index].surface =
+          PaintTile(slice_bounding_boxes, resolution, origin,
+                    tiles[index].offset, tiles[index].size);
+    });
+    for (SubmapSlicesTile& tile : tiles) {
+      tile_callback(std::move(tile));
+    }
+  }
+}
+
+// Appends 'value' to 'data' in network byte order as used by PNG.
+void AppendUint32(const uint32 value, std::string* const data) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    data->push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+// Computes the CRC-32 of 'data' as specified for PNG chunks.
+uint32 ComputePngCrc(const std::string& data) {
+  static const std::array<uint32, 256> kTable = [] {
+    std::array<uint32, 256> table;
+    for (uint32 n = 0; n < table.size(); ++n) {
+      uint32 c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+    return table;
+  }();
+  uint32 crc = 0xffffffffu;
+  for (const char byte : data) {
+    crc = kTable[(crc ^ static_cast<uint8>(byte)) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffu;
+}
+
+void WritePngChunk(const std::string& type, const std::string& data,
+                   FileWriter* const file_writer) {
+  std::string chunk;
+  AppendUint32(data.size(), &chunk);
+  chunk += type;
+  chunk += data;
+  AppendUint32(ComputePngCrc(chunk.substr(4)), &chunk);
+  CHECK(file_writer->Write(chunk.data(), chunk.size()));
+}
+
+// Writes the compressed image data it receives as PNG 'IDAT' chunks.
+class PngImageDataSink : public boost::iostreams::sink {
+ public:
+  explicit PngImageDataSink(FileWriter* const file_writer)
+      : file_writer_(file_writer) {}
+
+  std::streamsize write(const char* const data, const std::streamsize size) {
+    WritePngChunk("IDAT", std::string(data, size), file_writer_);
+    return size;
+  }
+
+ private:
+  FileWriter* file_writer_;
+};
+
+// Writes an 8 bit RGB PNG row by row, so that the image is never held in
+// memory as a whole.
+class PngWriter {
+ public:
+  PngWriter(const Eigen::Array2i& size, FileWriter* const file_writer)
+      : size_(size), file_writer_(file_writer) {
+    const char kSignature[] = {'\x89', 'P',    'N',    'G',
+                               '\r',   '\n', '\x1a', '\n'};
+    CHECK(file_writer_->Write(kSignature, sizeof(kSignature)));
+    std::string header;
+    AppendUint32(size_.x(), &header);
+    AppendUint32(size_.y(), &header);
+    // Bit depth 8, RGB, default compression and filtering, no interlacing.
+    header += std::string({8, 2, 0, 0, 0});
+    WritePngChunk("IHDR", header, file_writer_);
+    image_data_.push(
+        boost::iostreams::zlib_compressor(boost::iostreams::zlib::best_speed));
+    image_data_.push(PngImageDataSink(file_writer_));
+  }
+
+  void WriteRow(const std::vector<Uint8Color>& row) {
+    CHECK_EQ(static_cast<int>(row.size()), size_.x());
+    CHECK_LT(num_rows_, size_.y());
+    std::string data;
+    data.reserve(1 + 3 * row.size());
+    // No filtering.
+    data.push_back(0);
+    for (const Uint8Color& color : row) {
+      data.append(color.begin(), color.end());
+    }
+    image_data_.write(data.data(), data.size());
+    ++num_rows_;
+  }
+
+  void Close() {
+    CHECK_EQ(num_rows_, size_.y());
+    // Flushes the remaining compressed data.
+    image_data_.reset();
+    WritePngChunk("IEND", "", file_writer_);
+  }
+
+ private:
+  const Eigen::Array2i size_;
+  FileWriter* const file_writer_;
+  boost::iostreams::filtering_ostream image_data_;
+  int num_rows_ = 0;
+};
+
+// Combines 2x2 pixels into one for a coarser zoom level. Intensity encodes
+// free space and green marks observed pixels, so the observed pixel with the
+// lowest intensity, i.e. the highest probability of being occupied, is kept.
+// This way thin obstacles do not fade away when zooming out.
+Uint8Color DownsamplePixels(const std::array<Uint8Color, 4>& pixels) {
+  const Uint8Color* result = &pixels[0];
+  bool observed = false;
+  for (const Uint8Color& pixel : pixels) {
+    if (pixel[1] == 0) {
+      continue;
+    }
+    if (!observed || pixel[0] < (*result)[0]) {
+      result = &pixel;
+      observed = true;
+    }
+  }
+  return *result;
+}
+
+class TilePyramidWriter {
+ public:
+  TilePyramidWriter(const std::vector<SliceBoundingBox>& slice_bounding_boxes,
+                    const double resolution, const Eigen::Array2i& size,
+                    const Eigen::Array2f& origin, const int tile_size,
+                    common::ThreadPoolInterface* const thread_pool,
+                    const FileWriterFactory& file_writer_factory)
+      : slice_bounding_boxes_(slice_bounding_boxes),
+        resolution_(resolution),
+        size_(size),
+        origin_(origin),
+        tile_size_(tile_size),
+        thread_pool_(thread_pool),
+        file_writer_factory_(file_writer_factory) {
+    max_zoom_ = 0;
+    while ((tile_size_ << max_zoom_) < size_.maxCoeff()) {
+      ++max_zoom_;
+    }
+  }
+
+  // Writes the tile at 'zoom', 'x', 'y' and all tiles below it. Returns the
+  // tile, or nullptr if it lies outside of the image or no slice overlaps it.
+  // Such empty tiles are not written.
+  std::unique_ptr<Image> WriteTile(const int zoom, const int x, const int y) {
+    const int full_resolution_tile_size = tile_size_ << (max_zoom_ - zoom);
+    const Eigen::Array2i offset(x * full_resolution_tile_size,
+                                y * full_resolution_tile_size);
+    if ((offset >= size_).any()) {
+      return nullptr;
+    }
+    std::unique_ptr<Image> tile;
+    if (zoom == max_zoom_) {
+      UniqueCairoSurfacePtr surface =
+          PaintTile(slice_bounding_boxes_, resolution_, origin_, offset,
+                    Eigen::Array2i::Constant(tile_size_));
+      if (surface != nullptr) {
+        tile = absl::make_unique<Image>(std::move(surface));
+      }
+    } else {
+      tile = DownsampleChildren(zoom, x, y);
+    }
+    if (tile == nullptr) {
+      return nullptr;
+    }
+    auto file_writer =
+        file_writer_factory_(absl::StrCat(zoom, "_", x, "_", y, ".png"));
+    tile->WritePng(file_writer.get());
+    CHECK(file_writer->Close());
+    return tile;
+  }
+
+  int max_zoom() const { return max_zoom_; }
+
+ private:
+  std::unique_ptr<Image> DownsampleChildren(const int zoom, const int x,
+                                            const int y) {
+    std::array<std::unique_ptr<Image>, 4> children;
+    common::ParallelFor(thread_pool_, children.size(), [&](const int index) {
+      children[index] =
+          WriteTile(zoom + 1, 2 * x + index % 2, 2 * y + index / 2);
+    });
+    if (std::all_of(children.begin(), children.end(),
+                    [](const std::unique_ptr<Image>& child) {
+                      return child == nullptr;
+                    })) {
+      return nullptr;
+    }
+    auto tile = absl::make_unique<Image>(tile_size_, tile_size_);
+    const int half_tile_size = tile_size_ / 2;
+    for (int index = 0; index < 4; ++index) {
+      const Eigen::Array2i child_offset((index % 2) * half_tile_size,
+                                        (index / 2) * half_tile_size);
+      for (int j = 0; j < half_tile_size; ++j) {
+        for (int i = 0; i < half_tile_size; ++i) {
+          tile->SetPixel(
+              child_offset.x() + i, child_offset.y() + j,
+              children[index] == nullptr
+                  ? kBackgroundColor
+                  : DownsamplePixels(
+                        {{children[index]->GetPixel(2 * i, 2 * j),
+                          children[index]->GetPixel(2 * i + 1, 2 * j),
+                          children[index]->GetPixel(2 * i, 2 * j + 1),
+                          children[index]->GetPixel(2 * i + 1, 2 * j + 1)}}));
+        }
+      }
+    }
+    return tile;
+  }
+
+  const std::vector<SliceBoundingBox>& slice_bounding_boxes_;
+  const double resolution_;
+  const Eigen::Array2i size_;
+  const Eigen::Array2f origin_;
+  const int tile_size_;
+  common::ThreadPoolInterface* const thread_pool_;
+  const FileWriterFactory& file_writer_factory_;
+  int max_zoom_;
+};
+
 }  // namespace
 
 PaintSubmapSlicesResult PaintSubmapSlices(
     const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
     const double resolution) {
-  Eigen::AlignedBox2f bounding_box;
-  {
-    auto surface = MakeUniqueCairoSurfacePtr(
-        cairo_image_surface_create(kCairoFormat, 1, 1));
-    auto cr = MakeUniqueCairoPtr(cairo_create(surface.get()));
-    const auto update_bounding_box = [&bounding_box, &cr](double x, double y) {
-      cairo_user_to_device(cr.get(), &x, &y);
-      bounding_box.extend(Eigen::Vector2f(x, y));
-    };
-
-    CairoPaintSubmapSlices(
-        1. / resolution, submaps, cr.get(),
-        [&update_bounding_box](const SubmapSlice& submap_slice) {
-          update_bounding_box(0, 0);
-          update_bounding_box(submap_slice.width, 0);
-          update_bounding_box(0, submap_slice.height);
-          update_bounding_box(submap_slice.width, submap_slice.height);
-        });
-  }
-
-  const int kPaddingPixel = 5;
-  const Eigen::Array2i size(
-      std::ceil(bounding_box.sizes().x()) + 2 * kPaddingPixel,
-      std::ceil(bounding_box.sizes().y()) + 2 * kPaddingPixel);
-  const Eigen::Array2f origin(-bounding_box.min().x() + kPaddingPixel,
-                              -bounding_box.min().y() + kPaddingPixel);
+  Eigen::Array2i size;
+  Eigen::Array2f origin;
+  ComputeImageSizeAndOrigin(ComputeSliceBoundingBoxes(submaps, resolution),
+                            &size, &origin);
 
   auto surface = MakeUniqueCairoSurfacePtr(
       cairo_image_surface_create(kCairoFormat, size.x(), size.y()));
@@ -108,15 +447,85 @@ PaintSubmapSlicesResult PaintSubmapSlices(
     cairo_translate(cr.get(), origin.x(), origin.y());
     CairoPaintSubmapSlices(1. / resolution, submaps, cr.get(),
                            [&cr](const SubmapSlice& submap_slice) {
-                             cairo_set_source_surface(
-                                 cr.get(), submap_slice.surface.get(), 0., 0.);
-                             cairo_paint(cr.get());
+                             PaintSlice(cr.get(), submap_slice);
                            });
     cairo_surface_flush(surface.get());
   }
   return PaintSubmapSlicesResult(std::move(surface), origin);
 }
 
+PaintSubmapSlicesTiledResult PaintSubmapSlicesTiled(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    const double resolution, const int tile_size,
+    common::ThreadPoolInterface* const thread_pool,
+    const std::function<void(SubmapSlicesTile)>& tile_callback) {
+  const std::vector<SliceBoundingBox> slice_bounding_boxes =
+      ComputeSliceBoundingBoxes(submaps, resolution);
+  Eigen::Array2i size;
+  Eigen::Array2f origin;
+  ComputeImageSizeAndOrigin(slice_bounding_boxes, &size, &origin);
+  PaintTiles(slice_bounding_boxes, resolution, size, origin, tile_size,
+             thread_pool, tile_callback);
+  return PaintSubmapSlicesTiledResult{size, origin};
+}
+
+PaintSubmapSlicesTiledResult WriteSubmapSlicesPng(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    const double resolution, const int tile_size,
+    common::ThreadPoolInterface* const thread_pool,
+    FileWriter* const file_writer) {
+  const std::vector<SliceBoundingBox> slice_bounding_boxes =
+      ComputeSliceBoundingBoxes(submaps, resolution);
+  Eigen::Array2i size;
+  Eigen::Array2f origin;
+  ComputeImageSizeAndOrigin(slice_bounding_boxes, &size, &origin);
+  PngWriter png_writer(size, file_writer);
+  // The tiles of the current row, nullptr for those without a slice.
+  std::vector<std::unique_ptr<Image>> tiles;
+  std::vector<Uint8Color> row(size.x());
+  PaintTiles(
+      slice_bounding_boxes, resolution, size, origin, tile_size, thread_pool,
+      [&](SubmapSlicesTile tile) {
+        if (tile.surface == nullptr) {
+          tiles.push_back(nullptr);
+        } else {
+          tiles.push_back(absl::make_unique<Image>(std::move(tile.surface)));
+        }
+        if (tile.offset.x() + tile.size.x() < size.x()) {
+          return;
+        }
+        for (int y = 0; y < tile.size.y(); ++y) {
+          for (int x = 0; x < size.x(); ++x) {
+            const std::unique_ptr<Image>& image = tiles[x / tile_size];
+            row[x] = image == nullptr ? kBackgroundColor
+                                      : image->GetPixel(x % tile_size, y);
+          }
+          png_writer.WriteRow(row);
+        }
+        tiles.clear();
+      });
+  png_writer.Close();
+  return PaintSubmapSlicesTiledResult{size, origin};
+}
+
+int WriteSubmapSlicesTilePyramid(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    const double resolution, const int tile_size,
+    common::ThreadPoolInterface* const thread_pool,
+    const FileWriterFactory& file_writer_factory) {
+  CHECK_GT(tile_size, 1);
+  CHECK_EQ(tile_size % 2, 0);
+  const std::vector<SliceBoundingBox> slice_bounding_boxes =
+      ComputeSliceBoundingBoxes(submaps, resolution);
+  Eigen::Array2i size;
+  Eigen::Array2f origin;
+  ComputeImageSizeAndOrigin(slice_bounding_boxes, &size, &origin);
+  TilePyramidWriter writer(slice_bounding_boxes, resolution, size, origin,
+                           tile_size, thread_pool, file_writer_factory);
+  writer.WriteTile(0 /* zoom */, 0 /* x */, 0 /* y */);
+  return writer.max_zoom();
+}
+
 void FillSubmapSlice(
     const ::cartographer::transform::Rigid3d& global_submap_pose,
     const ::cartographer::mapping::proto::Submap& proto,
@@ -153,6 +562,16 @@ void DeserializeAndFillSubmapSlices(
     ProtoStreamDeserializer* deserializer,
     std::map<mapping::SubmapId, SubmapSlice>* submap_slices,
     mapping::ValueConversionTables* conversion_tables) {
+  DeserializeAndFillSubmapSlices(deserializer, submap_slices,
+                                 conversion_tables, nullptr);
+}
+
+void DeserializeAndFillSubmapSlices(
+    ProtoStreamDeserializer* deserializer,
+    std::map<mapping::SubmapId, SubmapSlice>* submap_slices,
+    mapping::ValueConversionTables* conversion_tables,
+    common::ThreadPoolInterface* const thread_pool) {
+  constexpr int kBatchSize = 64;
   std::map<mapping::SubmapId, transform::Rigid3d> submap_poses;
   for (const auto& trajectory : deserializer->pose_graph().trajectory()) {
     for (const auto& submap : trajectory.submap()) {
@@ -161,6 +580,19 @@ void DeserializeAndFillSubmapSlices(
           transform::ToRigid3(submap.pose());
     }
   }
+  std::vector<mapping::proto::Submap> batch;
+  std::vector<SubmapSlice*> batch_slices;
+  const auto fill_batch = [&]() {
+    common::ParallelFor(thread_pool, batch.size(), [&](const int index) {
+      const auto& submap = batch[index];
+      const mapping::SubmapId id{submap.submap_id().trajectory_id(),
+                                 submap.submap_id().submap_index()};
+      FillSubmapSlice(submap_poses.at(id), submap, batch_slices[index],
+                      conversion_tables);
+    });
+    batch.clear();
+    batch_slices.clear();
+  };
   mapping::proto::SerializedData proto;
   while (deserializer->ReadNextSerializedData(&proto)) {
     if (proto.has_submap() &&
@@ -168,10 +600,16 @@ void DeserializeAndFillSubmapSlices(
       const auto& submap = proto.submap();
       const mapping::SubmapId id{submap.submap_id().trajectory_id(),
                                  submap.submap_id().submap_index()};
-      FillSubmapSlice(submap_poses.at(id), submap, &(*submap_slices)[id],
-                      conversion_tables);
+      // Map entries are created here, so that slices are only written to from
+      // the thread pool.
+      batch_slices.push_back(&(*submap_slices)[id]);
+      batch.push_back(std::move(*proto.mutable_submap()));
+      if (batch.size() == kBatchSize) {
+        fill_batch();
+      }
     }
   }
+  fill_batch();
 }
 
 SubmapTexture::Pixels UnpackTextureData(const std::string& compressed_cells,
@@ -17,8 +17,12 @@
 #ifndef CARTOGRAPHER_IO_SUBMAP_PAINTER_H_
 #define CARTOGRAPHER_IO_SUBMAP_PAINTER_H_
 
+#include <functional>
+
 #include "Eigen/Geometry"
 #include "cairo/cairo.h"
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/io/file_writer.h"
 #include "cartographer/io/image.h"
 #include "cartographer/io/proto_stream_deserializer.h"
 #include "cartographer/mapping/id.h"
@@ -79,6 +83,56 @@ PaintSubmapSlicesResult PaintSubmapSlices(
     const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
     double resolution);
 
+struct SubmapSlicesTile {
+  // Top left pixel of the tile in the image painted by 'PaintSubmapSlices'.
+  Eigen::Array2i offset;
+  // Width and height of the tile in pixels.
+  Eigen::Array2i size;
+  // nullptr if no slice overlaps the tile, i.e. it only shows the background.
+  ::cartographer::io::UniqueCairoSurfacePtr surface;
+};
+
+struct PaintSubmapSlicesTiledResult {
+  // Size in pixels of the image the tiles make up.
+  Eigen::Array2i size;
+  // Top left pixel of the image in map frame.
+  Eigen::Array2f origin;
+};
+
+// Paints the same image as 'PaintSubmapSlices', but as tiles of at most
+// 'tile_size' x 'tile_size' pixels. The tiles of one row are composited in
+// parallel on 'thread_pool', each only from the slices that overlap it. Then
+// they are handed to 'tile_callback' from left to right, before the next row
+// is painted. So at most one row of tiles is kept in memory.
+PaintSubmapSlicesTiledResult PaintSubmapSlicesTiled(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    double resolution, int tile_size, common::ThreadPoolInterface* thread_pool,
+    const std::function<void(SubmapSlicesTile)>& tile_callback);
+
+// Writes the image painted by 'PaintSubmapSlices' as an RGB PNG to
+// 'file_writer', which is not closed. The image is painted tile by tile like
+// in 'PaintSubmapSlicesTiled' and encoded one row of tiles at a time, so it
+// never exists in memory as a whole.
+PaintSubmapSlicesTiledResult WriteSubmapSlicesPng(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    double resolution, int tile_size, common::ThreadPoolInterface* thread_pool,
+    FileWriter* file_writer);
+
+// Writes the image painted by 'PaintSubmapSlices' as a pyramid of PNG tiles
+// of 'tile_size' x 'tile_size' pixels for zoomable maps. Tiles are named
+// '<zoom>_<x>_<y>.png' following the usual web map convention: zoom level 0
+// is a single tile covering the whole map, and the highest zoom level, which
+// is returned, has the full 'resolution'. Each coarser level combines 2x2
+// pixels of the finer one and keeps the observed pixel most likely to be
+// occupied. Tiles which no submap overlaps are not written, so viewers should
+// show missing tiles as unknown space. Tiles are painted depth-first on
+// 'thread_pool' and written as soon as they are complete, so only a few tiles
+// per thread are kept in memory.
+int WriteSubmapSlicesTilePyramid(
+    const std::map<::cartographer::mapping::SubmapId, SubmapSlice>& submaps,
+    double resolution, int tile_size, common::ThreadPoolInterface* thread_pool,
+    const FileWriterFactory& file_writer_factory);
+
 void FillSubmapSlice(
     const ::cartographer::transform::Rigid3d& global_submap_pose,
     const ::cartographer::mapping::proto::Submap& proto,
@@ -90,6 +144,15 @@ void DeserializeAndFillSubmapSlices(
     std::map<::cartographer::mapping::SubmapId, SubmapSlice>* submap_slices,
     mapping::ValueConversionTables* conversion_tables);
 
+// Like above, but renders and decodes the textures on 'thread_pool'. Submaps
+// are read in batches, so only a bounded number of submap protos is kept in
+// memory at a time.
+void DeserializeAndFillSubmapSlices(
+    ProtoStreamDeserializer* deserializer,
+    std::map<::cartographer::mapping::SubmapId, SubmapSlice>* submap_slices,
+    mapping::ValueConversionTables* conversion_tables,
+    common::ThreadPoolInterface* thread_pool);
+
 // Unpacks cell data as provided by the backend into 'intensity' and 'alpha'.
 SubmapTexture::Pixels UnpackTextureData(const std::string& compressed_cells,
                                         int width, int height);
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cartographer/io/submap_painter.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "boost/iostreams/device/back_inserter.hpp"
+#include "boost/iostreams/filter/zlib.hpp"
+#include "boost/iostreams/filtering_stream.hpp"
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/io/fake_file_writer.h"
+#include "cartographer/io/image.h"
+#include "cartographer/io/internal/mapping_state_serialization.h"
+#include "cartographer/io/proto_stream_deserializer.h"
+#include "cartographer/io/testing/test_helpers.h"
+#include "cartographer/mapping/value_conversion_tables.h"
+#include "cartographer/transform/rigid_transform_test_helpers.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace io {
+namespace {
+
+constexpr double kResolution = 0.05;
+// Painted where there is no submap.
+constexpr Uint8Color kBackgroundColor = {{128, 0, 0}};
+
+std::map<mapping::SubmapId, SubmapSlice> DeserializeSubmapSlices(
+    const std::vector<mapping::proto::SerializedData>& serialized_data,
+    common::ThreadPoolInterface* const thread_pool) {
+  InMemoryProtoStreamReader reader;
+  mapping::proto::SerializationHeader header;
+  header.set_format_version(kMappingStateSerializationFormatVersion);
+  reader.AddProto(header);
+  for (const auto& data : serialized_data) {
+    reader.AddProto(data);
+  }
+  ProtoStreamDeserializer deserializer(&reader);
+  std::map<mapping::SubmapId, SubmapSlice> submap_slices;
+  mapping::ValueConversionTables conversion_tables;
+  DeserializeAndFillSubmapSlices(&deserializer, &submap_slices,
+                                 &conversion_tables, thread_pool);
+  return submap_slices;
+}
+
+TEST(SubmapPainterTest, DeserializesInParallelLikeSequentially) {
+  // More submaps than are filled in one batch.
+  constexpr int kNumSubmaps = 100;
+  const auto serialized_data =
+      testing::CreateFake2DSubmapsSerializedData(kNumSubmaps);
+  common::ThreadPool thread_pool(4);
+  const auto expected = DeserializeSubmapSlices(serialized_data, nullptr);
+  const auto actual = DeserializeSubmapSlices(serialized_data, &thread_pool);
+  ASSERT_EQ(expected.size(), kNumSubmaps);
+  ASSERT_EQ(actual.size(), kNumSubmaps);
+  for (const auto& entry : expected) {
+    const SubmapSlice& expected_slice = entry.second;
+    const SubmapSlice& actual_slice = actual.at(entry.first);
+    EXPECT_EQ(actual_slice.width, expected_slice.width);
+    EXPECT_EQ(actual_slice.height, expected_slice.height);
+    EXPECT_EQ(actual_slice.resolution, expected_slice.resolution);
+    EXPECT_THAT(actual_slice.pose,
+                transform::IsNearly(expected_slice.pose, 1e-9));
+    EXPECT_THAT(actual_slice.slice_pose,
+                transform::IsNearly(expected_slice.slice_pose, 1e-9));
+    EXPECT_NE(actual_slice.surface, nullptr);
+    EXPECT_FALSE(actual_slice.cairo_data.empty());
+    EXPECT_EQ(actual_slice.cairo_data, expected_slice.cairo_data);
+  }
+}
+
+std::vector<char> ToPng(Image* image) {
+  auto content = std::make_shared<std::vector<char>>();
+  FakeFileWriter file_writer("tile.png", content);
+  image->WritePng(&file_writer);
+  return *content;
+}
+
+// Returns the pixel of 'image' or the background color outside of it.
+Uint8Color GetPixelOrBackground(const Image& image, const int x, const int y) {
+  if (x >= image.width() || y >= image.height()) {
+    return kBackgroundColor;
+  }
+  return image.GetPixel(x, y);
+}
+
+bool IsObserved(const Uint8Color& color) { return color[1] != 0; }
+
+// Returns two submaps on a diagonal, so that some tiles contain no submap.
+std::map<mapping::SubmapId, SubmapSlice> CreateDiagonalSubmapSlices() {
+  auto serialized_data = testing::CreateFake2DSubmapsSerializedData(2);
+  *serialized_data[0]
+       .mutable_pose_graph()
+       ->mutable_trajectory(0)
+       ->mutable_submap(1)
+       ->mutable_pose() = transform::ToProto(
+      transform::Rigid3d::Translation(Eigen::Vector3d(6., 6., 0.)));
+  return DeserializeSubmapSlices(serialized_data, nullptr);
+}
+
+uint32 ReadUint32(const std::vector<char>& data, const size_t index) {
+  uint32 value = 0;
+  for (size_t i = index; i < index + 4; ++i) {
+    value = (value << 8) | static_cast<uint8>(data.at(i));
+  }
+  return value;
+}
+
+// Decodes the RGB PNG written by 'WriteSubmapSlicesPng'.
+Image DecodePng(const std::vector<char>& png) {
+  const std::string kSignature = "\x89PNG\r\n\x1a\n";
+  EXPECT_EQ(std::string(png.begin(), png.begin() + 8), kSignature);
+  int width = 0;
+  int height = 0;
+  std::vector<char> image_data;
+  {
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::zlib_decompressor());
+    out.push(boost::iostreams::back_inserter(image_data));
+    size_t index = kSignature.size();
+    std::string type;
+    while (type != "IEND") {
+      const uint32 length = ReadUint32(png, index);
+      type.assign(png.begin() + index + 4, png.begin() + index + 8);
+      const auto data = png.begin() + index + 8;
+      if (type == "IHDR") {
+        width = ReadUint32(png, index + 8);
+        height = ReadUint32(png, index + 12);
+        // Bit depth 8 and RGB.
+        EXPECT_EQ(std::string(data + 8, data + 10), std::string("\x08\x02"));
+      } else if (type == "IDAT") {
+        out.write(&*data, length);
+      }
+      // Skips length, type, data and CRC.
+      index += 12 + length;
+    }
+    EXPECT_EQ(index, png.size());
+  }
+  Image image(width, height);
+  EXPECT_EQ(image_data.size(), static_cast<size_t>(height * (1 + 3 * width)));
+  for (int y = 0; y < height; ++y) {
+    const auto row = image_data.begin() + y * (1 + 3 * width);
+    // No filtering.
+    EXPECT_EQ(row[0], 0);
+    for (int x = 0; x < width; ++x) {
+      image.SetPixel(x, y,
+                     {{static_cast<uint8>(row[1 + 3 * x]),
+                       static_cast<uint8>(row[2 + 3 * x]),
+                       static_cast<uint8>(row[3 + 3 * x])}});
+    }
+  }
+  return image;
+}
+
+void ExpectEqualImages(const Image& expected, const Image& actual) {
+  ASSERT_EQ(actual.width(), expected.width());
+  ASSERT_EQ(actual.height(), expected.height());
+  for (int y = 0; y < expected.height(); ++y) {
+    for (int x = 0; x < expected.width(); ++x) {
+      ASSERT_EQ(actual.GetPixel(x, y), expected.GetPixel(x, y))
+          << x << " " << y;
+    }
+  }
+}
+
+TEST(SubmapPainterTest, TiledPaintingMatchesPaintSubmapSlices) {
+  // Does not divide the image size, so that there are partial tiles.
+  constexpr int kTileSize = 23;
+  const auto submap_slices = CreateDiagonalSubmapSlices();
+  PaintSubmapSlicesResult expected =
+      PaintSubmapSlices(submap_slices, kResolution);
+  const Image expected_image(std::move(expected.surface));
+  ASSERT_NE(expected_image.width() % kTileSize, 0);
+  Image image(expected_image.width(), expected_image.height());
+  common::ThreadPool thread_pool(2);
+  Eigen::Array2i next_offset = Eigen::Array2i::Zero();
+  int num_empty_tiles = 0;
+  const PaintSubmapSlicesTiledResult result = PaintSubmapSlicesTiled(
+      submap_slices, kResolution, kTileSize, &thread_pool,
+      [&](SubmapSlicesTile tile) {
+        // Tiles are handed over row by row from left to right.
+        EXPECT_TRUE((tile.offset == next_offset).all());
+        EXPECT_TRUE((tile.size <= kTileSize).all());
+        next_offset.x() += tile.size.x();
+        if (next_offset.x() == expected_image.width()) {
+          next_offset = Eigen::Array2i(0, next_offset.y() + tile.size.y());
+        }
+        if (tile.surface == nullptr) {
+          ++num_empty_tiles;
+        }
+        const std::unique_ptr<Image> tile_image =
+            tile.surface == nullptr
+                ? nullptr
+                : absl::make_unique<Image>(std::move(tile.surface));
+        for (int y = 0; y < tile.size.y(); ++y) {
+          for (int x = 0; x < tile.size.x(); ++x) {
+            image.SetPixel(tile.offset.x() + x, tile.offset.y() + y,
+                           tile_image == nullptr ? kBackgroundColor
+                                                 : tile_image->GetPixel(x, y));
+          }
+        }
+      });
+  EXPECT_EQ(result.size.x(), expected_image.width());
+  EXPECT_EQ(result.size.y(), expected_image.height());
+  EXPECT_TRUE((result.origin == expected.origin).all());
+  EXPECT_EQ(next_offset.y(), expected_image.height());
+  EXPECT_GT(num_empty_tiles, 0);
+  ExpectEqualImages(expected_image, image);
+}
+
+TEST(SubmapPainterTest, WritesPngLikePaintSubmapSlices) {
+  const auto submap_slices = CreateDiagonalSubmapSlices();
+  PaintSubmapSlicesResult expected =
+      PaintSubmapSlices(submap_slices, kResolution);
+  const Image expected_image(std::move(expected.surface));
+  common::ThreadPool thread_pool(2);
+  auto content = std::make_shared<std::vector<char>>();
+  FakeFileWriter file_writer("map.png", content);
+  const PaintSubmapSlicesTiledResult result = WriteSubmapSlicesPng(
+      submap_slices, kResolution, 32 /* tile_size */, &thread_pool,
+      &file_writer);
+  EXPECT_TRUE((result.origin == expected.origin).all());
+  ExpectEqualImages(expected_image, DecodePng(*content));
+}
+
+class TilePyramidTest : public ::testing::Test {
+ protected:
+  static constexpr int kTileSize = 32;
+
+  TilePyramidTest()
+      : submap_slices_(CreateDiagonalSubmapSlices()), thread_pool_(2) {}
+
+  int WriteTilePyramid() {
+    return WriteSubmapSlicesTilePyramid(
+        submap_slices_, kResolution, kTileSize, &thread_pool_,
+        [this](const std::string& filename) {
+          auto content = std::make_shared<std::vector<char>>();
+          absl::MutexLock locker(&mutex_);
+          EXPECT_TRUE(files_.emplace(filename, content).second) << filename;
+          return absl::make_unique<FakeFileWriter>(filename, content);
+        });
+  }
+
+  bool HasTile(const int zoom, const int x, const int y) {
+    return files_.count(absl::StrCat(zoom, "_", x, "_", y, ".png")) == 1;
+  }
+
+  const std::vector<char>& GetTile(const int zoom, const int x, const int y) {
+    return *files_.at(absl::StrCat(zoom, "_", x, "_", y, ".png"));
+  }
+
+  std::map<mapping::SubmapId, SubmapSlice> submap_slices_;
+  common::ThreadPool thread_pool_;
+  absl::Mutex mutex_;
+  std::map<std::string, std::shared_ptr<std::vector<char>>> files_;
+};
+
+constexpr int TilePyramidTest::kTileSize;
+
+TEST_F(TilePyramidTest, WritesPyramidLevels) {
+  const int max_zoom = WriteTilePyramid();
+  const Image image(PaintSubmapSlices(submap_slices_, kResolution).surface);
+  int expected_max_zoom = 0;
+  while ((kTileSize << expected_max_zoom) <
+         std::max(image.width(), image.height())) {
+    ++expected_max_zoom;
+  }
+  EXPECT_EQ(max_zoom, expected_max_zoom);
+  EXPECT_GT(max_zoom, 1);
+  EXPECT_TRUE(HasTile(0, 0, 0));
+  // A coarser tile is written exactly if one of its children is.
+  size_t num_tiles = 0;
+  for (int zoom = 0; zoom <= max_zoom; ++zoom) {
+    for (int y = 0; y < (1 << zoom); ++y) {
+      for (int x = 0; x < (1 << zoom); ++x) {
+        if (HasTile(zoom, x, y)) {
+          ++num_tiles;
+        }
+        if (zoom == max_zoom) {
+          continue;
+        }
+        const bool has_child =
+            HasTile(zoom + 1, 2 * x, 2 * y) ||
+            HasTile(zoom + 1, 2 * x + 1, 2 * y) ||
+            HasTile(zoom + 1, 2 * x, 2 * y + 1) ||
+            HasTile(zoom + 1, 2 * x + 1, 2 * y + 1);
+        EXPECT_EQ(HasTile(zoom, x, y), has_child) << zoom << " " << x << " "
+                                                  << y;
+      }
+    }
+  }
+  // No tiles outside of the pyramid were written.
+  EXPECT_EQ(num_tiles, files_.size());
+}
+
+TEST_F(TilePyramidTest, HighestZoomLevelMatchesPaintedImage) {
+  const int max_zoom = WriteTilePyramid();
+  const Image image(PaintSubmapSlices(submap_slices_, kResolution).surface);
+  int num_empty_tiles = 0;
+  for (int y = 0; y * kTileSize < image.height(); ++y) {
+    for (int x = 0; x * kTileSize < image.width(); ++x) {
+      Image expected_tile(kTileSize, kTileSize);
+      bool observed = false;
+      for (int j = 0; j < kTileSize; ++j) {
+        for (int i = 0; i < kTileSize; ++i) {
+          const Uint8Color color = GetPixelOrBackground(
+              image, x * kTileSize + i, y * kTileSize + j);
+          observed |= IsObserved(color);
+          expected_tile.SetPixel(i, j, color);
+        }
+      }
+      if (!HasTile(max_zoom, x, y)) {
+        EXPECT_FALSE(observed) << x << " " << y;
+        ++num_empty_tiles;
+        continue;
+      }
+      EXPECT_EQ(GetTile(max_zoom, x, y), ToPng(&expected_tile))
+          << x << " " << y;
+    }
+  }
+  EXPECT_GT(num_empty_tiles, 0);
+}
+
+TEST_F(TilePyramidTest, DownsamplingKeepsOccupiedPixels) {
+  const int max_zoom = WriteTilePyramid();
+  const Image image(PaintSubmapSlices(submap_slices_, kResolution).surface);
+  const int zoom = max_zoom - 1;
+  const int size = 2 * kTileSize;
+  for (int y = 0; y * size < image.height(); ++y) {
+    for (int x = 0; x * size < image.width(); ++x) {
+      if (!HasTile(zoom, x, y)) {
+        continue;
+      }
+      Image expected_tile(kTileSize, kTileSize);
+      for (int j = 0; j < kTileSize; ++j) {
+        for (int i = 0; i < kTileSize; ++i) {
+          // Of the 2x2 pixels, the observed one with the lowest intensity,
+          // i.e. the highest probability of being occupied, is kept.
+          Uint8Color color = kBackgroundColor;
+          bool observed = false;
+          for (int k = 0; k < 4; ++k) {
+            const Uint8Color pixel = GetPixelOrBackground(
+                image, x * size + 2 * i + k % 2, y * size + 2 * j + k / 2);
+            if (k == 0) {
+              color = pixel;
+            }
+            if (IsObserved(pixel) && (!observed || pixel[0] < color[0])) {
+              color = pixel;
+              observed = true;
+            }
+          }
+          expected_tile.SetPixel(i, j, color);
+        }
+      }
+      EXPECT_EQ(GetTile(zoom, x, y), ToPng(&expected_tile)) << x << " " << y;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace cartographer
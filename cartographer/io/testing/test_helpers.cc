@@ -16,7 +16,10 @@
 
 #include "cartographer/io/testing/test_helpers.h"
 
-#include "cartographer/mapping/proto/serialization.pb.h"
+#include "cartographer/mapping/2d/probability_grid.h"
+#include "cartographer/mapping/2d/submap_2d.h"
+#include "cartographer/mapping/value_conversion_tables.h"
+#include "cartographer/transform/transform.h"
 
 namespace cartographer {
 namespace io {
@@ -39,6 +42,52 @@ std::unique_ptr<InMemoryProtoStreamReader> ProtoReaderFromStrings(
   return absl::make_unique<InMemoryProtoStreamReader>(std::move(proto_queue));
 }
 
+std::vector<::cartographer::mapping::proto::SerializedData>
+CreateFake2DSubmapsSerializedData(const int num_submaps) {
+  constexpr double kResolution = 0.05;
+  constexpr int kNumCells = 40;
+  ::cartographer::mapping::ValueConversionTables conversion_tables;
+  std::vector<::cartographer::mapping::proto::SerializedData> serialized_data(
+      2);
+  auto *const trajectory =
+      serialized_data[0].mutable_pose_graph()->add_trajectory();
+  trajectory->set_trajectory_id(0);
+  serialized_data[1]
+      .mutable_all_trajectory_builder_options()
+      ->add_options_with_sensor_ids();
+  for (int submap_index = 0; submap_index != num_submaps; ++submap_index) {
+    auto grid = absl::make_unique<::cartographer::mapping::ProbabilityGrid>(
+        ::cartographer::mapping::MapLimits(
+            kResolution, Eigen::Vector2d::Constant(kNumCells * kResolution),
+            ::cartographer::mapping::CellLimits(kNumCells, kNumCells)),
+        &conversion_tables);
+    for (int y = 0; y != kNumCells; ++y) {
+      for (int x = 0; x != kNumCells; ++x) {
+        if (x < 5 && y < 5) {
+          continue;
+        }
+        const bool occupied = x == 0 || y == 0 || x == kNumCells - 1 ||
+                              y == kNumCells - 1 || x == y;
+        grid->SetProbability({x, y}, occupied ? 0.9f : 0.1f);
+      }
+    }
+    ::cartographer::mapping::Submap2D submap(
+        Eigen::Vector2f::Zero(), std::move(grid), &conversion_tables);
+    ::cartographer::mapping::proto::SerializedData data;
+    *data.mutable_submap() = submap.ToProto(true /* include_grid_data */);
+    data.mutable_submap()->mutable_submap_id()->set_trajectory_id(0);
+    data.mutable_submap()->mutable_submap_id()->set_submap_index(submap_index);
+    serialized_data.push_back(data);
+
+    auto *const submap_proto = trajectory->add_submap();
+    submap_proto->set_submap_index(submap_index);
+    *submap_proto->mutable_pose() = ::cartographer::transform::ToProto(
+        ::cartographer::transform::Rigid3d::Translation(
+            Eigen::Vector3d(1.5 * submap_index, 0.25 * submap_index, 0.)));
+  }
+  return serialized_data;
+}
+
 }  // namespace testing
 }  // namespace io
 }  // namespace cartographer
@@ -18,8 +18,10 @@
 #define CARTOGRAPHER_IO_TESTING_TEST_HELPERS_H_
 
 #include <memory>
+#include <vector>
 
 #include "cartographer/io/internal/in_memory_proto_stream.h"
+#include "cartographer/mapping/proto/serialization.pb.h"
 #include "glog/logging.h"
 #include "google/protobuf/text_format.h"
 
@@ -38,6 +40,13 @@ std::unique_ptr<InMemoryProtoStreamReader> ProtoReaderFromStrings(
     const std::string &header_textpb,
     const std::initializer_list<std::string> &data_textpbs);
 
+// Returns the pose graph, trajectory builder options and 'num_submaps'
+// overlapping 2D submaps of trajectory 0, in the order in which they follow
+// the header in a pbstream. Each submap has occupied cells along its border
+// and diagonal, free cells elsewhere and unknown cells in one corner.
+std::vector<::cartographer::mapping::proto::SerializedData>
+CreateFake2DSubmapsSerializedData(int num_submaps);
+
 }  // namespace testing
 }  // namespace io
 }  // namespace cartographer
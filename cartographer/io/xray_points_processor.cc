@@ -103,16 +103,6 @@ Image IntoImage(const PixelDataMatrix& matrix, double saturation_factor) {
   return image;
 }
 
-bool ContainedIn(const common::Time& time,
-                 const std::vector<mapping::Timespan>& timespans) {
-  for (const mapping::Timespan& timespan : timespans) {
-    if (timespan.start <= time && time <= timespan.end) {
-      return true;
-    }
-  }
-  return false;
-}
-
 }  // namespace
 
 XRayPointsProcessor::XRayPointsProcessor(
@@ -128,6 +118,7 @@ XRayPointsProcessor::XRayPointsProcessor(
       file_writer_factory_(file_writer_factory),
       next_(next),
       floors_(floors),
+      floor_index_(floors_),
       output_filename_(output_filename),
       transform_(transform),
       saturation_factor_(saturation_factor) {
@@ -187,18 +178,21 @@ void XRayPointsProcessor::WriteVoxels(const Aggregation& aggregation,
   const int xsize = bounding_box_.sizes()[1] + 1;
   const int ysize = bounding_box_.sizes()[2] + 1;
   PixelDataMatrix pixel_data_matrix(xsize, ysize);
-  for (mapping::HybridGridBase<bool>::Iterator it(aggregation.voxels);
-       !it.Done(); it.Next()) {
-    const Eigen::Array3i cell_index = it.GetCellIndex();
-    const Eigen::Array2i pixel = voxel_index_to_pixel(cell_index);
-    PixelData& pixel_data = pixel_data_matrix(pixel.x(), pixel.y());
-    const auto& column_data = aggregation.column_data.at(
-        std::make_pair(cell_index[1], cell_index[2]));
-    pixel_data.mean_r = column_data.sum_r / column_data.count;
-    pixel_data.mean_g = column_data.sum_g / column_data.count;
-    pixel_data.mean_b = column_data.sum_b / column_data.count;
-    ++pixel_data.num_occupied_cells_in_column;
-  }
+  using VoxelBlock = mapping::HybridGridBase<bool>::BlockType;
+  aggregation.voxels.ForEachBlock([&](const Eigen::Array3i& block_offset,
+                                      const VoxelBlock& block) {
+    for (VoxelBlock::Iterator it(block); !it.Done(); it.Next()) {
+      const Eigen::Array3i cell_index = block_offset + it.GetCellIndex();
+      const Eigen::Array2i pixel = voxel_index_to_pixel(cell_index);
+      PixelData& pixel_data = pixel_data_matrix(pixel.x(), pixel.y());
+      const auto& column_data = aggregation.column_data.at(
+          std::make_pair(cell_index[1], cell_index[2]));
+      pixel_data.mean_r = column_data.sum_r / column_data.count;
+      pixel_data.mean_g = column_data.sum_g / column_data.count;
+      pixel_data.mean_b = column_data.sum_b / column_data.count;
+      ++pixel_data.num_occupied_cells_in_column;
+    }
+  });
 
   Image image = IntoImage(pixel_data_matrix, saturation_factor_);
   if (draw_trajectories_ == DrawTrajectories::kYes) {
@@ -243,11 +237,8 @@ void XRayPointsProcessor::Process(std::unique_ptr<PointsBatch> batch) {
     CHECK_EQ(aggregations_.size(), 1);
     Insert(*batch, &aggregations_[0]);
   } else {
-    for (size_t i = 0; i < floors_.size(); ++i) {
-      if (!ContainedIn(batch->start_time, floors_[i].timespans)) {
-        continue;
-      }
-      Insert(*batch, &aggregations_[i]);
+    for (const int floor_index : floor_index_.GetFloorsAt(batch->start_time)) {
+      Insert(*batch, &aggregations_[floor_index]);
     }
   }
   next_->Process(std::move(batch));
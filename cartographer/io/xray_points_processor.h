@@ -82,6 +82,8 @@ class XRayPointsProcessor : public PointsProcessor {
 
   // If empty, we do not separate into floors.
   std::vector<mapping::Floor> floors_;
+  // Maps the start time of a batch to the floors it belongs to.
+  const mapping::FloorIndex floor_index_;
 
   const std::string output_filename_;
   const transform::Rigid3f transform_;
@@ -163,6 +163,12 @@ void Grid2D::GrowLimits(const Eigen::Vector2f& point,
   }
 }
 
+size_t Grid2D::EstimateMemoryUsage() const {
+  return sizeof(*this) +
+         correspondence_cost_cells_.capacity() * sizeof(uint16) +
+         update_indices_.capacity() * sizeof(int);
+}
+
 proto::Grid2D Grid2D::ToProto() const {
   proto::Grid2D result;
   *result.mutable_limits() = mapping::ToProto(limits_);
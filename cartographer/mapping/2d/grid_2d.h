@@ -89,6 +89,9 @@ class Grid2D : public GridInterface {
       proto::SubmapQuery::Response::SubmapTexture* const texture,
       transform::Rigid3d local_pose) const = 0;
 
+  // Returns an estimate of the heap memory used by this grid in bytes.
+  virtual size_t EstimateMemoryUsage() const;
+
  protected:
   void GrowLimits(const Eigen::Vector2f& point,
                   const std::vector<std::vector<uint16>*>& grids,
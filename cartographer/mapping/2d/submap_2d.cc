@@ -134,6 +134,10 @@ void Submap2D::ToResponseProto(
   grid()->DrawToSubmapTexture(texture, local_pose());
 }
 
+size_t Submap2D::EstimateMemoryUsage() const {
+  return sizeof(*this) + (grid_ ? grid_->EstimateMemoryUsage() : 0);
+}
+
 void Submap2D::InsertRangeData(
     const sensor::RangeData& range_data,
     const RangeDataInserterInterface* range_data_inserter) {
@@ -115,6 +115,11 @@ proto::Grid2D TSDF2D::ToProto() const {
   return result;
 }
 
+size_t TSDF2D::EstimateMemoryUsage() const {
+  return Grid2D::EstimateMemoryUsage() - sizeof(Grid2D) + sizeof(*this) +
+         weight_cells_.capacity() * sizeof(uint16);
+}
+
 std::unique_ptr<Grid2D> TSDF2D::ComputeCroppedGrid() const {
   Eigen::Array2i offset;
   CellLimits cell_limits;
@@ -50,6 +50,7 @@ class TSDF2D : public Grid2D {
       proto::SubmapQuery::Response::SubmapTexture* const texture,
       transform::Rigid3d local_pose) const override;
   bool CellIsUpdated(const Eigen::Array2i& cell_index) const;
+  size_t EstimateMemoryUsage() const override;
 
  private:
   ValueConversionTables* conversion_tables_;
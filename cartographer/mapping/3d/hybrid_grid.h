@@ -19,13 +19,16 @@
 
 #include <array>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "Eigen/Core"
 #include "absl/memory/memory.h"
 #include "cartographer/common/math.h"
+#include "cartographer/common/parallel_for.h"
 #include "cartographer/common/port.h"
 #include "cartographer/mapping/probability_values.h"
 #include "cartographer/mapping/proto/3d/hybrid_grid.pb.h"
@@ -69,6 +72,7 @@ template <typename TValueType, int kBits>
 class FlatGrid {
  public:
   using ValueType = TValueType;
+  using BlockType = FlatGrid;
 
   // Creates a new flat grid with all values being default constructed.
   FlatGrid() {
@@ -94,6 +98,14 @@ class FlatGrid {
     return &cells_[ToFlatIndex(index, kBits)];
   }
 
+  // A flat grid is a single block, so 'visitor' is called once with 'offset',
+  // the index of its first voxel.
+  template <typename BlockVisitor>
+  void ForEachBlock(const Eigen::Array3i& offset,
+                    BlockVisitor& visitor) const {
+    visitor(offset, *this);
+  }
+
   // An iterator for iterating over all values not comparing equal to the
   // default constructed value.
   class Iterator {
@@ -144,6 +156,7 @@ template <typename WrappedGrid, int kBits>
 class NestedGrid {
  public:
   using ValueType = typename WrappedGrid::ValueType;
+  using BlockType = typename WrappedGrid::BlockType;
 
   // Returns the number of voxels per dimension.
   static int grid_size() { return WrappedGrid::grid_size() << kBits; }
@@ -176,6 +189,19 @@ class NestedGrid {
     return meta_cell->mutable_value(inner_index);
   }
 
+  // Calls 'visitor' for every allocated block with the index of its first
+  // voxel, given that the first voxel of this grid is at 'offset'.
+  template <typename BlockVisitor>
+  void ForEachBlock(const Eigen::Array3i& offset,
+                    BlockVisitor& visitor) const {
+    for (size_t i = 0; i < meta_cells_.size(); ++i) {
+      if (meta_cells_[i] != nullptr) {
+        meta_cells_[i]->ForEachBlock(
+            offset + To3DIndex(i, kBits) * WrappedGrid::grid_size(), visitor);
+      }
+    }
+  }
+
   // An iterator for iterating over all values not comparing equal to the
   // default constructed value.
   class Iterator {
@@ -251,6 +277,9 @@ template <typename WrappedGrid>
 class DynamicGrid {
  public:
   using ValueType = typename WrappedGrid::ValueType;
+  using BlockType = typename WrappedGrid::BlockType;
+  using BlockVisitor =
+      std::function<void(const Eigen::Array3i& block_offset, const BlockType&)>;
 
   DynamicGrid() : bits_(1), meta_cells_(8) {}
   DynamicGrid(DynamicGrid&&) = default;
@@ -299,6 +328,46 @@ class DynamicGrid {
     return meta_cell->mutable_value(inner_index);
   }
 
+  // Calls 'visitor' for every allocated block of voxels with the index of its
+  // first voxel, in the same order in which 'Iterator' visits the voxels.
+  // Values inside a block can be visited with 'BlockType::Iterator', which
+  // avoids the per-voxel overhead of skipping unallocated blocks.
+  template <typename Visitor>
+  void ForEachBlock(Visitor visitor) const {
+    const Eigen::Array3i offset =
+        Eigen::Array3i::Constant(-(grid_size() >> 1));
+    for (size_t i = 0; i < meta_cells_.size(); ++i) {
+      if (meta_cells_[i] != nullptr) {
+        meta_cells_[i]->ForEachBlock(
+            offset + To3DIndex(i, bits_) * WrappedGrid::grid_size(), visitor);
+      }
+    }
+  }
+
+  // Same as above, but calls 'visitor' in parallel on 'thread_pool' and the
+  // calling thread, in no particular order.
+  void ParallelForEachBlock(common::ThreadPoolInterface* const thread_pool,
+                            const BlockVisitor& visitor) const {
+    std::vector<std::pair<Eigen::Array3i, const BlockType*>> blocks;
+    ForEachBlock(
+        [&blocks](const Eigen::Array3i& block_offset, const BlockType& block) {
+          blocks.emplace_back(block_offset, &block);
+        });
+    common::ParallelFor(thread_pool, blocks.size(),
+                        [&blocks, &visitor](int index) {
+                          visitor(blocks[index].first, *blocks[index].second);
+                        });
+  }
+
+  // Returns the number of allocated blocks of voxels.
+  size_t num_blocks() const {
+    size_t num_blocks = 0;
+    ForEachBlock([&num_blocks](const Eigen::Array3i&, const BlockType&) {
+      ++num_blocks;
+    });
+    return num_blocks;
+  }
+
   // An iterator for iterating over all values not comparing equal to the
   // default constructed value.
   class Iterator {
@@ -414,6 +483,7 @@ template <typename ValueType>
 class HybridGridBase : public GridBase<ValueType> {
  public:
   using Iterator = typename GridBase<ValueType>::Iterator;
+  using BlockType = typename GridBase<ValueType>::BlockType;
 
   // Creates a new tree-based probability grid with voxels having edge length
   // 'resolution' around the origin which becomes the center of the cell at
@@ -481,6 +551,12 @@ class HybridGrid : public HybridGridBase<uint16> {
                                      proto.z_indices(i)),
                      ValueToProbability(proto.values(i)));
     }
+    Eigen::Array3i block_index = Eigen::Array3i::Zero();
+    for (const proto::HybridGrid::Block& block : proto.blocks()) {
+      block_index +=
+          Eigen::Array3i(block.delta_x(), block.delta_y(), block.delta_z());
+      AddBlockFromProto(block_index * BlockType::grid_size(), block);
+    }
   }
 
   // Sets the probability of the cell at 'index' to the given 'probability'.
@@ -530,16 +606,73 @@ class HybridGrid : public HybridGridBase<uint16> {
                                       "not supported. Finish the update first.";
     proto::HybridGrid result;
     result.set_resolution(resolution());
-    for (const auto it : *this) {
-      result.add_x_indices(it.first.x());
-      result.add_y_indices(it.first.y());
-      result.add_z_indices(it.first.z());
-      result.add_values(it.second);
-    }
+    Eigen::Array3i last_block_index = Eigen::Array3i::Zero();
+    ForEachBlock([&result, &last_block_index](
+                     const Eigen::Array3i& block_offset,
+                     const BlockType& block) {
+      std::array<uint64, kNumBlockCells / 64> known_mask{};
+      std::string values;
+      for (BlockType::Iterator it(block); !it.Done(); it.Next()) {
+        const int i = ToFlatIndex(it.GetCellIndex(), kBlockBits);
+        known_mask[i / 64] |= uint64{1} << (i % 64);
+        values.push_back(static_cast<char>(it.GetValue() & 0xff));
+        values.push_back(static_cast<char>(it.GetValue() >> 8));
+      }
+      if (values.empty()) {
+        return;
+      }
+      const Eigen::Array3i block_index = block_offset / BlockType::grid_size();
+      const Eigen::Array3i delta = block_index - last_block_index;
+      last_block_index = block_index;
+      proto::HybridGrid::Block* const block_proto = result.add_blocks();
+      block_proto->set_delta_x(delta.x());
+      block_proto->set_delta_y(delta.y());
+      block_proto->set_delta_z(delta.z());
+      if (values.size() < 2 * kNumBlockCells) {
+        for (const uint64 mask : known_mask) {
+          block_proto->add_known_mask(mask);
+        }
+      }
+      block_proto->set_values(std::move(values));
+    });
     return result;
   }
 
  private:
+  // Blocks are the 'FlatGrid's of 'GridBase'.
+  static constexpr int kBlockBits = 3;
+  static constexpr int kNumBlockCells = 1 << (3 * kBlockBits);
+
+  // Sets the known voxels of 'block' with its first voxel at 'block_offset'.
+  void AddBlockFromProto(const Eigen::Array3i& block_offset,
+                         const proto::HybridGrid::Block& block) {
+    const bool has_known_mask = block.known_mask_size() > 0;
+    if (has_known_mask) {
+      CHECK_EQ(block.known_mask_size(), kNumBlockCells / 64);
+    }
+    // The voxels of a block are stored contiguously in z-major order starting
+    // with the voxel at 'block_offset'.
+    ValueType* const cells = mutable_value(block_offset);
+    const std::string& values = block.values();
+    size_t num_values = 0;
+    for (int i = 0; i < kNumBlockCells; ++i) {
+      if (has_known_mask &&
+          ((block.known_mask(i / 64) >> (i % 64)) & uint64{1}) == 0) {
+        continue;
+      }
+      CHECK_LE(2 * num_values + 2, values.size());
+      const uint16 value =
+          static_cast<uint8>(values[2 * num_values]) |
+          (static_cast<uint16>(static_cast<uint8>(values[2 * num_values + 1]))
+           << 8);
+      CHECK_GT(value, 0);
+      CHECK_LT(value, kUpdateMarker);
+      cells[i] = value;
+      ++num_values;
+    }
+    CHECK_EQ(2 * num_values, values.size());
+  }
+
   // Markers at changed cells.
   std::vector<ValueType*> update_indices_;
 };
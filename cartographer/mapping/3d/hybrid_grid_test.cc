@@ -20,6 +20,8 @@
 #include <random>
 #include <tuple>
 
+#include "absl/synchronization/mutex.h"
+#include "cartographer/common/thread_pool.h"
 #include "gmock/gmock.h"
 
 namespace cartographer {
@@ -178,17 +180,63 @@ TEST_F(RandomHybridGridTest, TestIteration) {
   }
 }
 
+TEST_F(RandomHybridGridTest, ForEachBlockVisitsAllValuesInOrder) {
+  auto it = HybridGrid::Iterator(hybrid_grid_);
+  size_t num_blocks = 0;
+  hybrid_grid_.ForEachBlock([&it, &num_blocks](
+                                const Eigen::Array3i& block_offset,
+                                const HybridGrid::BlockType& block) {
+    ++num_blocks;
+    EXPECT_TRUE((block_offset.unaryExpr([](int i) { return i & 7; }) == 0)
+                    .all());
+    for (HybridGrid::BlockType::Iterator block_it(block); !block_it.Done();
+         block_it.Next()) {
+      ASSERT_FALSE(it.Done());
+      EXPECT_THAT(block_offset + block_it.GetCellIndex(),
+                  AllCwiseEqual(it.GetCellIndex()));
+      EXPECT_EQ(block_it.GetValue(), it.GetValue());
+      it.Next();
+    }
+  });
+  EXPECT_TRUE(it.Done());
+  EXPECT_EQ(num_blocks, hybrid_grid_.num_blocks());
+}
+
+TEST_F(RandomHybridGridTest, ParallelForEachBlock) {
+  common::ThreadPool thread_pool(4);
+  absl::Mutex mutex;
+  ValueMap visited_values;
+  hybrid_grid_.ParallelForEachBlock(
+      &thread_pool, [&mutex, &visited_values](
+                        const Eigen::Array3i& block_offset,
+                        const HybridGrid::BlockType& block) {
+        absl::MutexLock locker(&mutex);
+        for (HybridGrid::BlockType::Iterator it(block); !it.Done();
+             it.Next()) {
+          const Eigen::Array3i cell_index = block_offset + it.GetCellIndex();
+          visited_values[std::make_tuple(cell_index.x(), cell_index.y(),
+                                         cell_index.z())] =
+              ValueToProbability(it.GetValue());
+        }
+      });
+  ASSERT_EQ(visited_values.size(), values_.size());
+  for (const auto& entry : values_) {
+    EXPECT_NEAR(visited_values.at(entry.first), entry.second, 1e-4);
+  }
+}
+
 TEST_F(RandomHybridGridTest, ToProto) {
   const auto proto = hybrid_grid_.ToProto();
   EXPECT_EQ(hybrid_grid_.resolution(), proto.resolution());
-  ASSERT_EQ(proto.x_indices_size(), proto.y_indices_size());
-  ASSERT_EQ(proto.x_indices_size(), proto.z_indices_size());
-  ASSERT_EQ(proto.x_indices_size(), proto.values_size());
+  EXPECT_EQ(proto.x_indices_size(), 0);
+  EXPECT_EQ(proto.values_size(), 0);
+  EXPECT_GT(proto.blocks_size(), 0);
 
   ValueMap proto_map;
-  for (int i = 0; i < proto.x_indices_size(); ++i) {
-    proto_map[std::make_tuple(proto.x_indices(i), proto.y_indices(i),
-                              proto.z_indices(i))] = proto.values(i);
+  const HybridGrid constructed_grid(proto);
+  for (const auto i : constructed_grid) {
+    proto_map[std::make_tuple(i.first.x(), i.first.y(), i.first.z())] =
+        i.second;
   }
 
   // Get hybrid_grid_ into the same format.
@@ -201,6 +249,50 @@ TEST_F(RandomHybridGridTest, ToProto) {
   EXPECT_EQ(proto_map, hybrid_grid_map);
 }
 
+TEST(HybridGridTest, ToProtoOfFullBlockOmitsKnownMask) {
+  HybridGrid hybrid_grid(1.f);
+  for (int z = -8; z < 0; ++z) {
+    for (int y = 8; y < 16; ++y) {
+      for (int x = 0; x < 8; ++x) {
+        hybrid_grid.SetProbability(Eigen::Array3i(x, y, z), 0.7f);
+      }
+    }
+  }
+  hybrid_grid.SetProbability(Eigen::Array3i(-1, 1, 2), 0.3f);
+  const proto::HybridGrid proto = hybrid_grid.ToProto();
+  ASSERT_EQ(proto.blocks_size(), 2);
+  int num_full_blocks = 0;
+  for (const auto& block : proto.blocks()) {
+    if (block.known_mask_size() == 0) {
+      ++num_full_blocks;
+      EXPECT_EQ(block.values().size(), 2 * 512);
+    } else {
+      EXPECT_EQ(block.values().size(), 2);
+    }
+  }
+  EXPECT_EQ(num_full_blocks, 1);
+
+  const HybridGrid constructed_grid(proto);
+  EXPECT_NEAR(constructed_grid.GetProbability(Eigen::Array3i(7, 15, -8)), 0.7f,
+              1e-4);
+  EXPECT_NEAR(constructed_grid.GetProbability(Eigen::Array3i(-1, 1, 2)), 0.3f,
+              1e-4);
+  EXPECT_FALSE(constructed_grid.IsKnown(Eigen::Array3i(-1, 1, 3)));
+}
+
+TEST(HybridGridTest, FromLegacyProto) {
+  proto::HybridGrid proto;
+  proto.set_resolution(0.5f);
+  proto.add_x_indices(-3);
+  proto.add_y_indices(4);
+  proto.add_z_indices(100);
+  proto.add_values(ProbabilityToValue(0.8f));
+  const HybridGrid hybrid_grid(proto);
+  EXPECT_EQ(hybrid_grid.resolution(), 0.5f);
+  EXPECT_NEAR(hybrid_grid.GetProbability(Eigen::Array3i(-3, 4, 100)), 0.8f,
+              1e-4);
+}
+
 struct EigenComparator {
   bool operator()(const Eigen::Vector3i& lhs,
                   const Eigen::Vector3i& rhs) const {
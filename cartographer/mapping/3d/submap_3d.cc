@@ -86,28 +86,32 @@ std::vector<Eigen::Array4i> ExtractVoxelData(
   const float resolution_inverse = 1.f / hybrid_grid.resolution();
 
   constexpr float kXrayObstructedCellProbabilityLimit = 0.501f;
-  for (auto it = HybridGrid::Iterator(hybrid_grid); !it.Done(); it.Next()) {
-    const uint16 probability_value = it.GetValue();
-    const float probability = ValueToProbability(probability_value);
-    if (probability < kXrayObstructedCellProbabilityLimit) {
-      // We ignore non-obstructed cells.
-      continue;
+  hybrid_grid.ForEachBlock([&](const Eigen::Array3i& block_offset,
+                               const HybridGrid::BlockType& block) {
+    for (HybridGrid::BlockType::Iterator it(block); !it.Done(); it.Next()) {
+      const uint16 probability_value = it.GetValue();
+      const float probability = ValueToProbability(probability_value);
+      if (probability < kXrayObstructedCellProbabilityLimit) {
+        // We ignore non-obstructed cells.
+        continue;
+      }
+
+      const Eigen::Vector3f cell_center_submap =
+          hybrid_grid.GetCenterOfCell(block_offset + it.GetCellIndex());
+      const Eigen::Vector3f cell_center_global =
+          transform * cell_center_submap;
+      const Eigen::Array4i voxel_index_and_probability(
+          common::RoundToInt(cell_center_global.x() * resolution_inverse),
+          common::RoundToInt(cell_center_global.y() * resolution_inverse),
+          common::RoundToInt(cell_center_global.z() * resolution_inverse),
+          probability_value);
+
+      voxel_indices_and_probabilities.push_back(voxel_index_and_probability);
+      const Eigen::Array2i pixel_index = voxel_index_and_probability.head<2>();
+      *min_index = min_index->cwiseMin(pixel_index);
+      *max_index = max_index->cwiseMax(pixel_index);
     }
-
-    const Eigen::Vector3f cell_center_submap =
-        hybrid_grid.GetCenterOfCell(it.GetCellIndex());
-    const Eigen::Vector3f cell_center_global = transform * cell_center_submap;
-    const Eigen::Array4i voxel_index_and_probability(
-        common::RoundToInt(cell_center_global.x() * resolution_inverse),
-        common::RoundToInt(cell_center_global.y() * resolution_inverse),
-        common::RoundToInt(cell_center_global.z() * resolution_inverse),
-        probability_value);
-
-    voxel_indices_and_probabilities.push_back(voxel_index_and_probability);
-    const Eigen::Array2i pixel_index = voxel_index_and_probability.head<2>();
-    *min_index = min_index->cwiseMin(pixel_index);
-    *max_index = max_index->cwiseMax(pixel_index);
-  }
+  });
   return voxel_indices_and_probabilities;
 }
 
@@ -177,6 +181,13 @@ void AddToTextureProto(
           global_submap_pose.translation().z())));
 }
 
+// Estimates the memory used by 'hybrid_grid' from the number of allocated
+// voxel blocks.
+size_t EstimateMemoryUsage(const HybridGrid& hybrid_grid) {
+  return sizeof(hybrid_grid) +
+         hybrid_grid.num_blocks() * sizeof(HybridGrid::BlockType);
+}
+
 }  // namespace
 
 proto::SubmapsOptions3D CreateSubmapsOptions3D(
@@ -268,6 +279,13 @@ void Submap3D::ToResponseProto(
                     response->add_textures());
 }
 
+size_t Submap3D::EstimateMemoryUsage() const {
+  return sizeof(*this) +
+         mapping::EstimateMemoryUsage(*high_resolution_hybrid_grid_) +
+         mapping::EstimateMemoryUsage(*low_resolution_hybrid_grid_) +
+         rotational_scan_matcher_histogram_.size() * sizeof(float);
+}
+
 void Submap3D::InsertData(const sensor::RangeData& range_data_in_local,
                           const RangeDataInserter3D& range_data_inserter,
                           const float high_resolution_max_range,
@@ -54,6 +54,8 @@ class Submap3D : public Submap {
   void ToResponseProto(const transform::Rigid3d& global_submap_pose,
                        proto::SubmapQuery::Response* response) const override;
 
+  size_t EstimateMemoryUsage() const override;
+
   const HybridGrid& high_resolution_hybrid_grid() const {
     return *high_resolution_hybrid_grid_;
   }
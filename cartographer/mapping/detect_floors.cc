@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <utility>
 #include <vector>
 
 #include "Eigen/Core"
@@ -44,6 +45,8 @@ struct Span {
   int start_index;
   int end_index;
   std::vector<double> z_values;
+  // Length of the span in meters, accumulated while slicing.
+  double length = 0.;
 
   bool operator<(const Span& other) const {
     return std::forward_as_tuple(start_index, end_index) <
@@ -88,6 +91,11 @@ std::vector<Span> SliceByAltitudeChange(const proto::Trajectory& trajectory) {
     const double z = node.pose().translation().z();
     if (std::abs(Median(spans.back().z_values) - z) > kLevelHeightMeters) {
       spans.push_back(Span{i, i, {}});
+    } else {
+      const auto a =
+          transform::ToEigen(trajectory.node(i - 1).pose().translation());
+      const auto b = transform::ToEigen(node.pose().translation());
+      spans.back().length += (a - b).head<2>().norm();
     }
     InsertSorted(z, &spans.back().z_values);
     spans.back().end_index = i + 1;
@@ -95,33 +103,26 @@ std::vector<Span> SliceByAltitudeChange(const proto::Trajectory& trajectory) {
   return spans;
 }
 
-// Returns the length of 'span' in meters.
-double SpanLength(const proto::Trajectory& trajectory, const Span& span) {
-  double length = 0;
-  for (int i = span.start_index + 1; i < span.end_index; ++i) {
-    const auto a =
-        transform::ToEigen(trajectory.node(i - 1).pose().translation());
-    const auto b = transform::ToEigen(trajectory.node(i).pose().translation());
-    length += (a - b).head<2>().norm();
-  }
-  return length;
-}
-
 // True if 'span' is considered to be short, i.e. not interesting on its own,
 // but should be folded into the levels before and after entering it.
-bool IsShort(const proto::Trajectory& trajectory, const Span& span) {
-  return SpanLength(trajectory, span) < kMaxShortSpanLengthMeters;
+bool IsShort(const Span& span) {
+  return span.length < kMaxShortSpanLengthMeters;
 }
 
 // Merges all 'spans' that have similar median z value into the same level.
-void GroupSegmentsByAltitude(const proto::Trajectory& trajectory,
-                             const std::vector<Span>& spans, Levels* levels) {
+// Two spans end up in the same level iff they are connected by a chain of
+// spans with similar median z value, so it is sufficient to compare neighbors
+// in the order of median z value.
+void GroupSegmentsByAltitude(const std::vector<Span>& spans, Levels* levels) {
+  std::vector<std::pair<double, int>> medians;
+  medians.reserve(spans.size());
   for (size_t i = 0; i < spans.size(); ++i) {
-    for (size_t j = i + 1; j < spans.size(); ++j) {
-      if (std::abs(Median(spans[i].z_values) - Median(spans[j].z_values)) <
-          kMinLevelSeparationMeters) {
-        LevelUnion(i, j, levels);
-      }
+    medians.emplace_back(Median(spans[i].z_values), i);
+  }
+  std::sort(medians.begin(), medians.end());
+  for (size_t i = 1; i < medians.size(); ++i) {
+    if (medians[i].first - medians[i - 1].first < kMinLevelSeparationMeters) {
+      LevelUnion(medians[i - 1].second, medians[i].second, levels);
     }
   }
 }
@@ -134,14 +135,14 @@ std::vector<Floor> FindFloors(const proto::Trajectory& trajectory,
   // Initialize the levels to start out with only long spans.
   for (size_t i = 0; i < spans.size(); ++i) {
     const Span& span = spans[i];
-    if (!IsShort(trajectory, span)) {
+    if (!IsShort(span)) {
       level_spans[LevelFind(i, levels)].push_back(span);
     }
   }
 
   for (size_t i = 0; i < spans.size(); ++i) {
     const Span& span = spans[i];
-    if (!IsShort(trajectory, span)) {
+    if (!IsShort(span)) {
       continue;
     }
 
@@ -176,7 +177,7 @@ std::vector<Floor> FindFloors(const proto::Trajectory& trajectory,
     std::sort(level.second.begin(), level.second.end());
     floors.emplace_back();
     for (const auto& span : level.second) {
-      if (!IsShort(trajectory, span)) {
+      if (!IsShort(span)) {
         // To figure out the median height of this floor, we only care for the
         // long pieces that are guaranteed to be in the structure. This is a
         // heuristic to leave out intermediate (short) levels.
@@ -202,7 +203,7 @@ std::vector<Floor> DetectFloors(const proto::Trajectory& trajectory) {
   for (size_t i = 0; i < spans.size(); ++i) {
     levels[i] = i;
   }
-  GroupSegmentsByAltitude(trajectory, spans, &levels);
+  GroupSegmentsByAltitude(spans, &levels);
 
   std::vector<Floor> floors = FindFloors(trajectory, spans, levels);
   std::sort(floors.begin(), floors.end(),
@@ -210,5 +211,44 @@ std::vector<Floor> DetectFloors(const proto::Trajectory& trajectory) {
   return floors;
 }
 
+FloorIndex::FloorIndex(const std::vector<Floor>& floors) {
+  for (size_t i = 0; i < floors.size(); ++i) {
+    for (const Timespan& timespan : floors[i].timespans) {
+      entries_.push_back(Entry{timespan, static_cast<int>(i)});
+    }
+  }
+  std::sort(entries_.begin(), entries_.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.timespan.start < b.timespan.start;
+            });
+  max_end_.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    max_end_.push_back(max_end_.empty()
+                           ? entry.timespan.end
+                           : std::max(max_end_.back(), entry.timespan.end));
+  }
+}
+
+std::vector<int> FloorIndex::GetFloorsAt(const common::Time time) const {
+  std::vector<int> result;
+  // Only timespans starting at or before 'time' can contain it. Walking
+  // backwards, we can stop as soon as no earlier timespan reaches 'time'.
+  auto it = std::upper_bound(
+      entries_.begin(), entries_.end(), time,
+      [](const common::Time t, const Entry& entry) {
+        return t < entry.timespan.start;
+      });
+  for (size_t i = it - entries_.begin(); i > 0 && max_end_[i - 1] >= time;
+       --i) {
+    const Entry& entry = entries_[i - 1];
+    if (time <= entry.timespan.end) {
+      result.push_back(entry.floor_index);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 }  // namespace mapping
 }  // namespace cartographer
@@ -17,6 +17,8 @@
 #ifndef CARTOGRAPHER_MAPPING_DETECT_FLOORS_H_
 #define CARTOGRAPHER_MAPPING_DETECT_FLOORS_H_
 
+#include <vector>
+
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/proto/trajectory.pb.h"
 
@@ -44,6 +46,29 @@ struct Floor {
 // the stairs.
 std::vector<Floor> DetectFloors(const proto::Trajectory& trajectory);
 
+// Answers which of the given 'floors' we were on at a particular time. The
+// timespans of all floors are sorted once by start time, so that a lookup is
+// a binary search followed by a scan over the timespans that overlap 'time'.
+class FloorIndex {
+ public:
+  explicit FloorIndex(const std::vector<Floor>& floors);
+
+  // Returns the sorted indices into 'floors' of all floors having a timespan
+  // containing 'time'.
+  std::vector<int> GetFloorsAt(common::Time time) const;
+
+ private:
+  struct Entry {
+    Timespan timespan;
+    int floor_index;
+  };
+
+  // Sorted by 'timespan.start'.
+  std::vector<Entry> entries_;
+  // 'max_end_[i]' is the latest end of 'entries_[0]' to 'entries_[i]'.
+  std::vector<common::Time> max_end_;
+};
+
 }  // namespace mapping
 }  // namespace cartographer
 
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/detect_floors.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+common::Time TimeAt(const int seconds) {
+  return common::FromUniversal(0) + common::FromSeconds(seconds);
+}
+
+// Walks 'length' meters along x at height 'z', one node per meter.
+void AddWalk(const double z, const int length, proto::Trajectory* trajectory) {
+  for (int i = 0; i < length; ++i) {
+    auto* node = trajectory->add_node();
+    node->set_timestamp(common::ToUniversal(TimeAt(trajectory->node_size())));
+    node->mutable_pose()->mutable_translation()->set_x(i);
+    node->mutable_pose()->mutable_translation()->set_z(z);
+    node->mutable_pose()->mutable_rotation()->set_w(1.);
+  }
+}
+
+TEST(DetectFloorsTest, SeparatesFloorsAndFoldsStairs) {
+  proto::Trajectory trajectory;
+  AddWalk(0., 50, &trajectory);
+  AddWalk(3., 5, &trajectory);
+  AddWalk(6., 50, &trajectory);
+  AddWalk(0.2, 50, &trajectory);
+  const std::vector<Floor> floors = DetectFloors(trajectory);
+  ASSERT_EQ(floors.size(), 2);
+  EXPECT_NEAR(floors[0].z, 0., 0.25);
+  EXPECT_NEAR(floors[1].z, 6., 1e-9);
+  // The short piece on the stairs belongs to both neighboring floors.
+  EXPECT_EQ(floors[0].timespans.size(), 3);
+  EXPECT_EQ(floors[1].timespans.size(), 2);
+}
+
+TEST(FloorIndexTest, FindsContainingFloors) {
+  std::vector<Floor> floors(2);
+  floors[0].timespans = {Timespan{TimeAt(0), TimeAt(10)},
+                         Timespan{TimeAt(11), TimeAt(12)},
+                         Timespan{TimeAt(30), TimeAt(40)}};
+  floors[1].timespans = {Timespan{TimeAt(11), TimeAt(12)},
+                         Timespan{TimeAt(13), TimeAt(29)}};
+  const FloorIndex index(floors);
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(-1)), IsEmpty());
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(0)), ElementsAre(0));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(10)), ElementsAre(0));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(11)), ElementsAre(0, 1));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(20)), ElementsAre(1));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(35)), ElementsAre(0));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(41)), IsEmpty());
+}
+
+TEST(FloorIndexTest, HandlesNestedTimespans) {
+  std::vector<Floor> floors(2);
+  floors[0].timespans = {Timespan{TimeAt(0), TimeAt(100)}};
+  floors[1].timespans = {Timespan{TimeAt(10), TimeAt(20)},
+                         Timespan{TimeAt(30), TimeAt(40)}};
+  const FloorIndex index(floors);
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(25)), ElementsAre(0));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(35)), ElementsAre(0, 1));
+  EXPECT_THAT(index.GetFloorsAt(TimeAt(50)), ElementsAre(0));
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
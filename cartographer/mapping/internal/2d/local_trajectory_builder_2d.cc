@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "absl/memory/memory.h"
+#include "cartographer/mapping/internal/place_descriptor.h"
 #include "cartographer/metrics/family_factory.h"
 #include "cartographer/sensor/range_data.h"
 
@@ -41,6 +42,7 @@ LocalTrajectoryBuilder2D::LocalTrajectoryBuilder2D(
     : options_(options),
       active_submaps_(options.submaps_options()),
       motion_filter_(options_.motion_filter_options()),
+      stationary_filter_(options_.stationary_filter_options()),
       real_time_correlative_scan_matcher_(
           options_.real_time_correlative_scan_matcher_options()),
       ceres_scan_matcher_(options_.ceres_scan_matcher_options()),
@@ -198,6 +200,21 @@ LocalTrajectoryBuilder2D::AddRangeData(
     // TODO(gaschler): This assumes that 'range_data_poses.back()' is at time
     // 'time'.
     accumulated_range_data_.origin = range_data_poses.back().translation();
+    // This is the pose estimate if scan matching finds no correction.
+    const transform::Rigid3d pose_prediction =
+        transform::Embed3D(
+            transform::Project2D(extrapolator_->ExtrapolatePose(time) *
+                                 gravity_alignment.inverse())) *
+        gravity_alignment;
+    if (stationary_filter_.IsStationary(pose_prediction)) {
+      extrapolator_->AddPose(time, pose_prediction);
+      local_pose_stream_.AddPose(time, pose_prediction);
+      // The accumulated range data is already in the local frame, it is just
+      // not filtered.
+      return absl::make_unique<MatchingResult>(
+          MatchingResult{time, pose_prediction,
+                         std::move(accumulated_range_data_), nullptr});
+    }
     return AddAccumulatedRangeData(
         time,
         TransformToGravityAlignedFrameAndFilter(
@@ -242,6 +259,8 @@ LocalTrajectoryBuilder2D::AddAccumulatedRangeData(
   const transform::Rigid3d pose_estimate =
       transform::Embed3D(*pose_estimate_2d) * gravity_alignment;
   extrapolator_->AddPose(time, pose_estimate);
+  local_pose_stream_.AddPose(time, pose_estimate);
+  stationary_filter_.AddScanMatchedPose(pose_estimate);
 
   sensor::RangeData range_data_in_local =
       TransformRangeData(gravity_aligned_range_data,
@@ -295,7 +314,9 @@ LocalTrajectoryBuilder2D::InsertIntoSubmap(
           {},  // 'high_resolution_point_cloud' is only used in 3D.
           {},  // 'low_resolution_point_cloud' is only used in 3D.
           {},  // 'rotational_scan_matcher_histogram' is only used in 3D.
-          pose_estimate}),
+          pose_estimate,
+          ComputePlaceDescriptor(filtered_gravity_aligned_point_cloud,
+                                 options_.place_descriptor_options())}),
       std::move(insertion_submaps)});
 }
 
@@ -303,6 +324,7 @@ void LocalTrajectoryBuilder2D::AddImuData(const sensor::ImuData& imu_data) {
   CHECK(options_.use_imu_data()) << "An unexpected IMU packet was added.";
   InitializeExtrapolator(imu_data.time);
   extrapolator_->AddImuData(imu_data);
+  local_pose_stream_.AddImuData(imu_data);
 }
 
 void LocalTrajectoryBuilder2D::AddOdometryData(
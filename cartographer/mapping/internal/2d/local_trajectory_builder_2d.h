@@ -24,8 +24,10 @@
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/internal/2d/scan_matching/ceres_scan_matcher_2d.h"
 #include "cartographer/mapping/internal/2d/scan_matching/real_time_correlative_scan_matcher_2d.h"
+#include "cartographer/mapping/internal/local_pose_stream.h"
 #include "cartographer/mapping/internal/motion_filter.h"
 #include "cartographer/mapping/internal/range_data_collator.h"
+#include "cartographer/mapping/internal/stationary_filter.h"
 #include "cartographer/mapping/pose_extrapolator.h"
 #include "cartographer/mapping/proto/2d/local_trajectory_builder_options_2d.pb.h"
 #include "cartographer/metrics/family_factory.h"
@@ -74,6 +76,11 @@ class LocalTrajectoryBuilder2D {
   void AddImuData(const sensor::ImuData& imu_data);
   void AddOdometryData(const sensor::OdometryData& odometry_data);
 
+  // Latest local pose, which can be read concurrently by other threads.
+  const LocalPoseStream& local_pose_stream() const {
+    return local_pose_stream_;
+  }
+
   static void RegisterMetrics(metrics::FamilyFactory* family_factory);
 
  private:
@@ -103,11 +110,13 @@ class LocalTrajectoryBuilder2D {
   ActiveSubmaps2D active_submaps_;
 
   MotionFilter motion_filter_;
+  StationaryFilter stationary_filter_;
   scan_matching::RealTimeCorrelativeScanMatcher2D
       real_time_correlative_scan_matcher_;
   scan_matching::CeresScanMatcher2D ceres_scan_matcher_;
 
   std::unique_ptr<PoseExtrapolator> extrapolator_;
+  LocalPoseStream local_pose_stream_;
 
   int num_accumulated_ = 0;
   sensor::RangeData accumulated_range_data_;
@@ -19,6 +19,8 @@
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/internal/2d/scan_matching/ceres_scan_matcher_2d.h"
 #include "cartographer/mapping/internal/motion_filter.h"
+#include "cartographer/mapping/internal/place_descriptor.h"
+#include "cartographer/mapping/internal/stationary_filter.h"
 #include "cartographer/mapping/internal/scan_matching/real_time_correlative_scan_matcher.h"
 #include "cartographer/sensor/internal/voxel_filter.h"
 
@@ -58,6 +60,16 @@ proto::LocalTrajectoryBuilderOptions2D CreateLocalTrajectoryBuilderOptions2D(
           parameter_dictionary->GetDictionary("ceres_scan_matcher").get());
   *options.mutable_motion_filter_options() = mapping::CreateMotionFilterOptions(
       parameter_dictionary->GetDictionary("motion_filter").get());
+  if (parameter_dictionary->HasKey("stationary_filter")) {
+    *options.mutable_stationary_filter_options() =
+        mapping::CreateStationaryFilterOptions(
+            parameter_dictionary->GetDictionary("stationary_filter").get());
+  }
+  if (parameter_dictionary->HasKey("place_descriptor")) {
+    *options.mutable_place_descriptor_options() =
+        mapping::CreatePlaceDescriptorOptions(
+            parameter_dictionary->GetDictionary("place_descriptor").get());
+  }
   options.set_imu_gravity_time_constant(
       parameter_dictionary->GetDouble("imu_gravity_time_constant"));
   *options.mutable_submaps_options() = CreateSubmapsOptions2D(
@@ -17,125 +17,121 @@
 #include "cartographer/mapping/internal/2d/overlapping_submaps_trimmer_2d.h"
 
 #include <algorithm>
+#include <set>
 
+#include "absl/memory/memory.h"
+#include "cartographer/common/parallel_for.h"
 #include "cartographer/mapping/2d/submap_2d.h"
+#include "cartographer/transform/transform.h"
 
 namespace cartographer {
 namespace mapping {
 namespace {
 
-class SubmapCoverageGrid2D {
- public:
-  // Aliases for documentation only (no type-safety).
-  using CellId = std::pair<int64 /* x cells */, int64 /* y cells */>;
-  using StoredType = std::vector<std::pair<SubmapId, common::Time>>;
+// Submaps are rasterized again once the optimization moved any of their cells
+// by more than this fraction of the coverage grid resolution.
+constexpr double kMaxCellShiftBeforeUpdate = 0.1;
 
-  SubmapCoverageGrid2D(const MapLimits& map_limits)
-      : offset_(map_limits.max()), resolution_(map_limits.resolution()) {}
-
-  void AddPoint(const Eigen::Vector2d& point, const SubmapId& submap_id,
-                const common::Time& time) {
-    CellId cell_id{common::RoundToInt64((offset_(0) - point(0)) / resolution_),
-                   common::RoundToInt64((offset_(1) - point(1)) / resolution_)};
-    cells_[cell_id].emplace_back(submap_id, time);
+bool IsFresher(const common::Time& lhs_freshness, const SubmapId& lhs_id,
+               const common::Time& rhs_freshness, const SubmapId& rhs_id) {
+  if (lhs_freshness != rhs_freshness) {
+    return lhs_freshness > rhs_freshness;
   }
-
-  const std::map<CellId, StoredType>& cells() const { return cells_; }
-  double resolution() const { return resolution_; }
-
- private:
-  Eigen::Vector2d offset_;
-  double resolution_;
-  std::map<CellId, StoredType> cells_;
-};
+  return rhs_id < lhs_id;
+}
 
 // Iterates over every cell in a submap, transforms the center of the cell to
-// the global frame and then adds the submap id and the timestamp of the most
-// recent range data insertion into the global grid.
-std::set<SubmapId> AddSubmapsToSubmapCoverageGrid2D(
-    const std::map<SubmapId, common::Time>& submap_freshness,
-    const MapById<SubmapId, PoseGraphInterface::SubmapData>& submap_data,
-    SubmapCoverageGrid2D* coverage_grid) {
-  std::set<SubmapId> all_submap_ids;
+// the global frame and records the coverage grid cell it falls into.
+SubmapCoverageGrid2D::SubmapCells RasterizeSubmap(
+    const SubmapId& submap_id, const PoseGraphInterface::SubmapData& submap,
+    const common::Time& freshness, const SubmapCoverageGrid2D& coverage_grid) {
+  SubmapCoverageGrid2D::SubmapCells result;
+  result.freshness = freshness;
+  result.global_pose = submap.pose;
+  result.cells_per_shard.resize(SubmapCoverageGrid2D::kNumShards);
+  const Grid2D& grid =
+      *std::static_pointer_cast<const Submap2D>(submap.submap)->grid();
+  Eigen::Array2i offset;
+  CellLimits cell_limits;
+  grid.ComputeCroppedLimits(&offset, &cell_limits);
+  if (cell_limits.num_x_cells == 0 || cell_limits.num_y_cells == 0) {
+    LOG(WARNING) << "Empty grid found in submap ID = " << submap_id;
+    return result;
+  }
 
-  for (const auto& submap : submap_data) {
-    auto freshness = submap_freshness.find(submap.id);
-    if (freshness == submap_freshness.end()) continue;
-    if (!submap.data.submap->insertion_finished()) continue;
-    all_submap_ids.insert(submap.id);
-    const Grid2D& grid =
-        *std::static_pointer_cast<const Submap2D>(submap.data.submap)->grid();
-    // Iterate over every cell in a submap.
-    Eigen::Array2i offset;
-    CellLimits cell_limits;
-    grid.ComputeCroppedLimits(&offset, &cell_limits);
-    if (cell_limits.num_x_cells == 0 || cell_limits.num_y_cells == 0) {
-      LOG(WARNING) << "Empty grid found in submap ID = " << submap.id;
-      continue;
-    }
+  const transform::Rigid3d& global_frame_from_submap_frame = submap.pose;
+  const transform::Rigid3d submap_frame_from_local_frame =
+      submap.submap->local_pose().inverse();
+  const Eigen::Vector2d submap_origin_in_global_frame =
+      submap.pose.translation().head<2>();
+  for (const Eigen::Array2i& xy_index : XYIndexRangeIterator(cell_limits)) {
+    const Eigen::Array2i index = xy_index + offset;
+    if (!grid.IsKnown(index)) continue;
 
-    const transform::Rigid3d& global_frame_from_submap_frame = submap.data.pose;
-    const transform::Rigid3d submap_frame_from_local_frame =
-        submap.data.submap->local_pose().inverse();
-    for (const Eigen::Array2i& xy_index : XYIndexRangeIterator(cell_limits)) {
-      const Eigen::Array2i index = xy_index + offset;
-      if (!grid.IsKnown(index)) continue;
-
-      const transform::Rigid3d center_of_cell_in_local_frame =
-          transform::Rigid3d::Translation(Eigen::Vector3d(
-              grid.limits().max().x() -
-                  grid.limits().resolution() * (index.y() + 0.5),
-              grid.limits().max().y() -
-                  grid.limits().resolution() * (index.x() + 0.5),
-              0));
-
-      const transform::Rigid2d center_of_cell_in_global_frame =
-          transform::Project2D(global_frame_from_submap_frame *
-                               submap_frame_from_local_frame *
-                               center_of_cell_in_local_frame);
-      coverage_grid->AddPoint(center_of_cell_in_global_frame.translation(),
-                              submap.id, freshness->second);
-    }
+    const transform::Rigid3d center_of_cell_in_local_frame =
+        transform::Rigid3d::Translation(Eigen::Vector3d(
+            grid.limits().max().x() -
+                grid.limits().resolution() * (index.y() + 0.5),
+            grid.limits().max().y() -
+                grid.limits().resolution() * (index.x() + 0.5),
+            0));
+
+    const transform::Rigid2d center_of_cell_in_global_frame =
+        transform::Project2D(global_frame_from_submap_frame *
+                             submap_frame_from_local_frame *
+                             center_of_cell_in_local_frame);
+    const Eigen::Vector2d& point =
+        center_of_cell_in_global_frame.translation();
+    result.extent = std::max(
+        result.extent, (point - submap_origin_in_global_frame).norm());
+    const SubmapCoverageGrid2D::CellId cell_id = coverage_grid.GetCellId(point);
+    result.cells_per_shard[coverage_grid.GetShardIndex(cell_id)].push_back(
+        cell_id);
   }
-  return all_submap_ids;
+  return result;
+}
+
+// Returns true if the optimized pose 'global_pose' would move any of the
+// 'cells' by more than 'kMaxCellShiftBeforeUpdate' cells.
+bool HasMoved(const SubmapCoverageGrid2D::SubmapCells& cells,
+              const transform::Rigid3d& global_pose, const double resolution) {
+  const transform::Rigid3d correction =
+      global_pose * cells.global_pose.inverse();
+  const Eigen::Vector3d origin = cells.global_pose.translation();
+  const double max_shift = (correction * origin - origin).norm() +
+                           transform::GetAngle(correction) * cells.extent;
+  return max_shift > kMaxCellShiftBeforeUpdate * resolution;
 }
 
 // Uses intra-submap constraints and trajectory node timestamps to identify time
-// of the last range data insertion to the submap.
+// of the last range data insertion to each of the 'submap_ids'. Only the
+// constraints of these submaps are visited.
 std::map<SubmapId, common::Time> ComputeSubmapFreshness(
-    const MapById<SubmapId, PoseGraphInterface::SubmapData>& submap_data,
-    const MapById<NodeId, TrajectoryNode>& trajectory_nodes,
-    const std::vector<PoseGraphInterface::Constraint>& constraints) {
+    const std::set<SubmapId>& submap_ids, const Trimmable& pose_graph) {
   std::map<SubmapId, common::Time> submap_freshness;
-
-  // Find the node with the largest NodeId per SubmapId.
-  std::map<SubmapId, NodeId> submap_to_latest_node;
-  for (const PoseGraphInterface::Constraint& constraint : constraints) {
-    if (constraint.tag != PoseGraphInterface::Constraint::INTRA_SUBMAP) {
-      continue;
-    }
-    auto submap_to_node = submap_to_latest_node.find(constraint.submap_id);
-    if (submap_to_node == submap_to_latest_node.end()) {
-      submap_to_latest_node.insert(
-          std::make_pair(constraint.submap_id, constraint.node_id));
-      continue;
+  const MapById<NodeId, TrajectoryNode>& trajectory_nodes =
+      pose_graph.GetTrajectoryNodes();
+  for (const SubmapId& submap_id : submap_ids) {
+    // Find the node with the largest NodeId.
+    bool has_intra_submap_constraint = false;
+    NodeId latest_node_id{0, 0};
+    for (const PoseGraphInterface::Constraint& constraint :
+         pose_graph.GetSubmapConstraints(submap_id)) {
+      if (constraint.tag != PoseGraphInterface::Constraint::INTRA_SUBMAP) {
+        continue;
+      }
+      if (!has_intra_submap_constraint ||
+          latest_node_id < constraint.node_id) {
+        latest_node_id = constraint.node_id;
+      }
+      has_intra_submap_constraint = true;
     }
-    submap_to_node->second =
-        std::max(submap_to_node->second, constraint.node_id);
-  }
+    if (!has_intra_submap_constraint) continue;
 
-  // Find timestamp of every latest node.
-  for (const auto& submap_id_to_node_id : submap_to_latest_node) {
-    auto submap_data_item = submap_data.find(submap_id_to_node_id.first);
-    if (submap_data_item == submap_data.end()) {
-      LOG(WARNING) << "Intra-submap constraint between SubmapID = "
-                   << submap_id_to_node_id.first << " and NodeID "
-                   << submap_id_to_node_id.second << " is missing submap data";
-      continue;
-    }
-    auto latest_node_id = trajectory_nodes.find(submap_id_to_node_id.second);
-    if (latest_node_id == trajectory_nodes.end()) continue;
-    submap_freshness[submap_data_item->id] = latest_node_id->data.time();
+    // Find timestamp of the latest node.
+    auto latest_node = trajectory_nodes.find(latest_node_id);
+    if (latest_node == trajectory_nodes.end()) continue;
+    submap_freshness[submap_id] = latest_node->data.time();
   }
   return submap_freshness;
 }
@@ -144,44 +140,136 @@ std::map<SubmapId, common::Time> ComputeSubmapFreshness(
 // not overlapped by at least 'fresh_submaps_count' submaps.
 std::vector<SubmapId> FindSubmapIdsToTrim(
     const SubmapCoverageGrid2D& coverage_grid,
-    const std::set<SubmapId>& all_submap_ids, uint16 fresh_submaps_count,
-    uint16 min_covered_cells_count) {
-  std::map<SubmapId, uint16> submap_to_covered_cells_count;
-  for (const auto& cell : coverage_grid.cells()) {
-    std::vector<std::pair<SubmapId, common::Time>> submaps_per_cell(
-        cell.second);
-
-    // In case there are several submaps covering the cell, only the freshest
-    // submaps are kept.
-    if (submaps_per_cell.size() > fresh_submaps_count) {
-      // Sort by time in descending order.
-      std::sort(submaps_per_cell.begin(), submaps_per_cell.end(),
-                [](const std::pair<SubmapId, common::Time>& left,
-                   const std::pair<SubmapId, common::Time>& right) {
-                  return left.second > right.second;
-                });
-      submaps_per_cell.erase(submaps_per_cell.begin() + fresh_submaps_count,
-                             submaps_per_cell.end());
+    const uint16 min_covered_cells_count) {
+  std::vector<SubmapId> result;
+  for (const auto& submap : coverage_grid.submaps()) {
+    const int covered_cells_count =
+        coverage_grid.GetCoveredCellsCount(submap.first);
+    if (covered_cells_count > 0 &&
+        covered_cells_count >= min_covered_cells_count) {
+      continue;
     }
-    for (const std::pair<SubmapId, common::Time>& submap : submaps_per_cell) {
-      ++submap_to_covered_cells_count[submap.first];
+    result.push_back(submap.first);
+  }
+  return result;
+}
+
+}  // namespace
+
+SubmapCoverageGrid2D::SubmapCoverageGrid2D(const MapLimits& map_limits,
+                                           const uint16 fresh_submaps_count)
+    : offset_(map_limits.max()),
+      resolution_(map_limits.resolution()),
+      fresh_submaps_count_(fresh_submaps_count),
+      shards_(kNumShards) {}
+
+SubmapCoverageGrid2D::CellId SubmapCoverageGrid2D::GetCellId(
+    const Eigen::Vector2d& point) const {
+  return CellId{common::RoundToInt64((offset_(0) - point(0)) / resolution_),
+                common::RoundToInt64((offset_(1) - point(1)) / resolution_)};
+}
+
+int SubmapCoverageGrid2D::GetShardIndex(const CellId& cell_id) const {
+  return absl::Hash<CellId>()(cell_id) % kNumShards;
+}
+
+void SubmapCoverageGrid2D::Update(
+    const std::vector<SubmapId>& removed_submap_ids,
+    std::map<SubmapId, SubmapCells> added_submaps,
+    common::ThreadPoolInterface* const thread_pool) {
+  std::vector<std::pair<SubmapId, SubmapCells>> removed_submaps;
+  for (const SubmapId& submap_id : removed_submap_ids) {
+    auto it = submaps_.find(submap_id);
+    if (it == submaps_.end()) continue;
+    removed_submaps.emplace_back(submap_id, std::move(it->second));
+    submaps_.erase(it);
+  }
+
+  std::vector<std::map<SubmapId, int>> count_deltas_per_shard(kNumShards);
+  common::ParallelFor(thread_pool, kNumShards, [&](const int shard_index) {
+    Shard* const shard = &shards_[shard_index];
+    std::map<SubmapId, int>* const count_deltas =
+        &count_deltas_per_shard[shard_index];
+    for (const auto& submap : removed_submaps) {
+      for (const CellId& cell_id : submap.second.cells_per_shard[shard_index]) {
+        RemoveFromCell(cell_id, submap.first, shard, count_deltas);
+      }
+    }
+    for (const auto& submap : added_submaps) {
+      const Entry entry{submap.second.freshness, submap.first};
+      for (const CellId& cell_id : submap.second.cells_per_shard[shard_index]) {
+        AddToCell(cell_id, entry, shard, count_deltas);
+      }
+    }
+  });
+
+  for (const auto& count_deltas : count_deltas_per_shard) {
+    for (const auto& submap_id_to_delta : count_deltas) {
+      covered_cells_counts_[submap_id_to_delta.first] +=
+          submap_id_to_delta.second;
     }
   }
-  std::vector<SubmapId> submap_ids_to_keep;
-  for (const auto& id_to_cells_count : submap_to_covered_cells_count) {
-    if (id_to_cells_count.second < min_covered_cells_count) continue;
-    submap_ids_to_keep.push_back(id_to_cells_count.first);
+  for (auto& submap : added_submaps) {
+    submaps_[submap.first] = std::move(submap.second);
   }
+  for (const auto& submap : removed_submaps) {
+    if (submaps_.count(submap.first) == 0) {
+      covered_cells_counts_.erase(submap.first);
+    }
+  }
+}
 
-  DCHECK(std::is_sorted(submap_ids_to_keep.begin(), submap_ids_to_keep.end()));
-  std::vector<SubmapId> result;
-  std::set_difference(all_submap_ids.begin(), all_submap_ids.end(),
-                      submap_ids_to_keep.begin(), submap_ids_to_keep.end(),
-                      std::back_inserter(result));
-  return result;
+int SubmapCoverageGrid2D::GetCoveredCellsCount(
+    const SubmapId& submap_id) const {
+  auto it = covered_cells_counts_.find(submap_id);
+  return it == covered_cells_counts_.end() ? 0 : it->second;
 }
 
-}  // namespace
+void SubmapCoverageGrid2D::AddToCell(
+    const CellId& cell_id, const Entry& entry, Shard* const shard,
+    std::map<SubmapId, int>* const count_deltas) const {
+  std::vector<Entry>& entries = shard->cells[cell_id];
+  const auto it = std::upper_bound(
+      entries.begin(), entries.end(), entry,
+      [](const Entry& lhs, const Entry& rhs) {
+        return IsFresher(lhs.freshness, lhs.submap_id, rhs.freshness,
+                         rhs.submap_id);
+      });
+  const size_t position = it - entries.begin();
+  entries.insert(it, entry);
+  if (position < fresh_submaps_count_) {
+    ++(*count_deltas)[entry.submap_id];
+    // The submap that was the last fresh one in this cell is pushed out.
+    if (entries.size() > fresh_submaps_count_) {
+      --(*count_deltas)[entries[fresh_submaps_count_].submap_id];
+    }
+  }
+}
+
+void SubmapCoverageGrid2D::RemoveFromCell(
+    const CellId& cell_id, const SubmapId& submap_id, Shard* const shard,
+    std::map<SubmapId, int>* const count_deltas) const {
+  auto cell = shard->cells.find(cell_id);
+  CHECK(cell != shard->cells.end());
+  std::vector<Entry>& entries = cell->second;
+  const auto it = std::find_if(entries.begin(), entries.end(),
+                               [&submap_id](const Entry& entry) {
+                                 return entry.submap_id == submap_id;
+                               });
+  CHECK(it != entries.end());
+  const size_t position = it - entries.begin();
+  if (position < fresh_submaps_count_) {
+    --(*count_deltas)[submap_id];
+    // The first submap that was not fresh in this cell moves up.
+    if (entries.size() > fresh_submaps_count_) {
+      ++(*count_deltas)[entries[fresh_submaps_count_].submap_id];
+    }
+  }
+  entries.erase(it);
+  if (entries.empty()) {
+    shard->cells.erase(cell);
+  }
+}
 
 void OverlappingSubmapsTrimmer2D::Trim(Trimmable* pose_graph) {
   const auto submap_data = pose_graph->GetOptimizedSubmapData();
@@ -189,19 +277,68 @@ void OverlappingSubmapsTrimmer2D::Trim(Trimmable* pose_graph) {
     return;
   }
 
-  const MapLimits first_submap_map_limits =
-      std::static_pointer_cast<const Submap2D>(submap_data.begin()->data.submap)
-          ->grid()
-          ->limits();
-  SubmapCoverageGrid2D coverage_grid(first_submap_map_limits);
-  const std::map<SubmapId, common::Time> submap_freshness =
-      ComputeSubmapFreshness(submap_data, pose_graph->GetTrajectoryNodes(),
-                             pose_graph->GetConstraints());
-  const std::set<SubmapId> all_submap_ids = AddSubmapsToSubmapCoverageGrid2D(
-      submap_freshness, submap_data, &coverage_grid);
+  if (coverage_grid_ == nullptr) {
+    const MapLimits first_submap_map_limits =
+        std::static_pointer_cast<const Submap2D>(
+            submap_data.begin()->data.submap)
+            ->grid()
+            ->limits();
+    coverage_grid_ = absl::make_unique<SubmapCoverageGrid2D>(
+        first_submap_map_limits, fresh_submaps_count_);
+  }
+
+  // Submaps that are gone lose their cells, submaps that were moved by the
+  // optimization are rasterized again with their known freshness.
+  std::vector<SubmapId> removed_submap_ids;
+  std::map<SubmapId, common::Time> submaps_to_rasterize;
+  for (const auto& submap : coverage_grid_->submaps()) {
+    const auto it = submap_data.find(submap.first);
+    if (it == submap_data.end()) {
+      removed_submap_ids.push_back(submap.first);
+      continue;
+    }
+    if (HasMoved(submap.second, it->data.pose,
+                 coverage_grid_->resolution())) {
+      removed_submap_ids.push_back(submap.first);
+      submaps_to_rasterize[submap.first] = submap.second.freshness;
+    }
+  }
+
+  // Newly finished submaps are added once their freshness is known.
+  std::set<SubmapId> new_submap_ids;
+  for (const auto& submap : submap_data) {
+    if (!submap.data.submap->insertion_finished()) continue;
+    if (coverage_grid_->submaps().count(submap.id) != 0) continue;
+    new_submap_ids.insert(submap.id);
+  }
+  for (const auto& submap_id_to_freshness :
+       ComputeSubmapFreshness(new_submap_ids, *pose_graph)) {
+    submaps_to_rasterize.insert(submap_id_to_freshness);
+  }
+
+  const std::vector<std::pair<SubmapId, common::Time>> rasterization_inputs(
+      submaps_to_rasterize.begin(), submaps_to_rasterize.end());
+  std::vector<SubmapCoverageGrid2D::SubmapCells> rasterized_submaps(
+      rasterization_inputs.size());
+  common::ParallelFor(
+      thread_pool_, rasterization_inputs.size(), [&](const int index) {
+        const SubmapId& submap_id = rasterization_inputs[index].first;
+        rasterized_submaps[index] = RasterizeSubmap(
+            submap_id, submap_data.at(submap_id),
+            rasterization_inputs[index].second, *coverage_grid_);
+      });
+  std::map<SubmapId, SubmapCoverageGrid2D::SubmapCells> added_submaps;
+  for (size_t i = 0; i != rasterization_inputs.size(); ++i) {
+    added_submaps.emplace(rasterization_inputs[i].first,
+                          std::move(rasterized_submaps[i]));
+  }
+  coverage_grid_->Update(removed_submap_ids, std::move(added_submaps),
+                         thread_pool_);
+
   const std::vector<SubmapId> submap_ids_to_remove = FindSubmapIdsToTrim(
-      coverage_grid, all_submap_ids, fresh_submaps_count_,
-      min_covered_area_ / common::Pow2(coverage_grid.resolution()));
+      *coverage_grid_,
+      min_covered_area_ / common::Pow2(coverage_grid_->resolution()));
+  coverage_grid_->Update(submap_ids_to_remove, {}, thread_pool_);
   current_submap_count_ = submap_data.size() - submap_ids_to_remove.size();
   for (const SubmapId& id : submap_ids_to_remove) {
     pose_graph->TrimSubmap(id);
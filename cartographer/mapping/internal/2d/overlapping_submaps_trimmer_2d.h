@@ -17,22 +17,111 @@
 #ifndef CARTOGRAPHER_MAPPING_INTERNAL_2D_OVERLAPPING_SUBMAPS_TRIMMER_H_
 #define CARTOGRAPHER_MAPPING_INTERNAL_2D_OVERLAPPING_SUBMAPS_TRIMMER_H_
 
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "cartographer/common/port.h"
+#include "cartographer/common/thread_pool.h"
+#include "cartographer/common/time.h"
+#include "cartographer/mapping/2d/map_limits.h"
 #include "cartographer/mapping/pose_graph_trimmer.h"
+#include "cartographer/transform/rigid_transform.h"
 
 namespace cartographer {
 namespace mapping {
 
+// Coverage of the global frame by finished submaps which is kept across trim
+// calls. Cells are sharded by their index so that shards can be updated in
+// parallel. For every submap, the number of cells in which it is among the
+// 'fresh_submaps_count' most recently updated submaps is maintained
+// incrementally, so no pass over all cells is needed to decide what to trim.
+class SubmapCoverageGrid2D {
+ public:
+  // Aliases for documentation only (no type-safety).
+  using CellId = std::pair<int64 /* x cells */, int64 /* y cells */>;
+
+  static constexpr int kNumShards = 16;
+
+  // The global cells covered by a single submap.
+  struct SubmapCells {
+    // Time of the most recent range data insertion into the submap.
+    common::Time freshness;
+    // Global pose of the submap when its cells were computed.
+    transform::Rigid3d global_pose;
+    // Largest distance of a cell center from the submap origin.
+    double extent = 0.;
+    // Covered cells bucketed by shard index.
+    std::vector<std::vector<CellId>> cells_per_shard;
+  };
+
+  SubmapCoverageGrid2D(const MapLimits& map_limits,
+                       uint16 fresh_submaps_count);
+
+  CellId GetCellId(const Eigen::Vector2d& point) const;
+  int GetShardIndex(const CellId& cell_id) const;
+
+  // Removes the cells of 'removed_submap_ids', then adds 'added_submaps'. A
+  // submap that is removed and added again is updated in place.
+  void Update(const std::vector<SubmapId>& removed_submap_ids,
+              std::map<SubmapId, SubmapCells> added_submaps,
+              common::ThreadPoolInterface* thread_pool);
+
+  // Returns the number of cells in which 'submap_id' is among the freshest.
+  int GetCoveredCellsCount(const SubmapId& submap_id) const;
+
+  const std::map<SubmapId, SubmapCells>& submaps() const { return submaps_; }
+  double resolution() const { return resolution_; }
+
+ private:
+  struct Entry {
+    common::Time freshness;
+    SubmapId submap_id;
+  };
+
+  struct Shard {
+    // Per cell, the covering submaps sorted from freshest to oldest.
+    absl::flat_hash_map<CellId, std::vector<Entry>> cells;
+  };
+
+  void AddToCell(const CellId& cell_id, const Entry& entry, Shard* shard,
+                 std::map<SubmapId, int>* count_deltas) const;
+  void RemoveFromCell(const CellId& cell_id, const SubmapId& submap_id,
+                      Shard* shard,
+                      std::map<SubmapId, int>* count_deltas) const;
+
+  const Eigen::Vector2d offset_;
+  const double resolution_;
+  const uint16 fresh_submaps_count_;
+  std::map<SubmapId, SubmapCells> submaps_;
+  std::map<SubmapId, int> covered_cells_counts_;
+  std::vector<Shard> shards_;
+};
+
 // Trims submaps that have less than 'min_covered_cells_count' cells not
 // overlapped by at least 'fresh_submaps_count` submaps.
+//
+// The coverage grid persists between calls: only submaps that finished since
+// the last call, or that were moved by the optimization by a noticeable
+// fraction of a cell, are rasterized again. Rasterization is distributed over
+// 'thread_pool' if one is given.
 class OverlappingSubmapsTrimmer2D : public PoseGraphTrimmer {
  public:
   OverlappingSubmapsTrimmer2D(uint16 fresh_submaps_count,
                               double min_covered_area,
-                              uint16 min_added_submaps_count)
+                              uint16 min_added_submaps_count,
+                              common::ThreadPoolInterface* thread_pool)
       : fresh_submaps_count_(fresh_submaps_count),
         min_covered_area_(min_covered_area),
-        min_added_submaps_count_(min_added_submaps_count) {}
+        min_added_submaps_count_(min_added_submaps_count),
+        thread_pool_(thread_pool) {}
+  OverlappingSubmapsTrimmer2D(uint16 fresh_submaps_count,
+                              double min_covered_area,
+                              uint16 min_added_submaps_count)
+      : OverlappingSubmapsTrimmer2D(fresh_submaps_count, min_covered_area,
+                                    min_added_submaps_count, nullptr) {}
   ~OverlappingSubmapsTrimmer2D() override = default;
 
   void Trim(Trimmable* pose_graph) override;
@@ -45,8 +134,12 @@ class OverlappingSubmapsTrimmer2D : public PoseGraphTrimmer {
   const double min_covered_area_;
   // Number of added submaps before the trimmer is invoked.
   const uint16 min_added_submaps_count_;
+  // Used to rasterize submaps in parallel, may be nullptr.
+  common::ThreadPoolInterface* const thread_pool_;
   // Current finished submap count.
   uint16 current_submap_count_ = 0;
+  // Created on the first trim from the limits of the first submap.
+  std::unique_ptr<SubmapCoverageGrid2D> coverage_grid_;
 
   bool finished_ = false;
 };
@@ -18,6 +18,7 @@
 
 #include <vector>
 
+#include "cartographer/common/thread_pool.h"
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/id.h"
@@ -274,6 +275,69 @@ TEST_F(OverlappingSubmapsTrimmer2DTest, TestTransformations) {
               ElementsAre(EqualsSubmapId({0, 0})));
 }
 
+TEST_F(OverlappingSubmapsTrimmer2DTest, UpdateCoverageOfMovedSubmap) {
+  AddSquareSubmap(Rigid2d::Identity() /* global_from_submap_frame */,
+                  Rigid2d::Identity() /* local_from_submap_frame */,
+                  Eigen::Vector2d(1., 1.) /* submap corner */,
+                  0 /* submap_index */, 1 /* num_cells */,
+                  true /* is_finished */);
+  AddSquareSubmap(Rigid2d::Translation(
+                      Eigen::Vector2d(5., 5.)) /* global_from_submap_frame */,
+                  Rigid2d::Identity() /* local_from_submap_frame */,
+                  Eigen::Vector2d(1., 1.) /* submap corner */,
+                  1 /* submap_index */, 1 /* num_cells */,
+                  true /* is_finished */);
+  AddTrajectoryNode(0 /* node_index */, 1000 /* timestamp */);
+  AddTrajectoryNode(1 /* node_index */, 2000 /* timestamp */);
+  AddConstraint(0 /*submap_index*/, 0 /*node_index*/, true);
+  AddConstraint(1 /*submap_index*/, 1 /*node_index*/, true);
+
+  OverlappingSubmapsTrimmer2D trimmer(1 /* fresh_submaps_count */,
+                                      0 /* min_covered_area */,
+                                      0 /* min_added_submaps_count */);
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(), IsEmpty());
+
+  // The optimization moves the second submap on top of the first one.
+  fake_pose_graph_.mutable_submap_data()->at(SubmapId{0, 1}).pose =
+      Rigid3d::Identity();
+  AddSquareSubmap(Rigid2d::Translation(
+                      Eigen::Vector2d(10., 10.)) /* global_from_submap_frame */,
+                  Rigid2d::Identity() /* local_from_submap_frame */,
+                  Eigen::Vector2d(1., 1.) /* submap corner */,
+                  2 /* submap_index */, 1 /* num_cells */,
+                  true /* is_finished */);
+  AddTrajectoryNode(2 /* node_index */, 3000 /* timestamp */);
+  AddConstraint(2 /*submap_index*/, 2 /*node_index*/, true);
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(EqualsSubmapId({0, 0})));
+}
+
+TEST_F(OverlappingSubmapsTrimmer2DTest, RasterizeOnThreadPool) {
+  constexpr int kNumSubmaps = 10;
+  for (int i = 0; i < kNumSubmaps; ++i) {
+    AddSquareSubmap(Rigid2d::Identity() /* global_from_submap_frame */,
+                    Rigid2d::Identity() /* local_from_submap_frame */,
+                    Eigen::Vector2d(1., 1.) /* submap corner */,
+                    i /* submap_index */, 2 /* num_cells */,
+                    true /* is_finished */);
+    AddTrajectoryNode(i /* node_index */, 1000 * (i + 1) /* timestamp */);
+    AddConstraint(i /*submap_index*/, i /*node_index*/, true);
+  }
+
+  common::ThreadPool thread_pool(2);
+  OverlappingSubmapsTrimmer2D trimmer(
+      2 /* fresh_submaps_count */, 0 /* min_covered_area */,
+      0 /* min_added_submaps_count */, &thread_pool);
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_EQ(fake_pose_graph_.trimmed_submaps().size(), kNumSubmaps - 2);
+  for (int i = 0; i < kNumSubmaps - 2; ++i) {
+    EXPECT_THAT(fake_pose_graph_.trimmed_submaps()[i],
+                EqualsSubmapId({0, i}));
+  }
+}
+
 }  // namespace
 }  // namespace mapping
 }  // namespace cartographer
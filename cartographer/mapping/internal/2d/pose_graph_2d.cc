@@ -32,6 +32,7 @@
 #include "absl/memory/memory.h"
 #include "cartographer/common/math.h"
 #include "cartographer/mapping/internal/2d/overlapping_submaps_trimmer_2d.h"
+#include "cartographer/mapping/internal/memory_budget_trimmer.h"
 #include "cartographer/mapping/proto/pose_graph/constraint_builder_options.pb.h"
 #include "cartographer/sensor/compressed_point_cloud.h"
 #include "cartographer/sensor/internal/voxel_filter.h"
@@ -47,6 +48,12 @@ static auto* kConstraintsDifferentTrajectoryMetric = metrics::Gauge::Null();
 static auto* kActiveSubmapsMetric = metrics::Gauge::Null();
 static auto* kFrozenSubmapsMetric = metrics::Gauge::Null();
 static auto* kDeletedSubmapsMetric = metrics::Gauge::Null();
+static auto* kLandmarkSeededSearchesMetric = metrics::Counter::Null();
+static auto* kPlaceRecognitionCandidatesMetric = metrics::Counter::Null();
+static auto* kPlaceRecognitionRejectedMetric = metrics::Counter::Null();
+static auto* kLandmarkRelocalizationLatencyMetric = metrics::Histogram::Null();
+static auto* kFullSubmapRelocalizationLatencyMetric =
+    metrics::Histogram::Null();
 
 PoseGraph2D::PoseGraph2D(
     const proto::PoseGraphOptions& options,
@@ -55,13 +62,18 @@ PoseGraph2D::PoseGraph2D(
     : options_(options),
       optimization_problem_(std::move(optimization_problem)),
       constraint_builder_(options_.constraint_builder_options(), thread_pool),
-      thread_pool_(thread_pool) {
+      thread_pool_(thread_pool),
+      place_descriptor_index_(options_.place_recognition()) {
   if (options.has_overlapping_submaps_trimmer_2d()) {
     const auto& trimmer_options = options.overlapping_submaps_trimmer_2d();
     AddTrimmer(absl::make_unique<OverlappingSubmapsTrimmer2D>(
         trimmer_options.fresh_submaps_count(),
         trimmer_options.min_covered_area(),
-        trimmer_options.min_added_submaps_count()));
+        trimmer_options.min_added_submaps_count(), thread_pool));
+  }
+  if (options.has_memory_budget_trimmer()) {
+    AddTrimmer(absl::make_unique<MemoryBudgetTrimmer>(
+        options.memory_budget_trimmer()));
   }
 }
 
@@ -243,6 +255,9 @@ void PoseGraph2D::AddLandmarkData(int trajectory_id,
                 trajectory_id, landmark_data.time,
                 observation.landmark_to_tracking_transform,
                 observation.translation_weight, observation.rotation_weight});
+        landmark_index_.AddObservation(
+            observation.id, data_.landmark_nodes.at(observation.id)
+                                .landmark_observations.back());
       }
     }
     return WorkItem::Result::kDoNotRunOptimization;
@@ -250,9 +265,11 @@ void PoseGraph2D::AddLandmarkData(int trajectory_id,
 }
 
 void PoseGraph2D::ComputeConstraint(const NodeId& node_id,
-                                    const SubmapId& submap_id) {
+                                    const SubmapId& submap_id,
+                                    LandmarkEstimate* const landmark_estimate) {
   bool maybe_add_local_constraint = false;
   bool maybe_add_global_constraint = false;
+  absl::optional<transform::Rigid3d> landmark_global_node_pose;
   const TrajectoryNode::Data* constant_data;
   const Submap2D* submap;
   {
@@ -264,22 +281,42 @@ void PoseGraph2D::ComputeConstraint(const NodeId& node_id,
       return;
     }
 
-    const common::Time node_time = GetLatestNodeTime(node_id, submap_id);
-    const common::Time last_connection_time =
-        data_.trajectory_connectivity_state.LastConnectionTime(
-            node_id.trajectory_id, submap_id.trajectory_id);
-    if (node_id.trajectory_id == submap_id.trajectory_id ||
-        node_time <
-            last_connection_time +
-                common::FromSeconds(
-                    options_.global_constraint_search_after_n_seconds())) {
+    if (!RequiresGlobalSearch(node_id, submap_id)) {
       // If the node and the submap belong to the same trajectory or if there
       // has been a recent global constraint that ties that node's trajectory to
       // the submap's trajectory, it suffices to do a match constrained to a
       // local search window.
       maybe_add_local_constraint = true;
-    } else if (global_localization_samplers_[node_id.trajectory_id]->Pulse()) {
-      maybe_add_global_constraint = true;
+    } else {
+      // Only active trajectories are tracked, so that entries of finished
+      // trajectories are not recreated by matching their old nodes.
+      Relocalization* relocalization = nullptr;
+      if (data_.trajectories_state.at(node_id.trajectory_id).state ==
+          TrajectoryState::ACTIVE) {
+        relocalization =
+            &relocalizations_
+                 .emplace(node_id.trajectory_id,
+                          Relocalization{
+                              data_.trajectory_nodes.at(node_id).time(), false})
+                 .first->second;
+      }
+      if (!landmark_estimate->computed) {
+        landmark_estimate->global_node_pose =
+            EstimateGlobalNodePoseFromLandmarks(node_id);
+        landmark_estimate->computed = true;
+      }
+      landmark_global_node_pose = landmark_estimate->global_node_pose;
+      if (landmark_global_node_pose.has_value()) {
+        // A landmark observation ties the node to the rest of the map, so a
+        // match in a local search window around its estimate suffices.
+        maybe_add_local_constraint = true;
+        if (relocalization != nullptr) {
+          relocalization->landmark_seeded = true;
+        }
+        kLandmarkSeededSearchesMetric->Increment();
+      } else {
+        maybe_add_global_constraint = ShouldSearchGlobally(node_id, submap_id);
+      }
     }
     constant_data = data_.trajectory_nodes.at(node_id).constant_data.get();
     submap = static_cast<const Submap2D*>(
@@ -287,11 +324,18 @@ void PoseGraph2D::ComputeConstraint(const NodeId& node_id,
   }
 
   if (maybe_add_local_constraint) {
+    const transform::Rigid2d global_node_pose_2d =
+        landmark_global_node_pose.has_value()
+            ? transform::Project2D(
+                  landmark_global_node_pose.value() *
+                  transform::Rigid3d::Rotation(
+                      constant_data->gravity_alignment.inverse()))
+            : optimization_problem_->node_data().at(node_id).global_pose_2d;
     const transform::Rigid2d initial_relative_pose =
         optimization_problem_->submap_data()
             .at(submap_id)
             .global_pose.inverse() *
-        optimization_problem_->node_data().at(node_id).global_pose_2d;
+        global_node_pose_2d;
     constraint_builder_.MaybeAddConstraint(
         submap_id, submap, node_id, constant_data, initial_relative_pose);
   } else if (maybe_add_global_constraint) {
@@ -338,7 +382,7 @@ WorkItem::Result PoseGraph2D::ComputeConstraintsForNode(
       const transform::Rigid2d constraint_transform =
           constraints::ComputeSubmapPose(*insertion_submaps[i]).inverse() *
           local_pose_2d;
-      data_.constraints.push_back(
+      data_.constraints.Add(
           Constraint{submap_id,
                      node_id,
                      {transform::Embed3D(constraint_transform),
@@ -357,6 +401,17 @@ WorkItem::Result PoseGraph2D::ComputeConstraintsForNode(
         finished_submap_ids.emplace_back(submap_id_data.id);
       }
     }
+    place_descriptor_index_.AddNode(node_id, constant_data->place_descriptor);
+    if (place_descriptor_index_.Contains(node_id)) {
+      std::vector<SubmapId> global_search_submap_ids;
+      for (const SubmapId& submap_id : finished_submap_ids) {
+        if (RequiresGlobalSearch(node_id, submap_id)) {
+          global_search_submap_ids.push_back(submap_id);
+        }
+      }
+      place_descriptor_index_.RankSubmaps(node_id, global_search_submap_ids,
+                                          data_.submap_data);
+    }
     if (newly_finished_submap) {
       const SubmapId newly_finished_submap_id = submap_ids.front();
       InternalSubmapData& finished_submap_data =
@@ -367,8 +422,9 @@ WorkItem::Result PoseGraph2D::ComputeConstraintsForNode(
     }
   }
 
+  LandmarkEstimate landmark_estimate;
   for (const auto& submap_id : finished_submap_ids) {
-    ComputeConstraint(node_id, submap_id);
+    ComputeConstraint(node_id, submap_id, &landmark_estimate);
   }
 
   if (newly_finished_submap) {
@@ -378,7 +434,9 @@ WorkItem::Result PoseGraph2D::ComputeConstraintsForNode(
     for (const auto& node_id_data : optimization_problem_->node_data()) {
       const NodeId& node_id = node_id_data.id;
       if (newly_finished_submap_node_ids.count(node_id) == 0) {
-        ComputeConstraint(node_id, newly_finished_submap_id);
+        LandmarkEstimate old_node_landmark_estimate;
+        ComputeConstraint(node_id, newly_finished_submap_id,
+                          &old_node_landmark_estimate);
       }
     }
   }
@@ -406,6 +464,37 @@ common::Time PoseGraph2D::GetLatestNodeTime(const NodeId& node_id,
   return time;
 }
 
+bool PoseGraph2D::RequiresGlobalSearch(const NodeId& node_id,
+                                       const SubmapId& submap_id) {
+  if (node_id.trajectory_id == submap_id.trajectory_id) {
+    return false;
+  }
+  const common::Time node_time = GetLatestNodeTime(node_id, submap_id);
+  const common::Time last_connection_time =
+      data_.trajectory_connectivity_state.LastConnectionTime(
+          node_id.trajectory_id, submap_id.trajectory_id);
+  return node_time >=
+         last_connection_time +
+             common::FromSeconds(
+                 options_.global_constraint_search_after_n_seconds());
+}
+
+bool PoseGraph2D::ShouldSearchGlobally(const NodeId& node_id,
+                                       const SubmapId& submap_id) {
+  switch (place_descriptor_index_.GetRanking(node_id, submap_id,
+                                             data_.submap_data)) {
+    case PlaceDescriptorIndex::Ranking::kCandidate:
+      kPlaceRecognitionCandidatesMetric->Increment();
+      return true;
+    case PlaceDescriptorIndex::Ranking::kRejected:
+      kPlaceRecognitionRejectedMetric->Increment();
+      return false;
+    case PlaceDescriptorIndex::Ranking::kUnranked:
+      break;
+  }
+  return global_localization_samplers_[node_id.trajectory_id]->Pulse();
+}
+
 void PoseGraph2D::UpdateTrajectoryConnectivity(const Constraint& constraint) {
   CHECK_EQ(constraint.tag, Constraint::INTER_SUBMAP);
   const common::Time time =
@@ -413,6 +502,38 @@ void PoseGraph2D::UpdateTrajectoryConnectivity(const Constraint& constraint) {
   data_.trajectory_connectivity_state.Connect(
       constraint.node_id.trajectory_id, constraint.submap_id.trajectory_id,
       time);
+  if (constraint.node_id.trajectory_id == constraint.submap_id.trajectory_id) {
+    return;
+  }
+  for (const int trajectory_id : {constraint.node_id.trajectory_id,
+                                  constraint.submap_id.trajectory_id}) {
+    const auto it = relocalizations_.find(trajectory_id);
+    if (it == relocalizations_.end()) {
+      continue;
+    }
+    auto* const latency_metric = it->second.landmark_seeded
+                                     ? kLandmarkRelocalizationLatencyMetric
+                                     : kFullSubmapRelocalizationLatencyMetric;
+    latency_metric->Observe(
+        std::max(0., common::ToSeconds(time - it->second.start_time)));
+    relocalizations_.erase(it);
+  }
+}
+
+absl::optional<transform::Rigid3d>
+PoseGraph2D::EstimateGlobalNodePoseFromLandmarks(const NodeId& node_id) const {
+  if (!options_.has_landmark_relocalization()) {
+    return absl::nullopt;
+  }
+  const std::vector<transform::Rigid3d> global_node_poses =
+      landmark_index_.EstimateGlobalNodePoses(
+          node_id, data_.trajectory_nodes,
+          common::FromSeconds(options_.landmark_relocalization()
+                                  .max_observation_time_difference()));
+  if (global_node_poses.empty()) {
+    return absl::nullopt;
+  }
+  return global_node_poses.front();
 }
 
 void PoseGraph2D::DeleteTrajectoriesIfNeeded() {
@@ -428,6 +549,7 @@ void PoseGraph2D::DeleteTrajectoriesIfNeeded() {
       }
       it.second.state = TrajectoryState::DELETED;
       it.second.deletion_state = InternalTrajectoryState::DeletionState::NORMAL;
+      relocalizations_.erase(it.first);
     }
   }
 }
@@ -436,8 +558,9 @@ void PoseGraph2D::HandleWorkQueue(
     const constraints::ConstraintBuilder2D::Result& result) {
   {
     absl::MutexLock locker(&mutex_);
-    data_.constraints.insert(data_.constraints.end(), result.begin(),
-                             result.end());
+    for (const Constraint& constraint : result) {
+      data_.constraints.Add(constraint);
+    }
   }
   RunOptimization();
 
@@ -486,23 +609,10 @@ void PoseGraph2D::HandleWorkQueue(
     num_nodes_since_last_loop_closure_ = 0;
 
     // Update the gauges that count the current number of constraints.
-    double inter_constraints_same_trajectory = 0;
-    double inter_constraints_different_trajectory = 0;
-    for (const auto& constraint : data_.constraints) {
-      if (constraint.tag ==
-          cartographer::mapping::PoseGraph::Constraint::INTRA_SUBMAP) {
-        continue;
-      }
-      if (constraint.node_id.trajectory_id ==
-          constraint.submap_id.trajectory_id) {
-        ++inter_constraints_same_trajectory;
-      } else {
-        ++inter_constraints_different_trajectory;
-      }
-    }
-    kConstraintsSameTrajectoryMetric->Set(inter_constraints_same_trajectory);
+    kConstraintsSameTrajectoryMetric->Set(
+        data_.constraints.num_inter_submap_constraints_same_trajectory());
     kConstraintsDifferentTrajectoryMetric->Set(
-        inter_constraints_different_trajectory);
+        data_.constraints.num_inter_submap_constraints_different_trajectory());
   }
 
   DrainWorkQueue();
@@ -581,8 +691,9 @@ void PoseGraph2D::WaitForAllComputations() {
        &notification](const constraints::ConstraintBuilder2D::Result& result)
           LOCKS_EXCLUDED(mutex_) {
             absl::MutexLock locker(&mutex_);
-            data_.constraints.insert(data_.constraints.end(), result.begin(),
-                                     result.end());
+            for (const Constraint& constraint : result) {
+              data_.constraints.Add(constraint);
+            }
             notification = true;
           });
   const auto predicate = [&notification]() EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
@@ -627,6 +738,7 @@ void PoseGraph2D::FinishTrajectory(const int trajectory_id) {
     absl::MutexLock locker(&mutex_);
     CHECK(!IsTrajectoryFinished(trajectory_id));
     data_.trajectories_state[trajectory_id].state = TrajectoryState::FINISHED;
+    relocalizations_.erase(trajectory_id);
 
     for (const auto& submap : data_.submap_data.trajectory(trajectory_id)) {
       data_.submap_data.at(submap.id).state = SubmapState::kFinished;
@@ -723,6 +835,7 @@ void PoseGraph2D::AddNodeFromProto(const transform::Rigid3d& global_pose,
         data_.trajectory_nodes.at(node_id).constant_data;
     const auto gravity_alignment_inverse = transform::Rigid3d::Rotation(
         constant_data->gravity_alignment.inverse());
+    place_descriptor_index_.AddNode(node_id, constant_data->place_descriptor);
     optimization_problem_->InsertTrajectoryNode(
         node_id,
         optimization::NodeSpec2D{
@@ -777,7 +890,7 @@ void PoseGraph2D::AddSerializedConstraints(
                   data_.trajectory_nodes.at(constraint.node_id)
                       .constant_data->gravity_alignment.inverse()),
           constraint.pose.translation_weight, constraint.pose.rotation_weight};
-      data_.constraints.push_back(Constraint{
+      data_.constraints.Add(Constraint{
           constraint.submap_id, constraint.node_id, pose, constraint.tag});
     }
     LOG(INFO) << "Loaded " << constraints.size() << " constraints.";
@@ -824,7 +937,8 @@ void PoseGraph2D::RunOptimization() {
   // data_.constraints, data_.frozen_trajectories and data_.landmark_nodes
   // when executing the Solve. Solve is time consuming, so not taking the mutex
   // before Solve to avoid blocking foreground processing.
-  optimization_problem_->Solve(data_.constraints, GetTrajectoryStates(),
+  optimization_problem_->Solve(data_.constraints.constraints(),
+                               GetTrajectoryStates(),
                                data_.landmark_nodes);
   absl::MutexLock locker(&mutex_);
 
@@ -861,6 +975,9 @@ void PoseGraph2D::RunOptimization() {
   }
   for (const auto& landmark : optimization_problem_->landmark_data()) {
     data_.landmark_nodes[landmark.first].global_landmark_pose = landmark.second;
+    landmark_index_.SetGlobalLandmarkPose(
+        landmark.first, landmark.second,
+        data_.landmark_nodes.at(landmark.first).frozen);
   }
   data_.global_submap_poses_2d = submap_data;
 }
@@ -946,6 +1063,7 @@ void PoseGraph2D::SetLandmarkPose(const std::string& landmark_id,
     absl::MutexLock locker(&mutex_);
     data_.landmark_nodes[landmark_id].global_landmark_pose = global_pose;
     data_.landmark_nodes[landmark_id].frozen = frozen;
+    landmark_index_.SetGlobalLandmarkPose(landmark_id, global_pose, frozen);
     return WorkItem::Result::kDoNotRunOptimization;
   });
 }
@@ -982,7 +1100,7 @@ PoseGraph2D::GetFixedFramePoseData() const {
 std::vector<PoseGraphInterface::Constraint> PoseGraph2D::constraints() const {
   std::vector<PoseGraphInterface::Constraint> result;
   absl::MutexLock locker(&mutex_);
-  for (const Constraint& constraint : data_.constraints) {
+  for (const Constraint& constraint : data_.constraints.constraints()) {
     result.push_back(Constraint{
         constraint.submap_id, constraint.node_id,
         Constraint::Pose{constraint.pose.zbar_ij *
@@ -1150,7 +1268,31 @@ PoseGraph2D::TrimmingHandle::GetTrajectoryNodes() const {
 
 const std::vector<PoseGraphInterface::Constraint>&
 PoseGraph2D::TrimmingHandle::GetConstraints() const {
-  return parent_->data_.constraints;
+  return parent_->data_.constraints.constraints();
+}
+
+std::vector<PoseGraphInterface::Constraint>
+PoseGraph2D::TrimmingHandle::GetSubmapConstraints(
+    const SubmapId& submap_id) const {
+  const ConstraintStore& constraints = parent_->data_.constraints;
+  std::vector<Constraint> submap_constraints;
+  for (const ConstraintStore::Handle handle :
+       constraints.GetSubmapConstraints(submap_id)) {
+    submap_constraints.push_back(constraints.at(handle));
+  }
+  return submap_constraints;
+}
+
+size_t PoseGraph2D::TrimmingHandle::EstimateSensorDataMemoryUsage(
+    const int trajectory_id) const {
+  const auto& optimization_problem = *parent_->optimization_problem_;
+  const size_t num_imu_data =
+      optimization_problem.imu_data().SizeOfTrajectoryOrZero(trajectory_id);
+  const size_t num_odometry_data =
+      optimization_problem.odometry_data().SizeOfTrajectoryOrZero(
+          trajectory_id);
+  return num_imu_data * sizeof(sensor::ImuData) +
+         num_odometry_data * sizeof(sensor::OdometryData);
 }
 
 bool PoseGraph2D::TrimmingHandle::IsFinished(const int trajectory_id) const {
@@ -1168,42 +1310,39 @@ void PoseGraph2D::TrimmingHandle::TrimSubmap(const SubmapId& submap_id) {
   CHECK(parent_->data_.submap_data.at(submap_id).state ==
         SubmapState::kFinished);
 
-  // Compile all nodes that are still INTRA_SUBMAP constrained once the submap
-  // with 'submap_id' is gone.
-  std::set<NodeId> nodes_to_retain;
-  for (const Constraint& constraint : parent_->data_.constraints) {
-    if (constraint.tag == Constraint::Tag::INTRA_SUBMAP &&
-        constraint.submap_id != submap_id) {
-      nodes_to_retain.insert(constraint.node_id);
-    }
-  }
-  // Remove all 'data_.constraints' related to 'submap_id'.
+  // Compile all nodes that are no longer INTRA_SUBMAP constrained once the
+  // submap with 'submap_id' is gone.
+  ConstraintStore& constraints = parent_->data_.constraints;
+  const std::vector<ConstraintStore::Handle> submap_constraints =
+      constraints.GetSubmapConstraints(submap_id);
   std::set<NodeId> nodes_to_remove;
-  {
-    std::vector<Constraint> constraints;
-    for (const Constraint& constraint : parent_->data_.constraints) {
-      if (constraint.submap_id == submap_id) {
-        if (constraint.tag == Constraint::Tag::INTRA_SUBMAP &&
-            nodes_to_retain.count(constraint.node_id) == 0) {
-          // This node will no longer be INTRA_SUBMAP contrained and has to be
-          // removed.
-          nodes_to_remove.insert(constraint.node_id);
-        }
-      } else {
-        constraints.push_back(constraint);
-      }
+  for (const ConstraintStore::Handle handle : submap_constraints) {
+    const Constraint& constraint = constraints.at(handle);
+    if (constraint.tag != Constraint::Tag::INTRA_SUBMAP) continue;
+    const std::vector<ConstraintStore::Handle>& node_constraints =
+        constraints.GetNodeConstraints(constraint.node_id);
+    if (std::none_of(node_constraints.begin(), node_constraints.end(),
+                     [&](const ConstraintStore::Handle node_handle) {
+                       const Constraint& node_constraint =
+                           constraints.at(node_handle);
+                       return node_constraint.tag ==
+                                  Constraint::Tag::INTRA_SUBMAP &&
+                              node_constraint.submap_id != submap_id;
+                     })) {
+      nodes_to_remove.insert(constraint.node_id);
     }
-    parent_->data_.constraints = std::move(constraints);
   }
-  // Remove all 'data_.constraints' related to 'nodes_to_remove'.
-  {
-    std::vector<Constraint> constraints;
-    for (const Constraint& constraint : parent_->data_.constraints) {
-      if (nodes_to_remove.count(constraint.node_id) == 0) {
-        constraints.push_back(constraint);
-      }
+  // Remove all 'data_.constraints' related to 'submap_id' and to
+  // 'nodes_to_remove'.
+  for (const ConstraintStore::Handle handle : submap_constraints) {
+    constraints.Remove(handle);
+  }
+  for (const NodeId& node_id : nodes_to_remove) {
+    const std::vector<ConstraintStore::Handle> node_constraints =
+        constraints.GetNodeConstraints(node_id);
+    for (const ConstraintStore::Handle handle : node_constraints) {
+      constraints.Remove(handle);
     }
-    parent_->data_.constraints = std::move(constraints);
   }
 
   // Mark the submap with 'submap_id' as trimmed and remove its data.
@@ -1226,6 +1365,7 @@ void PoseGraph2D::TrimmingHandle::TrimSubmap(const SubmapId& submap_id) {
   for (const NodeId& node_id : nodes_to_remove) {
     parent_->data_.trajectory_nodes.Trim(node_id);
     parent_->optimization_problem_->TrimTrajectoryNode(node_id);
+    parent_->place_descriptor_index_.TrimNode(node_id);
   }
 }
 
@@ -1261,6 +1401,25 @@ void PoseGraph2D::RegisterMetrics(metrics::FamilyFactory* family_factory) {
   kActiveSubmapsMetric = submaps->Add({{"state", "active"}});
   kFrozenSubmapsMetric = submaps->Add({{"state", "frozen"}});
   kDeletedSubmapsMetric = submaps->Add({{"state", "deleted"}});
+  auto* landmark_seeded_searches = family_factory->NewCounterFamily(
+      "mapping_2d_pose_graph_landmark_seeded_searches",
+      "Constraint searches of unconnected nodes seeded by landmarks");
+  kLandmarkSeededSearchesMetric = landmark_seeded_searches->Add({});
+  auto* place_recognition_searches = family_factory->NewCounterFamily(
+      "mapping_2d_pose_graph_place_recognition_searches",
+      "Global searches decided by place descriptor ranking");
+  kPlaceRecognitionCandidatesMetric =
+      place_recognition_searches->Add({{"ranking", "candidate"}});
+  kPlaceRecognitionRejectedMetric =
+      place_recognition_searches->Add({{"ranking", "rejected"}});
+  auto* relocalization_latency = family_factory->NewHistogramFamily(
+      "mapping_2d_pose_graph_relocalization_latency",
+      "Sensor time in seconds until an unconnected trajectory is connected",
+      metrics::Histogram::ScaledPowersOf(2, 0.1, 600));
+  kLandmarkRelocalizationLatencyMetric =
+      relocalization_latency->Add({{"seed", "landmark"}});
+  kFullSubmapRelocalizationLatencyMetric =
+      relocalization_latency->Add({{"seed", "none"}});
 }
 
 }  // namespace mapping
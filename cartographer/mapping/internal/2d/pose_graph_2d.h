@@ -29,12 +29,15 @@
 #include "Eigen/Geometry"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "cartographer/common/fixed_ratio_sampler.h"
 #include "cartographer/common/thread_pool.h"
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/2d/submap_2d.h"
 #include "cartographer/mapping/internal/constraints/constraint_builder_2d.h"
 #include "cartographer/mapping/internal/optimization/optimization_problem_2d.h"
+#include "cartographer/mapping/internal/landmark_index.h"
+#include "cartographer/mapping/internal/place_descriptor_index.h"
 #include "cartographer/mapping/internal/trajectory_connectivity_state.h"
 #include "cartographer/mapping/internal/work_queue.h"
 #include "cartographer/mapping/pose_graph.h"
@@ -192,8 +195,17 @@ class PoseGraph2D : public PoseGraph {
       std::vector<std::shared_ptr<const Submap2D>> insertion_submaps,
       bool newly_finished_submap) LOCKS_EXCLUDED(mutex_);
 
-  // Computes constraints for a node and submap pair.
-  void ComputeConstraint(const NodeId& node_id, const SubmapId& submap_id)
+  // Global pose of a node estimated from landmarks, computed at most once
+  // however many submaps the node is matched against.
+  struct LandmarkEstimate {
+    bool computed = false;
+    absl::optional<transform::Rigid3d> global_node_pose;
+  };
+
+  // Computes constraints for a node and submap pair. 'landmark_estimate' is
+  // shared by all calls for the same node.
+  void ComputeConstraint(const NodeId& node_id, const SubmapId& submap_id,
+                         LandmarkEstimate* landmark_estimate)
       LOCKS_EXCLUDED(mutex_);
 
   // Deletes trajectories waiting for deletion. Must not be called during
@@ -234,10 +246,26 @@ class PoseGraph2D : public PoseGraph {
                                  const SubmapId& submap_id) const
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns true if 'node_id' has to be globally localized against 'submap_id',
+  // i.e. if they belong to different trajectories without a recent constraint
+  // between them.
+  bool RequiresGlobalSearch(const NodeId& node_id, const SubmapId& submap_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Decides whether to globally localize 'node_id' against 'submap_id': by
+  // place descriptor ranking if available, otherwise by sampling.
+  bool ShouldSearchGlobally(const NodeId& node_id, const SubmapId& submap_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Updates the trajectory connectivity structure with a new constraint.
   void UpdateTrajectoryConnectivity(const Constraint& constraint)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns the global pose of 'node_id' estimated from landmarks observed by
+  // its trajectory, if landmark relocalization is enabled and possible.
+  absl::optional<transform::Rigid3d> EstimateGlobalNodePoseFromLandmarks(
+      const NodeId& node_id) const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   const proto::PoseGraphOptions options_;
   GlobalSlamOptimizationCallback global_slam_optimization_callback_;
   mutable absl::Mutex mutex_;
@@ -266,6 +294,21 @@ class PoseGraph2D : public PoseGraph {
 
   PoseGraphData data_ GUARDED_BY(mutex_);
 
+  // Landmark observations and poses used to relocalize trajectories.
+  LandmarkIndex landmark_index_ GUARDED_BY(mutex_);
+
+  // Place descriptors used to select submaps for global localization.
+  PlaceDescriptorIndex place_descriptor_index_ GUARDED_BY(mutex_);
+
+  // A trajectory which searches for a connection to another trajectory.
+  struct Relocalization {
+    // Time of the first node which was not connected.
+    common::Time start_time;
+    // Whether any of the searches was seeded by landmarks.
+    bool landmark_seeded;
+  };
+  std::map<int, Relocalization> relocalizations_ GUARDED_BY(mutex_);
+
   ValueConversionTables conversion_tables_;
 
   // Allows querying and manipulating the pose graph by the 'trimmers_'. The
@@ -283,6 +326,11 @@ class PoseGraph2D : public PoseGraph {
         EXCLUSIVE_LOCKS_REQUIRED(parent_->mutex_);
     const std::vector<Constraint>& GetConstraints() const override
         EXCLUSIVE_LOCKS_REQUIRED(parent_->mutex_);
+    std::vector<Constraint> GetSubmapConstraints(
+        const SubmapId& submap_id) const override
+        EXCLUSIVE_LOCKS_REQUIRED(parent_->mutex_);
+    size_t EstimateSensorDataMemoryUsage(int trajectory_id) const override
+        EXCLUSIVE_LOCKS_REQUIRED(parent_->mutex_);
     void TrimSubmap(const SubmapId& submap_id)
         EXCLUSIVE_LOCKS_REQUIRED(parent_->mutex_) override;
     bool IsFinished(int trajectory_id) const override
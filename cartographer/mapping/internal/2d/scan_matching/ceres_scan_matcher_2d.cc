@@ -52,6 +52,10 @@ proto::CeresScanMatcherOptions2D CreateCeresScanMatcherOptions2D(
       parameter_dictionary->GetDouble("translation_weight"));
   options.set_rotation_weight(
       parameter_dictionary->GetDouble("rotation_weight"));
+  if (parameter_dictionary->HasKey("use_analytic_tsdf_cost_function")) {
+    options.set_use_analytic_tsdf_cost_function(
+        parameter_dictionary->GetBool("use_analytic_tsdf_cost_function"));
+  }
   *options.mutable_ceres_solver_options() =
       common::CreateCeresSolverOptionsProto(
           parameter_dictionary->GetDictionary("ceres_solver_options").get());
@@ -94,10 +98,15 @@ void CeresScanMatcher2D::Match(const Eigen::Vector2d& target_translation,
 
     //构造残差--平移
       problem.AddResidualBlock(
-          CreateTSDFMatchCostFunction2D(
-              options_.occupied_space_weight() /
-                  std::sqrt(static_cast<double>(point_cloud.size())),
-              point_cloud, static_cast<const TSDF2D&>(grid)),
+          options_.use_analytic_tsdf_cost_function()
+              ? CreateAnalyticTSDFMatchCostFunction2D(
+                    options_.occupied_space_weight() /
+                        std::sqrt(static_cast<double>(point_cloud.size())),
+                    point_cloud, static_cast<const TSDF2D&>(grid))
+              : CreateTSDFMatchCostFunction2D(
+                    options_.occupied_space_weight() /
+                        std::sqrt(static_cast<double>(point_cloud.size())),
+                    point_cloud, static_cast<const TSDF2D&>(grid)),
           nullptr /* loss function */, ceres_pose_estimate);
       break;
   }
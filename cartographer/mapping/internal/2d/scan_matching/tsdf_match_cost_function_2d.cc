@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include "cartographer/mapping/internal/2d/scan_matching/tsdf_match_cost_function_2d.h"
+
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "cartographer/mapping/internal/2d/scan_matching/interpolated_tsdf_2d.h"
@@ -74,6 +76,164 @@ class TSDFMatchCostFunction2D {
   const InterpolatedTSDF2D interpolated_grid_;
 };
 
+// Analytic counterpart of 'TSDFMatchCostFunction2D'. The scan is kept as a
+// contiguous 2xN matrix, the four neighbouring cells of every point are
+// gathered once per evaluation and the bilinear interpolation, residuals and
+// Jacobians are computed with Eigen array expressions over all points.
+class AnalyticTSDFMatchCostFunction2D : public ceres::CostFunction {
+ public:
+  AnalyticTSDFMatchCostFunction2D(const double residual_scaling_factor,
+                                  const sensor::PointCloud& point_cloud,
+                                  const TSDF2D& grid)
+      : residual_scaling_factor_(residual_scaling_factor),
+        points_(2, point_cloud.size()),
+        grid_(grid) {
+    for (size_t i = 0; i < point_cloud.size(); ++i) {
+      points_.col(i) = point_cloud[i].position.head<2>().cast<double>();
+    }
+    set_num_residuals(point_cloud.size());
+    mutable_parameter_block_sizes()->push_back(3);
+  }
+
+  AnalyticTSDFMatchCostFunction2D(const AnalyticTSDFMatchCostFunction2D&) =
+      delete;
+  AnalyticTSDFMatchCostFunction2D& operator=(
+      const AnalyticTSDFMatchCostFunction2D&) = delete;
+
+  bool Evaluate(double const* const* parameters, double* residuals,
+                double** jacobians) const override {
+    const double* const pose = parameters[0];
+    const Eigen::Matrix2d rotation_matrix =
+        Eigen::Rotation2Dd(pose[2]).toRotationMatrix();
+    const Eigen::Matrix2Xd rotated_points = rotation_matrix * points_;
+    const Eigen::Matrix2Xd world_points =
+        rotated_points.colwise() + Eigen::Vector2d(pose[0], pose[1]);
+
+    // Rows are the cells (x1, y1), (x1, y2), (x2, y1) and (x2, y2) around
+    // every point, in the order used by 'InterpolatedTSDF2D'.
+    const int num_points = points_.cols();
+    Eigen::Array4Xd costs(4, num_points);
+    Eigen::Array4Xd weights(4, num_points);
+    Eigen::Array2Xd normalized(2, num_points);
+    Eigen::Array2Xd cell_sizes(2, num_points);
+    GatherInterpolationData(world_points, &costs, &weights, &normalized,
+                            &cell_sizes);
+    const Eigen::ArrayXd normalized_x = normalized.row(0).transpose();
+    const Eigen::ArrayXd normalized_y = normalized.row(1).transpose();
+
+    // Points with at least one 'unknown' neighbour get the maximum
+    // correspondence cost with zero gradient.
+    const Eigen::ArrayXd known =
+        (weights != 0.).colwise().all().transpose().cast<double>();
+
+    Eigen::ArrayXd cost, cost_dx, cost_dy;
+    InterpolateBilinear(costs, normalized_x, normalized_y, cell_sizes, &cost,
+                        &cost_dx, &cost_dy);
+    cost = known * cost +
+           (1. - known) * static_cast<double>(grid_.GetMaxCorrespondenceCost());
+    cost_dx *= known;
+    cost_dy *= known;
+
+    Eigen::ArrayXd weight, weight_dx, weight_dy;
+    InterpolateBilinear(weights, normalized_x, normalized_y, cell_sizes,
+                        &weight, &weight_dx, &weight_dy);
+
+    const double summed_weight = weight.sum();
+    if (summed_weight == 0.) return false;
+    const double scale =
+        num_points * residual_scaling_factor_ / summed_weight;
+    Eigen::Map<Eigen::ArrayXd> residual(residuals, num_points);
+    residual = scale * cost * weight;
+
+    if (jacobians != nullptr && jacobians[0] != nullptr) {
+      // d(world point) / d(theta) is the rotated point turned by 90 degrees.
+      const Eigen::ArrayXd rotated_x = rotated_points.row(0).transpose();
+      const Eigen::ArrayXd rotated_y = rotated_points.row(1).transpose();
+      const Eigen::ArrayXd product_dx = cost_dx * weight + cost * weight_dx;
+      const Eigen::ArrayXd product_dy = cost_dy * weight + cost * weight_dy;
+      const Eigen::Vector3d summed_weight_gradient(
+          weight_dx.sum(), weight_dy.sum(),
+          (rotated_x * weight_dy - rotated_y * weight_dx).sum());
+      Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>>
+          jacobian(jacobians[0], num_points, 3);
+      jacobian.col(0) = (scale * product_dx -
+                         residual * (summed_weight_gradient[0] / summed_weight))
+                            .matrix();
+      jacobian.col(1) = (scale * product_dy -
+                         residual * (summed_weight_gradient[1] / summed_weight))
+                            .matrix();
+      jacobian.col(2) =
+          (scale * (rotated_x * product_dy - rotated_y * product_dx) -
+           residual * (summed_weight_gradient[2] / summed_weight))
+              .matrix();
+    }
+    return true;
+  }
+
+ private:
+  // Fetches the correspondence costs and weights of the four cells around
+  // every point and the point's position relative to them. This mirrors the
+  // cell selection of 'InterpolatedTSDF2D'.
+  void GatherInterpolationData(const Eigen::Matrix2Xd& world_points,
+                               Eigen::Array4Xd* const costs,
+                               Eigen::Array4Xd* const weights,
+                               Eigen::Array2Xd* const normalized,
+                               Eigen::Array2Xd* const cell_sizes) const {
+    const MapLimits& limits = grid_.limits();
+    const float resolution = static_cast<float>(limits.resolution());
+    const Eigen::Array2i kOffsets[4] = {
+        Eigen::Array2i(0, 0), Eigen::Array2i(-1, 0), Eigen::Array2i(0, -1),
+        Eigen::Array2i(-1, -1)};
+    for (int i = 0; i < world_points.cols(); ++i) {
+      const double x = world_points(0, i);
+      const double y = world_points(1, i);
+      // Center of the next lower pixel.
+      Eigen::Vector2f lower = limits.GetCellCenter(limits.GetCellIndex(
+          Eigen::Vector2f(static_cast<float>(x), static_cast<float>(y))));
+      if (lower.x() > x) lower.x() -= limits.resolution();
+      if (lower.y() > y) lower.y() -= limits.resolution();
+      const float size_x = (lower.x() + resolution) - lower.x();
+      const float size_y = (lower.y() + resolution) - lower.y();
+      (*cell_sizes)(0, i) = size_x;
+      (*cell_sizes)(1, i) = size_y;
+      (*normalized)(0, i) = (x - lower.x()) / size_x;
+      (*normalized)(1, i) = (y - lower.y()) / size_y;
+      const Eigen::Array2i index = limits.GetCellIndex(lower);
+      for (int j = 0; j < 4; ++j) {
+        const Eigen::Array2i cell_index = index + kOffsets[j];
+        (*costs)(j, i) = grid_.GetCorrespondenceCost(cell_index);
+        (*weights)(j, i) = grid_.GetWeight(cell_index);
+      }
+    }
+  }
+
+  // Bilinearly interpolates the four 'values' of every point and returns the
+  // derivatives with respect to the point's world coordinates.
+  static void InterpolateBilinear(const Eigen::Array4Xd& values,
+                                  const Eigen::ArrayXd& normalized_x,
+                                  const Eigen::ArrayXd& normalized_y,
+                                  const Eigen::Array2Xd& cell_sizes,
+                                  Eigen::ArrayXd* const value,
+                                  Eigen::ArrayXd* const value_dx,
+                                  Eigen::ArrayXd* const value_dy) {
+    const Eigen::ArrayXd q11 = values.row(0).transpose();
+    const Eigen::ArrayXd q12 = values.row(1).transpose();
+    const Eigen::ArrayXd q21 = values.row(2).transpose();
+    const Eigen::ArrayXd q22 = values.row(3).transpose();
+    const Eigen::ArrayXd q1 = (q12 - q11) * normalized_y + q11;
+    const Eigen::ArrayXd q2 = (q22 - q21) * normalized_y + q21;
+    *value = (q2 - q1) * normalized_x + q1;
+    *value_dx = (q2 - q1) / cell_sizes.row(0).transpose();
+    *value_dy = ((q12 - q11) * (1. - normalized_x) +
+                 (q22 - q21) * normalized_x) /
+                cell_sizes.row(1).transpose();
+  }
+
+  const double residual_scaling_factor_;
+  Eigen::Matrix2Xd points_;
+  const TSDF2D& grid_;
+};
+
 ceres::CostFunction* CreateTSDFMatchCostFunction2D(
     const double scaling_factor, const sensor::PointCloud& point_cloud,
     const TSDF2D& tsdf) {
@@ -84,6 +244,13 @@ ceres::CostFunction* CreateTSDFMatchCostFunction2D(
       point_cloud.size());
 }
 
+ceres::CostFunction* CreateAnalyticTSDFMatchCostFunction2D(
+    const double scaling_factor, const sensor::PointCloud& point_cloud,
+    const TSDF2D& tsdf) {
+  return new AnalyticTSDFMatchCostFunction2D(scaling_factor, point_cloud,
+                                             tsdf);
+}
+
 }  // namespace scan_matching
 }  // namespace mapping
 }  // namespace cartographer
@@ -32,6 +32,13 @@ ceres::CostFunction* CreateTSDFMatchCostFunction2D(
     const double scaling_factor, const sensor::PointCloud& point_cloud,
     const TSDF2D& grid);
 
+// Same cost as CreateTSDFMatchCostFunction2D(), but evaluated with analytic
+// Jacobians. All points are transformed and interpolated in one pass over
+// contiguous arrays instead of per point under Ceres Jets.
+ceres::CostFunction* CreateAnalyticTSDFMatchCostFunction2D(
+    const double scaling_factor, const sensor::PointCloud& point_cloud,
+    const TSDF2D& grid);
+
 }  // namespace scan_matching
 }  // namespace mapping
 }  // namespace cartographer
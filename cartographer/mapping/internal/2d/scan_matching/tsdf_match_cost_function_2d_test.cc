@@ -160,6 +160,46 @@ TEST_F(TSDFSpaceCostFunction2DTest, InvalidInitialPose) {
   EXPECT_FALSE(valid_result);
 }
 
+TEST_F(TSDFSpaceCostFunction2DTest, AnalyticMatchesAutoDiff) {
+  InsertPointcloud();
+  const sensor::PointCloud matching_cloud = {
+      {Eigen::Vector3f{-0.3f, 1.f, 0.f}},
+      {Eigen::Vector3f{0.f, 1.f, 0.f}},
+      {Eigen::Vector3f{0.25f, 0.95f, 0.f}},
+      {Eigen::Vector3f{3.f, 3.f, 0.f}}};
+  std::unique_ptr<ceres::CostFunction> auto_diff_cost_function(
+      CreateTSDFMatchCostFunction2D(1.f, matching_cloud, tsdf_));
+  std::unique_ptr<ceres::CostFunction> analytic_cost_function(
+      CreateAnalyticTSDFMatchCostFunction2D(1.f, matching_cloud, tsdf_));
+  for (const std::array<double, 3>& pose_estimate :
+       {std::array<double, 3>{{0., 0., 0.}},
+        std::array<double, 3>{{0.02, 0.07, 0.05}},
+        std::array<double, 3>{{-0.04, -0.08, -0.1}},
+        std::array<double, 3>{{0., 0.4, 0.}}}) {
+    const std::array<const double*, 1> parameter_blocks{
+        {pose_estimate.data()}};
+    std::array<double, 4> expected_residuals;
+    std::array<double, 12> expected_jacobian;
+    double* expected_jacobians[] = {expected_jacobian.data()};
+    std::array<double, 4> residuals;
+    std::array<double, 12> jacobian;
+    double* jacobians[] = {jacobian.data()};
+    const bool expected_valid = auto_diff_cost_function->Evaluate(
+        parameter_blocks.data(), expected_residuals.data(),
+        expected_jacobians);
+    ASSERT_EQ(expected_valid,
+              analytic_cost_function->Evaluate(parameter_blocks.data(),
+                                               residuals.data(), jacobians));
+    if (!expected_valid) continue;
+    for (size_t i = 0; i < residuals.size(); ++i) {
+      EXPECT_NEAR(expected_residuals[i], residuals[i], 1e-9);
+    }
+    for (size_t i = 0; i < jacobian.size(); ++i) {
+      EXPECT_NEAR(expected_jacobian[i], jacobian[i], 1e-9);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace scan_matching
 }  // namespace mapping
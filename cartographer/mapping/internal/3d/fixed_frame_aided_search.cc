@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/3d/fixed_frame_aided_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "cartographer/transform/timestamped_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+absl::optional<transform::Rigid3d> LookupFixedFramePose(
+    const sensor::MapByTime<sensor::FixedFramePoseData>& fixed_frame_pose_data,
+    const int trajectory_id, const common::Time time,
+    const common::Duration max_time_difference) {
+  if (!fixed_frame_pose_data.HasTrajectory(trajectory_id)) {
+    return absl::nullopt;
+  }
+  const auto begin = fixed_frame_pose_data.BeginOfTrajectory(trajectory_id);
+  const auto end = fixed_frame_pose_data.EndOfTrajectory(trajectory_id);
+  const auto next_it = fixed_frame_pose_data.lower_bound(trajectory_id, time);
+  const auto prev_it = next_it != begin ? std::prev(next_it) : end;
+  const bool has_next = next_it != end && next_it->pose.has_value();
+  const bool has_prev = prev_it != end && prev_it->pose.has_value();
+  if (has_next && next_it->time == time) {
+    return next_it->pose.value();
+  }
+  if (has_prev && has_next) {
+    return transform::Interpolate(
+               transform::TimestampedTransform{prev_it->time,
+                                               prev_it->pose.value()},
+               transform::TimestampedTransform{next_it->time,
+                                               next_it->pose.value()},
+               time)
+        .transform;
+  }
+  if (has_prev && time - prev_it->time <= max_time_difference) {
+    return prev_it->pose.value();
+  }
+  if (has_next && next_it->time - time <= max_time_difference) {
+    return next_it->pose.value();
+  }
+  return absl::nullopt;
+}
+
+scan_matching::FastCorrelativeScanMatcher3D::SearchWindow
+ComputeFixedFrameSearchWindow(const proto::PoseGraphOptions& options,
+                              const bool search_all_rotations) {
+  const auto& matcher_options = options.constraint_builder_options()
+                                    .fast_correlative_scan_matcher_options_3d();
+  const auto& optimization_options = options.optimization_problem_options();
+  const double num_standard_deviations =
+      options.fixed_frame_aided_search().num_standard_deviations();
+  scan_matching::FastCorrelativeScanMatcher3D::SearchWindow search_window{
+      matcher_options.linear_xy_search_window(),
+      matcher_options.linear_z_search_window(),
+      matcher_options.angular_search_window()};
+  // The fixed frame pose weights are inverse standard deviations.
+  const double linear_search_window =
+      num_standard_deviations /
+      optimization_options.fixed_frame_pose_translation_weight();
+  search_window.linear_xy_search_window =
+      std::min(search_window.linear_xy_search_window, linear_search_window);
+  search_window.linear_z_search_window =
+      std::min(search_window.linear_z_search_window, linear_search_window);
+  if (optimization_options.fixed_frame_pose_rotation_weight() > 0.) {
+    search_window.angular_search_window =
+        std::min(search_window.angular_search_window,
+                 num_standard_deviations /
+                     optimization_options.fixed_frame_pose_rotation_weight());
+  } else if (search_all_rotations) {
+    search_window.angular_search_window = M_PI;
+  }
+  return search_window;
+}
+
+}  // namespace mapping
+}  // namespace cartographer
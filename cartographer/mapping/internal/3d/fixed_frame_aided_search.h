@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_3D_FIXED_FRAME_AIDED_SEARCH_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_3D_FIXED_FRAME_AIDED_SEARCH_H_
+
+#include "absl/types/optional.h"
+#include "cartographer/common/time.h"
+#include "cartographer/mapping/internal/3d/scan_matching/fast_correlative_scan_matcher_3d.h"
+#include "cartographer/mapping/proto/pose_graph_options.pb.h"
+#include "cartographer/sensor/fixed_frame_pose_data.h"
+#include "cartographer/sensor/map_by_time.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Returns the fixed frame pose of 'trajectory_id' at 'time'. It is
+// interpolated if 'time' is between two fixed frame poses. Otherwise, the
+// closest fixed frame pose at most 'max_time_difference' away is returned, so
+// that nodes can be looked up before the next fixed frame pose was added.
+absl::optional<transform::Rigid3d> LookupFixedFramePose(
+    const sensor::MapByTime<sensor::FixedFramePoseData>& fixed_frame_pose_data,
+    int trajectory_id, common::Time time, common::Duration max_time_difference);
+
+// Returns the configured constraint search window with its linear and, if
+// fixed frame poses carry rotation, angular extents shrunk to the uncertainty
+// of fixed frame poses. These never grow beyond the configured window. Without
+// a fixed frame rotation weight, the angular window is widened to all
+// rotations if 'search_all_rotations', as for a global search.
+scan_matching::FastCorrelativeScanMatcher3D::SearchWindow
+ComputeFixedFrameSearchWindow(const proto::PoseGraphOptions& options,
+                              bool search_all_rotations);
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_3D_FIXED_FRAME_AIDED_SEARCH_H_
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/3d/fixed_frame_aided_search.h"
+
+#include <cmath>
+
+#include "cartographer/transform/rigid_transform_test_helpers.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+constexpr int kTrajectoryId = 1;
+
+transform::Rigid3d TranslationX(const double x) {
+  return transform::Rigid3d::Translation(Eigen::Vector3d(x, 0., 0.));
+}
+
+class LookupFixedFramePoseTest : public ::testing::Test {
+ protected:
+  void Append(const double seconds,
+              const absl::optional<transform::Rigid3d>& pose) {
+    fixed_frame_pose_data_.Append(
+        kTrajectoryId,
+        sensor::FixedFramePoseData{common::FromUniversal(0) +
+                                       common::FromSeconds(seconds),
+                                   pose});
+  }
+
+  absl::optional<transform::Rigid3d> Lookup(const double seconds) const {
+    return LookupFixedFramePose(
+        fixed_frame_pose_data_, kTrajectoryId,
+        common::FromUniversal(0) + common::FromSeconds(seconds),
+        common::FromSeconds(1.));
+  }
+
+  sensor::MapByTime<sensor::FixedFramePoseData> fixed_frame_pose_data_;
+};
+
+TEST_F(LookupFixedFramePoseTest, UnknownTrajectory) {
+  EXPECT_FALSE(Lookup(0.).has_value());
+}
+
+TEST_F(LookupFixedFramePoseTest, InterpolatesBetweenPoses) {
+  Append(10., TranslationX(1.));
+  Append(12., TranslationX(3.));
+  ASSERT_TRUE(Lookup(11.).has_value());
+  EXPECT_THAT(Lookup(11.).value(), transform::IsNearly(TranslationX(2.), 1e-9));
+  ASSERT_TRUE(Lookup(12.).has_value());
+  EXPECT_THAT(Lookup(12.).value(), transform::IsNearly(TranslationX(3.), 1e-9));
+}
+
+TEST_F(LookupFixedFramePoseTest, UsesClosestPoseWithinMaxTimeDifference) {
+  Append(10., TranslationX(1.));
+  Append(12., TranslationX(3.));
+  // The next fixed frame pose has not been added yet.
+  ASSERT_TRUE(Lookup(12.5).has_value());
+  EXPECT_THAT(Lookup(12.5).value(),
+              transform::IsNearly(TranslationX(3.), 1e-9));
+  ASSERT_TRUE(Lookup(9.5).has_value());
+  EXPECT_THAT(Lookup(9.5).value(), transform::IsNearly(TranslationX(1.), 1e-9));
+  EXPECT_FALSE(Lookup(13.5).has_value());
+  EXPECT_FALSE(Lookup(8.5).has_value());
+}
+
+TEST_F(LookupFixedFramePoseTest, IgnoresMissingPoses) {
+  Append(10., TranslationX(1.));
+  Append(11., absl::nullopt);
+  ASSERT_TRUE(Lookup(10.5).has_value());
+  EXPECT_THAT(Lookup(10.5).value(),
+              transform::IsNearly(TranslationX(1.), 1e-9));
+  // A missing pose hides older poses.
+  EXPECT_FALSE(Lookup(11.5).has_value());
+}
+
+class ComputeFixedFrameSearchWindowTest : public ::testing::Test {
+ protected:
+  ComputeFixedFrameSearchWindowTest() {
+    auto* matcher_options =
+        options_.mutable_constraint_builder_options()
+            ->mutable_fast_correlative_scan_matcher_options_3d();
+    matcher_options->set_linear_xy_search_window(5.);
+    matcher_options->set_linear_z_search_window(1.);
+    matcher_options->set_angular_search_window(0.3);
+    options_.mutable_fixed_frame_aided_search()->set_num_standard_deviations(
+        2.);
+  }
+
+  void SetWeights(const double translation_weight,
+                  const double rotation_weight) {
+    auto* optimization_options =
+        options_.mutable_optimization_problem_options();
+    optimization_options->set_fixed_frame_pose_translation_weight(
+        translation_weight);
+    optimization_options->set_fixed_frame_pose_rotation_weight(
+        rotation_weight);
+  }
+
+  proto::PoseGraphOptions options_;
+};
+
+TEST_F(ComputeFixedFrameSearchWindowTest, ShrinksToStandardDeviations) {
+  SetWeights(10., 100.);
+  for (const bool search_all_rotations : {false, true}) {
+    const auto search_window =
+        ComputeFixedFrameSearchWindow(options_, search_all_rotations);
+    EXPECT_NEAR(0.2, search_window.linear_xy_search_window, 1e-9);
+    EXPECT_NEAR(0.2, search_window.linear_z_search_window, 1e-9);
+    EXPECT_NEAR(0.02, search_window.angular_search_window, 1e-9);
+  }
+}
+
+TEST_F(ComputeFixedFrameSearchWindowTest, NeverGrowsLinearWindows) {
+  SetWeights(0.1, 1.);
+  const auto search_window =
+      ComputeFixedFrameSearchWindow(options_, true /* search_all_rotations */);
+  EXPECT_NEAR(5., search_window.linear_xy_search_window, 1e-9);
+  EXPECT_NEAR(1., search_window.linear_z_search_window, 1e-9);
+  EXPECT_NEAR(0.3, search_window.angular_search_window, 1e-9);
+}
+
+TEST_F(ComputeFixedFrameSearchWindowTest, WithoutRotationWeight) {
+  SetWeights(10., 0.);
+  EXPECT_NEAR(0.3,
+              ComputeFixedFrameSearchWindow(options_,
+                                            false /* search_all_rotations */)
+                  .angular_search_window,
+              1e-9);
+  EXPECT_NEAR(M_PI,
+              ComputeFixedFrameSearchWindow(options_,
+                                            true /* search_all_rotations */)
+                  .angular_search_window,
+              1e-9);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/3d/imu_integration_buffer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "cartographer/transform/transform.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+// Holds the angular velocity and linear acceleration of 'imu_data' for
+// 'delta_t' seconds, just like a single step of 'IntegrateImu'.
+void IntegrateSample(const sensor::ImuData& imu_data, const double delta_t,
+                     IntegrateImuResult<double>* const result) {
+  result->delta_rotation *= transform::AngleAxisVectorToRotationQuaternion(
+      Eigen::Vector3d(imu_data.angular_velocity * delta_t));
+  result->delta_velocity +=
+      result->delta_rotation * (imu_data.linear_acceleration * delta_t);
+}
+
+}  // namespace
+
+void ImuIntegrationBuffer::Append(const sensor::ImuData& imu_data) {
+  if (samples_.empty()) {
+    samples_.push_back(Sample{imu_data, Eigen::Quaterniond::Identity(),
+                              Eigen::Vector3d::Zero()});
+    return;
+  }
+  const Sample& last = samples_.back();
+  CHECK_LE(last.imu_data.time, imu_data.time);
+  IntegrateImuResult<double> result{last.velocity, last.rotation};
+  IntegrateSample(last.imu_data,
+                  common::ToSeconds(imu_data.time - last.imu_data.time),
+                  &result);
+  samples_.push_back(Sample{imu_data, result.delta_rotation.normalized(),
+                            result.delta_velocity});
+}
+
+IntegrateImuResult<double> ImuIntegrationBuffer::Integrate(
+    const common::Time start_time, const common::Time end_time) const {
+  CHECK_LE(start_time, end_time);
+  CHECK(!samples_.empty());
+  CHECK_LE(samples_.front().imu_data.time, start_time);
+  IntegrateImuResult<double> result{Eigen::Vector3d::Zero(),
+                                    Eigen::Quaterniond::Identity()};
+  if (start_time == end_time) {
+    return result;
+  }
+  // 'first' is the last sample at or before 'start_time', 'last' the last
+  // sample before 'end_time'.
+  const auto first = std::prev(std::upper_bound(
+      samples_.begin(), samples_.end(), start_time,
+      [](const common::Time time, const Sample& sample) {
+        return time < sample.imu_data.time;
+      }));
+  const auto last = std::prev(std::lower_bound(
+      samples_.begin(), samples_.end(), end_time,
+      [](const Sample& sample, const common::Time time) {
+        return sample.imu_data.time < time;
+      }));
+  if (first == last) {
+    IntegrateSample(first->imu_data,
+                    common::ToSeconds(end_time - start_time), &result);
+    return result;
+  }
+  const Sample& second = *std::next(first);
+  IntegrateSample(first->imu_data,
+                  common::ToSeconds(second.imu_data.time - start_time),
+                  &result);
+  // Maps from the frame of the first sample to the frame at 'start_time'.
+  const Eigen::Quaterniond to_start_frame =
+      result.delta_rotation * second.rotation.conjugate();
+  result.delta_velocity += to_start_frame * (last->velocity - second.velocity);
+  result.delta_rotation = to_start_frame * last->rotation;
+  IntegrateSample(last->imu_data,
+                  common::ToSeconds(end_time - last->imu_data.time), &result);
+  return result;
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_3D_IMU_INTEGRATION_BUFFER_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_3D_IMU_INTEGRATION_BUFFER_H_
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "cartographer/common/time.h"
+#include "cartographer/mapping/internal/3d/imu_integration.h"
+#include "cartographer/sensor/imu_data.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Integrates IMU data over arbitrary intervals in O(log n), where n is the
+// number of samples. For this, the rotations between consecutive samples are
+// accumulated into prefix products, and the accelerations rotated into the
+// frame of the first sample into prefix sums. The results agree with
+// 'IntegrateImu' without calibration up to rounding.
+class ImuIntegrationBuffer {
+ public:
+  ImuIntegrationBuffer() = default;
+
+  // Appends 'imu_data', which must not be older than the last sample.
+  void Append(const sensor::ImuData& imu_data);
+
+  bool empty() const { return samples_.empty(); }
+  size_t size() const { return samples_.size(); }
+
+  // Integrates from 'start_time' to 'end_time'. Each sample is held until the
+  // next one, the last sample indefinitely. 'start_time' must not be before
+  // the first sample.
+  IntegrateImuResult<double> Integrate(common::Time start_time,
+                                       common::Time end_time) const;
+
+ private:
+  struct Sample {
+    sensor::ImuData imu_data;
+    // Rotation from the frame of the first sample to this sample's.
+    Eigen::Quaterniond rotation;
+    // Sum of the velocity deltas between the first sample and this one in the
+    // frame of the first sample.
+    Eigen::Vector3d velocity;
+  };
+
+  std::vector<Sample> samples_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_3D_IMU_INTEGRATION_BUFFER_H_
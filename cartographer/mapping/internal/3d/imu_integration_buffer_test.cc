@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/3d/imu_integration_buffer.h"
+
+#include <deque>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+class ImuIntegrationBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 prng(42);
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+    std::uniform_int_distribution<int> time_step_distribution(0, 10000);
+    common::Time time = common::FromUniversal(1000);
+    for (int i = 0; i != 100; ++i) {
+      imu_data_.push_back(sensor::ImuData{
+          time,
+          Eigen::Vector3d(distribution(prng), distribution(prng),
+                          9.81 + distribution(prng)),
+          Eigen::Vector3d(distribution(prng), distribution(prng),
+                          distribution(prng))});
+      buffer_.Append(imu_data_.back());
+      // Includes samples with equal timestamps.
+      time += common::Duration(time_step_distribution(prng));
+    }
+  }
+
+  IntegrateImuResult<double> IntegrateImuFromStart(
+      const common::Time start_time, const common::Time end_time) {
+    auto it = imu_data_.cbegin();
+    while (std::next(it) != imu_data_.cend() &&
+           std::next(it)->time <= start_time) {
+      ++it;
+    }
+    return IntegrateImu(imu_data_, start_time, end_time, &it);
+  }
+
+  void ExpectNear(const IntegrateImuResult<double>& expected,
+                  const IntegrateImuResult<double>& actual) {
+    EXPECT_NEAR(0., (expected.delta_velocity - actual.delta_velocity).norm(),
+                1e-9);
+    EXPECT_NEAR(0., expected.delta_rotation.angularDistance(
+                        actual.delta_rotation),
+                1e-9);
+  }
+
+  std::deque<sensor::ImuData> imu_data_;
+  ImuIntegrationBuffer buffer_;
+};
+
+TEST_F(ImuIntegrationBufferTest, EmptyInterval) {
+  const common::Time time = imu_data_[10].time;
+  const IntegrateImuResult<double> result = buffer_.Integrate(time, time);
+  EXPECT_TRUE(result.delta_velocity.isZero());
+  EXPECT_TRUE(result.delta_rotation.isApprox(Eigen::Quaterniond::Identity()));
+}
+
+TEST_F(ImuIntegrationBufferTest, AgreesWithIntegrateImu) {
+  const common::Time first_time = imu_data_.front().time;
+  const common::Time past_last_time =
+      imu_data_.back().time + common::FromSeconds(0.01);
+  std::mt19937 prng(23);
+  std::uniform_int_distribution<int64> time_distribution(
+      0, common::ToUniversal(past_last_time) -
+             common::ToUniversal(first_time));
+  for (int i = 0; i != 1000; ++i) {
+    common::Time start_time =
+        first_time + common::Duration(time_distribution(prng));
+    common::Time end_time =
+        first_time + common::Duration(time_distribution(prng));
+    if (end_time < start_time) {
+      std::swap(start_time, end_time);
+    }
+    ExpectNear(IntegrateImuFromStart(start_time, end_time),
+               buffer_.Integrate(start_time, end_time));
+  }
+}
+
+TEST_F(ImuIntegrationBufferTest, AgreesWithIntegrateImuAtSampleTimes) {
+  for (size_t i = 0; i < imu_data_.size(); i += 7) {
+    for (size_t j = i; j < imu_data_.size(); j += 13) {
+      ExpectNear(IntegrateImuFromStart(imu_data_[i].time, imu_data_[j].time),
+                 buffer_.Integrate(imu_data_[i].time, imu_data_[j].time));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -21,6 +21,7 @@
 #include "absl/memory/memory.h"
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/internal/3d/scan_matching/rotational_scan_matcher.h"
+#include "cartographer/mapping/internal/place_descriptor.h"
 #include "cartographer/mapping/proto/3d/local_trajectory_builder_options_3d.pb.h"
 #include "cartographer/mapping/proto/3d/submaps_options_3d.pb.h"
 #include "cartographer/mapping/proto/scan_matching//ceres_scan_matcher_options_3d.pb.h"
@@ -50,13 +51,15 @@ LocalTrajectoryBuilder3D::LocalTrajectoryBuilder3D(
     : options_(options),
       active_submaps_(options.submaps_options()),
       motion_filter_(options.motion_filter_options()),
+      stationary_filter_(options.stationary_filter_options()),
       real_time_correlative_scan_matcher_(
           absl::make_unique<scan_matching::RealTimeCorrelativeScanMatcher3D>(
               options_.real_time_correlative_scan_matcher_options())),
       ceres_scan_matcher_(absl::make_unique<scan_matching::CeresScanMatcher3D>(
           options_.ceres_scan_matcher_options())),
       accumulated_range_data_{Eigen::Vector3f::Zero(), {}, {}},
-      range_data_collator_(expected_range_sensor_ids) {}
+      range_data_collator_(expected_range_sensor_ids,
+                           0.5f * options_.voxel_filter_size()) {}
 
 LocalTrajectoryBuilder3D::~LocalTrajectoryBuilder3D() {}
 
@@ -106,6 +109,7 @@ std::unique_ptr<transform::Rigid3d> LocalTrajectoryBuilder3D::ScanMatch(
 void LocalTrajectoryBuilder3D::AddImuData(const sensor::ImuData& imu_data) {
   if (extrapolator_ != nullptr) {
     extrapolator_->AddImuData(imu_data);
+    local_pose_stream_.AddImuData(imu_data);
     return;
   }
   // We derive velocities from poses which are at least 1 ms apart for numerical
@@ -146,9 +150,9 @@ LocalTrajectoryBuilder3D::AddRangeData(
     return nullptr;
   }
 
-  std::vector<sensor::TimedPointCloudOriginData::RangeMeasurement> hits =
-      sensor::VoxelFilter(0.5f * options_.voxel_filter_size())
-          .Filter(synchronized_data.ranges);
+  // The range data collator already voxel filtered the points while merging.
+  const std::vector<sensor::TimedPointCloudOriginData::RangeMeasurement>& hits =
+      synchronized_data.ranges;
 
   std::vector<transform::Rigid3f> hits_poses;
   hits_poses.reserve(hits.size());
@@ -205,8 +209,20 @@ LocalTrajectoryBuilder3D::AddRangeData(
     last_sensor_time_ = current_sensor_time;
     num_accumulated_ = 0;
 
-    transform::Rigid3f current_pose =
-        extrapolator_->ExtrapolatePose(current_sensor_time).cast<float>();
+    const transform::Rigid3d pose_prediction =
+        extrapolator_->ExtrapolatePose(current_sensor_time);
+    if (stationary_filter_.IsStationary(pose_prediction)) {
+      extrapolator_->AddPose(current_sensor_time, pose_prediction);
+      local_pose_stream_.AddPose(current_sensor_time, pose_prediction);
+      // The accumulated range data is already in the local frame, it is just
+      // not filtered.
+      accumulated_range_data_.origin =
+          pose_prediction.translation().cast<float>();
+      return absl::make_unique<MatchingResult>(
+          MatchingResult{current_sensor_time, pose_prediction,
+                         std::move(accumulated_range_data_), nullptr});
+    }
+    transform::Rigid3f current_pose = pose_prediction.cast<float>();
 
     const auto voxel_filter_start = std::chrono::steady_clock::now();
     const sensor::RangeData filtered_range_data = {
@@ -273,6 +289,8 @@ LocalTrajectoryBuilder3D::AddAccumulatedRangeData(
     return nullptr;
   }
   extrapolator_->AddPose(time, *pose_estimate);
+  local_pose_stream_.AddPose(time, *pose_estimate);
+  stationary_filter_.AddScanMatchedPose(*pose_estimate);
 
   const auto scan_matcher_stop = std::chrono::steady_clock::now();
   const auto scan_matcher_duration = scan_matcher_stop - scan_matcher_start;
@@ -352,12 +370,12 @@ LocalTrajectoryBuilder3D::InsertIntoSubmap(
   if (motion_filter_.IsSimilar(time, pose_estimate)) {
     return nullptr;
   }
+  const sensor::PointCloud returns_in_gravity = sensor::TransformPointCloud(
+      filtered_range_data_in_tracking.returns,
+      transform::Rigid3f::Rotation(gravity_alignment.cast<float>()));
   const Eigen::VectorXf rotational_scan_matcher_histogram_in_gravity =
       scan_matching::RotationalScanMatcher::ComputeHistogram(
-          sensor::TransformPointCloud(
-              filtered_range_data_in_tracking.returns,
-              transform::Rigid3f::Rotation(gravity_alignment.cast<float>())),
-          options_.rotational_histogram_size());
+          returns_in_gravity, options_.rotational_histogram_size());
 
   const Eigen::Quaterniond local_from_gravity_aligned =
       pose_estimate.rotation() * gravity_alignment.inverse();
@@ -374,7 +392,10 @@ LocalTrajectoryBuilder3D::InsertIntoSubmap(
                               high_resolution_point_cloud_in_tracking,
                               low_resolution_point_cloud_in_tracking,
                               rotational_scan_matcher_histogram_in_gravity,
-                              pose_estimate}),
+                              pose_estimate,
+                              ComputePlaceDescriptor(
+                                  returns_in_gravity,
+                                  options_.place_descriptor_options())}),
                       std::move(insertion_submaps)});
 }
 
@@ -24,8 +24,10 @@
 #include "cartographer/mapping/3d/submap_3d.h"
 #include "cartographer/mapping/internal/3d/scan_matching/ceres_scan_matcher_3d.h"
 #include "cartographer/mapping/internal/3d/scan_matching/real_time_correlative_scan_matcher_3d.h"
+#include "cartographer/mapping/internal/local_pose_stream.h"
 #include "cartographer/mapping/internal/motion_filter.h"
 #include "cartographer/mapping/internal/range_data_collator.h"
+#include "cartographer/mapping/internal/stationary_filter.h"
 #include "cartographer/mapping/pose_extrapolator.h"
 #include "cartographer/mapping/proto/3d/local_trajectory_builder_options_3d.pb.h"
 #include "cartographer/metrics/family_factory.h"
@@ -72,6 +74,11 @@ class LocalTrajectoryBuilder3D {
       const sensor::TimedPointCloudData& range_data);
   void AddOdometryData(const sensor::OdometryData& odometry_data);
 
+  // Latest local pose, which can be read concurrently by other threads.
+  const LocalPoseStream& local_pose_stream() const {
+    return local_pose_stream_;
+  }
+
   static void RegisterMetrics(metrics::FamilyFactory* family_factory);
 
  private:
@@ -99,11 +106,13 @@ class LocalTrajectoryBuilder3D {
   mapping::ActiveSubmaps3D active_submaps_;
 
   mapping::MotionFilter motion_filter_;
+  mapping::StationaryFilter stationary_filter_;
   std::unique_ptr<scan_matching::RealTimeCorrelativeScanMatcher3D>
       real_time_correlative_scan_matcher_;
   std::unique_ptr<scan_matching::CeresScanMatcher3D> ceres_scan_matcher_;
 
   std::unique_ptr<mapping::PoseExtrapolator> extrapolator_;
+  mapping::LocalPoseStream local_pose_stream_;
 
   int num_accumulated_ = 0;
   sensor::RangeData accumulated_range_data_;
@@ -19,6 +19,8 @@
 #include "cartographer/mapping/3d/submap_3d.h"
 #include "cartographer/mapping/internal/3d/scan_matching/ceres_scan_matcher_3d.h"
 #include "cartographer/mapping/internal/motion_filter.h"
+#include "cartographer/mapping/internal/place_descriptor.h"
+#include "cartographer/mapping/internal/stationary_filter.h"
 #include "cartographer/mapping/internal/scan_matching/real_time_correlative_scan_matcher.h"
 #include "cartographer/sensor/internal/voxel_filter.h"
 #include "glog/logging.h"
@@ -57,6 +59,15 @@ proto::LocalTrajectoryBuilderOptions3D CreateLocalTrajectoryBuilderOptions3D(
           parameter_dictionary->GetDictionary("ceres_scan_matcher").get());
   *options.mutable_motion_filter_options() = CreateMotionFilterOptions(
       parameter_dictionary->GetDictionary("motion_filter").get());
+  if (parameter_dictionary->HasKey("stationary_filter")) {
+    *options.mutable_stationary_filter_options() =
+        CreateStationaryFilterOptions(
+            parameter_dictionary->GetDictionary("stationary_filter").get());
+  }
+  if (parameter_dictionary->HasKey("place_descriptor")) {
+    *options.mutable_place_descriptor_options() = CreatePlaceDescriptorOptions(
+        parameter_dictionary->GetDictionary("place_descriptor").get());
+  }
   options.set_imu_gravity_time_constant(
       parameter_dictionary->GetDouble("imu_gravity_time_constant"));
   options.set_rotational_histogram_size(
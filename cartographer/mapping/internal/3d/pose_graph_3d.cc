@@ -30,6 +30,8 @@
 #include "Eigen/Eigenvalues"
 #include "absl/memory/memory.h"
 #include "cartographer/common/math.h"
+#include "cartographer/mapping/internal/3d/fixed_frame_aided_search.h"
+#include "cartographer/mapping/internal/memory_budget_trimmer.h"
 #include "cartographer/mapping/proto/pose_graph/constraint_builder_options.pb.h"
 #include "cartographer/sensor/compressed_point_cloud.h"
 #include "cartographer/sensor/internal/voxel_filter.h"
@@ -45,6 +47,17 @@ static auto* kConstraintsDifferentTrajectoryMetric = metrics::Gauge::Null();
 static auto* kActiveSubmapsMetric = metrics::Gauge::Null();
 static auto* kFrozenSubmapsMetric = metrics::Gauge::Null();
 static auto* kDeletedSubmapsMetric = metrics::Gauge::Null();
+static auto* kLandmarkSeededSearchesMetric = metrics::Counter::Null();
+static auto* kFixedFrameSeededSearchesMetric = metrics::Counter::Null();
+static auto* kFixedFramePreAlignedTrajectoriesMetric =
+    metrics::Counter::Null();
+static auto* kPlaceRecognitionCandidatesMetric = metrics::Counter::Null();
+static auto* kPlaceRecognitionRejectedMetric = metrics::Counter::Null();
+static auto* kLandmarkRelocalizationLatencyMetric = metrics::Histogram::Null();
+static auto* kFixedFrameRelocalizationLatencyMetric =
+    metrics::Histogram::Null();
+static auto* kFullSubmapRelocalizationLatencyMetric =
+    metrics::Histogram::Null();
 
 PoseGraph3D::PoseGraph3D(
     const proto::PoseGraphOptions& options,
@@ -53,7 +66,13 @@ PoseGraph3D::PoseGraph3D(
     : options_(options),
       optimization_problem_(std::move(optimization_problem)),
       constraint_builder_(options_.constraint_builder_options(), thread_pool),
-      thread_pool_(thread_pool) {}
+      thread_pool_(thread_pool),
+      place_descriptor_index_(options_.place_recognition()) {
+  if (options.has_memory_budget_trimmer()) {
+    AddTrimmer(absl::make_unique<MemoryBudgetTrimmer>(
+        options.memory_budget_trimmer()));
+  }
+}
 
 PoseGraph3D::~PoseGraph3D() {
   WaitForAllComputations();
@@ -63,22 +82,38 @@ PoseGraph3D::~PoseGraph3D() {
 
 std::vector<SubmapId> PoseGraph3D::InitializeGlobalSubmapPoses(
     const int trajectory_id, const common::Time time,
+    const transform::Rigid3d& local_pose,
     const std::vector<std::shared_ptr<const Submap3D>>& insertion_submaps) {
   CHECK(!insertion_submaps.empty());
   const auto& submap_data = optimization_problem_->submap_data();
   if (insertion_submaps.size() == 1) {
     // If we don't already have an entry for the first submap, add one.
     if (submap_data.SizeOfTrajectoryOrZero(trajectory_id) == 0) {
+      transform::Rigid3d local_to_global = ComputeLocalToGlobalTransform(
+          data_.global_submap_poses_3d, trajectory_id);
       if (data_.initial_trajectory_poses.count(trajectory_id) > 0) {
         data_.trajectory_connectivity_state.Connect(
             trajectory_id,
             data_.initial_trajectory_poses.at(trajectory_id).to_trajectory_id,
             time);
+      } else {
+        // Pre-align the new trajectory to the first trajectory whose fixed
+        // frame origin in the map is known.
+        for (const auto& entry : optimization_problem_->trajectory_data()) {
+          if (entry.first == trajectory_id) continue;
+          const absl::optional<transform::Rigid3d> global_node_pose =
+              EstimateGlobalNodePoseFromFixedFrame(
+                  trajectory_id, time, entry.first,
+                  local_to_global * local_pose);
+          if (global_node_pose.has_value()) {
+            local_to_global = global_node_pose.value() * local_pose.inverse();
+            kFixedFramePreAlignedTrajectoriesMetric->Increment();
+            break;
+          }
+        }
       }
       optimization_problem_->AddSubmap(
-          trajectory_id, ComputeLocalToGlobalTransform(
-                             data_.global_submap_poses_3d, trajectory_id) *
-                             insertion_submaps[0]->local_pose());
+          trajectory_id, local_to_global * insertion_submaps[0]->local_pose());
     }
     CHECK_EQ(1, submap_data.SizeOfTrajectoryOrZero(trajectory_id));
     const SubmapId submap_id{trajectory_id, 0};
@@ -238,6 +273,9 @@ void PoseGraph3D::AddLandmarkData(int trajectory_id,
                 trajectory_id, landmark_data.time,
                 observation.landmark_to_tracking_transform,
                 observation.translation_weight, observation.rotation_weight});
+        landmark_index_.AddObservation(
+            observation.id, data_.landmark_nodes.at(observation.id)
+                                .landmark_observations.back());
       }
     }
     return WorkItem::Result::kDoNotRunOptimization;
@@ -245,8 +283,9 @@ void PoseGraph3D::AddLandmarkData(int trajectory_id,
 }
 
 void PoseGraph3D::ComputeConstraint(const NodeId& node_id,
-                                    const SubmapId& submap_id) {
-  const transform::Rigid3d global_node_pose =
+                                    const SubmapId& submap_id,
+                                    LandmarkEstimate* const landmark_estimate) {
+  transform::Rigid3d global_node_pose =
       optimization_problem_->node_data().at(node_id).global_pose;
 
   const transform::Rigid3d global_submap_pose =
@@ -254,6 +293,8 @@ void PoseGraph3D::ComputeConstraint(const NodeId& node_id,
 
   bool maybe_add_local_constraint = false;
   bool maybe_add_global_constraint = false;
+  absl::optional<scan_matching::FastCorrelativeScanMatcher3D::SearchWindow>
+      search_window;
   const TrajectoryNode::Data* constant_data;
   const Submap3D* submap;
   {
@@ -265,34 +306,87 @@ void PoseGraph3D::ComputeConstraint(const NodeId& node_id,
       return;
     }
 
-    const common::Time node_time = GetLatestNodeTime(node_id, submap_id);
-    const common::Time last_connection_time =
-        data_.trajectory_connectivity_state.LastConnectionTime(
-            node_id.trajectory_id, submap_id.trajectory_id);
-    if (node_id.trajectory_id == submap_id.trajectory_id ||
-        node_time <
-            last_connection_time +
-                common::FromSeconds(
-                    options_.global_constraint_search_after_n_seconds())) {
+    const common::Time node_time = data_.trajectory_nodes.at(node_id).time();
+    if (!RequiresGlobalSearch(node_id, submap_id)) {
       // If the node and the submap belong to the same trajectory or if there
       // has been a recent global constraint that ties that node's trajectory to
       // the submap's trajectory, it suffices to do a match constrained to a
       // local search window.
       maybe_add_local_constraint = true;
-    } else if (global_localization_samplers_[node_id.trajectory_id]->Pulse()) {
-      // In this situation, 'global_node_pose' and 'global_submap_pose' have
-      // orientations agreeing on gravity. Their relationship regarding yaw is
-      // arbitrary. Finding the correct yaw component will be handled by the
-      // matching procedure in the FastCorrelativeScanMatcher, and the given yaw
-      // is essentially ignored.
-      maybe_add_global_constraint = true;
+      const absl::optional<transform::Rigid3d> fixed_frame_global_node_pose =
+          EstimateGlobalNodePoseFromFixedFrame(node_id.trajectory_id,
+                                               node_time,
+                                               submap_id.trajectory_id,
+                                               global_node_pose);
+      if (fixed_frame_global_node_pose.has_value()) {
+        global_node_pose = fixed_frame_global_node_pose.value();
+        search_window = ComputeFixedFrameSearchWindow(
+            options_, false /* search_all_rotations */);
+      }
+    } else {
+      // Only active trajectories are tracked, so that entries of finished
+      // trajectories are not recreated by matching their old nodes.
+      Relocalization* relocalization = nullptr;
+      if (data_.trajectories_state.at(node_id.trajectory_id).state ==
+          TrajectoryState::ACTIVE) {
+        relocalization = &relocalizations_
+                              .emplace(node_id.trajectory_id,
+                                       Relocalization{node_time, false, false})
+                              .first->second;
+      }
+      if (!landmark_estimate->computed) {
+        landmark_estimate->global_node_pose =
+            EstimateGlobalNodePoseFromLandmarks(node_id);
+        landmark_estimate->computed = true;
+      }
+      const absl::optional<transform::Rigid3d>& landmark_global_node_pose =
+          landmark_estimate->global_node_pose;
+      const absl::optional<transform::Rigid3d> fixed_frame_global_node_pose =
+          EstimateGlobalNodePoseFromFixedFrame(node_id.trajectory_id,
+                                               node_time,
+                                               submap_id.trajectory_id,
+                                               global_node_pose);
+      if (landmark_global_node_pose.has_value()) {
+        // A landmark observation ties the node to the rest of the map, so a
+        // match in a local search window around its estimate suffices.
+        global_node_pose = landmark_global_node_pose.value();
+        maybe_add_local_constraint = true;
+        if (relocalization != nullptr) {
+          relocalization->landmark_seeded = true;
+        }
+        kLandmarkSeededSearchesMetric->Increment();
+      } else if (fixed_frame_global_node_pose.has_value()) {
+        // Fixed frame poses of both trajectories tie them together up to
+        // their uncertainty, which bounds the search window.
+        global_node_pose = fixed_frame_global_node_pose.value();
+        search_window = ComputeFixedFrameSearchWindow(
+            options_, true /* search_all_rotations */);
+        maybe_add_local_constraint = true;
+        if (relocalization != nullptr) {
+          relocalization->fixed_frame_seeded = true;
+        }
+        kFixedFrameSeededSearchesMetric->Increment();
+      } else if (ShouldSearchGlobally(node_id, submap_id)) {
+        // In this situation, 'global_node_pose' and 'global_submap_pose' have
+        // orientations agreeing on gravity. Their relationship regarding yaw
+        // is arbitrary. Finding the correct yaw component will be handled by
+        // the matching procedure in the FastCorrelativeScanMatcher, and the
+        // given yaw is essentially ignored.
+        maybe_add_global_constraint = true;
+      }
     }
     constant_data = data_.trajectory_nodes.at(node_id).constant_data.get();
     submap = static_cast<const Submap3D*>(
         data_.submap_data.at(submap_id).submap.get());
   }
 
-  if (maybe_add_local_constraint) {
+  if (maybe_add_local_constraint && search_window.has_value()) {
+    // Since 'global_node_pose' is derived from the fixed frame pose, the
+    // 'max_constraint_distance' check also filters submaps spatially.
+    constraint_builder_.MaybeAddConstraint(
+        submap_id, submap, node_id, constant_data, global_node_pose,
+        global_submap_pose, search_window.value());
+  } else if (maybe_add_local_constraint) {
     constraint_builder_.MaybeAddConstraint(submap_id, submap, node_id,
                                            constant_data, global_node_pose,
                                            global_submap_pose);
@@ -315,7 +409,8 @@ WorkItem::Result PoseGraph3D::ComputeConstraintsForNode(
     const auto& constant_data =
         data_.trajectory_nodes.at(node_id).constant_data;
     submap_ids = InitializeGlobalSubmapPoses(
-        node_id.trajectory_id, constant_data->time, insertion_submaps);
+        node_id.trajectory_id, constant_data->time, constant_data->local_pose,
+        insertion_submaps);
     CHECK_EQ(submap_ids.size(), insertion_submaps.size());
     const SubmapId matching_id = submap_ids.front();
     const transform::Rigid3d& local_pose = constant_data->local_pose;
@@ -334,7 +429,7 @@ WorkItem::Result PoseGraph3D::ComputeConstraintsForNode(
       data_.submap_data.at(submap_id).node_ids.emplace(node_id);
       const transform::Rigid3d constraint_transform =
           insertion_submaps[i]->local_pose().inverse() * local_pose;
-      data_.constraints.push_back(Constraint{
+      data_.constraints.Add(Constraint{
           submap_id,
           node_id,
           {constraint_transform, options_.matcher_translation_weight(),
@@ -351,6 +446,17 @@ WorkItem::Result PoseGraph3D::ComputeConstraintsForNode(
         finished_submap_ids.emplace_back(submap_id_data.id);
       }
     }
+    place_descriptor_index_.AddNode(node_id, constant_data->place_descriptor);
+    if (place_descriptor_index_.Contains(node_id)) {
+      std::vector<SubmapId> global_search_submap_ids;
+      for (const SubmapId& submap_id : finished_submap_ids) {
+        if (RequiresGlobalSearch(node_id, submap_id)) {
+          global_search_submap_ids.push_back(submap_id);
+        }
+      }
+      place_descriptor_index_.RankSubmaps(node_id, global_search_submap_ids,
+                                          data_.submap_data);
+    }
     if (newly_finished_submap) {
       const SubmapId newly_finished_submap_id = submap_ids.front();
       InternalSubmapData& finished_submap_data =
@@ -361,8 +467,9 @@ WorkItem::Result PoseGraph3D::ComputeConstraintsForNode(
     }
   }
 
+  LandmarkEstimate landmark_estimate;
   for (const auto& submap_id : finished_submap_ids) {
-    ComputeConstraint(node_id, submap_id);
+    ComputeConstraint(node_id, submap_id, &landmark_estimate);
   }
 
   if (newly_finished_submap) {
@@ -372,7 +479,9 @@ WorkItem::Result PoseGraph3D::ComputeConstraintsForNode(
     for (const auto& node_id_data : optimization_problem_->node_data()) {
       const NodeId& node_id = node_id_data.id;
       if (newly_finished_submap_node_ids.count(node_id) == 0) {
-        ComputeConstraint(node_id, newly_finished_submap_id);
+        LandmarkEstimate old_node_landmark_estimate;
+        ComputeConstraint(node_id, newly_finished_submap_id,
+                          &old_node_landmark_estimate);
       }
     }
   }
@@ -400,6 +509,37 @@ common::Time PoseGraph3D::GetLatestNodeTime(const NodeId& node_id,
   return time;
 }
 
+bool PoseGraph3D::RequiresGlobalSearch(const NodeId& node_id,
+                                       const SubmapId& submap_id) {
+  if (node_id.trajectory_id == submap_id.trajectory_id) {
+    return false;
+  }
+  const common::Time node_time = GetLatestNodeTime(node_id, submap_id);
+  const common::Time last_connection_time =
+      data_.trajectory_connectivity_state.LastConnectionTime(
+          node_id.trajectory_id, submap_id.trajectory_id);
+  return node_time >=
+         last_connection_time +
+             common::FromSeconds(
+                 options_.global_constraint_search_after_n_seconds());
+}
+
+bool PoseGraph3D::ShouldSearchGlobally(const NodeId& node_id,
+                                       const SubmapId& submap_id) {
+  switch (place_descriptor_index_.GetRanking(node_id, submap_id,
+                                             data_.submap_data)) {
+    case PlaceDescriptorIndex::Ranking::kCandidate:
+      kPlaceRecognitionCandidatesMetric->Increment();
+      return true;
+    case PlaceDescriptorIndex::Ranking::kRejected:
+      kPlaceRecognitionRejectedMetric->Increment();
+      return false;
+    case PlaceDescriptorIndex::Ranking::kUnranked:
+      break;
+  }
+  return global_localization_samplers_[node_id.trajectory_id]->Pulse();
+}
+
 void PoseGraph3D::UpdateTrajectoryConnectivity(const Constraint& constraint) {
   CHECK_EQ(constraint.tag, PoseGraphInterface::Constraint::INTER_SUBMAP);
   const common::Time time =
@@ -407,6 +547,74 @@ void PoseGraph3D::UpdateTrajectoryConnectivity(const Constraint& constraint) {
   data_.trajectory_connectivity_state.Connect(
       constraint.node_id.trajectory_id, constraint.submap_id.trajectory_id,
       time);
+  if (constraint.node_id.trajectory_id == constraint.submap_id.trajectory_id) {
+    return;
+  }
+  for (const int trajectory_id : {constraint.node_id.trajectory_id,
+                                  constraint.submap_id.trajectory_id}) {
+    const auto it = relocalizations_.find(trajectory_id);
+    if (it == relocalizations_.end()) {
+      continue;
+    }
+    auto* latency_metric = kFullSubmapRelocalizationLatencyMetric;
+    if (it->second.landmark_seeded) {
+      latency_metric = kLandmarkRelocalizationLatencyMetric;
+    } else if (it->second.fixed_frame_seeded) {
+      latency_metric = kFixedFrameRelocalizationLatencyMetric;
+    }
+    latency_metric->Observe(
+        std::max(0., common::ToSeconds(time - it->second.start_time)));
+    relocalizations_.erase(it);
+  }
+}
+
+absl::optional<transform::Rigid3d>
+PoseGraph3D::EstimateGlobalNodePoseFromLandmarks(const NodeId& node_id) const {
+  if (!options_.has_landmark_relocalization()) {
+    return absl::nullopt;
+  }
+  const std::vector<transform::Rigid3d> global_node_poses =
+      landmark_index_.EstimateGlobalNodePoses(
+          node_id, data_.trajectory_nodes,
+          common::FromSeconds(options_.landmark_relocalization()
+                                  .max_observation_time_difference()));
+  if (global_node_poses.empty()) {
+    return absl::nullopt;
+  }
+  return global_node_poses.front();
+}
+
+absl::optional<transform::Rigid3d>
+PoseGraph3D::EstimateGlobalNodePoseFromFixedFrame(
+    const int trajectory_id, const common::Time time,
+    const int reference_trajectory_id,
+    const transform::Rigid3d& global_node_pose) const {
+  const auto& optimization_options = options_.optimization_problem_options();
+  if (!options_.has_fixed_frame_aided_search() ||
+      optimization_options.fixed_frame_pose_translation_weight() <= 0.) {
+    return absl::nullopt;
+  }
+  const auto& trajectory_data = optimization_problem_->trajectory_data();
+  const auto it = trajectory_data.find(reference_trajectory_id);
+  if (it == trajectory_data.end() ||
+      !it->second.fixed_frame_origin_in_map.has_value()) {
+    return absl::nullopt;
+  }
+  const absl::optional<transform::Rigid3d> fixed_frame_pose =
+      LookupFixedFramePose(
+          optimization_problem_->fixed_frame_pose_data(), trajectory_id, time,
+          common::FromSeconds(
+              options_.fixed_frame_aided_search().max_time_difference()));
+  if (!fixed_frame_pose.has_value()) {
+    return absl::nullopt;
+  }
+  const transform::Rigid3d fixed_frame_global_node_pose =
+      it->second.fixed_frame_origin_in_map.value() * fixed_frame_pose.value();
+  if (optimization_options.fixed_frame_pose_rotation_weight() <= 0.) {
+    return transform::Rigid3d(fixed_frame_global_node_pose.translation(),
+                              global_node_pose.rotation());
+  }
+  return fixed_frame_global_node_pose;
 }
 
 void PoseGraph3D::DeleteTrajectoriesIfNeeded() {
@@ -422,6 +630,7 @@ void PoseGraph3D::DeleteTrajectoriesIfNeeded() {
       }
       it.second.state = TrajectoryState::DELETED;
       it.second.deletion_state = InternalTrajectoryState::DeletionState::NORMAL;
+      relocalizations_.erase(it.first);
     }
   }
 }
@@ -430,8 +639,9 @@ void PoseGraph3D::HandleWorkQueue(
     const constraints::ConstraintBuilder3D::Result& result) {
   {
     absl::MutexLock locker(&mutex_);
-    data_.constraints.insert(data_.constraints.end(), result.begin(),
-                             result.end());
+    for (const Constraint& constraint : result) {
+      data_.constraints.Add(constraint);
+    }
   }
   RunOptimization();
 
@@ -480,23 +690,10 @@ void PoseGraph3D::HandleWorkQueue(
     num_nodes_since_last_loop_closure_ = 0;
 
     // Update the gauges that count the current number of constraints.
-    double inter_constraints_same_trajectory = 0;
-    double inter_constraints_different_trajectory = 0;
-    for (const auto& constraint : data_.constraints) {
-      if (constraint.tag ==
-          cartographer::mapping::PoseGraph::Constraint::INTRA_SUBMAP) {
-        continue;
-      }
-      if (constraint.node_id.trajectory_id ==
-          constraint.submap_id.trajectory_id) {
-        ++inter_constraints_same_trajectory;
-      } else {
-        ++inter_constraints_different_trajectory;
-      }
-    }
-    kConstraintsSameTrajectoryMetric->Set(inter_constraints_same_trajectory);
+    kConstraintsSameTrajectoryMetric->Set(
+        data_.constraints.num_inter_submap_constraints_same_trajectory());
     kConstraintsDifferentTrajectoryMetric->Set(
-        inter_constraints_different_trajectory);
+        data_.constraints.num_inter_submap_constraints_different_trajectory());
   }
 
   DrainWorkQueue();
@@ -575,8 +772,9 @@ void PoseGraph3D::WaitForAllComputations() {
        &notification](const constraints::ConstraintBuilder3D::Result& result)
           LOCKS_EXCLUDED(mutex_) {
             absl::MutexLock locker(&mutex_);
-            data_.constraints.insert(data_.constraints.end(), result.begin(),
-                                     result.end());
+            for (const Constraint& constraint : result) {
+              data_.constraints.Add(constraint);
+            }
             notification = true;
           });
   const auto predicate = [&notification]() EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
@@ -621,6 +819,7 @@ void PoseGraph3D::FinishTrajectory(const int trajectory_id) {
     absl::MutexLock locker(&mutex_);
     CHECK(!IsTrajectoryFinished(trajectory_id));
     data_.trajectories_state[trajectory_id].state = TrajectoryState::FINISHED;
+    relocalizations_.erase(trajectory_id);
 
     for (const auto& submap : data_.submap_data.trajectory(trajectory_id)) {
       data_.submap_data.at(submap.id).state = SubmapState::kFinished;
@@ -711,6 +910,7 @@ void PoseGraph3D::AddNodeFromProto(const transform::Rigid3d& global_pose,
     absl::MutexLock locker(&mutex_);
     const auto& constant_data =
         data_.trajectory_nodes.at(node_id).constant_data;
+    place_descriptor_index_.AddNode(node_id, constant_data->place_descriptor);
     optimization_problem_->InsertTrajectoryNode(
         node_id,
         optimization::NodeSpec3D{constant_data->time, constant_data->local_pose,
@@ -772,7 +972,7 @@ void PoseGraph3D::AddSerializedConstraints(
           UpdateTrajectoryConnectivity(constraint);
           break;
       }
-      data_.constraints.push_back(constraint);
+      data_.constraints.Add(constraint);
     }
     LOG(INFO) << "Loaded " << constraints.size() << " constraints.";
     return WorkItem::Result::kDoNotRunOptimization;
@@ -812,7 +1012,7 @@ void PoseGraph3D::RunFinalOptimization() {
 void PoseGraph3D::LogResidualHistograms() const {
   common::Histogram rotational_residual;
   common::Histogram translational_residual;
-  for (const Constraint& constraint : data_.constraints) {
+  for (const Constraint& constraint : data_.constraints.constraints()) {
     if (constraint.tag == Constraint::Tag::INTRA_SUBMAP) {
       const cartographer::transform::Rigid3d optimized_node_to_map =
           data_.trajectory_nodes.at(constraint.node_id).global_pose;
@@ -844,7 +1044,8 @@ void PoseGraph3D::RunOptimization() {
   // data_.frozen_trajectories and data_.landmark_nodes when executing the
   // Solve. Solve is time consuming, so not taking the mutex before Solve to
   // avoid blocking foreground processing.
-  optimization_problem_->Solve(data_.constraints, GetTrajectoryStates(),
+  optimization_problem_->Solve(data_.constraints.constraints(),
+                               GetTrajectoryStates(),
                                data_.landmark_nodes);
   absl::MutexLock locker(&mutex_);
 
@@ -877,6 +1078,9 @@ void PoseGraph3D::RunOptimization() {
   }
   for (const auto& landmark : optimization_problem_->landmark_data()) {
     data_.landmark_nodes[landmark.first].global_landmark_pose = landmark.second;
+    landmark_index_.SetGlobalLandmarkPose(
+        landmark.first, landmark.second,
+        data_.landmark_nodes.at(landmark.first).frozen);
   }
   data_.global_submap_poses_3d = submap_data;
 
@@ -967,6 +1171,7 @@ void PoseGraph3D::SetLandmarkPose(const std::string& landmark_id,
     absl::MutexLock locker(&mutex_);
     data_.landmark_nodes[landmark_id].global_landmark_pose = global_pose;
     data_.landmark_nodes[landmark_id].frozen = frozen;
+    landmark_index_.SetGlobalLandmarkPose(landmark_id, global_pose, frozen);
     return WorkItem::Result::kDoNotRunOptimization;
   });
 }
@@ -1001,7 +1206,7 @@ PoseGraph3D::GetTrajectoryData() const {
 
 std::vector<PoseGraphInterface::Constraint> PoseGraph3D::constraints() const {
   absl::MutexLock locker(&mutex_);
-  return data_.constraints;
+  return data_.constraints.constraints();
 }
 
 void PoseGraph3D::SetInitialTrajectoryPose(const int from_trajectory_id,
@@ -1153,7 +1358,35 @@ PoseGraph3D::TrimmingHandle::GetTrajectoryNodes() const {
 
 const std::vector<PoseGraphInterface::Constraint>&
 PoseGraph3D::TrimmingHandle::GetConstraints() const {
-  return parent_->data_.constraints;
+  return parent_->data_.constraints.constraints();
+}
+
+std::vector<PoseGraphInterface::Constraint>
+PoseGraph3D::TrimmingHandle::GetSubmapConstraints(
+    const SubmapId& submap_id) const {
+  const ConstraintStore& constraints = parent_->data_.constraints;
+  std::vector<Constraint> submap_constraints;
+  for (const ConstraintStore::Handle handle :
+       constraints.GetSubmapConstraints(submap_id)) {
+    submap_constraints.push_back(constraints.at(handle));
+  }
+  return submap_constraints;
+}
+
+size_t PoseGraph3D::TrimmingHandle::EstimateSensorDataMemoryUsage(
+    const int trajectory_id) const {
+  const auto& optimization_problem = *parent_->optimization_problem_;
+  const size_t num_imu_data =
+      optimization_problem.imu_data().SizeOfTrajectoryOrZero(trajectory_id);
+  const size_t num_odometry_data =
+      optimization_problem.odometry_data().SizeOfTrajectoryOrZero(
+          trajectory_id);
+  const size_t num_fixed_frame_pose_data =
+      optimization_problem.fixed_frame_pose_data().SizeOfTrajectoryOrZero(
+          trajectory_id);
+  return num_imu_data * sizeof(sensor::ImuData) +
+         num_odometry_data * sizeof(sensor::OdometryData) +
+         num_fixed_frame_pose_data * sizeof(sensor::FixedFramePoseData);
 }
 
 bool PoseGraph3D::TrimmingHandle::IsFinished(const int trajectory_id) const {
@@ -1171,42 +1404,39 @@ void PoseGraph3D::TrimmingHandle::TrimSubmap(const SubmapId& submap_id) {
   CHECK(parent_->data_.submap_data.at(submap_id).state ==
         SubmapState::kFinished);
 
-  // Compile all nodes that are still INTRA_SUBMAP constrained once the submap
-  // with 'submap_id' is gone.
-  std::set<NodeId> nodes_to_retain;
-  for (const Constraint& constraint : parent_->data_.constraints) {
-    if (constraint.tag == Constraint::Tag::INTRA_SUBMAP &&
-        constraint.submap_id != submap_id) {
-      nodes_to_retain.insert(constraint.node_id);
-    }
-  }
-  // Remove all 'data_.constraints' related to 'submap_id'.
+  // Compile all nodes that are no longer INTRA_SUBMAP constrained once the
+  // submap with 'submap_id' is gone.
+  ConstraintStore& constraints = parent_->data_.constraints;
+  const std::vector<ConstraintStore::Handle> submap_constraints =
+      constraints.GetSubmapConstraints(submap_id);
   std::set<NodeId> nodes_to_remove;
-  {
-    std::vector<Constraint> constraints;
-    for (const Constraint& constraint : parent_->data_.constraints) {
-      if (constraint.submap_id == submap_id) {
-        if (constraint.tag == Constraint::Tag::INTRA_SUBMAP &&
-            nodes_to_retain.count(constraint.node_id) == 0) {
-          // This node will no longer be INTRA_SUBMAP contrained and has to be
-          // removed.
-          nodes_to_remove.insert(constraint.node_id);
-        }
-      } else {
-        constraints.push_back(constraint);
-      }
+  for (const ConstraintStore::Handle handle : submap_constraints) {
+    const Constraint& constraint = constraints.at(handle);
+    if (constraint.tag != Constraint::Tag::INTRA_SUBMAP) continue;
+    const std::vector<ConstraintStore::Handle>& node_constraints =
+        constraints.GetNodeConstraints(constraint.node_id);
+    if (std::none_of(node_constraints.begin(), node_constraints.end(),
+                     [&](const ConstraintStore::Handle node_handle) {
+                       const Constraint& node_constraint =
+                           constraints.at(node_handle);
+                       return node_constraint.tag ==
+                                  Constraint::Tag::INTRA_SUBMAP &&
+                              node_constraint.submap_id != submap_id;
+                     })) {
+      nodes_to_remove.insert(constraint.node_id);
     }
-    parent_->data_.constraints = std::move(constraints);
   }
-  // Remove all 'data_.constraints' related to 'nodes_to_remove'.
-  {
-    std::vector<Constraint> constraints;
-    for (const Constraint& constraint : parent_->data_.constraints) {
-      if (nodes_to_remove.count(constraint.node_id) == 0) {
-        constraints.push_back(constraint);
-      }
+  // Remove all 'data_.constraints' related to 'submap_id' and to
+  // 'nodes_to_remove'.
+  for (const ConstraintStore::Handle handle : submap_constraints) {
+    constraints.Remove(handle);
+  }
+  for (const NodeId& node_id : nodes_to_remove) {
+    const std::vector<ConstraintStore::Handle> node_constraints =
+        constraints.GetNodeConstraints(node_id);
+    for (const ConstraintStore::Handle handle : node_constraints) {
+      constraints.Remove(handle);
     }
-    parent_->data_.constraints = std::move(constraints);
   }
 
   // Mark the submap with 'submap_id' as trimmed and remove its data.
@@ -1229,6 +1459,7 @@ void PoseGraph3D::TrimmingHandle::TrimSubmap(const SubmapId& submap_id) {
   for (const NodeId& node_id : nodes_to_remove) {
     parent_->data_.trajectory_nodes.Trim(node_id);
     parent_->optimization_problem_->TrimTrajectoryNode(node_id);
+    parent_->place_descriptor_index_.TrimNode(node_id);
   }
 }
 
@@ -1264,6 +1495,37 @@ void PoseGraph3D::RegisterMetrics(metrics::FamilyFactory* family_factory) {
   kActiveSubmapsMetric = submaps->Add({{"state", "active"}});
   kFrozenSubmapsMetric = submaps->Add({{"state", "frozen"}});
   kDeletedSubmapsMetric = submaps->Add({{"state", "deleted"}});
+  auto* landmark_seeded_searches = family_factory->NewCounterFamily(
+      "mapping_3d_pose_graph_landmark_seeded_searches",
+      "Constraint searches of unconnected nodes seeded by landmarks");
+  kLandmarkSeededSearchesMetric = landmark_seeded_searches->Add({});
+  auto* fixed_frame_seeded_searches = family_factory->NewCounterFamily(
+      "mapping_3d_pose_graph_fixed_frame_seeded_searches",
+      "Constraint searches of unconnected nodes seeded by fixed frame poses");
+  kFixedFrameSeededSearchesMetric = fixed_frame_seeded_searches->Add({});
+  auto* fixed_frame_pre_aligned_trajectories =
+      family_factory->NewCounterFamily(
+          "mapping_3d_pose_graph_fixed_frame_pre_aligned_trajectories",
+          "New trajectories pre-aligned to the map by fixed frame poses");
+  kFixedFramePreAlignedTrajectoriesMetric =
+      fixed_frame_pre_aligned_trajectories->Add({});
+  auto* place_recognition_searches = family_factory->NewCounterFamily(
+      "mapping_3d_pose_graph_place_recognition_searches",
+      "Global searches decided by place descriptor ranking");
+  kPlaceRecognitionCandidatesMetric =
+      place_recognition_searches->Add({{"ranking", "candidate"}});
+  kPlaceRecognitionRejectedMetric =
+      place_recognition_searches->Add({{"ranking", "rejected"}});
+  auto* relocalization_latency = family_factory->NewHistogramFamily(
+      "mapping_3d_pose_graph_relocalization_latency",
+      "Sensor time in seconds until an unconnected trajectory is connected",
+      metrics::Histogram::ScaledPowersOf(2, 0.1, 600));
+  kLandmarkRelocalizationLatencyMetric =
+      relocalization_latency->Add({{"seed", "landmark"}});
+  kFixedFrameRelocalizationLatencyMetric =
+      relocalization_latency->Add({{"seed", "fixed_frame"}});
+  kFullSubmapRelocalizationLatencyMetric =
+      relocalization_latency->Add({{"seed", "none"}});
 }
 
 }  // namespace mapping
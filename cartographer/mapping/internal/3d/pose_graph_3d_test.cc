@@ -323,6 +323,38 @@ TEST_F(PoseGraph3DTest, EvenSubmapTrimmer) {
   }
 }
 
+TEST_F(PoseGraph3DTest, PreAlignsTrajectoryToFixedFrame) {
+  pose_graph_options_.mutable_fixed_frame_aided_search()
+      ->set_max_time_difference(1.);
+  BuildPoseGraphWithFakeOptimization();
+  proto::TrajectoryData trajectory_data;
+  trajectory_data.set_trajectory_id(0);
+  *trajectory_data.mutable_fixed_frame_origin_in_map() =
+      transform::ToProto(Rigid3d::Translation(Eigen::Vector3d(10., 0., 0.)));
+  pose_graph_->SetTrajectoryDataFromProto(trajectory_data);
+
+  const int trajectory_id = 1;
+  const common::Time time = common::FromUniversal(1000);
+  pose_graph_->AddFixedFramePoseData(
+      trajectory_id,
+      sensor::FixedFramePoseData{
+          time, Rigid3d::Translation(Eigen::Vector3d(1., 2., 0.))});
+  // The node is not between two fixed frame poses, but close enough to the
+  // only one.
+  auto constant_data = std::make_shared<TrajectoryNode::Data>();
+  constant_data->time = time + common::FromSeconds(0.5);
+  constant_data->gravity_alignment = Eigen::Quaterniond::Identity();
+  constant_data->rotational_scan_matcher_histogram = Eigen::VectorXf::Zero(1);
+  constant_data->local_pose = Rigid3d::Identity();
+  const auto submap = std::make_shared<const Submap3D>(
+      0.1f, 1.f, Rigid3d::Identity(), Eigen::VectorXf::Zero(1));
+  pose_graph_->AddNode(constant_data, trajectory_id, {submap});
+  pose_graph_->RunFinalOptimization();
+  EXPECT_THAT(pose_graph_->GetLocalToGlobalTransform(trajectory_id),
+              transform::IsNearly(
+                  Rigid3d::Translation(Eigen::Vector3d(11., 2., 0.)), 1e-9));
+}
+
 }  // namespace
 }  // namespace mapping
 }  // namespace cartographer
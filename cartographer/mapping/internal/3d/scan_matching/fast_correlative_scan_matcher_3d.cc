@@ -20,6 +20,7 @@
 #include <cmath>
 #include <functional>
 #include <limits>
+#include <utility>
 
 #include "Eigen/Geometry"
 #include "absl/memory/memory.h"
@@ -78,8 +79,10 @@ PrecomputationGridStack3D::PrecomputationGridStack3D(
 
 struct DiscreteScan3D {
   transform::Rigid3f pose;
-  // Contains a vector of discretized scans for each 'depth'.
-  std::vector<std::vector<Eigen::Array3i>> cell_indices_per_depth;
+  // Contains a vector of discretized scans for each resolution reduction
+  // exponent. Depths below 'full_resolution_depth' share the full resolution
+  // scan at index 0.
+  std::vector<std::vector<Eigen::Array3i>> cell_indices_per_reduction_exponent;
   float rotational_score;
 };
 
@@ -129,12 +132,25 @@ FastCorrelativeScanMatcher3D::Match(
     const transform::Rigid3d& global_node_pose,
     const transform::Rigid3d& global_submap_pose,
     const TrajectoryNode::Data& constant_data, const float min_score) const {
+  return Match(global_node_pose, global_submap_pose, constant_data,
+               SearchWindow{options_.linear_xy_search_window(),
+                            options_.linear_z_search_window(),
+                            options_.angular_search_window()},
+               min_score);
+}
+
+std::unique_ptr<FastCorrelativeScanMatcher3D::Result>
+FastCorrelativeScanMatcher3D::Match(
+    const transform::Rigid3d& global_node_pose,
+    const transform::Rigid3d& global_submap_pose,
+    const TrajectoryNode::Data& constant_data,
+    const SearchWindow& search_window, const float min_score) const {
   const auto low_resolution_matcher = scan_matching::CreateLowResolutionMatcher(
       low_resolution_hybrid_grid_, &constant_data.low_resolution_point_cloud);
   const SearchParameters search_parameters{
-      common::RoundToInt(options_.linear_xy_search_window() / resolution_),
-      common::RoundToInt(options_.linear_z_search_window() / resolution_),
-      options_.angular_search_window(), &low_resolution_matcher};
+      common::RoundToInt(search_window.linear_xy_search_window / resolution_),
+      common::RoundToInt(search_window.linear_z_search_window / resolution_),
+      search_window.angular_search_window, &low_resolution_matcher};
   return MatchWithSearchParameters(
       search_parameters, global_node_pose.cast<float>(),
       global_submap_pose.cast<float>(),
@@ -201,46 +217,48 @@ DiscreteScan3D FastCorrelativeScanMatcher3D::DiscretizeScan(
     const FastCorrelativeScanMatcher3D::SearchParameters& search_parameters,
     const sensor::PointCloud& point_cloud, const transform::Rigid3f& pose,
     const float rotational_score) const {
-  std::vector<std::vector<Eigen::Array3i>> cell_indices_per_depth;
-  const PrecomputationGrid3D& original_grid =
-      precomputation_grid_stack_->Get(0);
-  std::vector<Eigen::Array3i> full_resolution_cell_indices;
-  for (const sensor::RangefinderPoint& point :
-       sensor::TransformPointCloud(point_cloud, pose)) {
-    full_resolution_cell_indices.push_back(
-        original_grid.GetCellIndex(point.position));
-  }
   const int full_resolution_depth = std::min(options_.full_resolution_depth(),
                                              options_.branch_and_bound_depth());
   CHECK_GE(full_resolution_depth, 1);
-  for (int i = 0; i != full_resolution_depth; ++i) {
-    cell_indices_per_depth.push_back(full_resolution_cell_indices);
-  }
   const int low_resolution_depth =
       options_.branch_and_bound_depth() - full_resolution_depth;
   CHECK_GE(low_resolution_depth, 0);
+  std::vector<std::vector<Eigen::Array3i>> cell_indices_per_reduction_exponent(
+      1 + low_resolution_depth);
+  const PrecomputationGrid3D& original_grid =
+      precomputation_grid_stack_->Get(0);
+  std::vector<Eigen::Array3i>& full_resolution_cell_indices =
+      cell_indices_per_reduction_exponent[0];
+  full_resolution_cell_indices.reserve(point_cloud.size());
+  for (const sensor::RangefinderPoint& point : point_cloud) {
+    full_resolution_cell_indices.push_back(
+        original_grid.GetCellIndex(pose * point.position));
+  }
   const Eigen::Array3i search_window_start(
       -search_parameters.linear_xy_window_size,
       -search_parameters.linear_xy_window_size,
       -search_parameters.linear_z_window_size);
-  for (int i = 0; i != low_resolution_depth; ++i) {
-    const int reduction_exponent = i + 1;
+  for (int reduction_exponent = 1; reduction_exponent <= low_resolution_depth;
+       ++reduction_exponent) {
     const Eigen::Array3i low_resolution_search_window_start(
         search_window_start[0] >> reduction_exponent,
         search_window_start[1] >> reduction_exponent,
         search_window_start[2] >> reduction_exponent);
-    cell_indices_per_depth.emplace_back();
+    std::vector<Eigen::Array3i>& low_resolution_cell_indices =
+        cell_indices_per_reduction_exponent[reduction_exponent];
+    low_resolution_cell_indices.reserve(full_resolution_cell_indices.size());
     for (const Eigen::Array3i& cell_index : full_resolution_cell_indices) {
       const Eigen::Array3i cell_at_start = cell_index + search_window_start;
       const Eigen::Array3i low_resolution_cell_at_start(
           cell_at_start[0] >> reduction_exponent,
           cell_at_start[1] >> reduction_exponent,
           cell_at_start[2] >> reduction_exponent);
-      cell_indices_per_depth.back().push_back(
+      low_resolution_cell_indices.push_back(
           low_resolution_cell_at_start - low_resolution_search_window_start);
     }
   }
-  return DiscreteScan3D{pose, cell_indices_per_depth, rotational_score};
+  return DiscreteScan3D{pose, std::move(cell_indices_per_reduction_exponent),
+                        rotational_score};
 }
 
 std::vector<DiscreteScan3D> FastCorrelativeScanMatcher3D::GenerateDiscreteScans(
@@ -334,21 +352,24 @@ void FastCorrelativeScanMatcher3D::ScoreCandidates(
     std::vector<Candidate3D>* const candidates) const {
   const int reduction_exponent =
       std::max(0, depth - options_.full_resolution_depth() + 1);
+  const PrecomputationGrid3D& precomputation_grid =
+      precomputation_grid_stack_->Get(depth);
   for (Candidate3D& candidate : *candidates) {
     int sum = 0;
     const DiscreteScan3D& discrete_scan = discrete_scans[candidate.scan_index];
     const Eigen::Array3i offset(candidate.offset[0] >> reduction_exponent,
                                 candidate.offset[1] >> reduction_exponent,
                                 candidate.offset[2] >> reduction_exponent);
-    CHECK_LT(depth, discrete_scan.cell_indices_per_depth.size());
-    for (const Eigen::Array3i& cell_index :
-         discrete_scan.cell_indices_per_depth[depth]) {
+    CHECK_LT(reduction_exponent,
+             discrete_scan.cell_indices_per_reduction_exponent.size());
+    const std::vector<Eigen::Array3i>& cell_indices =
+        discrete_scan.cell_indices_per_reduction_exponent[reduction_exponent];
+    for (const Eigen::Array3i& cell_index : cell_indices) {
       const Eigen::Array3i proposed_cell_index = cell_index + offset;
-      sum += precomputation_grid_stack_->Get(depth).value(proposed_cell_index);
+      sum += precomputation_grid.value(proposed_cell_index);
     }
     candidate.score = PrecomputationGrid3D::ToProbability(
-        sum /
-        static_cast<float>(discrete_scan.cell_indices_per_depth[depth].size()));
+        sum / static_cast<float>(cell_indices.size()));
   }
   std::sort(candidates->begin(), candidates->end(),
             std::greater<Candidate3D>());
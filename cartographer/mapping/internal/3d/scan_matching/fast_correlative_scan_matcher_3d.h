@@ -72,6 +72,13 @@ class FastCorrelativeScanMatcher3D {
     float low_resolution_score;
   };
 
+  // Extents of a search around an initial pose estimate.
+  struct SearchWindow {
+    double linear_xy_search_window;  // meters
+    double linear_z_search_window;   // meters
+    double angular_search_window;    // radians
+  };
+
   FastCorrelativeScanMatcher3D(
       const HybridGrid& hybrid_grid,
       const HybridGrid* low_resolution_hybrid_grid,
@@ -91,6 +98,14 @@ class FastCorrelativeScanMatcher3D {
                                 const TrajectoryNode::Data& constant_data,
                                 float min_score) const;
 
+  // Like 'Match', but searches the given 'search_window' instead of the one
+  // configured in the options.
+  std::unique_ptr<Result> Match(const transform::Rigid3d& global_node_pose,
+                                const transform::Rigid3d& global_submap_pose,
+                                const TrajectoryNode::Data& constant_data,
+                                const SearchWindow& search_window,
+                                float min_score) const;
+
   // Aligns the node with the given 'constant_data' within the 'hybrid_grid'
   // given rotations which are expected to be approximately gravity aligned.
   // 'Result' is only returned if a score above 'min_score' (excluding equality)
@@ -166,6 +166,43 @@ TEST_F(FastCorrelativeScanMatcher3DTest, CorrectPoseForMatch) {
   }
 }
 
+TEST_F(FastCorrelativeScanMatcher3DTest, MatchRespectsSearchWindow) {
+  const transform::Rigid3f expected_pose =
+      transform::Rigid3f::Translation(Eigen::Vector3f(0.5f, 0.f, 0.f));
+  std::unique_ptr<FastCorrelativeScanMatcher3D> fast_correlative_scan_matcher(
+      GetFastCorrelativeScanMatcher(options_, expected_pose));
+  const FastCorrelativeScanMatcher3D::SearchWindow search_window{0.1, 0.1,
+                                                                 0.05};
+
+  const std::unique_ptr<FastCorrelativeScanMatcher3D::Result> result =
+      fast_correlative_scan_matcher->Match(
+          transform::Rigid3d::Translation(Eigen::Vector3d(0.45, 0.05, 0.)),
+          transform::Rigid3d::Identity(), CreateConstantData(point_cloud_),
+          search_window, kMinScore);
+  ASSERT_THAT(result, testing::NotNull());
+  EXPECT_THAT(expected_pose,
+              transform::IsNearly(result->pose_estimate.cast<float>(), 0.05f))
+      << "Actual: " << transform::ToProto(result->pose_estimate).DebugString()
+      << "\nExpected: " << transform::ToProto(expected_pose).DebugString();
+
+  // The expected pose lies outside of the window around the identity, so the
+  // best match is a worse pose within the window.
+  const std::unique_ptr<FastCorrelativeScanMatcher3D::Result>
+      out_of_window_result = fast_correlative_scan_matcher->Match(
+          transform::Rigid3d::Identity(), transform::Rigid3d::Identity(),
+          CreateConstantData(point_cloud_), search_window, kMinScore);
+  ASSERT_THAT(out_of_window_result, testing::NotNull());
+  const Eigen::Vector3d translation =
+      out_of_window_result->pose_estimate.translation();
+  EXPECT_GE(search_window.linear_xy_search_window + 1e-6,
+            std::abs(translation.x()));
+  EXPECT_GE(search_window.linear_xy_search_window + 1e-6,
+            std::abs(translation.y()));
+  EXPECT_GE(search_window.linear_z_search_window + 1e-6,
+            std::abs(translation.z()));
+  EXPECT_LT(out_of_window_result->score, result->score);
+}
+
 TEST_F(FastCorrelativeScanMatcher3DTest, CorrectPoseForMatchFullSubmap) {
   const auto expected_pose = GetRandomPose();
 
@@ -49,14 +49,17 @@ Eigen::Array3i CellIndexAtHalfResolution(const Eigen::Array3i& cell_index) {
 PrecomputationGrid3D ConvertToPrecomputationGrid(
     const HybridGrid& hybrid_grid) {
   PrecomputationGrid3D result(hybrid_grid.resolution());
-  for (auto it = HybridGrid::Iterator(hybrid_grid); !it.Done(); it.Next()) {
-    const int cell_value = common::RoundToInt(
-        (ValueToProbability(it.GetValue()) - kMinProbability) *
-        (255.f / (kMaxProbability - kMinProbability)));
-    CHECK_GE(cell_value, 0);
-    CHECK_LE(cell_value, 255);
-    *result.mutable_value(it.GetCellIndex()) = cell_value;
-  }
+  hybrid_grid.ForEachBlock([&result](const Eigen::Array3i& block_offset,
+                                     const HybridGrid::BlockType& block) {
+    for (HybridGrid::BlockType::Iterator it(block); !it.Done(); it.Next()) {
+      const int cell_value = common::RoundToInt(
+          (ValueToProbability(it.GetValue()) - kMinProbability) *
+          (255.f / (kMaxProbability - kMinProbability)));
+      CHECK_GE(cell_value, 0);
+      CHECK_LE(cell_value, 255);
+      *result.mutable_value(block_offset + it.GetCellIndex()) = cell_value;
+    }
+  });
   return result;
 }
 
@@ -64,19 +67,26 @@ PrecomputationGrid3D PrecomputeGrid(const PrecomputationGrid3D& grid,
                                     const bool half_resolution,
                                     const Eigen::Array3i& shift) {
   PrecomputationGrid3D result(grid.resolution());
-  for (auto it = PrecomputationGrid3D::Iterator(grid); !it.Done(); it.Next()) {
-    for (int i = 0; i != 8; ++i) {
-      // We use this value to update 8 values in the resulting grid, at
-      // position (x - {0, 'shift'}, y - {0, 'shift'}, z - {0, 'shift'}).
-      // If 'shift' is 2 ** (depth - 1), where depth 0 is the original grid,
-      // this results in precomputation grids analogous to the 2D case.
-      const Eigen::Array3i cell_index =
-          it.GetCellIndex() - shift * PrecomputationGrid3D::GetOctant(i);
-      auto* const cell_value = result.mutable_value(
-          half_resolution ? CellIndexAtHalfResolution(cell_index) : cell_index);
-      *cell_value = std::max(it.GetValue(), *cell_value);
+  grid.ForEachBlock([&](const Eigen::Array3i& block_offset,
+                        const PrecomputationGrid3D::BlockType& block) {
+    for (PrecomputationGrid3D::BlockType::Iterator it(block); !it.Done();
+         it.Next()) {
+      const Eigen::Array3i index = block_offset + it.GetCellIndex();
+      for (int i = 0; i != 8; ++i) {
+        // We use this value to update 8 values in the resulting grid, at
+        // position (x - {0, 'shift'}, y - {0, 'shift'}, z - {0, 'shift'}).
+        // If 'shift' is 2 ** (depth - 1), where depth 0 is the original grid,
+        // this results in precomputation grids analogous to the 2D case.
+        const Eigen::Array3i cell_index =
+            index - shift * PrecomputationGrid3D::GetOctant(i);
+        auto* const cell_value =
+            result.mutable_value(half_resolution
+                                     ? CellIndexAtHalfResolution(cell_index)
+                                     : cell_index);
+        *cell_value = std::max(it.GetValue(), *cell_value);
+      }
     }
-  }
+  });
   return result;
 }
 
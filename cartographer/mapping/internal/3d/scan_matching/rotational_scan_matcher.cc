@@ -16,6 +16,8 @@
 
 #include "cartographer/mapping/internal/3d/scan_matching/rotational_scan_matcher.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <vector>
 
@@ -58,6 +60,47 @@ Eigen::Vector3f ComputeCentroid(const sensor::PointCloud& slice) {
   return sum / static_cast<float>(slice.size());
 }
 
+// Returns a value in [-2, 2] which increases monotonically with the angle
+// 'common::atan2(vector)' in (-pi, pi]. This is enough to sort by angle and
+// cheaper than computing the angle itself.
+float PseudoAngle(const Eigen::Vector2f& vector) {
+  const float ratio =
+      vector.y() / (std::abs(vector.x()) + std::abs(vector.y()));
+  if (vector.x() >= 0.f) {
+    return ratio;
+  }
+  return vector.y() >= 0.f ? 2.f - ratio : -2.f - ratio;
+}
+
+// Returns the angle of 'vector' modulo pi in [0, pi]. Approximates the arc
+// tangent by a polynomial with an absolute error below 1e-5.
+float ApproximateAngleModuloPi(Eigen::Vector2f vector) {
+  // A vector and its inverse represent the same angle modulo pi.
+  if (vector.y() < 0.f) {
+    vector = -vector;
+  }
+  const float abs_x = std::abs(vector.x());
+  const bool is_steep = vector.y() > abs_x;
+  const float ratio = is_steep ? abs_x / vector.y() : vector.y() / abs_x;
+  // Minimax polynomial of atan on [0, 1] in powers of 'ratio' squared, highest
+  // order first.
+  constexpr float kCoefficients[] = {-0.01172120f, 0.05265332f, -0.11643287f,
+                                     0.19354346f,  -0.33262347f, 0.99997726f};
+  const float ratio_squared = ratio * ratio;
+  float angle = 0.f;
+  for (const float coefficient : kCoefficients) {
+    angle = angle * ratio_squared + coefficient;
+  }
+  angle *= ratio;
+  if (is_steep) {
+    angle = static_cast<float>(M_PI_2) - angle;
+  }
+  if (vector.x() < 0.f) {
+    angle = static_cast<float>(M_PI) - angle;
+  }
+  return angle;
+}
+
 void AddPointCloudSliceToHistogram(const sensor::PointCloud& slice,
                                    Eigen::VectorXf* const histogram) {
   if (slice.empty()) {
@@ -74,17 +117,18 @@ void AddPointCloudSliceToHistogram(const sensor::PointCloud& slice,
         (point.position - last_point_position).head<2>();
     const Eigen::Vector2f direction = (point.position - centroid).head<2>();
     const float distance = delta.norm();
-    if (distance < kMinDistance || direction.norm() < kMinDistance) {
+    const float direction_norm = direction.norm();
+    if (distance < kMinDistance || direction_norm < kMinDistance) {
       continue;
     }
     if (distance > kMaxDistance) {
       last_point_position = point.position;
       continue;
     }
-    const float angle = common::atan2(delta);
-    const float value = std::max(
-        0.f, 1.f - std::abs(delta.normalized().dot(direction.normalized())));
-    AddValueToHistogram(angle, value, histogram);
+    const float value =
+        std::max(0.f, 1.f - std::abs(delta.dot(direction)) /
+                                (distance * direction_norm));
+    AddValueToHistogram(ApproximateAngleModuloPi(delta), value, histogram);
   }
 }
 
@@ -105,13 +149,14 @@ sensor::PointCloud SortSlice(const sensor::PointCloud& slice) {
   by_angle.reserve(slice.size());
   for (const sensor::RangefinderPoint& point : slice) {
     const Eigen::Vector2f delta = (point.position - centroid).head<2>();
-    if (delta.norm() < kMinDistance) {
+    if (delta.squaredNorm() < kMinDistance * kMinDistance) {
       continue;
     }
-    by_angle.push_back(SortableAnglePointPair{common::atan2(delta), point});
+    by_angle.push_back(SortableAnglePointPair{PseudoAngle(delta), point});
   }
   std::sort(by_angle.begin(), by_angle.end());
   sensor::PointCloud result;
+  result.reserve(by_angle.size());
   for (const auto& pair : by_angle) {
     result.push_back(pair.point);
   }
@@ -16,8 +16,11 @@
 
 #include "cartographer/mapping/internal/3d/scan_matching/rotational_scan_matcher.h"
 
+#include <algorithm>
 #include <cmath>
+#include <random>
 
+#include "cartographer/transform/transform.h"
 #include "gtest/gtest.h"
 
 namespace cartographer {
@@ -66,6 +69,71 @@ TEST(RotationalScanMatcher3DTest, InterpolatesAsExpected) {
   }
 }
 
+// Returns points on the walls of a box shaped room in the order of a
+// rangefinder rotating counterclockwise, starting at 'start_angle'.
+sensor::PointCloud CreateRoomScan(const float start_angle) {
+  constexpr int kNumPointsPerRevolution = 720;
+  constexpr float kHalfWidth = 4.f;
+  constexpr float kHalfLength = 7.f;
+  sensor::PointCloud scan;
+  for (float z = -0.5f; z < 0.6f; z += 0.25f) {
+    for (int i = 0; i != kNumPointsPerRevolution; ++i) {
+      const float angle =
+          start_angle + 2.f * M_PI * i / kNumPointsPerRevolution;
+      const Eigen::Vector2f direction(std::cos(angle), std::sin(angle));
+      const float range = std::min(kHalfLength / std::abs(direction.x()),
+                                   kHalfWidth / std::abs(direction.y()));
+      scan.push_back({Eigen::Vector3f(range * direction.x(),
+                                      range * direction.y(), z)});
+    }
+  }
+  return scan;
+}
+
+TEST(RotationalScanMatcher3DTest, HistogramDoesNotDependOnPointOrder) {
+  constexpr int kHistogramSize = 120;
+  const sensor::PointCloud scan = CreateRoomScan(1.f);
+  const Eigen::VectorXf histogram =
+      RotationalScanMatcher::ComputeHistogram(scan, kHistogramSize);
+  EXPECT_GT(histogram.sum(), 0.f);
+  sensor::PointCloud shuffled_scan = scan;
+  std::mt19937 prng(42);
+  std::shuffle(shuffled_scan.begin(), shuffled_scan.end(), prng);
+  const Eigen::VectorXf shuffled_histogram =
+      RotationalScanMatcher::ComputeHistogram(shuffled_scan, kHistogramSize);
+  EXPECT_NEAR(0.f, (histogram - shuffled_histogram).norm(),
+              1e-3f * histogram.norm());
+}
+
+TEST(RotationalScanMatcher3DTest, MatchesRotatedScan) {
+  constexpr int kHistogramSize = 120;
+  constexpr float kAnglePerBucket = M_PI / kHistogramSize;
+  // Rotate by a whole number of buckets and keep the walls in the middle of
+  // a bucket.
+  constexpr float kAngle = 10.f * kAnglePerBucket;
+  const auto rotate = [](const sensor::PointCloud& scan, const float angle) {
+    const transform::Rigid3f rotation = transform::Rigid3f::Rotation(
+        Eigen::AngleAxisf(angle, Eigen::Vector3f::UnitZ()));
+    sensor::PointCloud result;
+    for (const sensor::RangefinderPoint& point : scan) {
+      result.push_back(rotation * point);
+    }
+    return result;
+  };
+  const sensor::PointCloud scan =
+      rotate(CreateRoomScan(0.f), 0.5f * kAnglePerBucket);
+  const Eigen::VectorXf histogram =
+      RotationalScanMatcher::ComputeHistogram(scan, kHistogramSize);
+  const Eigen::VectorXf rotated_histogram =
+      RotationalScanMatcher::ComputeHistogram(rotate(scan, kAngle),
+                                              kHistogramSize);
+  RotationalScanMatcher matcher(&histogram);
+  const auto scores = matcher.Match(rotated_histogram, 0.f, {-kAngle, 0.f});
+  ASSERT_EQ(2, scores.size());
+  EXPECT_NEAR(1.f, scores[0], 1e-2f);
+  EXPECT_GT(scores[0], scores[1]);
+}
+
 }  // namespace
 }  // namespace scan_matching
 }  // namespace mapping
@@ -30,10 +30,12 @@ constexpr double kSensorDataRatesLoggingPeriodSeconds = 15.;
 
 CollatedTrajectoryBuilder::CollatedTrajectoryBuilder(
     const proto::TrajectoryBuilderOptions& trajectory_options,
-    sensor::CollatorInterface* const sensor_collator, const int trajectory_id,
-    const std::set<SensorId>& expected_sensor_ids,
+    sensor::CollatorInterface* const sensor_collator,
+    TrajectoryBuilderThread* const trajectory_builder_thread,
+    const int trajectory_id, const std::set<SensorId>& expected_sensor_ids,
     std::unique_ptr<TrajectoryBuilderInterface> wrapped_trajectory_builder)
     : sensor_collator_(sensor_collator),
+      trajectory_builder_thread_(trajectory_builder_thread),
       collate_landmarks_(trajectory_options.collate_landmarks()),
       collate_fixed_frame_(trajectory_options.collate_fixed_frame()),
       trajectory_id_(trajectory_id),
@@ -51,14 +53,38 @@ CollatedTrajectoryBuilder::CollatedTrajectoryBuilder(
     }
     expected_sensor_id_strings.insert(sensor_id.id);
   }
-  sensor_collator_->AddTrajectory(
-      trajectory_id, expected_sensor_id_strings,
-      [this](const std::string& sensor_id, std::unique_ptr<sensor::Data> data) {
-        HandleCollatedSensorData(sensor_id, std::move(data));
-      });
+  const auto add_trajectory = [this, &expected_sensor_id_strings]() {
+    sensor_collator_->AddTrajectory(
+        trajectory_id_, expected_sensor_id_strings,
+        [this](const std::string& sensor_id,
+               std::unique_ptr<sensor::Data> data) {
+          HandleCollatedSensorData(sensor_id, std::move(data));
+        });
+  };
+  if (trajectory_builder_thread_ == nullptr) {
+    add_trajectory();
+    return;
+  }
+  const auto add_to_collator = [this](std::unique_ptr<sensor::Data> data) {
+    sensor_collator_->AddSensorData(trajectory_id_, std::move(data));
+  };
+  for (const std::string& sensor_id : expected_sensor_id_strings) {
+    sensor_queues_[sensor_id] = trajectory_builder_thread_->AddSensorQueue(
+        trajectory_id_, add_to_collator);
+  }
+  unexpected_sensor_queue_ = trajectory_builder_thread_->AddSensorQueue(
+      trajectory_id_, add_to_collator);
+  // The collator is used by the thread.
+  trajectory_builder_thread_->RunExclusively(add_trajectory);
 }
 
 void CollatedTrajectoryBuilder::AddData(std::unique_ptr<sensor::Data> data) {
+  if (trajectory_builder_thread_ != nullptr) {
+    const auto it = sensor_queues_.find(data->GetSensorId());
+    (it != sensor_queues_.end() ? it->second : unexpected_sensor_queue_)
+        ->Push(std::move(data));
+    return;
+  }
   sensor_collator_->AddSensorData(trajectory_id_, std::move(data));
 }
 
@@ -23,8 +23,10 @@
 #include <set>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "cartographer/common/port.h"
 #include "cartographer/common/rate_timer.h"
+#include "cartographer/mapping/internal/trajectory_builder_thread.h"
 #include "cartographer/mapping/local_slam_result_data.h"
 #include "cartographer/mapping/submaps.h"
 #include "cartographer/mapping/trajectory_builder_interface.h"
@@ -36,13 +38,18 @@ namespace mapping {
 
 // Collates sensor data using a sensor::CollatorInterface, then passes it on to
 // a mapping::TrajectoryBuilderInterface which is common for 2D and 3D.
+//
+// If a 'trajectory_builder_thread' is given, data to be collated is handed
+// over to it, and collation and everything downstream runs on that thread.
+// In this case, it has to be the same for all users of 'sensor_collator'.
 class CollatedTrajectoryBuilder : public TrajectoryBuilderInterface {
  public:
   using SensorId = TrajectoryBuilderInterface::SensorId;
 
   CollatedTrajectoryBuilder(
       const proto::TrajectoryBuilderOptions& trajectory_options,
-      sensor::CollatorInterface* sensor_collator, int trajectory_id,
+      sensor::CollatorInterface* sensor_collator,
+      TrajectoryBuilderThread* trajectory_builder_thread, int trajectory_id,
       const std::set<SensorId>& expected_sensor_ids,
       std::unique_ptr<TrajectoryBuilderInterface> wrapped_trajectory_builder);
   ~CollatedTrajectoryBuilder() override {}
@@ -92,6 +99,11 @@ class CollatedTrajectoryBuilder : public TrajectoryBuilderInterface {
     AddData(std::move(local_slam_result_data));
   }
 
+  absl::optional<transform::Rigid3d> ExtrapolateLocalPose(
+      const common::Time time) const override {
+    return wrapped_trajectory_builder_->ExtrapolateLocalPose(time);
+  }
+
  private:
   void AddData(std::unique_ptr<sensor::Data> data);
 
@@ -99,6 +111,15 @@ class CollatedTrajectoryBuilder : public TrajectoryBuilderInterface {
                                 std::unique_ptr<sensor::Data> data);
 
   sensor::CollatorInterface* const sensor_collator_;
+  TrajectoryBuilderThread* const trajectory_builder_thread_;
+  // Only used with a 'trajectory_builder_thread_'. Not modified after
+  // construction, so concurrent lookups are safe.
+  absl::flat_hash_map<std::string,
+                      std::shared_ptr<TrajectoryBuilderThread::SensorQueue>>
+      sensor_queues_;
+  // Shared by all sensors which were not expected.
+  std::shared_ptr<TrajectoryBuilderThread::SensorQueue>
+      unexpected_sensor_queue_;
   const bool collate_landmarks_;
   const bool collate_fixed_frame_;
   const int trajectory_id_;
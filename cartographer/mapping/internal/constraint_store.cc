@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/constraint_store.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using Handle = ConstraintStore::Handle;
+
+const std::vector<Handle>& GetEmptyHandles() {
+  static const std::vector<Handle>* const kEmptyHandles =
+      new std::vector<Handle>();
+  return *kEmptyHandles;
+}
+
+// Removes 'handle' from the adjacency list of 'id' in 'adjacency'.
+template <typename IdType>
+void RemoveAdjacentHandle(const IdType& id, const Handle handle,
+                          std::map<IdType, std::vector<Handle>>* adjacency) {
+  const auto it = adjacency->find(id);
+  CHECK(it != adjacency->end());
+  std::vector<Handle>& handles = it->second;
+  const auto handle_it = std::find(handles.begin(), handles.end(), handle);
+  CHECK(handle_it != handles.end());
+  *handle_it = handles.back();
+  handles.pop_back();
+  if (handles.empty()) {
+    adjacency->erase(it);
+  }
+}
+
+}  // namespace
+
+ConstraintStore::Handle ConstraintStore::Add(const Constraint& constraint) {
+  Handle handle;
+  if (free_handles_.empty()) {
+    handle = indices_.size();
+    indices_.push_back(-1);
+  } else {
+    handle = free_handles_.back();
+    free_handles_.pop_back();
+  }
+  indices_[handle] = constraints_.size();
+  constraints_.push_back(constraint);
+  handles_.push_back(handle);
+  node_constraints_[constraint.node_id].push_back(handle);
+  submap_constraints_[constraint.submap_id].push_back(handle);
+  UpdateInterSubmapConstraintCounts(constraint, 1);
+  return handle;
+}
+
+void ConstraintStore::Remove(const Handle handle) {
+  const Constraint& constraint = at(handle);
+  UpdateInterSubmapConstraintCounts(constraint, -1);
+  RemoveAdjacentHandle(constraint.node_id, handle, &node_constraints_);
+  RemoveAdjacentHandle(constraint.submap_id, handle, &submap_constraints_);
+
+  const int index = indices_[handle];
+  const Handle last_handle = handles_.back();
+  constraints_[index] = constraints_.back();
+  handles_[index] = last_handle;
+  indices_[last_handle] = index;
+  constraints_.pop_back();
+  handles_.pop_back();
+  indices_[handle] = -1;
+  free_handles_.push_back(handle);
+}
+
+const ConstraintStore::Constraint& ConstraintStore::at(
+    const Handle handle) const {
+  CHECK_GE(handle, 0);
+  CHECK_LT(handle, static_cast<int>(indices_.size()));
+  const int index = indices_[handle];
+  CHECK_NE(index, -1) << "Constraint " << handle << " was removed.";
+  return constraints_[index];
+}
+
+const std::vector<Handle>& ConstraintStore::GetNodeConstraints(
+    const NodeId& node_id) const {
+  const auto it = node_constraints_.find(node_id);
+  return it != node_constraints_.end() ? it->second : GetEmptyHandles();
+}
+
+const std::vector<Handle>& ConstraintStore::GetSubmapConstraints(
+    const SubmapId& submap_id) const {
+  const auto it = submap_constraints_.find(submap_id);
+  return it != submap_constraints_.end() ? it->second : GetEmptyHandles();
+}
+
+void ConstraintStore::UpdateInterSubmapConstraintCounts(
+    const Constraint& constraint, const int delta) {
+  if (constraint.tag != Constraint::INTER_SUBMAP) {
+    return;
+  }
+  if (constraint.node_id.trajectory_id == constraint.submap_id.trajectory_id) {
+    num_inter_submap_constraints_same_trajectory_ += delta;
+  } else {
+    num_inter_submap_constraints_different_trajectory_ += delta;
+  }
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_CONSTRAINT_STORE_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_CONSTRAINT_STORE_H_
+
+#include <map>
+#include <vector>
+
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_interface.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Stores the constraints of a pose graph contiguously, as the optimization
+// consumes them, and indexes them by node and by submap. Constraints are
+// referred to by handles which stay valid until the constraint is removed.
+// Removing a constraint takes constant time plus the number of constraints of
+// its node and its submap.
+//
+// This class is thread-compatible.
+class ConstraintStore {
+ public:
+  using Constraint = PoseGraphInterface::Constraint;
+  // Handles of removed constraints are reused by later additions.
+  using Handle = int;
+
+  ConstraintStore() = default;
+
+  Handle Add(const Constraint& constraint);
+  void Remove(Handle handle);
+
+  const Constraint& at(Handle handle) const;
+
+  // Handles of the constraints of 'node_id' and 'submap_id' respectively. The
+  // returned references are invalidated by 'Add' and 'Remove'.
+  const std::vector<Handle>& GetNodeConstraints(const NodeId& node_id) const;
+  const std::vector<Handle>& GetSubmapConstraints(
+      const SubmapId& submap_id) const;
+
+  // All constraints. 'Remove' moves the last constraint into the place of the
+  // removed one, so the order is only preserved while nothing is removed.
+  const std::vector<Constraint>& constraints() const { return constraints_; }
+  size_t size() const { return constraints_.size(); }
+  bool empty() const { return constraints_.empty(); }
+
+  // Numbers of INTER_SUBMAP constraints between a node and a submap of the
+  // same or of different trajectories.
+  int num_inter_submap_constraints_same_trajectory() const {
+    return num_inter_submap_constraints_same_trajectory_;
+  }
+  int num_inter_submap_constraints_different_trajectory() const {
+    return num_inter_submap_constraints_different_trajectory_;
+  }
+
+ private:
+  void UpdateInterSubmapConstraintCounts(const Constraint& constraint,
+                                         int delta);
+
+  std::vector<Constraint> constraints_;
+  // Handle of the constraint at each index of 'constraints_'.
+  std::vector<Handle> handles_;
+  // Index into 'constraints_' for each handle, or -1 if unused.
+  std::vector<int> indices_;
+  std::vector<Handle> free_handles_;
+  std::map<NodeId, std::vector<Handle>> node_constraints_;
+  std::map<SubmapId, std::vector<Handle>> submap_constraints_;
+  int num_inter_submap_constraints_same_trajectory_ = 0;
+  int num_inter_submap_constraints_different_trajectory_ = 0;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_CONSTRAINT_STORE_H_
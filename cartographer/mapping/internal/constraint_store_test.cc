@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/constraint_store.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using Constraint = ConstraintStore::Constraint;
+using ::testing::UnorderedElementsAre;
+
+Constraint CreateConstraint(const SubmapId& submap_id, const NodeId& node_id,
+                            const Constraint::Tag tag) {
+  return Constraint{submap_id,
+                    node_id,
+                    {transform::Rigid3d::Identity(), 1., 1.},
+                    tag};
+}
+
+TEST(ConstraintStoreTest, IndexesByNodeAndSubmap) {
+  ConstraintStore store;
+  const ConstraintStore::Handle a = store.Add(
+      CreateConstraint({0, 0}, {0, 0}, Constraint::INTRA_SUBMAP));
+  const ConstraintStore::Handle b = store.Add(
+      CreateConstraint({0, 0}, {0, 1}, Constraint::INTRA_SUBMAP));
+  const ConstraintStore::Handle c = store.Add(
+      CreateConstraint({1, 0}, {0, 1}, Constraint::INTER_SUBMAP));
+  EXPECT_EQ(3, store.size());
+  EXPECT_THAT(store.GetSubmapConstraints({0, 0}), UnorderedElementsAre(a, b));
+  EXPECT_THAT(store.GetSubmapConstraints({1, 0}), UnorderedElementsAre(c));
+  EXPECT_THAT(store.GetNodeConstraints({0, 1}), UnorderedElementsAre(b, c));
+  EXPECT_TRUE(store.GetNodeConstraints({2, 0}).empty());
+  EXPECT_EQ(NodeId(0, 1), store.at(c).node_id);
+  EXPECT_EQ(0, store.num_inter_submap_constraints_same_trajectory());
+  EXPECT_EQ(1, store.num_inter_submap_constraints_different_trajectory());
+}
+
+TEST(ConstraintStoreTest, RemoveKeepsOtherHandlesValid) {
+  ConstraintStore store;
+  std::vector<ConstraintStore::Handle> handles;
+  for (int i = 0; i != 5; ++i) {
+    handles.push_back(store.Add(
+        CreateConstraint({0, i % 2}, {0, i}, Constraint::INTER_SUBMAP)));
+  }
+  EXPECT_EQ(5, store.num_inter_submap_constraints_same_trajectory());
+  store.Remove(handles[1]);
+  store.Remove(handles[0]);
+  EXPECT_EQ(3, store.size());
+  EXPECT_EQ(3, store.num_inter_submap_constraints_same_trajectory());
+  for (int i = 2; i != 5; ++i) {
+    EXPECT_EQ(NodeId(0, i), store.at(handles[i]).node_id);
+  }
+  EXPECT_THAT(store.GetSubmapConstraints({0, 0}),
+              UnorderedElementsAre(handles[2], handles[4]));
+  EXPECT_THAT(store.GetSubmapConstraints({0, 1}),
+              UnorderedElementsAre(handles[3]));
+  EXPECT_TRUE(store.GetNodeConstraints({0, 0}).empty());
+
+  std::vector<NodeId> node_ids;
+  for (const Constraint& constraint : store.constraints()) {
+    node_ids.push_back(constraint.node_id);
+  }
+  EXPECT_THAT(node_ids, UnorderedElementsAre(NodeId(0, 2), NodeId(0, 3),
+                                             NodeId(0, 4)));
+
+  // Handles of removed constraints are reused.
+  const ConstraintStore::Handle handle = store.Add(
+      CreateConstraint({0, 1}, {0, 5}, Constraint::INTRA_SUBMAP));
+  EXPECT_TRUE(handle == handles[0] || handle == handles[1]);
+  EXPECT_EQ(NodeId(0, 5), store.at(handle).node_id);
+  EXPECT_EQ(4, store.size());
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -79,6 +79,29 @@ void ConstraintBuilder3D::MaybeAddConstraint(
     const NodeId& node_id, const TrajectoryNode::Data* const constant_data,
     const transform::Rigid3d& global_node_pose,
     const transform::Rigid3d& global_submap_pose) {
+  MaybeAddLocalConstraint(submap_id, submap, node_id, constant_data,
+                          global_node_pose, global_submap_pose, absl::nullopt);
+}
+
+void ConstraintBuilder3D::MaybeAddConstraint(
+    const SubmapId& submap_id, const Submap3D* const submap,
+    const NodeId& node_id, const TrajectoryNode::Data* const constant_data,
+    const transform::Rigid3d& global_node_pose,
+    const transform::Rigid3d& global_submap_pose,
+    const scan_matching::FastCorrelativeScanMatcher3D::SearchWindow&
+        search_window) {
+  MaybeAddLocalConstraint(submap_id, submap, node_id, constant_data,
+                          global_node_pose, global_submap_pose, search_window);
+}
+
+void ConstraintBuilder3D::MaybeAddLocalConstraint(
+    const SubmapId& submap_id, const Submap3D* const submap,
+    const NodeId& node_id, const TrajectoryNode::Data* const constant_data,
+    const transform::Rigid3d& global_node_pose,
+    const transform::Rigid3d& global_submap_pose,
+    const absl::optional<
+        scan_matching::FastCorrelativeScanMatcher3D::SearchWindow>&
+        search_window) {
   if ((global_node_pose.translation() - global_submap_pose.translation())
           .norm() > options_.max_constraint_distance()) {
     return;
@@ -98,7 +121,7 @@ void ConstraintBuilder3D::MaybeAddConstraint(
   constraint_task->SetWorkItem([=]() LOCKS_EXCLUDED(mutex_) {
     ComputeConstraint(submap_id, node_id, false, /* match_full_submap */
                       constant_data, global_node_pose, global_submap_pose,
-                      *scan_matcher, constraint);
+                      search_window, *scan_matcher, constraint);
   });
   constraint_task->AddDependency(scan_matcher->creation_task_handle);
   auto constraint_task_handle =
@@ -126,7 +149,7 @@ void ConstraintBuilder3D::MaybeAddGlobalConstraint(
                       constant_data,
                       transform::Rigid3d::Rotation(global_node_rotation),
                       transform::Rigid3d::Rotation(global_submap_rotation),
-                      *scan_matcher, constraint);
+                      absl::nullopt, *scan_matcher, constraint);
   });
   constraint_task->AddDependency(scan_matcher->creation_task_handle);
   auto constraint_task_handle =
@@ -194,6 +217,9 @@ void ConstraintBuilder3D::ComputeConstraint(
     const TrajectoryNode::Data* const constant_data,
     const transform::Rigid3d& global_node_pose,
     const transform::Rigid3d& global_submap_pose,
+    const absl::optional<
+        scan_matching::FastCorrelativeScanMatcher3D::SearchWindow>&
+        search_window,
     const SubmapScanMatcher& submap_scan_matcher,
     std::unique_ptr<Constraint>* constraint) {
   CHECK(submap_scan_matcher.fast_correlative_scan_matcher);
@@ -228,9 +254,16 @@ void ConstraintBuilder3D::ComputeConstraint(
     }
   } else {
     kConstraintsSearchedMetric->Increment();
-    match_result = submap_scan_matcher.fast_correlative_scan_matcher->Match(
-        global_node_pose, global_submap_pose, *constant_data,
-        options_.min_score());
+    const auto* const fast_correlative_scan_matcher =
+        submap_scan_matcher.fast_correlative_scan_matcher.get();
+    match_result =
+        search_window.has_value()
+            ? fast_correlative_scan_matcher->Match(
+                  global_node_pose, global_submap_pose, *constant_data,
+                  search_window.value(), options_.min_score())
+            : fast_correlative_scan_matcher->Match(
+                  global_node_pose, global_submap_pose, *constant_data,
+                  options_.min_score());
     if (match_result != nullptr) {
       // We've reported a successful local match.
       CHECK_GT(match_result->score, options_.min_score());
@@ -26,6 +26,7 @@
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "cartographer/common/fixed_ratio_sampler.h"
 #include "cartographer/common/histogram.h"
 #include "cartographer/common/lua_parameter_dictionary.h"
@@ -81,6 +82,16 @@ class ConstraintBuilder3D {
                           const transform::Rigid3d& global_node_pose,
                           const transform::Rigid3d& global_submap_pose);
 
+  // Like above, but matches within 'search_window' instead of the search window
+  // configured for the fast correlative scan matcher.
+  void MaybeAddConstraint(
+      const SubmapId& submap_id, const Submap3D* submap, const NodeId& node_id,
+      const TrajectoryNode::Data* const constant_data,
+      const transform::Rigid3d& global_node_pose,
+      const transform::Rigid3d& global_submap_pose,
+      const scan_matching::FastCorrelativeScanMatcher3D::SearchWindow&
+          search_window);
+
   // Schedules exploring a new constraint between 'submap' identified by
   // 'submap_id' and the 'compressed_point_cloud' for 'node_id'.
   // This performs full-submap matching.
@@ -127,17 +138,30 @@ class ConstraintBuilder3D {
       const SubmapId& submap_id, const Submap3D* submap)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Implements both 'MaybeAddConstraint' overloads. The configured search
+  // window is used if 'search_window' is not set.
+  void MaybeAddLocalConstraint(
+      const SubmapId& submap_id, const Submap3D* submap, const NodeId& node_id,
+      const TrajectoryNode::Data* const constant_data,
+      const transform::Rigid3d& global_node_pose,
+      const transform::Rigid3d& global_submap_pose,
+      const absl::optional<
+          scan_matching::FastCorrelativeScanMatcher3D::SearchWindow>&
+          search_window);
+
   // Runs in a background thread and does computations for an additional
-  // constraint.
+  // constraint. 'search_window' is only used if not 'match_full_submap'.
   // As output, it may create a new Constraint in 'constraint'.
-  void ComputeConstraint(const SubmapId& submap_id, const NodeId& node_id,
-                         bool match_full_submap,
-                         const TrajectoryNode::Data* const constant_data,
-                         const transform::Rigid3d& global_node_pose,
-                         const transform::Rigid3d& global_submap_pose,
-                         const SubmapScanMatcher& submap_scan_matcher,
-                         std::unique_ptr<Constraint>* constraint)
-      LOCKS_EXCLUDED(mutex_);
+  void ComputeConstraint(
+      const SubmapId& submap_id, const NodeId& node_id, bool match_full_submap,
+      const TrajectoryNode::Data* const constant_data,
+      const transform::Rigid3d& global_node_pose,
+      const transform::Rigid3d& global_submap_pose,
+      const absl::optional<
+          scan_matching::FastCorrelativeScanMatcher3D::SearchWindow>&
+          search_window,
+      const SubmapScanMatcher& submap_scan_matcher,
+      std::unique_ptr<Constraint>* constraint) LOCKS_EXCLUDED(mutex_);
 
   void RunWhenDoneCallback() LOCKS_EXCLUDED(mutex_);
 
@@ -122,6 +122,15 @@ class GlobalTrajectoryBuilder : public mapping::TrajectoryBuilderInterface {
     local_slam_result_data->AddToPoseGraph(trajectory_id_, pose_graph_);
   }
 
+  absl::optional<transform::Rigid3d> ExtrapolateLocalPose(
+      const common::Time time) const override {
+    if (local_trajectory_builder_ == nullptr) {
+      return absl::nullopt;
+    }
+    return local_trajectory_builder_->local_pose_stream().ExtrapolatePose(
+        time);
+  }
+
  private:
   const int trajectory_id_;
   PoseGraph* const pose_graph_;
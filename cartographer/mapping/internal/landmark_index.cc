@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/landmark_index.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "cartographer/transform/timestamped_transform.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+// Returns the local pose of the tracking frame of 'trajectory_id' at 'time',
+// interpolated between its nodes. Times outside of the trajectory's nodes are
+// clamped to its first or last node.
+transform::Rigid3d InterpolateLocalPose(
+    const MapById<NodeId, TrajectoryNode>& trajectory_nodes,
+    const int trajectory_id, const common::Time time) {
+  const auto begin = trajectory_nodes.BeginOfTrajectory(trajectory_id);
+  const auto end = trajectory_nodes.EndOfTrajectory(trajectory_id);
+  CHECK(begin != end);
+  const auto next = trajectory_nodes.lower_bound(trajectory_id, time);
+  if (next == end) {
+    return std::prev(end)->data.constant_data->local_pose;
+  }
+  if (next == begin || next->data.time() == time) {
+    return next->data.constant_data->local_pose;
+  }
+  const auto prev = std::prev(next);
+  return transform::Interpolate(
+             transform::TimestampedTransform{
+                 prev->data.time(), prev->data.constant_data->local_pose},
+             transform::TimestampedTransform{
+                 next->data.time(), next->data.constant_data->local_pose},
+             time)
+      .transform;
+}
+
+}  // namespace
+
+void LandmarkIndex::AddObservation(
+    const std::string& landmark_id,
+    const PoseGraphInterface::LandmarkNode::LandmarkObservation& observation) {
+  landmarks_[landmark_id].observing_trajectory_ids.insert(
+      observation.trajectory_id);
+  std::vector<Observation>& observations =
+      trajectory_observations_[observation.trajectory_id];
+  const auto it = std::upper_bound(
+      observations.begin(), observations.end(), observation.time,
+      [](const common::Time time, const Observation& other) {
+        return time < other.time;
+      });
+  observations.insert(
+      it, Observation{observation.time, landmark_id,
+                      observation.landmark_to_tracking_transform});
+}
+
+void LandmarkIndex::SetGlobalLandmarkPose(const std::string& landmark_id,
+                                          const transform::Rigid3d& global_pose,
+                                          const bool frozen) {
+  Landmark& landmark = landmarks_[landmark_id];
+  landmark.global_pose = global_pose;
+  landmark.frozen = frozen;
+}
+
+bool LandmarkIndex::CanRelocalize(const Landmark& landmark,
+                                  const int trajectory_id) const {
+  if (!landmark.global_pose.has_value()) {
+    return false;
+  }
+  return landmark.frozen ||
+         std::any_of(landmark.observing_trajectory_ids.begin(),
+                     landmark.observing_trajectory_ids.end(),
+                     [trajectory_id](const int observing_trajectory_id) {
+                       return observing_trajectory_id != trajectory_id;
+                     });
+}
+
+std::vector<transform::Rigid3d> LandmarkIndex::EstimateGlobalNodePoses(
+    const NodeId& node_id,
+    const MapById<NodeId, TrajectoryNode>& trajectory_nodes,
+    const common::Duration max_time_difference) const {
+  const auto observations_it =
+      trajectory_observations_.find(node_id.trajectory_id);
+  if (observations_it == trajectory_observations_.end()) {
+    return {};
+  }
+  const std::vector<Observation>& observations = observations_it->second;
+  const TrajectoryNode::Data& node_data =
+      *trajectory_nodes.at(node_id).constant_data;
+  const auto begin = std::lower_bound(
+      observations.begin(), observations.end(),
+      node_data.time - max_time_difference,
+      [](const Observation& observation, const common::Time time) {
+        return observation.time < time;
+      });
+  const auto end = std::upper_bound(
+      begin, observations.end(), node_data.time + max_time_difference,
+      [](const common::Time time, const Observation& observation) {
+        return time < observation.time;
+      });
+
+  // Pairs of the time difference to the node and the estimated pose.
+  using Estimate = std::pair<common::Duration, transform::Rigid3d>;
+  std::vector<Estimate> estimates;
+  for (auto it = begin; it != end; ++it) {
+    const Landmark& landmark = landmarks_.at(it->landmark_id);
+    if (!CanRelocalize(landmark, node_id.trajectory_id)) {
+      continue;
+    }
+    // The landmark observation ties the global landmark pose to the tracking
+    // frame at the time of the observation, and the local poses of the
+    // trajectory give the motion from there to the node.
+    const transform::Rigid3d global_pose_at_observation =
+        landmark.global_pose.value() *
+        it->landmark_to_tracking_transform.inverse();
+    const transform::Rigid3d observation_to_node =
+        InterpolateLocalPose(trajectory_nodes, node_id.trajectory_id,
+                             it->time)
+            .inverse() *
+        node_data.local_pose;
+    estimates.emplace_back(
+        it->time < node_data.time ? node_data.time - it->time
+                                  : it->time - node_data.time,
+        global_pose_at_observation * observation_to_node);
+  }
+  std::stable_sort(estimates.begin(), estimates.end(),
+                   [](const Estimate& a, const Estimate& b) {
+                     return a.first < b.first;
+                   });
+  std::vector<transform::Rigid3d> result;
+  result.reserve(estimates.size());
+  for (const auto& estimate : estimates) {
+    result.push_back(estimate.second);
+  }
+  return result;
+}
+
+}  // namespace mapping
+}  // namespace cartographer
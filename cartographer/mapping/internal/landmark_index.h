@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_LANDMARK_INDEX_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_LANDMARK_INDEX_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "cartographer/common/time.h"
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_interface.h"
+#include "cartographer/mapping/trajectory_node.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Indexes landmarks by ID with their optimized global poses, and landmark
+// observations by trajectory and time. This allows to estimate the global pose
+// of a node from the landmarks its trajectory observed, e.g. to relocalize a
+// trajectory which is not connected to the rest of the map with a narrow
+// search instead of a full submap search.
+//
+// A landmark can only relocalize trajectory 'T' if its global pose does not
+// depend on 'T' alone, i.e. if it is frozen or was also observed by another
+// trajectory.
+//
+// This class is thread-compatible.
+class LandmarkIndex {
+ public:
+  LandmarkIndex() = default;
+
+  LandmarkIndex(const LandmarkIndex&) = delete;
+  LandmarkIndex& operator=(const LandmarkIndex&) = delete;
+
+  void AddObservation(
+      const std::string& landmark_id,
+      const PoseGraphInterface::LandmarkNode::LandmarkObservation& observation);
+
+  void SetGlobalLandmarkPose(const std::string& landmark_id,
+                             const transform::Rigid3d& global_pose,
+                             bool frozen);
+
+  // Returns estimates of the global pose of the tracking frame of 'node_id',
+  // one for each observation of a landmark which can relocalize its trajectory
+  // and was made within 'max_time_difference' of the node. The motion between
+  // the observation and the node is taken from the local poses of the
+  // trajectory's nodes in 'trajectory_nodes'. Estimates from observations
+  // closer in time come first.
+  std::vector<transform::Rigid3d> EstimateGlobalNodePoses(
+      const NodeId& node_id,
+      const MapById<NodeId, TrajectoryNode>& trajectory_nodes,
+      common::Duration max_time_difference) const;
+
+ private:
+  struct Landmark {
+    absl::optional<transform::Rigid3d> global_pose;
+    bool frozen = false;
+    std::set<int> observing_trajectory_ids;
+  };
+
+  struct Observation {
+    common::Time time;
+    std::string landmark_id;
+    transform::Rigid3d landmark_to_tracking_transform;
+  };
+
+  bool CanRelocalize(const Landmark& landmark, int trajectory_id) const;
+
+  std::map<std::string, Landmark> landmarks_;
+  // Observations of each trajectory, sorted by time.
+  std::map<int, std::vector<Observation>> trajectory_observations_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_LANDMARK_INDEX_H_
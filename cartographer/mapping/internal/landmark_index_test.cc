@@ -0,0 +1,169 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/landmark_index.h"
+
+#include "cartographer/transform/rigid_transform_test_helpers.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using LandmarkObservation =
+    PoseGraphInterface::LandmarkNode::LandmarkObservation;
+
+constexpr int kTrajectoryId = 1;
+constexpr int kOtherTrajectoryId = 0;
+
+class LandmarkIndexTest : public ::testing::Test {
+ protected:
+  LandmarkIndexTest() {
+    // The trajectory moves along x with 1 m/s, starting at time 100.
+    for (int i = 0; i != 5; ++i) {
+      TrajectoryNode::Data data;
+      data.time = common::FromUniversal(100 + i * 10000000);
+      data.gravity_alignment = Eigen::Quaterniond::Identity();
+      data.local_pose = transform::Rigid3d::Translation(
+          Eigen::Vector3d(static_cast<double>(i), 0., 0.));
+      trajectory_nodes_.Append(
+          kTrajectoryId,
+          TrajectoryNode{std::make_shared<const TrajectoryNode::Data>(data),
+                         transform::Rigid3d::Identity()});
+    }
+  }
+
+  common::Time NodeTime(const int node_index) const {
+    return trajectory_nodes_.at(NodeId{kTrajectoryId, node_index}).time();
+  }
+
+  LandmarkObservation CreateObservation(
+      const int trajectory_id, const common::Time time,
+      const transform::Rigid3d& landmark_to_tracking_transform) {
+    return LandmarkObservation{trajectory_id, time,
+                               landmark_to_tracking_transform, 1., 1.};
+  }
+
+  MapById<NodeId, TrajectoryNode> trajectory_nodes_;
+  LandmarkIndex landmark_index_;
+};
+
+TEST_F(LandmarkIndexTest, NoEstimateWithoutAnchoredLandmark) {
+  const transform::Rigid3d landmark_to_tracking =
+      transform::Rigid3d::Translation(Eigen::Vector3d(2., 0., 0.));
+  landmark_index_.AddObservation(
+      "landmark",
+      CreateObservation(kTrajectoryId, NodeTime(2), landmark_to_tracking));
+  EXPECT_TRUE(landmark_index_
+                  .EstimateGlobalNodePoses(NodeId{kTrajectoryId, 2},
+                                           trajectory_nodes_,
+                                           common::FromSeconds(1.))
+                  .empty());
+  // The landmark was optimized, but only observed by this trajectory.
+  landmark_index_.SetGlobalLandmarkPose(
+      "landmark", transform::Rigid3d::Translation(Eigen::Vector3d(7., 0., 0.)),
+      false /* frozen */);
+  EXPECT_TRUE(landmark_index_
+                  .EstimateGlobalNodePoses(NodeId{kTrajectoryId, 2},
+                                           trajectory_nodes_,
+                                           common::FromSeconds(1.))
+                  .empty());
+  landmark_index_.AddObservation(
+      "landmark", CreateObservation(kOtherTrajectoryId, NodeTime(0),
+                                    transform::Rigid3d::Identity()));
+  EXPECT_EQ(landmark_index_
+                .EstimateGlobalNodePoses(NodeId{kTrajectoryId, 2},
+                                         trajectory_nodes_,
+                                         common::FromSeconds(1.))
+                .size(),
+            1);
+}
+
+TEST_F(LandmarkIndexTest, EstimatesFromFrozenLandmark) {
+  const transform::Rigid3d global_landmark_pose =
+      transform::Rigid3d(Eigen::Vector3d(10., 5., 0.),
+                         Eigen::Quaterniond(Eigen::AngleAxisd(
+                             0.5, Eigen::Vector3d::UnitZ())));
+  landmark_index_.SetGlobalLandmarkPose("landmark", global_landmark_pose,
+                                        true /* frozen */);
+  const transform::Rigid3d landmark_to_tracking =
+      transform::Rigid3d::Translation(Eigen::Vector3d(1., 2., 0.));
+  landmark_index_.AddObservation(
+      "landmark",
+      CreateObservation(kTrajectoryId, NodeTime(3), landmark_to_tracking));
+  const std::vector<transform::Rigid3d> estimates =
+      landmark_index_.EstimateGlobalNodePoses(
+          NodeId{kTrajectoryId, 3}, trajectory_nodes_, common::FromSeconds(1.));
+  ASSERT_EQ(estimates.size(), 1);
+  EXPECT_THAT(estimates[0],
+              transform::IsNearly(
+                  global_landmark_pose * landmark_to_tracking.inverse(), 1e-9));
+}
+
+TEST_F(LandmarkIndexTest, AccountsForMotionSinceObservation) {
+  const transform::Rigid3d global_landmark_pose =
+      transform::Rigid3d::Translation(Eigen::Vector3d(10., 0., 0.));
+  landmark_index_.SetGlobalLandmarkPose("landmark", global_landmark_pose,
+                                        true /* frozen */);
+  // Observed half-way between nodes 1 and 2, when the tracking frame was at
+  // local x = 1.5.
+  const common::Time observation_time =
+      NodeTime(1) + (NodeTime(2) - NodeTime(1)) / 2;
+  landmark_index_.AddObservation(
+      "landmark",
+      CreateObservation(kTrajectoryId, observation_time,
+                        transform::Rigid3d::Translation(
+                            Eigen::Vector3d(3., 0., 0.))));
+  const std::vector<transform::Rigid3d> estimates =
+      landmark_index_.EstimateGlobalNodePoses(
+          NodeId{kTrajectoryId, 2}, trajectory_nodes_, common::FromSeconds(1.));
+  ASSERT_EQ(estimates.size(), 1);
+  // At the observation the tracking frame was at global x = 7, and it moved
+  // 0.5 m forward since.
+  EXPECT_THAT(estimates[0],
+              transform::IsNearly(transform::Rigid3d::Translation(
+                                      Eigen::Vector3d(7.5, 0., 0.)),
+                                  1e-9));
+}
+
+TEST_F(LandmarkIndexTest, IgnoresDistantObservationsAndSortsByTime) {
+  landmark_index_.SetGlobalLandmarkPose("near", transform::Rigid3d::Identity(),
+                                        true /* frozen */);
+  landmark_index_.SetGlobalLandmarkPose(
+      "far", transform::Rigid3d::Translation(Eigen::Vector3d(0., 1., 0.)),
+      true /* frozen */);
+  landmark_index_.AddObservation(
+      "far", CreateObservation(kTrajectoryId, NodeTime(0),
+                               transform::Rigid3d::Identity()));
+  landmark_index_.AddObservation(
+      "far", CreateObservation(kTrajectoryId, NodeTime(3),
+                               transform::Rigid3d::Identity()));
+  landmark_index_.AddObservation(
+      "near", CreateObservation(kTrajectoryId, NodeTime(2),
+                                transform::Rigid3d::Identity()));
+  const std::vector<transform::Rigid3d> estimates =
+      landmark_index_.EstimateGlobalNodePoses(
+          NodeId{kTrajectoryId, 2}, trajectory_nodes_, common::FromSeconds(1.));
+  ASSERT_EQ(estimates.size(), 2);
+  EXPECT_THAT(estimates[0],
+              transform::IsNearly(transform::Rigid3d::Identity(), 1e-9));
+  EXPECT_NEAR(estimates[1].translation().y(), 1., 1e-9);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/local_pose_stream.h"
+
+#include "cartographer/transform/transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+void LocalPoseStream::AddPose(const common::Time time,
+                              const transform::Rigid3d& pose) {
+  Eigen::Vector3d linear_velocity = Eigen::Vector3d::Zero();
+  Eigen::Vector3d angular_velocity = Eigen::Vector3d::Zero();
+  if (last_pose_.has_value() && time > last_pose_->time) {
+    const double delta_t = common::ToSeconds(time - last_pose_->time);
+    linear_velocity =
+        (pose.translation() - last_pose_->pose.translation()) / delta_t;
+    angular_velocity =
+        transform::RotationQuaternionToAngleAxisVector(
+            last_pose_->pose.rotation().inverse() * pose.rotation()) /
+        delta_t;
+  }
+  last_pose_ = TimedPose{time, pose};
+  Publish(time, pose, linear_velocity, angular_velocity);
+}
+
+void LocalPoseStream::AddImuData(const sensor::ImuData& imu_data) {
+  if (!state_.valid || common::ToUniversal(imu_data.time) < state_.time) {
+    return;
+  }
+  Publish(imu_data.time, Extrapolate(state_, imu_data.time),
+          Eigen::Vector3d(state_.linear_velocity[0], state_.linear_velocity[1],
+                          state_.linear_velocity[2]),
+          imu_data.angular_velocity);
+}
+
+absl::optional<transform::Rigid3d> LocalPoseStream::ExtrapolatePose(
+    const common::Time time) const {
+  const State state = published_state_.Load();
+  if (!state.valid) {
+    return absl::nullopt;
+  }
+  return Extrapolate(state, time);
+}
+
+transform::Rigid3d LocalPoseStream::Extrapolate(const State& state,
+                                                const common::Time time) {
+  const double delta_t =
+      common::ToSeconds(time - common::FromUniversal(state.time));
+  const Eigen::Vector3d translation =
+      Eigen::Vector3d(state.translation[0], state.translation[1],
+                      state.translation[2]) +
+      delta_t * Eigen::Vector3d(state.linear_velocity[0],
+                                state.linear_velocity[1],
+                                state.linear_velocity[2]);
+  const Eigen::Quaterniond rotation =
+      Eigen::Quaterniond(state.rotation[0], state.rotation[1],
+                         state.rotation[2], state.rotation[3]) *
+      transform::AngleAxisVectorToRotationQuaternion(
+          Eigen::Vector3d(delta_t * state.angular_velocity[0],
+                          delta_t * state.angular_velocity[1],
+                          delta_t * state.angular_velocity[2]));
+  return transform::Rigid3d(translation, rotation.normalized());
+}
+
+void LocalPoseStream::Publish(const common::Time time,
+                              const transform::Rigid3d& pose,
+                              const Eigen::Vector3d& linear_velocity,
+                              const Eigen::Vector3d& angular_velocity) {
+  state_.valid = true;
+  state_.time = common::ToUniversal(time);
+  for (int i = 0; i < 3; ++i) {
+    state_.translation[i] = pose.translation()[i];
+    state_.linear_velocity[i] = linear_velocity[i];
+    state_.angular_velocity[i] = angular_velocity[i];
+  }
+  state_.rotation[0] = pose.rotation().w();
+  state_.rotation[1] = pose.rotation().x();
+  state_.rotation[2] = pose.rotation().y();
+  state_.rotation[3] = pose.rotation().z();
+  published_state_.Store(state_);
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_LOCAL_POSE_STREAM_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_LOCAL_POSE_STREAM_H_
+
+#include "absl/types/optional.h"
+#include "cartographer/common/port.h"
+#include "cartographer/common/seqlock.h"
+#include "cartographer/common/time.h"
+#include "cartographer/sensor/imu_data.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Publishes the latest local pose of a trajectory for consumers which need
+// poses at a higher rate than local SLAM produces them, e.g. controllers.
+// Between local SLAM results, the orientation is integrated from IMU data and
+// the translation from the velocity between the last two poses.
+//
+// A single writer, the local trajectory builder, adds poses and IMU data.
+// Any number of threads can extrapolate poses concurrently without locks.
+class LocalPoseStream {
+ public:
+  LocalPoseStream() = default;
+
+  LocalPoseStream(const LocalPoseStream&) = delete;
+  LocalPoseStream& operator=(const LocalPoseStream&) = delete;
+
+  // Publishes a pose found by local SLAM.
+  void AddPose(common::Time time, const transform::Rigid3d& pose);
+
+  // Integrates the angular velocity since the last published state. Data
+  // before the first pose or older than the last published state is ignored.
+  void AddImuData(const sensor::ImuData& imu_data);
+
+  // Returns the pose at 'time' extrapolated from the last published state, or
+  // nothing if no pose was added yet. Thread-safe and lock-free.
+  absl::optional<transform::Rigid3d> ExtrapolatePose(common::Time time) const;
+
+ private:
+  // Trivially copyable, so it can be published through a 'SeqLock'.
+  struct State {
+    bool valid;
+    int64 time;
+    double translation[3];
+    // Quaternion in (w, x, y, z) order.
+    double rotation[4];
+    // In the local frame.
+    double linear_velocity[3];
+    // In the tracking frame.
+    double angular_velocity[3];
+  };
+
+  struct TimedPose {
+    common::Time time;
+    transform::Rigid3d pose;
+  };
+
+  static transform::Rigid3d Extrapolate(const State& state,
+                                        common::Time time);
+  void Publish(common::Time time, const transform::Rigid3d& pose,
+               const Eigen::Vector3d& linear_velocity,
+               const Eigen::Vector3d& angular_velocity);
+
+  common::SeqLock<State> published_state_;
+
+  // Only accessed by the writer.
+  State state_{};
+  absl::optional<TimedPose> last_pose_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_LOCAL_POSE_STREAM_H_
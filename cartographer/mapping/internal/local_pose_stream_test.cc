@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/local_pose_stream.h"
+
+#include "cartographer/transform/rigid_transform_test_helpers.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+common::Time Time(const double seconds) {
+  return common::FromUniversal(0) + common::FromSeconds(seconds);
+}
+
+TEST(LocalPoseStreamTest, EmptyWithoutPose) {
+  LocalPoseStream local_pose_stream;
+  EXPECT_FALSE(local_pose_stream.ExtrapolatePose(Time(1.)).has_value());
+  local_pose_stream.AddImuData(
+      sensor::ImuData{Time(1.), Eigen::Vector3d::UnitZ() * 9.81,
+                      Eigen::Vector3d::Zero()});
+  EXPECT_FALSE(local_pose_stream.ExtrapolatePose(Time(1.)).has_value());
+}
+
+TEST(LocalPoseStreamTest, ExtrapolatesVelocityBetweenPoses) {
+  LocalPoseStream local_pose_stream;
+  local_pose_stream.AddPose(Time(1.), transform::Rigid3d::Identity());
+  EXPECT_THAT(local_pose_stream.ExtrapolatePose(Time(2.)).value(),
+              transform::IsNearly(transform::Rigid3d::Identity(), 1e-9));
+  local_pose_stream.AddPose(
+      Time(2.), transform::Rigid3d::Translation(Eigen::Vector3d(1., 0., 0.)));
+  EXPECT_THAT(local_pose_stream.ExtrapolatePose(Time(2.5)).value(),
+              transform::IsNearly(transform::Rigid3d::Translation(
+                                      Eigen::Vector3d(1.5, 0., 0.)),
+                                  1e-9));
+}
+
+TEST(LocalPoseStreamTest, IntegratesImuAngularVelocity) {
+  LocalPoseStream local_pose_stream;
+  local_pose_stream.AddPose(Time(1.), transform::Rigid3d::Identity());
+  local_pose_stream.AddImuData(
+      sensor::ImuData{Time(1.), Eigen::Vector3d::UnitZ() * 9.81,
+                      Eigen::Vector3d(0., 0., 0.5)});
+  local_pose_stream.AddImuData(
+      sensor::ImuData{Time(2.), Eigen::Vector3d::UnitZ() * 9.81,
+                      Eigen::Vector3d(0., 0., 0.5)});
+  EXPECT_THAT(local_pose_stream.ExtrapolatePose(Time(3.)).value(),
+              transform::IsNearly(
+                  transform::Rigid3d::Rotation(Eigen::Quaterniond(
+                      Eigen::AngleAxisd(1., Eigen::Vector3d::UnitZ()))),
+                  1e-9));
+  // Older IMU data is ignored.
+  local_pose_stream.AddImuData(
+      sensor::ImuData{Time(1.5), Eigen::Vector3d::UnitZ() * 9.81,
+                      Eigen::Vector3d(0., 0., -5.)});
+  EXPECT_THAT(local_pose_stream.ExtrapolatePose(Time(3.)).value(),
+              transform::IsNearly(
+                  transform::Rigid3d::Rotation(Eigen::Quaterniond(
+                      Eigen::AngleAxisd(1., Eigen::Vector3d::UnitZ()))),
+                  1e-9));
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/memory_budget_trimmer.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "cartographer/metrics/counter.h"
+#include "cartographer/metrics/gauge.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+
+static auto* kSubmapsMemoryUsageMetric = metrics::Gauge::Null();
+static auto* kNodesMemoryUsageMetric = metrics::Gauge::Null();
+static auto* kConstraintsMemoryUsageMetric = metrics::Gauge::Null();
+static auto* kSensorDataMemoryUsageMetric = metrics::Gauge::Null();
+static auto* kTrimmedSubmapsMetric = metrics::Counter::Null();
+
+namespace {
+
+size_t EstimateMemoryUsage(const sensor::PointCloud& point_cloud) {
+  return point_cloud.size() * sizeof(sensor::RangefinderPoint);
+}
+
+struct Candidate {
+  SubmapId submap_id;
+  bool revisited;
+};
+
+}  // namespace
+
+size_t EstimateMemoryUsage(const TrajectoryNode& node) {
+  size_t memory_usage = sizeof(node);
+  if (node.constant_data == nullptr) {
+    return memory_usage;
+  }
+  const TrajectoryNode::Data& data = *node.constant_data;
+  return memory_usage + sizeof(data) +
+         EstimateMemoryUsage(data.filtered_gravity_aligned_point_cloud) +
+         EstimateMemoryUsage(data.high_resolution_point_cloud) +
+         EstimateMemoryUsage(data.low_resolution_point_cloud) +
+         data.rotational_scan_matcher_histogram.size() * sizeof(float) +
+         data.place_descriptor.size() * sizeof(float);
+}
+
+MemoryBudgetTrimmer::MemoryBudgetTrimmer(
+    const proto::PoseGraphOptions::MemoryBudgetTrimmerOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.max_memory_mb(), 0.);
+  CHECK_GE(options_.min_submaps_to_keep_per_trajectory(), 0);
+  CHECK_GT(options_.max_submaps_trimmed_per_call(), 0);
+}
+
+PoseGraphMemoryUsage MemoryBudgetTrimmer::EstimateMemoryUsage(
+    const Trimmable& pose_graph,
+    const MapById<SubmapId, PoseGraphInterface::SubmapData>& submap_data) {
+  PoseGraphMemoryUsage memory_usage;
+  // Rebuilding the cache from the current submaps drops trimmed submaps.
+  // Active submaps still grow, so they are estimated again on every call.
+  std::map<SubmapId, size_t> submap_memory_usage;
+  for (const auto& submap : submap_data) {
+    if (submap.data.submap == nullptr) continue;
+    const auto it = submap_memory_usage_.find(submap.id);
+    const size_t submap_bytes =
+        it != submap_memory_usage_.end()
+            ? it->second
+            : submap.data.submap->EstimateMemoryUsage();
+    if (submap.data.submap->insertion_finished()) {
+      submap_memory_usage.emplace_hint(submap_memory_usage.end(), submap.id,
+                                       submap_bytes);
+    }
+    memory_usage.submaps += submap_bytes;
+  }
+  submap_memory_usage_ = std::move(submap_memory_usage);
+
+  const auto& trajectory_nodes = pose_graph.GetTrajectoryNodes();
+  for (const auto& node : trajectory_nodes) {
+    memory_usage.nodes += mapping::EstimateMemoryUsage(node.data);
+  }
+  memory_usage.constraints = pose_graph.GetConstraints().size() *
+                             sizeof(PoseGraphInterface::Constraint);
+  for (const int trajectory_id : trajectory_nodes.trajectory_ids()) {
+    memory_usage.sensor_data +=
+        pose_graph.EstimateSensorDataMemoryUsage(trajectory_id);
+  }
+  return memory_usage;
+}
+
+void MemoryBudgetTrimmer::Trim(Trimmable* pose_graph) {
+  const auto submap_data = pose_graph->GetOptimizedSubmapData();
+  last_memory_usage_ = EstimateMemoryUsage(*pose_graph, submap_data);
+  kSubmapsMemoryUsageMetric->Set(last_memory_usage_.submaps);
+  kNodesMemoryUsageMetric->Set(last_memory_usage_.nodes);
+  kConstraintsMemoryUsageMetric->Set(last_memory_usage_.constraints);
+  kSensorDataMemoryUsageMetric->Set(last_memory_usage_.sensor_data);
+
+  const size_t max_memory_bytes =
+      static_cast<size_t>(options_.max_memory_mb() * 1024. * 1024.);
+  size_t memory_usage = last_memory_usage_.total();
+  if (memory_usage <= max_memory_bytes) {
+    return;
+  }
+
+  // Collects in a single pass over the constraints which nodes belong to
+  // which submaps and which submaps have loop closures.
+  std::map<SubmapId, std::vector<NodeId>> submap_to_nodes;
+  std::map<SubmapId, int> num_constraints_per_submap;
+  std::map<SubmapId, int> num_inter_constraints_per_submap;
+  std::map<NodeId, int> num_submaps_per_node;
+  for (const PoseGraphInterface::Constraint& constraint :
+       pose_graph->GetConstraints()) {
+    ++num_constraints_per_submap[constraint.submap_id];
+    if (constraint.tag == PoseGraphInterface::Constraint::INTRA_SUBMAP) {
+      submap_to_nodes[constraint.submap_id].push_back(constraint.node_id);
+      ++num_submaps_per_node[constraint.node_id];
+    } else {
+      ++num_inter_constraints_per_submap[constraint.submap_id];
+    }
+  }
+
+  const auto& trajectory_nodes = pose_graph->GetTrajectoryNodes();
+  std::map<int, size_t> sensor_data_bytes_per_node;
+  std::vector<Candidate> candidates;
+  for (const int trajectory_id : submap_data.trajectory_ids()) {
+    const std::vector<SubmapId> submap_ids =
+        pose_graph->GetSubmapIds(trajectory_id);
+    const int num_submaps_to_keep = std::min<int>(
+        options_.min_submaps_to_keep_per_trajectory(), submap_ids.size());
+    for (const auto& submap : submap_data.trajectory(trajectory_id)) {
+      if (num_submaps_to_keep != 0 &&
+          !(submap.id < submap_ids[submap_ids.size() - num_submaps_to_keep])) {
+        break;
+      }
+      // Only finished submaps can be trimmed.
+      if (submap.data.submap == nullptr ||
+          !submap.data.submap->insertion_finished()) {
+        continue;
+      }
+      candidates.push_back(
+          Candidate{submap.id, num_inter_constraints_per_submap.count(
+                                   submap.id) != 0});
+    }
+    const size_t num_nodes =
+        trajectory_nodes.SizeOfTrajectoryOrZero(trajectory_id);
+    if (num_nodes != 0) {
+      sensor_data_bytes_per_node[trajectory_id] =
+          pose_graph->EstimateSensorDataMemoryUsage(trajectory_id) /
+          num_nodes;
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& lhs, const Candidate& rhs) {
+                     return std::forward_as_tuple(!lhs.revisited,
+                                                  lhs.submap_id) <
+                            std::forward_as_tuple(!rhs.revisited,
+                                                  rhs.submap_id);
+                   });
+
+  int num_trimmed_submaps = 0;
+  for (const Candidate& candidate : candidates) {
+    if (memory_usage <= max_memory_bytes ||
+        num_trimmed_submaps == options_.max_submaps_trimmed_per_call()) {
+      break;
+    }
+    size_t freed_bytes = submap_memory_usage_.at(candidate.submap_id) +
+                         num_constraints_per_submap[candidate.submap_id] *
+                             sizeof(PoseGraphInterface::Constraint);
+    for (const NodeId& node_id : submap_to_nodes[candidate.submap_id]) {
+      if (--num_submaps_per_node[node_id] == 0 &&
+          trajectory_nodes.Contains(node_id)) {
+        freed_bytes += mapping::EstimateMemoryUsage(
+                           trajectory_nodes.at(node_id)) +
+                       sensor_data_bytes_per_node[node_id.trajectory_id];
+      }
+    }
+    pose_graph->TrimSubmap(candidate.submap_id);
+    submap_memory_usage_.erase(candidate.submap_id);
+    memory_usage -= std::min(freed_bytes, memory_usage);
+    ++num_trimmed_submaps;
+    kTrimmedSubmapsMetric->Increment();
+  }
+  if (memory_usage > max_memory_bytes) {
+    LOG(WARNING) << "Pose graph is estimated to use " << memory_usage
+                 << " bytes after trimming " << num_trimmed_submaps
+                 << " submaps, exceeding the budget of " << max_memory_bytes
+                 << " bytes.";
+  }
+}
+
+void MemoryBudgetTrimmer::RegisterMetrics(
+    metrics::FamilyFactory* family_factory) {
+  auto* memory_usage = family_factory->NewGaugeFamily(
+      "mapping_memory_budget_trimmer_memory_usage",
+      "Estimated pose graph memory usage in bytes");
+  kSubmapsMemoryUsageMetric = memory_usage->Add({{"kind", "submaps"}});
+  kNodesMemoryUsageMetric = memory_usage->Add({{"kind", "nodes"}});
+  kConstraintsMemoryUsageMetric = memory_usage->Add({{"kind", "constraints"}});
+  kSensorDataMemoryUsageMetric = memory_usage->Add({{"kind", "sensor_data"}});
+  auto* trimmed_submaps = family_factory->NewCounterFamily(
+      "mapping_memory_budget_trimmer_trimmed_submaps",
+      "Submaps trimmed to stay within the memory budget");
+  kTrimmedSubmapsMetric = trimmed_submaps->Add({});
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_MEMORY_BUDGET_TRIMMER_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_MEMORY_BUDGET_TRIMMER_H_
+
+#include <cstddef>
+#include <map>
+
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_trimmer.h"
+#include "cartographer/mapping/proto/pose_graph_options.pb.h"
+#include "cartographer/mapping/trajectory_node.h"
+#include "cartographer/metrics/family_factory.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Estimated memory in bytes used by the parts of a pose graph.
+struct PoseGraphMemoryUsage {
+  size_t submaps = 0;
+  size_t nodes = 0;
+  size_t constraints = 0;
+  size_t sensor_data = 0;
+
+  size_t total() const { return submaps + nodes + constraints + sensor_data; }
+};
+
+// Returns an estimate of the memory in bytes used by a trajectory node.
+size_t EstimateMemoryUsage(const TrajectoryNode& node);
+
+// Trims finished submaps and their nodes while the estimated memory used by
+// the pose graph exceeds 'max_memory_mb'. Submaps that were revisited, i.e.
+// that have loop closure constraints, are trimmed first since their area is
+// covered by other submaps. Within each group the oldest submaps go first.
+// The most recent 'min_submaps_to_keep_per_trajectory' submaps of each
+// trajectory are never trimmed, with 0 making all finished submaps candidates.
+// Active submaps are never trimmed. At most 'max_submaps_trimmed_per_call'
+// submaps are trimmed after each optimization to bound the cost of a call.
+class MemoryBudgetTrimmer : public PoseGraphTrimmer {
+ public:
+  explicit MemoryBudgetTrimmer(
+      const proto::PoseGraphOptions::MemoryBudgetTrimmerOptions& options);
+  ~MemoryBudgetTrimmer() override = default;
+
+  void Trim(Trimmable* pose_graph) override;
+  bool IsFinished() override { return false; }
+
+  // Returns the memory usage estimated at the start of the last 'Trim' call.
+  const PoseGraphMemoryUsage& last_memory_usage() const {
+    return last_memory_usage_;
+  }
+
+  static void RegisterMetrics(metrics::FamilyFactory* family_factory);
+
+ private:
+  PoseGraphMemoryUsage EstimateMemoryUsage(
+      const Trimmable& pose_graph,
+      const MapById<SubmapId, PoseGraphInterface::SubmapData>& submap_data);
+
+  const proto::PoseGraphOptions::MemoryBudgetTrimmerOptions options_;
+  // Finished submaps do not change anymore, so their estimates are cached.
+  std::map<SubmapId, size_t> submap_memory_usage_;
+  PoseGraphMemoryUsage last_memory_usage_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_MEMORY_BUDGET_TRIMMER_H_
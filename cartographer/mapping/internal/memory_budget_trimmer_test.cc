@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/memory_budget_trimmer.h"
+
+#include <memory>
+#include <vector>
+
+#include "cartographer/mapping/2d/submap_2d.h"
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/internal/testing/fake_trimmable.h"
+#include "cartographer/transform/transform.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr int kTrajectoryId = 0;
+constexpr int kNumCells = 10;
+constexpr double kBytesPerMb = 1024. * 1024.;
+
+class MemoryBudgetTrimmerTest : public ::testing::Test {
+ protected:
+  void AddSubmaps(int num_submaps) {
+    for (int submap_index = 0; submap_index < num_submaps; ++submap_index) {
+      AddSubmap(submap_index, kNumCells, true /* finished */);
+    }
+  }
+
+  void AddSubmap(int submap_index, int num_cells, bool finished) {
+    proto::Submap2D submap_2d;
+    submap_2d.set_num_range_data(1);
+    submap_2d.set_finished(finished);
+    *submap_2d.mutable_local_pose() =
+        transform::ToProto(transform::Rigid3d::Identity());
+    auto* grid = submap_2d.mutable_grid();
+    for (int i = 0; i < num_cells * num_cells; ++i) {
+      grid->add_cells(1);
+    }
+    auto* map_limits = grid->mutable_limits();
+    map_limits->set_resolution(1.);
+    *map_limits->mutable_max() =
+        transform::ToProto(Eigen::Vector2d(num_cells, num_cells));
+    map_limits->mutable_cell_limits()->set_num_x_cells(num_cells);
+    map_limits->mutable_cell_limits()->set_num_y_cells(num_cells);
+    grid->mutable_probability_grid_2d();
+    auto submap =
+        std::make_shared<const Submap2D>(submap_2d, &conversion_tables_);
+    if (num_cells == kNumCells) {
+      submap_bytes_ = submap->EstimateMemoryUsage();
+    }
+    const SubmapId submap_id{kTrajectoryId, submap_index};
+    if (fake_pose_graph_.mutable_submap_data()->Contains(submap_id)) {
+      fake_pose_graph_.mutable_submap_data()->at(submap_id).submap = submap;
+      return;
+    }
+    fake_pose_graph_.mutable_submap_data()->Insert(
+        submap_id, {submap, transform::Rigid3d::Identity()});
+  }
+
+  void AddConstraint(int submap_index, int node_index,
+                     PoseGraphInterface::Constraint::Tag tag) {
+    fake_pose_graph_.mutable_constraints()->push_back(
+        PoseGraphInterface::Constraint{
+            SubmapId{kTrajectoryId, submap_index},
+            NodeId{kTrajectoryId, node_index},
+            {transform::Rigid3d::Identity(), 1., 1.},
+            tag});
+  }
+
+  proto::PoseGraphOptions::MemoryBudgetTrimmerOptions CreateOptions(
+      size_t max_memory_bytes, int max_submaps_trimmed_per_call,
+      int min_submaps_to_keep_per_trajectory = 2) {
+    proto::PoseGraphOptions::MemoryBudgetTrimmerOptions options;
+    options.set_max_memory_mb(max_memory_bytes / kBytesPerMb);
+    options.set_min_submaps_to_keep_per_trajectory(
+        min_submaps_to_keep_per_trajectory);
+    options.set_max_submaps_trimmed_per_call(max_submaps_trimmed_per_call);
+    return options;
+  }
+
+  ValueConversionTables conversion_tables_;
+  testing::FakeTrimmable fake_pose_graph_;
+  size_t submap_bytes_ = 0;
+};
+
+TEST_F(MemoryBudgetTrimmerTest, DoesNotTrimWithinBudget) {
+  AddSubmaps(5);
+  fake_pose_graph_.set_sensor_data_memory_usage(1000);
+  MemoryBudgetTrimmer trimmer(CreateOptions(5 * submap_bytes_, 10));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(), IsEmpty());
+  EXPECT_EQ(trimmer.last_memory_usage().submaps, 5 * submap_bytes_);
+  EXPECT_EQ(trimmer.last_memory_usage().constraints, 0);
+}
+
+TEST_F(MemoryBudgetTrimmerTest, TrimsRevisitedSubmapsFirst) {
+  AddSubmaps(5);
+  AddConstraint(0, 0, PoseGraphInterface::Constraint::INTRA_SUBMAP);
+  AddConstraint(2, 1, PoseGraphInterface::Constraint::INTRA_SUBMAP);
+  AddConstraint(2, 5, PoseGraphInterface::Constraint::INTER_SUBMAP);
+  const size_t constraint_bytes =
+      3 * sizeof(PoseGraphInterface::Constraint);
+  MemoryBudgetTrimmer trimmer(
+      CreateOptions(4 * submap_bytes_ + constraint_bytes, 10));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(SubmapId{kTrajectoryId, 2}));
+  EXPECT_EQ(trimmer.last_memory_usage().constraints, constraint_bytes);
+}
+
+TEST_F(MemoryBudgetTrimmerTest, KeepsMostRecentSubmaps) {
+  AddSubmaps(5);
+  MemoryBudgetTrimmer trimmer(CreateOptions(1, 10));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(SubmapId{kTrajectoryId, 0},
+                          SubmapId{kTrajectoryId, 1},
+                          SubmapId{kTrajectoryId, 2}));
+}
+
+TEST_F(MemoryBudgetTrimmerTest, BoundsSubmapsTrimmedPerCall) {
+  AddSubmaps(5);
+  MemoryBudgetTrimmer trimmer(CreateOptions(1, 2));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(SubmapId{kTrajectoryId, 0},
+                          SubmapId{kTrajectoryId, 1}));
+}
+
+TEST_F(MemoryBudgetTrimmerTest, NeverTrimsActiveSubmapsWithoutKeptSubmaps) {
+  AddSubmaps(3);
+  AddSubmap(3, kNumCells, false /* finished */);
+  AddSubmap(4, kNumCells, false /* finished */);
+  MemoryBudgetTrimmer trimmer(CreateOptions(1, 10, 0));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(SubmapId{kTrajectoryId, 0},
+                          SubmapId{kTrajectoryId, 1},
+                          SubmapId{kTrajectoryId, 2}));
+}
+
+TEST_F(MemoryBudgetTrimmerTest, NeverTrimsActiveSubmapsWithOneKeptSubmap) {
+  AddSubmaps(3);
+  AddSubmap(3, kNumCells, false /* finished */);
+  AddSubmap(4, kNumCells, false /* finished */);
+  MemoryBudgetTrimmer trimmer(CreateOptions(1, 10, 1));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_THAT(fake_pose_graph_.trimmed_submaps(),
+              ElementsAre(SubmapId{kTrajectoryId, 0},
+                          SubmapId{kTrajectoryId, 1},
+                          SubmapId{kTrajectoryId, 2}));
+}
+
+TEST_F(MemoryBudgetTrimmerTest, ReestimatesActiveSubmaps) {
+  AddSubmap(0, kNumCells, false /* finished */);
+  MemoryBudgetTrimmer trimmer(CreateOptions(1024 * 1024, 10));
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_EQ(trimmer.last_memory_usage().submaps, submap_bytes_);
+
+  AddSubmap(0, 2 * kNumCells, false /* finished */);
+  const size_t grown_submap_bytes =
+      fake_pose_graph_.GetOptimizedSubmapData()
+          .at(SubmapId{kTrajectoryId, 0})
+          .submap->EstimateMemoryUsage();
+  ASSERT_GT(grown_submap_bytes, submap_bytes_);
+  trimmer.Trim(&fake_pose_graph_);
+  EXPECT_EQ(trimmer.last_memory_usage().submaps, grown_submap_bytes);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -31,6 +31,7 @@
 #include "cartographer/common/math.h"
 #include "cartographer/common/time.h"
 #include "cartographer/mapping/internal/3d/imu_integration.h"
+#include "cartographer/mapping/internal/3d/imu_integration_buffer.h"
 #include "cartographer/mapping/internal/3d/rotation_parameterization.h"
 #include "cartographer/mapping/internal/optimization/ceres_pose.h"
 #include "cartographer/mapping/internal/optimization/cost_functions/acceleration_cost_function_3d.h"
@@ -194,6 +195,10 @@ OptimizationProblem3D::~OptimizationProblem3D() {}
 void OptimizationProblem3D::AddImuData(const int trajectory_id,
                                        const sensor::ImuData& imu_data) {
   imu_data_.Append(trajectory_id, imu_data);
+  const auto it = imu_integration_buffers_.find(trajectory_id);
+  if (it != imu_integration_buffers_.end()) {
+    it->second.Append(imu_data);
+  }
 }
 
 void OptimizationProblem3D::AddOdometryData(
@@ -226,6 +231,8 @@ void OptimizationProblem3D::InsertTrajectoryNode(const NodeId& node_id,
 
 void OptimizationProblem3D::TrimTrajectoryNode(const NodeId& node_id) {
   imu_data_.Trim(node_data_, node_id);
+  // The buffer is rebuilt from the remaining IMU data when needed.
+  imu_integration_buffers_.erase(node_id.trajectory_id);
   odometry_data_.Trim(node_data_, node_id);
   fixed_frame_pose_data_.Trim(node_data_, node_id);
   node_data_.Trim(node_id);
@@ -369,10 +376,9 @@ void OptimizationProblem3D::Solve(
             trajectory_data.imu_calibration.data());
       }
       CHECK(imu_data_.HasTrajectory(trajectory_id));
-      const auto imu_data = imu_data_.trajectory(trajectory_id);
-      CHECK(imu_data.begin() != imu_data.end());
+      const ImuIntegrationBuffer& imu_integration_buffer =
+          GetImuIntegrationBuffer(trajectory_id);
 
-      auto imu_it = imu_data.begin();
       auto prev_node_it = node_it;
       for (++node_it; node_it != trajectory_end; ++node_it) {
         const NodeId first_node_id = prev_node_it->id;
@@ -385,15 +391,9 @@ void OptimizationProblem3D::Solve(
           continue;
         }
 
-        // Skip IMU data before the node.
-        while (std::next(imu_it) != imu_data.end() &&
-               std::next(imu_it)->time <= first_node_data.time) {
-          ++imu_it;
-        }
-
-        auto imu_it2 = imu_it;
-        const IntegrateImuResult<double> result = IntegrateImu(
-            imu_data, first_node_data.time, second_node_data.time, &imu_it);
+        const IntegrateImuResult<double> result =
+            imu_integration_buffer.Integrate(first_node_data.time,
+                                             second_node_data.time);
         const auto next_node_it = std::next(node_it);
         if (next_node_it != trajectory_end &&
             next_node_it->id.node_index == second_node_id.node_index + 1) {
@@ -407,9 +407,9 @@ void OptimizationProblem3D::Solve(
           const common::Time first_center = first_time + first_duration / 2;
           const common::Time second_center = second_time + second_duration / 2;
           const IntegrateImuResult<double> result_to_first_center =
-              IntegrateImu(imu_data, first_time, first_center, &imu_it2);
+              imu_integration_buffer.Integrate(first_time, first_center);
           const IntegrateImuResult<double> result_center_to_center =
-              IntegrateImu(imu_data, first_center, second_center, &imu_it2);
+              imu_integration_buffer.Integrate(first_center, second_center);
           // 'delta_velocity' is the change in velocity from the point in time
           // halfway between the first and second poses to halfway between
           // second and third pose. It is computed from IMU data and still
@@ -596,6 +596,20 @@ void OptimizationProblem3D::Solve(
   }
 }
 
+const ImuIntegrationBuffer& OptimizationProblem3D::GetImuIntegrationBuffer(
+    const int trajectory_id) {
+  auto it = imu_integration_buffers_.find(trajectory_id);
+  if (it == imu_integration_buffers_.end()) {
+    it = imu_integration_buffers_.emplace(trajectory_id, ImuIntegrationBuffer())
+             .first;
+    for (const sensor::ImuData& imu_data :
+         imu_data_.trajectory(trajectory_id)) {
+      it->second.Append(imu_data);
+    }
+  }
+  return it->second;
+}
+
 std::unique_ptr<transform::Rigid3d>
 OptimizationProblem3D::CalculateOdometryBetweenNodes(
     const int trajectory_id, const NodeSpec3D& first_node_data,
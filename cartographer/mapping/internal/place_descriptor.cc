@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/place_descriptor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cartographer/common/math.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+
+proto::PlaceDescriptorOptions CreatePlaceDescriptorOptions(
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  proto::PlaceDescriptorOptions options;
+  options.set_num_rings(parameter_dictionary->GetNonNegativeInt("num_rings"));
+  options.set_num_sectors(
+      parameter_dictionary->GetNonNegativeInt("num_sectors"));
+  options.set_max_range(parameter_dictionary->GetDouble("max_range"));
+  CHECK_GT(options.num_sectors(), 0);
+  CHECK_GT(options.max_range(), 0.);
+  return options;
+}
+
+Eigen::MatrixXf ComputePlaceDescriptor(
+    const sensor::PointCloud& point_cloud,
+    const proto::PlaceDescriptorOptions& options) {
+  const int num_rings = options.num_rings();
+  const int num_sectors = options.num_sectors();
+  if (num_rings == 0) {
+    return Eigen::MatrixXf();
+  }
+  const float max_range = options.max_range();
+  const float rings_per_meter = num_rings / max_range;
+  const float sectors_per_radian = num_sectors / (2.f * M_PI);
+  Eigen::MatrixXf place_descriptor = Eigen::MatrixXf::Zero(num_rings,
+                                                           num_sectors);
+  for (const sensor::RangefinderPoint& point : point_cloud) {
+    const float range = point.position.head<2>().norm();
+    if (!(range < max_range)) continue;
+    const int ring = std::min(static_cast<int>(range * rings_per_meter),
+                              num_rings - 1);
+    const float angle = std::atan2(point.position.y(), point.position.x());
+    const int sector =
+        std::min(static_cast<int>((angle + M_PI) * sectors_per_radian),
+                 num_sectors - 1);
+    place_descriptor(ring, sector) += 1.f;
+  }
+  return place_descriptor;
+}
+
+Eigen::VectorXf ComputeRingKey(const Eigen::MatrixXf& place_descriptor) {
+  if (place_descriptor.cols() == 0) {
+    return Eigen::VectorXf::Zero(place_descriptor.rows());
+  }
+  return (place_descriptor.array() > 0.f)
+             .cast<float>()
+             .rowwise()
+             .mean();
+}
+
+Eigen::MatrixXf NormalizeSectors(const Eigen::MatrixXf& place_descriptor) {
+  Eigen::MatrixXf normalized = place_descriptor;
+  for (int sector = 0; sector != normalized.cols(); ++sector) {
+    const float norm = normalized.col(sector).norm();
+    if (norm > 0.f) {
+      normalized.col(sector) /= norm;
+    }
+  }
+  return normalized;
+}
+
+float ComputePlaceDescriptorDistance(const Eigen::MatrixXf& normalized_a,
+                                     const Eigen::MatrixXf& normalized_b) {
+  CHECK_EQ(normalized_a.rows(), normalized_b.rows());
+  CHECK_EQ(normalized_a.cols(), normalized_b.cols());
+  const int num_sectors = normalized_a.cols();
+  // Sectors are unit length or zero, so the cosine similarity of each pair of
+  // sectors is an entry of this product.
+  const Eigen::MatrixXf similarities =
+      normalized_a.transpose() * normalized_b;
+  std::vector<bool> a_occupied(num_sectors);
+  std::vector<bool> b_occupied(num_sectors);
+  for (int sector = 0; sector != num_sectors; ++sector) {
+    a_occupied[sector] = normalized_a.col(sector).squaredNorm() > 0.f;
+    b_occupied[sector] = normalized_b.col(sector).squaredNorm() > 0.f;
+  }
+  float min_distance = 1.f;
+  for (int shift = 0; shift != num_sectors; ++shift) {
+    float sum_of_distances = 0.f;
+    int num_compared_sectors = 0;
+    for (int a_sector = 0; a_sector != num_sectors; ++a_sector) {
+      int b_sector = a_sector + shift;
+      if (b_sector >= num_sectors) b_sector -= num_sectors;
+      if (!a_occupied[a_sector] || !b_occupied[b_sector]) continue;
+      sum_of_distances += 1.f - similarities(a_sector, b_sector);
+      ++num_compared_sectors;
+    }
+    if (num_compared_sectors > 0) {
+      min_distance =
+          std::min(min_distance, sum_of_distances / num_compared_sectors);
+    }
+  }
+  return common::Clamp(min_distance, 0.f, 1.f);
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_H_
+
+#include "Eigen/Core"
+#include "cartographer/common/lua_parameter_dictionary.h"
+#include "cartographer/mapping/proto/place_descriptor_options.pb.h"
+#include "cartographer/sensor/point_cloud.h"
+
+namespace cartographer {
+namespace mapping {
+
+proto::PlaceDescriptorOptions CreatePlaceDescriptorOptions(
+    common::LuaParameterDictionary* parameter_dictionary);
+
+// Computes a scan context style place descriptor of 'point_cloud', which is
+// given in a gravity-aligned frame at the tracking frame: a 'num_rings' x
+// 'num_sectors' polar grid in the horizontal plane holding the number of
+// points per cell. Points are counted rather than their maximum height taken
+// so that planar 2D scans are described as well. Returns an empty matrix if
+// 'num_rings' is 0.
+Eigen::MatrixXf ComputePlaceDescriptor(
+    const sensor::PointCloud& point_cloud,
+    const proto::PlaceDescriptorOptions& options);
+
+// Returns the rotation invariant ring key of 'place_descriptor': the fraction
+// of non-empty cells per ring.
+Eigen::VectorXf ComputeRingKey(const Eigen::MatrixXf& place_descriptor);
+
+// Scales each sector, i.e. column, of 'place_descriptor' to unit length.
+// Empty sectors stay zero.
+Eigen::MatrixXf NormalizeSectors(const Eigen::MatrixXf& place_descriptor);
+
+// Returns the distance in [0, 1] between two place descriptors of equal size
+// normalized by 'NormalizeSectors()': the mean cosine distance between
+// corresponding sectors that are non-empty in both, minimized over rotations of
+// 'b' by whole sectors. Returns 1 if no rotation has such sectors.
+float ComputePlaceDescriptorDistance(const Eigen::MatrixXf& normalized_a,
+                                     const Eigen::MatrixXf& normalized_b);
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_H_
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/place_descriptor_index.h"
+
+#include <algorithm>
+
+#include "cartographer/mapping/internal/place_descriptor.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+// Number of submaps, per candidate to be found, whose full descriptors are
+// compared after ranking by ring keys.
+constexpr int kNumRingKeyCandidatesPerCandidate = 5;
+
+// Number of nodes per submap whose full descriptors are compared.
+constexpr int kNumNodesComparedPerSubmap = 3;
+
+}  // namespace
+
+PlaceDescriptorIndex::PlaceDescriptorIndex(
+    const proto::PoseGraphOptions::PlaceRecognitionOptions& options)
+    : options_(options) {
+  CHECK_GE(options_.max_candidate_submaps(), 0);
+}
+
+void PlaceDescriptorIndex::AddNode(const NodeId& node_id,
+                                   const Eigen::MatrixXf& place_descriptor) {
+  if (options_.max_candidate_submaps() == 0 || place_descriptor.size() == 0) {
+    return;
+  }
+  Node& node = nodes_[node_id];
+  node.normalized_place_descriptor = NormalizeSectors(place_descriptor);
+  node.ring_key = ComputeRingKey(place_descriptor);
+}
+
+void PlaceDescriptorIndex::TrimNode(const NodeId& node_id) {
+  nodes_.erase(node_id);
+}
+
+bool PlaceDescriptorIndex::Contains(const NodeId& node_id) const {
+  return nodes_.count(node_id) != 0;
+}
+
+void PlaceDescriptorIndex::RankSubmaps(
+    const NodeId& node_id, const std::vector<SubmapId>& submap_ids,
+    const MapById<SubmapId, InternalSubmapData>& submap_data) {
+  const auto it = nodes_.find(node_id);
+  if (it == nodes_.end()) return;
+  Node& node = it->second;
+
+  std::vector<std::pair<float, SubmapId>> ring_key_distances;
+  for (const SubmapId& submap_id : submap_ids) {
+    const auto closest_ring_keys = FindClosestRingKeys(
+        node, submap_data.at(submap_id).node_ids, 1 /* max_num_nodes */);
+    if (!closest_ring_keys.empty()) {
+      ring_key_distances.emplace_back(closest_ring_keys.front().first,
+                                      submap_id);
+    }
+  }
+  const size_t max_num_candidates = options_.max_candidate_submaps();
+  const size_t max_num_ring_key_candidates =
+      kNumRingKeyCandidatesPerCandidate * max_num_candidates;
+  node.max_ring_key_distance = std::numeric_limits<float>::infinity();
+  if (ring_key_distances.size() > max_num_ring_key_candidates) {
+    std::nth_element(ring_key_distances.begin(),
+                     ring_key_distances.begin() +
+                         (max_num_ring_key_candidates - 1),
+                     ring_key_distances.end());
+    node.max_ring_key_distance =
+        ring_key_distances[max_num_ring_key_candidates - 1].first;
+    ring_key_distances.erase(
+        ring_key_distances.begin() + max_num_ring_key_candidates,
+        ring_key_distances.end());
+  }
+
+  std::vector<float> distances;
+  distances.reserve(ring_key_distances.size());
+  for (const auto& ring_key_distance : ring_key_distances) {
+    distances.push_back(ComputeDistance(
+        node,
+        FindClosestRingKeys(node,
+                            submap_data.at(ring_key_distance.second).node_ids,
+                            kNumNodesComparedPerSubmap)));
+  }
+  node.max_distance = options_.max_descriptor_distance();
+  if (distances.size() >= max_num_candidates) {
+    std::nth_element(distances.begin(),
+                     distances.begin() + (max_num_candidates - 1),
+                     distances.end());
+    node.max_distance =
+        std::min(node.max_distance, distances[max_num_candidates - 1]);
+  }
+  node.ranked = true;
+}
+
+PlaceDescriptorIndex::Ranking PlaceDescriptorIndex::GetRanking(
+    const NodeId& node_id, const SubmapId& submap_id,
+    const MapById<SubmapId, InternalSubmapData>& submap_data) const {
+  const auto it = nodes_.find(node_id);
+  if (it == nodes_.end() || !it->second.ranked) {
+    return Ranking::kUnranked;
+  }
+  const Node& node = it->second;
+  const auto closest_ring_keys =
+      FindClosestRingKeys(node, submap_data.at(submap_id).node_ids,
+                          kNumNodesComparedPerSubmap);
+  if (closest_ring_keys.empty()) {
+    return Ranking::kUnranked;
+  }
+  if (closest_ring_keys.front().first > node.max_ring_key_distance ||
+      ComputeDistance(node, closest_ring_keys) > node.max_distance) {
+    return Ranking::kRejected;
+  }
+  return Ranking::kCandidate;
+}
+
+std::vector<std::pair<float, const PlaceDescriptorIndex::Node*>>
+PlaceDescriptorIndex::FindClosestRingKeys(
+    const Node& node, const std::set<NodeId>& submap_node_ids,
+    const int max_num_nodes) const {
+  std::vector<std::pair<float, const Node*>> ring_key_distances;
+  for (const NodeId& submap_node_id : submap_node_ids) {
+    const auto it = nodes_.find(submap_node_id);
+    if (it == nodes_.end() ||
+        it->second.ring_key.size() != node.ring_key.size() ||
+        it->second.normalized_place_descriptor.cols() !=
+            node.normalized_place_descriptor.cols()) {
+      continue;
+    }
+    ring_key_distances.emplace_back(
+        (it->second.ring_key - node.ring_key).norm(), &it->second);
+  }
+  const auto by_distance = [](const std::pair<float, const Node*>& lhs,
+                              const std::pair<float, const Node*>& rhs) {
+    return lhs.first < rhs.first;
+  };
+  if (ring_key_distances.size() > static_cast<size_t>(max_num_nodes)) {
+    std::partial_sort(ring_key_distances.begin(),
+                      ring_key_distances.begin() + max_num_nodes,
+                      ring_key_distances.end(), by_distance);
+    ring_key_distances.resize(max_num_nodes);
+  } else {
+    std::sort(ring_key_distances.begin(), ring_key_distances.end(),
+              by_distance);
+  }
+  return ring_key_distances;
+}
+
+float PlaceDescriptorIndex::ComputeDistance(
+    const Node& node,
+    const std::vector<std::pair<float, const Node*>>& closest_ring_keys)
+    const {
+  float min_distance = 1.f;
+  for (const auto& closest_ring_key : closest_ring_keys) {
+    const Eigen::MatrixXf& submap_node_place_descriptor =
+        closest_ring_key.second->normalized_place_descriptor;
+    min_distance = std::min(
+        min_distance,
+        ComputePlaceDescriptorDistance(node.normalized_place_descriptor,
+                                       submap_node_place_descriptor));
+  }
+  return min_distance;
+}
+
+}  // namespace mapping
+}  // namespace cartographer
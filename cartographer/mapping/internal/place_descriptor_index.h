@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_INDEX_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_INDEX_H_
+
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_data.h"
+#include "cartographer/mapping/proto/pose_graph_options.pb.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Indexes the place descriptors of nodes to rank submaps by how similar the
+// places seen by their nodes are to the place seen by a query node. This
+// allows global localization to search only the most similar submaps instead
+// of a random sample of all of them.
+//
+// Submaps are compared by the closest of their nodes. Following scan context,
+// ring keys are compared first and full descriptors only for the closest ring
+// keys.
+//
+// This class is thread-compatible.
+class PlaceDescriptorIndex {
+ public:
+  enum class Ranking { kUnranked, kCandidate, kRejected };
+
+  explicit PlaceDescriptorIndex(
+      const proto::PoseGraphOptions::PlaceRecognitionOptions& options);
+
+  PlaceDescriptorIndex(const PlaceDescriptorIndex&) = delete;
+  PlaceDescriptorIndex& operator=(const PlaceDescriptorIndex&) = delete;
+
+  // Adds the 'place_descriptor' of 'node_id'. Does nothing if it is empty or
+  // if place recognition is disabled.
+  void AddNode(const NodeId& node_id, const Eigen::MatrixXf& place_descriptor);
+
+  void TrimNode(const NodeId& node_id);
+
+  // Returns true if 'node_id' has a place descriptor in the index.
+  bool Contains(const NodeId& node_id) const;
+
+  // Ranks 'submap_ids' by place descriptor distance to 'node_id' and remembers
+  // how close a submap has to be to be among the 'max_candidate_submaps' most
+  // similar ones. The nodes of each submap are taken from 'submap_data'.
+  void RankSubmaps(const NodeId& node_id,
+                   const std::vector<SubmapId>& submap_ids,
+                   const MapById<SubmapId, InternalSubmapData>& submap_data);
+
+  // Returns whether 'submap_id' is close enough to 'node_id' to be searched
+  // according to the last 'RankSubmaps()' for 'node_id'. This also applies to
+  // submaps that were not ranked, e.g. because they were finished later.
+  // Returns 'kUnranked' if the node was never ranked or no node of the submap
+  // has a comparable place descriptor.
+  Ranking GetRanking(
+      const NodeId& node_id, const SubmapId& submap_id,
+      const MapById<SubmapId, InternalSubmapData>& submap_data) const;
+
+ private:
+  struct Node {
+    Eigen::MatrixXf normalized_place_descriptor;
+    Eigen::VectorXf ring_key;
+    // Set by 'RankSubmaps()'.
+    bool ranked = false;
+    float max_ring_key_distance = std::numeric_limits<float>::infinity();
+    float max_distance = std::numeric_limits<float>::infinity();
+  };
+
+  // Returns up to 'max_num_nodes' of 'submap_node_ids' with descriptors
+  // comparable to 'node', closest ring keys first, with their ring key
+  // distances.
+  std::vector<std::pair<float, const Node*>> FindClosestRingKeys(
+      const Node& node, const std::set<NodeId>& submap_node_ids,
+      int max_num_nodes) const;
+
+  // Returns the smallest full descriptor distance between 'node' and the
+  // 'closest_ring_keys' found by 'FindClosestRingKeys()'.
+  float ComputeDistance(
+      const Node& node,
+      const std::vector<std::pair<float, const Node*>>& closest_ring_keys)
+      const;
+
+  const proto::PoseGraphOptions::PlaceRecognitionOptions options_;
+  std::map<NodeId, Node> nodes_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_PLACE_DESCRIPTOR_INDEX_H_
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/place_descriptor_index.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+using Ranking = PlaceDescriptorIndex::Ranking;
+
+constexpr int kMapTrajectoryId = 0;
+constexpr int kNumMapSubmaps = 4;
+constexpr int kNumNodesPerSubmap = 3;
+const NodeId kQueryNodeId{1, 0};
+
+// Returns a sparse place descriptor with random counts.
+Eigen::MatrixXf CreateRandomPlaceDescriptor(std::mt19937* prng) {
+  std::uniform_int_distribution<int> distribution(-6, 3);
+  Eigen::MatrixXf place_descriptor(10, 24);
+  for (int i = 0; i != place_descriptor.size(); ++i) {
+    place_descriptor(i) = std::max(0, distribution(*prng));
+  }
+  return place_descriptor;
+}
+
+// Returns 'place_descriptor' rotated by 'rotation_in_sectors' whole sectors.
+Eigen::MatrixXf Rotate(const Eigen::MatrixXf& place_descriptor,
+                       const int rotation_in_sectors) {
+  Eigen::MatrixXf rotated(place_descriptor.rows(), place_descriptor.cols());
+  for (int sector = 0; sector != place_descriptor.cols(); ++sector) {
+    rotated.col((sector + rotation_in_sectors) % place_descriptor.cols()) =
+        place_descriptor.col(sector);
+  }
+  return rotated;
+}
+
+class PlaceDescriptorIndexTest : public ::testing::Test {
+ protected:
+  PlaceDescriptorIndexTest() : prng_(42) {
+    for (int submap_index = 0; submap_index != kNumMapSubmaps;
+         ++submap_index) {
+      const SubmapId submap_id{kMapTrajectoryId, submap_index};
+      InternalSubmapData submap;
+      submap.state = SubmapState::kFinished;
+      for (int i = 0; i != kNumNodesPerSubmap; ++i) {
+        const NodeId node_id{kMapTrajectoryId,
+                             submap_index * kNumNodesPerSubmap + i};
+        place_descriptors_[node_id] = CreateRandomPlaceDescriptor(&prng_);
+        submap.node_ids.insert(node_id);
+      }
+      submap_data_.Insert(submap_id, submap);
+      submap_ids_.push_back(submap_id);
+    }
+  }
+
+  std::unique_ptr<PlaceDescriptorIndex> CreateIndex(
+      const int max_candidate_submaps, const double max_descriptor_distance) {
+    proto::PoseGraphOptions::PlaceRecognitionOptions options;
+    options.set_max_candidate_submaps(max_candidate_submaps);
+    options.set_max_descriptor_distance(max_descriptor_distance);
+    auto index = absl::make_unique<PlaceDescriptorIndex>(options);
+    for (const auto& entry : place_descriptors_) {
+      index->AddNode(entry.first, entry.second);
+    }
+    return index;
+  }
+
+  // Returns the place descriptor of the second node of 'submap_index', seen
+  // with a different heading.
+  Eigen::MatrixXf PlaceDescriptorInSubmap(const int submap_index) {
+    return Rotate(place_descriptors_.at(NodeId{
+                      kMapTrajectoryId, submap_index * kNumNodesPerSubmap + 1}),
+                  5);
+  }
+
+  std::mt19937 prng_;
+  std::map<NodeId, Eigen::MatrixXf> place_descriptors_;
+  MapById<SubmapId, InternalSubmapData> submap_data_;
+  std::vector<SubmapId> submap_ids_;
+};
+
+TEST_F(PlaceDescriptorIndexTest, RanksMostSimilarSubmap) {
+  auto index = CreateIndex(1 /* max_candidate_submaps */,
+                           1. /* max_descriptor_distance */);
+  index->AddNode(kQueryNodeId, PlaceDescriptorInSubmap(2));
+  ASSERT_TRUE(index->Contains(kQueryNodeId));
+  index->RankSubmaps(kQueryNodeId, submap_ids_, submap_data_);
+  for (const SubmapId& submap_id : submap_ids_) {
+    EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_id, submap_data_),
+              submap_id.submap_index == 2 ? Ranking::kCandidate
+                                          : Ranking::kRejected);
+  }
+}
+
+TEST_F(PlaceDescriptorIndexTest, RejectsDissimilarSubmaps) {
+  auto index = CreateIndex(3 /* max_candidate_submaps */,
+                           0.1 /* max_descriptor_distance */);
+  index->AddNode(kQueryNodeId, PlaceDescriptorInSubmap(1));
+  index->RankSubmaps(kQueryNodeId, submap_ids_, submap_data_);
+  for (const SubmapId& submap_id : submap_ids_) {
+    EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_id, submap_data_),
+              submap_id.submap_index == 1 ? Ranking::kCandidate
+                                          : Ranking::kRejected);
+  }
+}
+
+TEST_F(PlaceDescriptorIndexTest, RankingAppliesToLaterSubmaps) {
+  auto index = CreateIndex(1 /* max_candidate_submaps */,
+                           1. /* max_descriptor_distance */);
+  index->AddNode(kQueryNodeId, PlaceDescriptorInSubmap(3));
+  index->RankSubmaps(kQueryNodeId, {submap_ids_[0], submap_ids_[1]},
+                     submap_data_);
+  EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_ids_[3], submap_data_),
+            Ranking::kCandidate);
+}
+
+TEST_F(PlaceDescriptorIndexTest, UnrankedWithoutDescriptors) {
+  auto index = CreateIndex(1 /* max_candidate_submaps */,
+                           1. /* max_descriptor_distance */);
+  EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_ids_[0], submap_data_),
+            Ranking::kUnranked);
+  index->AddNode(kQueryNodeId, PlaceDescriptorInSubmap(0));
+  EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_ids_[0], submap_data_),
+            Ranking::kUnranked);
+  index->RankSubmaps(kQueryNodeId, submap_ids_, submap_data_);
+  for (int i = 0; i != kNumNodesPerSubmap; ++i) {
+    index->TrimNode(NodeId{kMapTrajectoryId, i});
+  }
+  EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_ids_[0], submap_data_),
+            Ranking::kUnranked);
+}
+
+TEST_F(PlaceDescriptorIndexTest, DisabledWithoutCandidates) {
+  auto index = CreateIndex(0 /* max_candidate_submaps */,
+                           1. /* max_descriptor_distance */);
+  index->AddNode(kQueryNodeId, PlaceDescriptorInSubmap(0));
+  EXPECT_FALSE(index->Contains(kQueryNodeId));
+  index->RankSubmaps(kQueryNodeId, submap_ids_, submap_data_);
+  EXPECT_EQ(index->GetRanking(kQueryNodeId, submap_ids_[0], submap_data_),
+            Ranking::kUnranked);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/place_descriptor.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+proto::PlaceDescriptorOptions CreateOptions() {
+  proto::PlaceDescriptorOptions options;
+  options.set_num_rings(4);
+  options.set_num_sectors(8);
+  options.set_max_range(8.);
+  return options;
+}
+
+// Returns a point in the middle of the cell at 'ring' and 'sector'.
+sensor::RangefinderPoint PointInCell(const int ring, const int sector) {
+  const proto::PlaceDescriptorOptions options = CreateOptions();
+  const float range = (ring + 0.5f) * options.max_range() / options.num_rings();
+  const float angle = -M_PI + (sector + 0.5f) * 2.f * M_PI /
+                                  options.num_sectors();
+  return {Eigen::Vector3f(range * std::cos(angle), range * std::sin(angle),
+                          0.3f)};
+}
+
+// Returns points describing a place with a few occupied cells per sector. The
+// place is rotated by 'rotation_in_sectors' whole sectors.
+sensor::PointCloud CreatePlace(const int rotation_in_sectors) {
+  const proto::PlaceDescriptorOptions options = CreateOptions();
+  sensor::PointCloud point_cloud;
+  for (int sector = 0; sector != options.num_sectors(); ++sector) {
+    const int rotated_sector =
+        (sector + rotation_in_sectors) % options.num_sectors();
+    for (int i = 0; i <= sector % 3; ++i) {
+      point_cloud.push_back(PointInCell(sector % 4, rotated_sector));
+    }
+    point_cloud.push_back(PointInCell((sector + 2) % 4, rotated_sector));
+  }
+  return point_cloud;
+}
+
+TEST(PlaceDescriptorTest, CountsPointsPerCell) {
+  const Eigen::MatrixXf place_descriptor = ComputePlaceDescriptor(
+      {PointInCell(0, 0), PointInCell(0, 0), PointInCell(3, 5),
+       {Eigen::Vector3f(0.f, -9.f, 0.f)}},
+      CreateOptions());
+  ASSERT_EQ(place_descriptor.rows(), 4);
+  ASSERT_EQ(place_descriptor.cols(), 8);
+  EXPECT_EQ(place_descriptor(0, 0), 2.f);
+  EXPECT_EQ(place_descriptor(3, 5), 1.f);
+  EXPECT_EQ(place_descriptor.sum(), 3.f);
+}
+
+TEST(PlaceDescriptorTest, EmptyWithoutRings) {
+  proto::PlaceDescriptorOptions options = CreateOptions();
+  options.set_num_rings(0);
+  EXPECT_EQ(ComputePlaceDescriptor({PointInCell(0, 0)}, options).size(), 0);
+}
+
+TEST(PlaceDescriptorTest, RingKeyIsRotationInvariant) {
+  const Eigen::VectorXf ring_key =
+      ComputeRingKey(ComputePlaceDescriptor(CreatePlace(0), CreateOptions()));
+  EXPECT_EQ(ring_key.size(), 4);
+  EXPECT_EQ(ring_key(0), 4.f / 8.f);
+  for (int rotation = 1; rotation != 8; ++rotation) {
+    EXPECT_EQ(ring_key, ComputeRingKey(ComputePlaceDescriptor(
+                            CreatePlace(rotation), CreateOptions())));
+  }
+}
+
+TEST(PlaceDescriptorTest, DistanceIsZeroForRotatedPlace) {
+  const Eigen::MatrixXf place = NormalizeSectors(
+      ComputePlaceDescriptor(CreatePlace(0), CreateOptions()));
+  for (int rotation = 0; rotation != 8; ++rotation) {
+    const Eigen::MatrixXf rotated_place = NormalizeSectors(
+        ComputePlaceDescriptor(CreatePlace(rotation), CreateOptions()));
+    EXPECT_NEAR(ComputePlaceDescriptorDistance(place, rotated_place), 0.f,
+                1e-6f);
+  }
+}
+
+TEST(PlaceDescriptorTest, DistanceSeparatesPlaces) {
+  const Eigen::MatrixXf place = NormalizeSectors(
+      ComputePlaceDescriptor(CreatePlace(0), CreateOptions()));
+  sensor::PointCloud other_point_cloud;
+  for (int sector = 0; sector != 8; sector += 2) {
+    other_point_cloud.push_back(PointInCell(3 - sector / 2, sector));
+  }
+  const Eigen::MatrixXf other_place = NormalizeSectors(
+      ComputePlaceDescriptor(other_point_cloud, CreateOptions()));
+  EXPECT_GT(ComputePlaceDescriptorDistance(place, other_place), 0.3f);
+  EXPECT_EQ(ComputePlaceDescriptorDistance(
+                place, Eigen::MatrixXf::Zero(place.rows(), place.cols())),
+            1.f);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -16,30 +16,56 @@
 
 #include "cartographer/mapping/internal/range_data_collator.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/memory/memory.h"
 #include "cartographer/mapping/local_slam_result_data.h"
+#include "cartographer/sensor/internal/voxel_filter.h"
 #include "glog/logging.h"
 
 namespace cartographer {
 namespace mapping {
 
+namespace {
+
+// Points of one sensor which are merged into the output, sorted by time.
+struct PointRun {
+  float time() const { return begin->time + time_correction; }
+
+  sensor::TimedPointCloud::const_iterator begin;
+  sensor::TimedPointCloud::const_iterator end;
+  size_t origin_index;
+  // Makes point times relative to the time of the output.
+  float time_correction;
+};
+
+}  // namespace
+
 sensor::TimedPointCloudOriginData RangeDataCollator::AddRangeData(
     const std::string& sensor_id,
     const sensor::TimedPointCloudData& timed_point_cloud_data) {
+  return AddRangeData(sensor_id,
+                      sensor::TimedPointCloudData(timed_point_cloud_data));
+}
+
+sensor::TimedPointCloudOriginData RangeDataCollator::AddRangeData(
+    const std::string& sensor_id,
+    sensor::TimedPointCloudData&& timed_point_cloud_data) {
   CHECK_NE(expected_sensor_ids_.count(sensor_id), 0);
   // TODO(gaschler): These two cases can probably be one.
   if (id_to_pending_data_.count(sensor_id) != 0) {
     current_start_ = current_end_;
     // When we have two messages of the same sensor, move forward the older of
     // the two (do not send out current).
-    current_end_ = id_to_pending_data_.at(sensor_id).time;
+    current_end_ = id_to_pending_data_.at(sensor_id).data.time;
     auto result = CropAndMerge();
-    id_to_pending_data_.emplace(sensor_id, timed_point_cloud_data);
+    id_to_pending_data_.emplace(
+        sensor_id, PendingData{std::move(timed_point_cloud_data), 0});
     return result;
   }
-  id_to_pending_data_.emplace(sensor_id, timed_point_cloud_data);
+  id_to_pending_data_.emplace(
+      sensor_id, PendingData{std::move(timed_point_cloud_data), 0});
   if (expected_sensor_ids_.size() != id_to_pending_data_.size()) {
     return {};
   }
@@ -47,7 +73,7 @@ sensor::TimedPointCloudOriginData RangeDataCollator::AddRangeData(
   // We have messages from all sensors, move forward to oldest.
   common::Time oldest_timestamp = common::Time::max();
   for (const auto& pair : id_to_pending_data_) {
-    oldest_timestamp = std::min(oldest_timestamp, pair.second.time);
+    oldest_timestamp = std::min(oldest_timestamp, pair.second.data.time);
   }
   current_end_ = oldest_timestamp;
   return CropAndMerge();
@@ -55,13 +81,17 @@ sensor::TimedPointCloudOriginData RangeDataCollator::AddRangeData(
 
 sensor::TimedPointCloudOriginData RangeDataCollator::CropAndMerge() {
   sensor::TimedPointCloudOriginData result{current_end_, {}, {}};
+  std::vector<PointRun> runs;
+  size_t num_points = 0;
+  bool runs_are_sorted = true;
   bool warned_for_dropped_points = false;
-  for (auto it = id_to_pending_data_.begin();
-       it != id_to_pending_data_.end();) {
-    sensor::TimedPointCloudData& data = it->second;
-    sensor::TimedPointCloud& ranges = it->second.ranges;
+  for (auto& id_and_pending_data : id_to_pending_data_) {
+    PendingData& pending_data = id_and_pending_data.second;
+    const sensor::TimedPointCloudData& data = pending_data.data;
+    const sensor::TimedPointCloud& ranges = data.ranges;
+    const auto ranges_begin = ranges.begin() + pending_data.next_point_index;
 
-    auto overlap_begin = ranges.begin();
+    auto overlap_begin = ranges_begin;
     while (overlap_begin < ranges.end() &&
            data.time + common::FromSeconds((*overlap_begin).time) <
                current_start_) {
@@ -73,47 +103,90 @@ sensor::TimedPointCloudOriginData RangeDataCollator::CropAndMerge() {
                current_end_) {
       ++overlap_end;
     }
-    if (ranges.begin() < overlap_begin && !warned_for_dropped_points) {
-      LOG(WARNING) << "Dropped " << std::distance(ranges.begin(), overlap_begin)
+    if (ranges_begin < overlap_begin && !warned_for_dropped_points) {
+      LOG(WARNING) << "Dropped " << std::distance(ranges_begin, overlap_begin)
                    << " earlier points.";
       warned_for_dropped_points = true;
     }
 
-    // Copy overlapping range.
     if (overlap_begin < overlap_end) {
-      std::size_t origin_index = result.origins.size();
+      runs.push_back(PointRun{
+          overlap_begin, overlap_end, result.origins.size(),
+          static_cast<float>(common::ToSeconds(data.time - current_end_))});
       result.origins.push_back(data.origin);
-      const float time_correction =
-          static_cast<float>(common::ToSeconds(data.time - current_end_));
-      for (auto overlap_it = overlap_begin; overlap_it != overlap_end;
-           ++overlap_it) {
-        sensor::TimedPointCloudOriginData::RangeMeasurement point{*overlap_it,
-                                                                  origin_index};
-        // current_end_ + point_time[3]_after == in_timestamp +
-        // point_time[3]_before
-        point.point_time.time += time_correction;
-        result.ranges.push_back(point);
+      num_points += std::distance(overlap_begin, overlap_end);
+      runs_are_sorted =
+          runs_are_sorted &&
+          std::is_sorted(overlap_begin, overlap_end,
+                         [](const sensor::TimedRangefinderPoint& a,
+                            const sensor::TimedRangefinderPoint& b) {
+                           return a.time < b.time;
+                         });
+    }
+    // Points until 'overlap_end' are either merged now or dropped.
+    pending_data.next_point_index = std::distance(ranges.begin(), overlap_end);
+  }
+
+  // current_end_ + point_time[3]_after == in_timestamp +
+  // point_time[3]_before
+  const auto to_range_measurement = [](const PointRun& run) {
+    sensor::TimedPointCloudOriginData::RangeMeasurement point{
+        *run.begin, run.origin_index};
+    point.point_time.time += run.time_correction;
+    return point;
+  };
+  if (runs_are_sorted) {
+    // Merge the sorted runs using a heap ordered by the time of their next
+    // point, voxel filtering the points in their output order.
+    sensor::VoxelFilter voxel_filter(voxel_filter_size_);
+    const auto later = [](const PointRun& a, const PointRun& b) {
+      return a.time() > b.time();
+    };
+    if (voxel_filter_size_ <= 0.f) {
+      result.ranges.reserve(num_points);
+    }
+    std::make_heap(runs.begin(), runs.end(), later);
+    while (!runs.empty()) {
+      std::pop_heap(runs.begin(), runs.end(), later);
+      PointRun& run = runs.back();
+      if (voxel_filter_size_ <= 0.f ||
+          voxel_filter.Insert(run.begin->position)) {
+        result.ranges.push_back(to_range_measurement(run));
+      }
+      ++run.begin;
+      if (run.begin == run.end) {
+        runs.pop_back();
+      } else {
+        std::push_heap(runs.begin(), runs.end(), later);
       }
     }
+  } else {
+    result.ranges.reserve(num_points);
+    for (PointRun& run : runs) {
+      for (; run.begin != run.end; ++run.begin) {
+        result.ranges.push_back(to_range_measurement(run));
+      }
+    }
+    std::sort(result.ranges.begin(), result.ranges.end(),
+              [](const sensor::TimedPointCloudOriginData::RangeMeasurement& a,
+                 const sensor::TimedPointCloudOriginData::RangeMeasurement& b) {
+                return a.point_time.time < b.point_time.time;
+              });
+    if (voxel_filter_size_ > 0.f) {
+      result.ranges =
+          sensor::VoxelFilter(voxel_filter_size_).Filter(result.ranges);
+    }
+  }
 
-    // Drop buffered points until overlap_end.
-    if (overlap_end == ranges.end()) {
+  // Drop buffered data once all of its points have been merged.
+  for (auto it = id_to_pending_data_.begin();
+       it != id_to_pending_data_.end();) {
+    if (it->second.next_point_index == it->second.data.ranges.size()) {
       it = id_to_pending_data_.erase(it);
-    } else if (overlap_end == ranges.begin()) {
-      ++it;
     } else {
-      data = sensor::TimedPointCloudData{
-          data.time, data.origin,
-          sensor::TimedPointCloud(overlap_end, ranges.end())};
       ++it;
     }
   }
-
-  std::sort(result.ranges.begin(), result.ranges.end(),
-            [](const sensor::TimedPointCloudOriginData::RangeMeasurement& a,
-               const sensor::TimedPointCloudOriginData::RangeMeasurement& b) {
-              return a.point_time.time < b.point_time.time;
-            });
   return result;
 }
 
@@ -17,7 +17,11 @@
 #ifndef CARTOGRAPHER_MAPPING_INTERNAL_RANGE_DATA_COLLATOR_H_
 #define CARTOGRAPHER_MAPPING_INTERNAL_RANGE_DATA_COLLATOR_H_
 
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "cartographer/sensor/timed_point_cloud_data.h"
@@ -34,19 +38,39 @@ class RangeDataCollator {
  public:
   explicit RangeDataCollator(
       const std::vector<std::string>& expected_range_sensor_ids)
+      : RangeDataCollator(expected_range_sensor_ids,
+                          /*voxel_filter_size=*/0.f) {}
+
+  // If 'voxel_filter_size' is positive, the output is voxel filtered with
+  // this edge length while merging, keeping the earliest point of each voxel.
+  RangeDataCollator(const std::vector<std::string>& expected_range_sensor_ids,
+                    float voxel_filter_size)
       : expected_sensor_ids_(expected_range_sensor_ids.begin(),
-                             expected_range_sensor_ids.end()) {}
+                             expected_range_sensor_ids.end()),
+        voxel_filter_size_(voxel_filter_size) {}
 
   sensor::TimedPointCloudOriginData AddRangeData(
       const std::string& sensor_id,
       const sensor::TimedPointCloudData& timed_point_cloud_data);
 
+  // Same as above, but takes ownership of the points instead of copying them.
+  sensor::TimedPointCloudOriginData AddRangeData(
+      const std::string& sensor_id,
+      sensor::TimedPointCloudData&& timed_point_cloud_data);
+
  private:
+  struct PendingData {
+    sensor::TimedPointCloudData data;
+    // Points of 'data' before this index have already been merged.
+    size_t next_point_index;
+  };
+
   sensor::TimedPointCloudOriginData CropAndMerge();
 
   const std::set<std::string> expected_sensor_ids_;
+  const float voxel_filter_size_;
   // Store at most one message for each sensor.
-  std::map<std::string, sensor::TimedPointCloudData> id_to_pending_data_;
+  std::map<std::string, PendingData> id_to_pending_data_;
   common::Time current_start_ = common::Time::min();
   common::Time current_end_ = common::Time::min();
 };
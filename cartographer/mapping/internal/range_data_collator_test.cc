@@ -165,6 +165,51 @@ TEST(RangeDataCollatorTest, ThreeSensors) {
   EXPECT_TRUE(ArePointTimestampsSorted(output_3));
 }
 
+TEST(RangeDataCollatorTest, VoxelFiltersWhileMerging) {
+  const std::string sensor_0 = "sensor_0";
+  const std::string sensor_1 = "sensor_1";
+  RangeDataCollator collator({sensor_0, sensor_1}, /*voxel_filter_size=*/0.1f);
+  // All points of the fake range data fall into the same voxel.
+  EXPECT_TRUE(collator.AddRangeData(sensor_0, CreateFakeRangeData(100, 200))
+                  .ranges.empty());
+  const auto output =
+      collator.AddRangeData(sensor_1, CreateFakeRangeData(150, 200));
+  EXPECT_EQ(common::ToUniversal(output.time), 200);
+  ASSERT_EQ(output.ranges.size(), 1);
+  EXPECT_NEAR(common::ToUniversal(
+                  output.time +
+                  common::FromSeconds(output.ranges[0].point_time.time)),
+              100, 2);
+}
+
+TEST(RangeDataCollatorTest, MovedDataMatchesCopiedData) {
+  const std::string sensor_0 = "sensor_0";
+  const std::string sensor_1 = "sensor_1";
+  RangeDataCollator copying_collator({sensor_0, sensor_1});
+  RangeDataCollator moving_collator({sensor_0, sensor_1});
+  const std::vector<std::pair<std::string, std::pair<int, int>>> inputs = {
+      {sensor_0, {100, 200}},
+      {sensor_1, {120, 220}},
+      {sensor_0, {200, 300}},
+      {sensor_1, {220, 320}}};
+  for (const auto& input : inputs) {
+    const sensor::TimedPointCloudData data =
+        CreateFakeRangeData(input.second.first, input.second.second);
+    const auto copied = copying_collator.AddRangeData(input.first, data);
+    const auto moved = moving_collator.AddRangeData(
+        input.first, CreateFakeRangeData(input.second.first,
+                                         input.second.second));
+    EXPECT_EQ(copied.time, moved.time);
+    EXPECT_EQ(copied.origins.size(), moved.origins.size());
+    ASSERT_EQ(copied.ranges.size(), moved.ranges.size());
+    for (size_t i = 0; i < copied.ranges.size(); ++i) {
+      EXPECT_EQ(copied.ranges[i].point_time.time,
+                moved.ranges[i].point_time.time);
+    }
+    EXPECT_TRUE(ArePointTimestampsSorted(moved));
+  }
+}
+
 }  // namespace
 }  // namespace mapping
 }  // namespace cartographer
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/stationary_filter.h"
+
+#include "cartographer/transform/transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+static auto* kSkippedRangeDataMetric = metrics::Counter::Null();
+static auto* kScanMatchedRangeDataMetric = metrics::Counter::Null();
+
+proto::StationaryFilterOptions CreateStationaryFilterOptions(
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  proto::StationaryFilterOptions options;
+  options.set_max_distance_meters(
+      parameter_dictionary->GetDouble("max_distance_meters"));
+  options.set_max_angle_radians(
+      parameter_dictionary->GetDouble("max_angle_radians"));
+  options.set_max_num_skipped_range_data(
+      parameter_dictionary->GetNonNegativeInt("max_num_skipped_range_data"));
+  return options;
+}
+
+StationaryFilter::StationaryFilter(
+    const proto::StationaryFilterOptions& options)
+    : options_(options) {}
+
+bool StationaryFilter::IsStationary(const transform::Rigid3d& pose_prediction) {
+  if (!last_scan_matched_pose_.has_value() ||
+      num_skipped_range_data_ >= options_.max_num_skipped_range_data()) {
+    return false;
+  }
+  const transform::Rigid3d motion =
+      last_scan_matched_pose_.value().inverse() * pose_prediction;
+  if (motion.translation().norm() > options_.max_distance_meters() ||
+      transform::GetAngle(motion) > options_.max_angle_radians()) {
+    return false;
+  }
+  ++num_skipped_range_data_;
+  kSkippedRangeDataMetric->Increment();
+  return true;
+}
+
+void StationaryFilter::AddScanMatchedPose(const transform::Rigid3d& pose) {
+  last_scan_matched_pose_ = pose;
+  num_skipped_range_data_ = 0;
+  kScanMatchedRangeDataMetric->Increment();
+}
+
+void StationaryFilter::RegisterMetrics(
+    metrics::FamilyFactory* family_factory) {
+  auto* range_data = family_factory->NewCounterFamily(
+      "mapping_stationary_filter_range_data",
+      "Accumulated range data by whether scan matching was skipped");
+  kSkippedRangeDataMetric = range_data->Add({{"kind", "skipped"}});
+  kScanMatchedRangeDataMetric = range_data->Add({{"kind", "scan_matched"}});
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_STATIONARY_FILTER_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_STATIONARY_FILTER_H_
+
+#include "absl/types/optional.h"
+#include "cartographer/common/lua_parameter_dictionary.h"
+#include "cartographer/mapping/proto/stationary_filter_options.pb.h"
+#include "cartographer/metrics/family_factory.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+proto::StationaryFilterOptions CreateStationaryFilterOptions(
+    common::LuaParameterDictionary* parameter_dictionary);
+
+// Decides whether accumulated range data can skip filtering and scan matching
+// because the robot is not moving. This is decided before any processing,
+// based on the pose predicted by the 'PoseExtrapolator'.
+class StationaryFilter {
+ public:
+  explicit StationaryFilter(const proto::StationaryFilterOptions& options);
+
+  // Returns true if the 'pose_prediction' is close to the last scan matched
+  // pose and the limit of consecutively skipped range data has not been
+  // reached. Skipped range data are counted.
+  bool IsStationary(const transform::Rigid3d& pose_prediction);
+
+  // Has to be called with every pose found by scan matching.
+  void AddScanMatchedPose(const transform::Rigid3d& pose);
+
+  static void RegisterMetrics(metrics::FamilyFactory* family_factory);
+
+ private:
+  const proto::StationaryFilterOptions options_;
+  absl::optional<transform::Rigid3d> last_scan_matched_pose_;
+  int num_skipped_range_data_ = 0;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_STATIONARY_FILTER_H_
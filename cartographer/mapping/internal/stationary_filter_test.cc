@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/stationary_filter.h"
+
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+proto::StationaryFilterOptions CreateOptions() {
+  proto::StationaryFilterOptions options;
+  options.set_max_distance_meters(0.01);
+  options.set_max_angle_radians(0.01);
+  options.set_max_num_skipped_range_data(3);
+  return options;
+}
+
+TEST(StationaryFilterTest, RequiresScanMatchedPose) {
+  StationaryFilter stationary_filter(CreateOptions());
+  EXPECT_FALSE(stationary_filter.IsStationary(transform::Rigid3d::Identity()));
+}
+
+TEST(StationaryFilterTest, SkipsUntilMotion) {
+  StationaryFilter stationary_filter(CreateOptions());
+  stationary_filter.AddScanMatchedPose(
+      transform::Rigid3d::Translation(Eigen::Vector3d(1., 2., 0.)));
+  EXPECT_TRUE(stationary_filter.IsStationary(
+      transform::Rigid3d::Translation(Eigen::Vector3d(1.005, 2., 0.))));
+  EXPECT_FALSE(stationary_filter.IsStationary(
+      transform::Rigid3d::Translation(Eigen::Vector3d(1.02, 2., 0.))));
+  EXPECT_FALSE(stationary_filter.IsStationary(transform::Rigid3d(
+      Eigen::Vector3d(1., 2., 0.),
+      Eigen::AngleAxisd(0.02, Eigen::Vector3d::UnitZ()))));
+}
+
+TEST(StationaryFilterTest, LimitsConsecutiveSkips) {
+  StationaryFilter stationary_filter(CreateOptions());
+  stationary_filter.AddScanMatchedPose(transform::Rigid3d::Identity());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(
+        stationary_filter.IsStationary(transform::Rigid3d::Identity()));
+  }
+  EXPECT_FALSE(stationary_filter.IsStationary(transform::Rigid3d::Identity()));
+  stationary_filter.AddScanMatchedPose(transform::Rigid3d::Identity());
+  EXPECT_TRUE(stationary_filter.IsStationary(transform::Rigid3d::Identity()));
+}
+
+TEST(StationaryFilterTest, DisabledByDefault) {
+  StationaryFilter stationary_filter(proto::StationaryFilterOptions{});
+  stationary_filter.AddScanMatchedPose(transform::Rigid3d::Identity());
+  EXPECT_FALSE(stationary_filter.IsStationary(transform::Rigid3d::Identity()));
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
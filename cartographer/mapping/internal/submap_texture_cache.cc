@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/submap_texture_cache.h"
+
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+
+SubmapTextureCache::SubmapTextureCache(
+    const size_t max_size_in_bytes, const bool textures_depend_on_global_pose)
+    : max_size_in_bytes_(max_size_in_bytes),
+      textures_depend_on_global_pose_(textures_depend_on_global_pose) {}
+
+void SubmapTextureCache::ToResponseProto(
+    const SubmapId& submap_id,
+    const PoseGraphInterface::SubmapData& submap_data,
+    proto::SubmapQuery::Response* const response) {
+  CHECK(submap_data.submap != nullptr);
+  std::shared_ptr<const proto::SubmapQuery::Response> cached_response;
+  {
+    absl::MutexLock locker(&mutex_);
+    const auto it = entries_.find(submap_id);
+    if (it != entries_.end()) {
+      if (IsUpToDate(it->second, submap_data)) {
+        lru_submap_ids_.splice(lru_submap_ids_.begin(), lru_submap_ids_,
+                               it->second.lru_position);
+        cached_response = it->second.response;
+      } else {
+        EraseEntry(it);
+      }
+    }
+  }
+  if (cached_response != nullptr) {
+    // Cached responses are immutable, so they are copied without the lock.
+    *response = *cached_response;
+    return;
+  }
+
+  // Rendering and compressing the textures is the expensive part and happens
+  // without holding the lock. The state is read before rendering, so that a
+  // concurrent insertion can only make the entry look outdated.
+  const int version = submap_data.submap->num_range_data();
+  const bool finished = submap_data.submap->insertion_finished();
+  auto rendered_response = std::make_shared<proto::SubmapQuery::Response>();
+  submap_data.submap->ToResponseProto(submap_data.pose,
+                                      rendered_response.get());
+  *response = *rendered_response;
+  const size_t size_in_bytes = rendered_response->ByteSizeLong();
+  if (size_in_bytes > max_size_in_bytes_) {
+    return;
+  }
+
+  absl::MutexLock locker(&mutex_);
+  const auto it = entries_.find(submap_id);
+  if (it != entries_.end()) {
+    // Another query rendered the submap concurrently.
+    EraseEntry(it);
+  }
+  while (size_in_bytes_ + size_in_bytes > max_size_in_bytes_) {
+    EraseEntry(entries_.find(lru_submap_ids_.back()));
+  }
+  lru_submap_ids_.push_front(submap_id);
+  entries_.emplace(
+      submap_id,
+      Entry{version, finished, submap_data.pose, std::move(rendered_response),
+            size_in_bytes, lru_submap_ids_.begin()});
+  size_in_bytes_ += size_in_bytes;
+}
+
+void SubmapTextureCache::Erase(const SubmapId& submap_id) {
+  absl::MutexLock locker(&mutex_);
+  const auto it = entries_.find(submap_id);
+  if (it != entries_.end()) {
+    EraseEntry(it);
+  }
+}
+
+int SubmapTextureCache::num_entries() const {
+  absl::MutexLock locker(&mutex_);
+  return entries_.size();
+}
+
+size_t SubmapTextureCache::size_in_bytes() const {
+  absl::MutexLock locker(&mutex_);
+  return size_in_bytes_;
+}
+
+bool SubmapTextureCache::IsUpToDate(
+    const Entry& entry,
+    const PoseGraphInterface::SubmapData& submap_data) const {
+  if (entry.version != submap_data.submap->num_range_data() ||
+      entry.finished != submap_data.submap->insertion_finished()) {
+    return false;
+  }
+  if (!textures_depend_on_global_pose_) {
+    return true;
+  }
+  return entry.global_pose.translation() == submap_data.pose.translation() &&
+         entry.global_pose.rotation().coeffs() ==
+             submap_data.pose.rotation().coeffs();
+}
+
+void SubmapTextureCache::EraseEntry(
+    const std::map<SubmapId, Entry>::iterator it) {
+  size_in_bytes_ -= it->second.size_in_bytes;
+  lru_submap_ids_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+}  // namespace mapping
+}  // namespace cartographer
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_SUBMAP_TEXTURE_CACHE_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_SUBMAP_TEXTURE_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "cartographer/mapping/id.h"
+#include "cartographer/mapping/pose_graph_interface.h"
+#include "cartographer/mapping/proto/submap_visualization.pb.h"
+#include "cartographer/transform/rigid_transform.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Caches the responses to submap queries, so that repeated queries of a
+// submap which did not change since it was last rendered only cost a lookup
+// and a copy of the already compressed textures. A cached response is reused
+// as long as the submap's version and finished state are unchanged and, if
+// 'textures_depend_on_global_pose' is set as for 3D submaps, the global
+// submap pose is the same. Responses are evicted in least recently used
+// order once the cached textures exceed 'max_size_in_bytes'.
+class SubmapTextureCache {
+ public:
+  SubmapTextureCache(size_t max_size_in_bytes,
+                     bool textures_depend_on_global_pose);
+
+  SubmapTextureCache(const SubmapTextureCache&) = delete;
+  SubmapTextureCache& operator=(const SubmapTextureCache&) = delete;
+
+  // Fills 'response' for the submap in 'submap_data' with 'submap_id',
+  // rendering the textures only if no cached response is up to date.
+  void ToResponseProto(const SubmapId& submap_id,
+                       const PoseGraphInterface::SubmapData& submap_data,
+                       proto::SubmapQuery::Response* response)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Removes the cached response of 'submap_id', e.g. after it was trimmed.
+  void Erase(const SubmapId& submap_id) LOCKS_EXCLUDED(mutex_);
+
+  int num_entries() const LOCKS_EXCLUDED(mutex_);
+  size_t size_in_bytes() const LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Entry {
+    int version;
+    bool finished;
+    transform::Rigid3d global_pose;
+    std::shared_ptr<const proto::SubmapQuery::Response> response;
+    size_t size_in_bytes;
+    std::list<SubmapId>::iterator lru_position;
+  };
+
+  bool IsUpToDate(const Entry& entry,
+                  const PoseGraphInterface::SubmapData& submap_data) const;
+  void EraseEntry(std::map<SubmapId, Entry>::iterator it)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t max_size_in_bytes_;
+  const bool textures_depend_on_global_pose_;
+
+  mutable absl::Mutex mutex_;
+  std::map<SubmapId, Entry> entries_ GUARDED_BY(mutex_);
+  // Submap IDs of all entries, the most recently used first.
+  std::list<SubmapId> lru_submap_ids_ GUARDED_BY(mutex_);
+  size_t size_in_bytes_ GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_SUBMAP_TEXTURE_CACHE_H_
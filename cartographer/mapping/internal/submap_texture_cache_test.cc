@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/submap_texture_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cartographer/mapping/submaps.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+constexpr int kTextureSize = 1000;
+
+// Renders a texture of 'kTextureSize' bytes and counts how often it did.
+class FakeSubmap : public Submap {
+ public:
+  FakeSubmap() : Submap(transform::Rigid3d::Identity()) {}
+
+  proto::Submap ToProto(bool) const override { return proto::Submap(); }
+  void UpdateFromProto(const proto::Submap&) override {}
+  void ToResponseProto(const transform::Rigid3d&,
+                       proto::SubmapQuery::Response* response) const override {
+    ++num_renderings_;
+    response->set_submap_version(num_range_data());
+    response->add_textures()->set_cells(std::string(kTextureSize, 'x'));
+  }
+  size_t EstimateMemoryUsage() const override { return sizeof(*this); }
+
+  int num_renderings() const { return num_renderings_; }
+
+ private:
+  mutable int num_renderings_ = 0;
+};
+
+PoseGraphInterface::SubmapData CreateSubmapData(
+    std::shared_ptr<FakeSubmap> submap, const transform::Rigid3d& pose) {
+  return PoseGraphInterface::SubmapData{std::move(submap), pose};
+}
+
+TEST(SubmapTextureCacheTest, RendersOnlyChangedSubmaps) {
+  SubmapTextureCache cache(10 * kTextureSize,
+                           false /* textures_depend_on_global_pose */);
+  auto submap = std::make_shared<FakeSubmap>();
+  const SubmapId submap_id{0, 0};
+  proto::SubmapQuery::Response response;
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  cache.ToResponseProto(
+      submap_id,
+      CreateSubmapData(submap, transform::Rigid3d::Translation(
+                                   Eigen::Vector3d(1., 0., 0.))),
+      &response);
+  EXPECT_EQ(submap->num_renderings(), 1);
+  EXPECT_EQ(response.textures(0).cells().size(), kTextureSize);
+
+  submap->set_num_range_data(1);
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  EXPECT_EQ(submap->num_renderings(), 2);
+  EXPECT_EQ(response.submap_version(), 1);
+
+  submap->set_insertion_finished(true);
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  EXPECT_EQ(submap->num_renderings(), 3);
+  EXPECT_EQ(cache.num_entries(), 1);
+}
+
+TEST(SubmapTextureCacheTest, RendersAgainIfGlobalPoseChanged) {
+  SubmapTextureCache cache(10 * kTextureSize,
+                           true /* textures_depend_on_global_pose */);
+  auto submap = std::make_shared<FakeSubmap>();
+  const SubmapId submap_id{0, 0};
+  proto::SubmapQuery::Response response;
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  cache.ToResponseProto(
+      submap_id, CreateSubmapData(submap, transform::Rigid3d::Identity()),
+      &response);
+  EXPECT_EQ(submap->num_renderings(), 1);
+  cache.ToResponseProto(
+      submap_id,
+      CreateSubmapData(submap, transform::Rigid3d::Translation(
+                                   Eigen::Vector3d(1., 0., 0.))),
+      &response);
+  EXPECT_EQ(submap->num_renderings(), 2);
+}
+
+TEST(SubmapTextureCacheTest, EvictsLeastRecentlyUsed) {
+  SubmapTextureCache cache(3 * kTextureSize,
+                           false /* textures_depend_on_global_pose */);
+  std::vector<std::shared_ptr<FakeSubmap>> submaps;
+  proto::SubmapQuery::Response response;
+  for (int i = 0; i < 3; ++i) {
+    submaps.push_back(std::make_shared<FakeSubmap>());
+    cache.ToResponseProto(
+        SubmapId{0, i},
+        CreateSubmapData(submaps.back(), transform::Rigid3d::Identity()),
+        &response);
+  }
+  // The size of a response slightly exceeds the texture size, so only two
+  // responses fit.
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_LE(cache.size_in_bytes(), 3 * kTextureSize);
+
+  // Submap 1 is used more recently than submap 2 afterwards.
+  cache.ToResponseProto(
+      SubmapId{0, 1},
+      CreateSubmapData(submaps[1], transform::Rigid3d::Identity()), &response);
+  EXPECT_EQ(submaps[1]->num_renderings(), 1);
+  cache.ToResponseProto(
+      SubmapId{0, 0},
+      CreateSubmapData(submaps[0], transform::Rigid3d::Identity()), &response);
+  EXPECT_EQ(submaps[0]->num_renderings(), 2);
+  cache.ToResponseProto(
+      SubmapId{0, 1},
+      CreateSubmapData(submaps[1], transform::Rigid3d::Identity()), &response);
+  EXPECT_EQ(submaps[1]->num_renderings(), 1);
+  cache.ToResponseProto(
+      SubmapId{0, 2},
+      CreateSubmapData(submaps[2], transform::Rigid3d::Identity()), &response);
+  EXPECT_EQ(submaps[2]->num_renderings(), 2);
+
+  cache.Erase(SubmapId{0, 2});
+  EXPECT_EQ(cache.num_entries(), 1);
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -90,6 +90,14 @@ class FakeTrimmable : public Trimmable {
     return constraints_;
   }
 
+  void set_sensor_data_memory_usage(const size_t sensor_data_memory_usage) {
+    sensor_data_memory_usage_ = sensor_data_memory_usage;
+  }
+
+  size_t EstimateSensorDataMemoryUsage(int trajectory_id) const override {
+    return sensor_data_memory_usage_;
+  }
+
   void TrimSubmap(const SubmapId& submap_id) override {
     trimmed_submaps_.push_back(submap_id);
   }
@@ -104,6 +112,7 @@ class FakeTrimmable : public Trimmable {
 
  private:
   std::vector<SubmapId> trimmed_submaps_;
+  size_t sensor_data_memory_usage_ = 0;
 
   std::vector<PoseGraphInterface::Constraint> constraints_;
   MapById<NodeId, TrajectoryNode> trajectory_nodes_;
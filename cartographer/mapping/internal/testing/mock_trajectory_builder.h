@@ -49,6 +49,8 @@ class MockTrajectoryBuilder : public mapping::TrajectoryBuilderInterface {
                                   local_slam_result_data) override {
     DoAddLocalSlamResultData(local_slam_result_data.get());
   }
+  MOCK_CONST_METHOD1(ExtrapolateLocalPose,
+                     absl::optional<transform::Rigid3d>(common::Time));
 };
 
 }  // namespace testing
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/trajectory_builder_thread.h"
+
+#include <algorithm>
+
+#include "absl/time/time.h"
+#include "glog/logging.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+// The thread wakes up regularly even if it missed no notification.
+constexpr absl::Duration kWakeupTimeout = absl::Milliseconds(100);
+
+}  // namespace
+
+static auto* kPendingDataMetric = metrics::Gauge::Null();
+
+TrajectoryBuilderThread::SensorQueue::SensorQueue(
+    TrajectoryBuilderThread* const trajectory_builder_thread,
+    const int trajectory_id, Callback callback)
+    : trajectory_builder_thread_(trajectory_builder_thread),
+      trajectory_id_(trajectory_id),
+      callback_(std::move(callback)),
+      removed_(false) {}
+
+void TrajectoryBuilderThread::SensorQueue::Push(
+    std::unique_ptr<sensor::Data> data) {
+  if (removed_) {
+    LOG_EVERY_N(WARNING, 1000)
+        << "Ignored data of removed trajectory " << trajectory_id_ << ".";
+    return;
+  }
+  // Counted before it becomes visible to the thread, which may process it
+  // right away. Until then, the thread may find one data less than counted
+  // and check again.
+  const bool was_idle =
+      trajectory_builder_thread_->num_pending_data_.fetch_add(1) == 0;
+  queue_.Push(std::move(data));
+  if (was_idle) {
+    trajectory_builder_thread_->WakeUp();
+  }
+}
+
+bool TrajectoryBuilderThread::SensorQueue::ProcessOne() {
+  std::unique_ptr<sensor::Data> data = queue_.Pop();
+  if (data == nullptr) {
+    return false;
+  }
+  trajectory_builder_thread_->num_pending_data_.fetch_sub(1);
+  callback_(std::move(data));
+  return true;
+}
+
+TrajectoryBuilderThread::TrajectoryBuilderThread()
+    : num_pending_data_(0),
+      shutting_down_(false),
+      thread_([this]() { Run(); }) {}
+
+TrajectoryBuilderThread::~TrajectoryBuilderThread() {
+  shutting_down_ = true;
+  { absl::MutexLock locker(&wakeup_mutex_); }
+  thread_.join();
+}
+
+std::shared_ptr<TrajectoryBuilderThread::SensorQueue>
+TrajectoryBuilderThread::AddSensorQueue(const int trajectory_id,
+                                        Callback callback) {
+  absl::MutexLock locker(&mutex_);
+  sensor_queues_.push_back(std::shared_ptr<SensorQueue>(
+      new SensorQueue(this, trajectory_id, std::move(callback))));
+  return sensor_queues_.back();
+}
+
+void TrajectoryBuilderThread::RemoveSensorQueues(const int trajectory_id) {
+  absl::MutexLock locker(&mutex_);
+  ProcessPendingData();
+  const auto it = std::stable_partition(
+      sensor_queues_.begin(), sensor_queues_.end(),
+      [trajectory_id](const std::shared_ptr<SensorQueue>& sensor_queue) {
+        return sensor_queue->trajectory_id_ != trajectory_id;
+      });
+  for (auto removed_it = it; removed_it != sensor_queues_.end();
+       ++removed_it) {
+    (*removed_it)->removed_ = true;
+  }
+  sensor_queues_.erase(it, sensor_queues_.end());
+}
+
+void TrajectoryBuilderThread::RunExclusively(
+    const std::function<void()>& function) {
+  absl::MutexLock locker(&mutex_);
+  ProcessPendingData();
+  function();
+}
+
+void TrajectoryBuilderThread::WakeUp() {
+  // Unlocking makes a waiting thread reevaluate its condition.
+  absl::MutexLock locker(&wakeup_mutex_);
+}
+
+void TrajectoryBuilderThread::Run() {
+  const auto predicate = [this]() {
+    return num_pending_data_ > 0 || shutting_down_;
+  };
+  while (true) {
+    {
+      absl::MutexLock locker(&wakeup_mutex_);
+      wakeup_mutex_.AwaitWithTimeout(absl::Condition(&predicate),
+                                     kWakeupTimeout);
+    }
+    // Read before processing, so that all data pushed before shutting down
+    // is processed.
+    const bool shutting_down = shutting_down_;
+    absl::MutexLock locker(&mutex_);
+    ProcessPendingData();
+    if (shutting_down) {
+      return;
+    }
+  }
+}
+
+void TrajectoryBuilderThread::ProcessPendingData() {
+  kPendingDataMetric->Set(num_pending_data_);
+  // Takes turns between sensors, so that a single sensor cannot starve the
+  // others.
+  bool processed_data = true;
+  while (processed_data) {
+    processed_data = false;
+    for (const auto& sensor_queue : sensor_queues_) {
+      processed_data |= sensor_queue->ProcessOne();
+    }
+  }
+}
+
+void TrajectoryBuilderThread::RegisterMetrics(
+    metrics::FamilyFactory* family_factory) {
+  auto* pending_data = family_factory->NewGaugeFamily(
+      "mapping_trajectory_builder_thread_pending_data",
+      "Number of sensor data waiting to be processed");
+  kPendingDataMetric = pending_data->Add({});
+}
+
+}  // namespace mapping
+}  // namespace cartographer
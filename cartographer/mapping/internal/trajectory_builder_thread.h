@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CARTOGRAPHER_MAPPING_INTERNAL_TRAJECTORY_BUILDER_THREAD_H_
+#define CARTOGRAPHER_MAPPING_INTERNAL_TRAJECTORY_BUILDER_THREAD_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "cartographer/common/lockless_queue.h"
+#include "cartographer/metrics/family_factory.h"
+#include "cartographer/sensor/data.h"
+
+namespace cartographer {
+namespace mapping {
+
+// Processes sensor data on a dedicated thread. Threads adding sensor data only
+// push it onto a lock-free queue, one per sensor, and return immediately, so
+// bursts of data are buffered instead of blocking them.
+class TrajectoryBuilderThread {
+ public:
+  using Callback = std::function<void(std::unique_ptr<sensor::Data>)>;
+
+  class SensorQueue {
+   public:
+    SensorQueue(const SensorQueue&) = delete;
+    SensorQueue& operator=(const SensorQueue&) = delete;
+
+    // Hands 'data' over to the thread, which passes it to the callback in the
+    // order it was pushed. Lock-free unless the thread is idle and needs to
+    // be woken up. Data pushed after the queue was removed is dropped.
+    void Push(std::unique_ptr<sensor::Data> data);
+
+   private:
+    friend class TrajectoryBuilderThread;
+
+    SensorQueue(TrajectoryBuilderThread* trajectory_builder_thread,
+                int trajectory_id, Callback callback);
+
+    // Passes the oldest data to the callback. Returns false if there was none.
+    bool ProcessOne();
+
+    TrajectoryBuilderThread* const trajectory_builder_thread_;
+    const int trajectory_id_;
+    const Callback callback_;
+    common::LocklessQueue<sensor::Data> queue_;
+    std::atomic<bool> removed_;
+  };
+
+  TrajectoryBuilderThread();
+  // Processes all remaining data before the thread is stopped.
+  ~TrajectoryBuilderThread();
+
+  TrajectoryBuilderThread(const TrajectoryBuilderThread&) = delete;
+  TrajectoryBuilderThread& operator=(const TrajectoryBuilderThread&) = delete;
+
+  // Returns a queue whose data is passed to 'callback' on the thread until the
+  // queues of 'trajectory_id' are removed.
+  std::shared_ptr<SensorQueue> AddSensorQueue(int trajectory_id,
+                                              Callback callback)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Processes all data pushed so far, then removes the queues of
+  // 'trajectory_id' so that the thread no longer polls them. Must not be
+  // called concurrently with pushing data to these queues.
+  void RemoveSensorQueues(int trajectory_id) LOCKS_EXCLUDED(mutex_);
+
+  // Processes all data pushed so far, then calls 'function' while no data is
+  // processed. Used to synchronize with state shared with the thread.
+  void RunExclusively(const std::function<void()>& function)
+      LOCKS_EXCLUDED(mutex_);
+
+  static void RegisterMetrics(metrics::FamilyFactory* family_factory);
+
+ private:
+  void Run() LOCKS_EXCLUDED(mutex_);
+  void ProcessPendingData() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void WakeUp() LOCKS_EXCLUDED(wakeup_mutex_);
+
+  absl::Mutex mutex_;
+  std::vector<std::shared_ptr<SensorQueue>> sensor_queues_ GUARDED_BY(mutex_);
+
+  // Number of data being pushed or pushed, but not yet processed. Producers
+  // increase it before the data is published, so it never becomes negative.
+  // The thread waits on 'wakeup_mutex_' until this becomes positive, and
+  // producers which increased it from zero lock it once the data is
+  // published.
+  std::atomic<int> num_pending_data_;
+  std::atomic<bool> shutting_down_;
+  absl::Mutex wakeup_mutex_;
+
+  std::thread thread_;
+};
+
+}  // namespace mapping
+}  // namespace cartographer
+
+#endif  // CARTOGRAPHER_MAPPING_INTERNAL_TRAJECTORY_BUILDER_THREAD_H_
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cartographer/mapping/internal/trajectory_builder_thread.h"
+
+#include <thread>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "cartographer/sensor/imu_data.h"
+#include "cartographer/sensor/internal/dispatchable.h"
+#include "gtest/gtest.h"
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+std::unique_ptr<sensor::Data> MakeImuData(const std::string& sensor_id,
+                                          const int64_t timestamp) {
+  return sensor::MakeDispatchable(
+      sensor_id, sensor::ImuData{common::FromUniversal(timestamp),
+                                 Eigen::Vector3d::Zero(),
+                                 Eigen::Vector3d::Zero()});
+}
+
+TEST(TrajectoryBuilderThreadTest, ProcessesDataInOrderPerSensor) {
+  constexpr int kNumSensors = 3;
+  constexpr int kNumDataPerSensor = 1000;
+  absl::Mutex mutex;
+  std::vector<std::vector<common::Time>> times(kNumSensors);
+  {
+    TrajectoryBuilderThread trajectory_builder_thread;
+    std::vector<std::shared_ptr<TrajectoryBuilderThread::SensorQueue>>
+        sensor_queues;
+    for (int i = 0; i < kNumSensors; ++i) {
+      sensor_queues.push_back(trajectory_builder_thread.AddSensorQueue(
+          0 /* trajectory_id */,
+          [&mutex, &times, i](std::unique_ptr<sensor::Data> data) {
+            absl::MutexLock locker(&mutex);
+            times[i].push_back(data->GetTime());
+          }));
+    }
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kNumSensors; ++i) {
+      producers.emplace_back([&sensor_queues, i]() {
+        for (int j = 0; j < kNumDataPerSensor; ++j) {
+          sensor_queues[i]->Push(MakeImuData("imu", j));
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+  }
+  for (int i = 0; i < kNumSensors; ++i) {
+    ASSERT_EQ(times[i].size(), kNumDataPerSensor);
+    for (int j = 0; j < kNumDataPerSensor; ++j) {
+      EXPECT_EQ(times[i][j], common::FromUniversal(j));
+    }
+  }
+}
+
+TEST(TrajectoryBuilderThreadTest, RunExclusivelyProcessesPendingData) {
+  int num_processed = 0;
+  TrajectoryBuilderThread trajectory_builder_thread;
+  const auto sensor_queue = trajectory_builder_thread.AddSensorQueue(
+      0 /* trajectory_id */,
+      [&num_processed](std::unique_ptr<sensor::Data>) { ++num_processed; });
+  for (int i = 0; i < 10; ++i) {
+    sensor_queue->Push(MakeImuData("imu", i));
+  }
+  trajectory_builder_thread.RunExclusively(
+      [&num_processed]() { EXPECT_EQ(num_processed, 10); });
+}
+
+TEST(TrajectoryBuilderThreadTest, RemovesSensorQueuesOfTrajectory) {
+  std::vector<int> num_processed(2, 0);
+  TrajectoryBuilderThread trajectory_builder_thread;
+  std::vector<std::shared_ptr<TrajectoryBuilderThread::SensorQueue>>
+      sensor_queues;
+  for (int trajectory_id = 0; trajectory_id < 2; ++trajectory_id) {
+    sensor_queues.push_back(trajectory_builder_thread.AddSensorQueue(
+        trajectory_id,
+        [&num_processed, trajectory_id](std::unique_ptr<sensor::Data>) {
+          ++num_processed[trajectory_id];
+        }));
+  }
+  for (int i = 0; i < 10; ++i) {
+    sensor_queues[0]->Push(MakeImuData("imu", i));
+    sensor_queues[1]->Push(MakeImuData("imu", i));
+  }
+  trajectory_builder_thread.RemoveSensorQueues(0);
+  // Data which was pushed before is still processed, data pushed afterwards
+  // is dropped.
+  sensor_queues[0]->Push(MakeImuData("imu", 10));
+  sensor_queues[1]->Push(MakeImuData("imu", 10));
+  trajectory_builder_thread.RunExclusively([&num_processed]() {
+    EXPECT_EQ(num_processed[0], 10);
+    EXPECT_EQ(num_processed[1], 11);
+  });
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
@@ -84,6 +84,10 @@ proto::MapBuilderOptions CreateMapBuilderOptions(
       parameter_dictionary->GetNonNegativeInt("num_background_threads"));
   options.set_collate_by_trajectory(
       parameter_dictionary->GetBool("collate_by_trajectory"));
+  options.set_submap_texture_cache_size_mb(
+      parameter_dictionary->GetNonNegativeInt("submap_texture_cache_size_mb"));
+  options.set_use_trajectory_builder_thread(
+      parameter_dictionary->GetBool("use_trajectory_builder_thread"));
   *options.mutable_pose_graph_options() = CreatePoseGraphOptions(
       parameter_dictionary->GetDictionary("pose_graph").get());
   CHECK_NE(options.use_trajectory_builder_2d(),
@@ -114,6 +118,15 @@ MapBuilder::MapBuilder(const proto::MapBuilderOptions& options)
   } else {
     sensor_collator_ = absl::make_unique<sensor::Collator>();
   }
+  if (options.submap_texture_cache_size_mb() > 0) {
+    submap_texture_cache_ = absl::make_unique<SubmapTextureCache>(
+        static_cast<size_t>(options.submap_texture_cache_size_mb()) * 1024 *
+            1024,
+        options.use_trajectory_builder_3d());
+  }
+  if (options.use_trajectory_builder_thread()) {
+    trajectory_builder_thread_ = absl::make_unique<TrajectoryBuilderThread>();
+  }
 }
 
 int MapBuilder::AddTrajectoryBuilder(
@@ -130,7 +143,8 @@ int MapBuilder::AddTrajectoryBuilder(
     }
     DCHECK(dynamic_cast<PoseGraph3D*>(pose_graph_.get()));
     trajectory_builders_.push_back(absl::make_unique<CollatedTrajectoryBuilder>(
-        trajectory_options, sensor_collator_.get(), trajectory_id,
+        trajectory_options, sensor_collator_.get(),
+        trajectory_builder_thread_.get(), trajectory_id,
         expected_sensor_ids,
         CreateGlobalTrajectoryBuilder3D(
             std::move(local_trajectory_builder), trajectory_id,
@@ -145,7 +159,8 @@ int MapBuilder::AddTrajectoryBuilder(
     }
     DCHECK(dynamic_cast<PoseGraph2D*>(pose_graph_.get()));
     trajectory_builders_.push_back(absl::make_unique<CollatedTrajectoryBuilder>(
-        trajectory_options, sensor_collator_.get(), trajectory_id,
+        trajectory_options, sensor_collator_.get(),
+        trajectory_builder_thread_.get(), trajectory_id,
         expected_sensor_ids,
         CreateGlobalTrajectoryBuilder2D(
             std::move(local_trajectory_builder), trajectory_id,
@@ -185,8 +200,18 @@ int MapBuilder::AddTrajectoryForDeserialization(
 }
 
 void MapBuilder::FinishTrajectory(const int trajectory_id) {
-  sensor_collator_->FinishTrajectory(trajectory_id);
-  pose_graph_->FinishTrajectory(trajectory_id);
+  const auto finish_trajectory = [this, trajectory_id]() {
+    sensor_collator_->FinishTrajectory(trajectory_id);
+    pose_graph_->FinishTrajectory(trajectory_id);
+  };
+  if (trajectory_builder_thread_ != nullptr) {
+    // Data which was already added is processed first. The trajectory's
+    // queues are removed, so that the thread stops polling them.
+    trajectory_builder_thread_->RemoveSensorQueues(trajectory_id);
+    trajectory_builder_thread_->RunExclusively(finish_trajectory);
+  } else {
+    finish_trajectory();
+  }
 }
 
 std::string MapBuilder::SubmapToProto(
@@ -200,25 +225,32 @@ std::string MapBuilder::SubmapToProto(
 
   const auto submap_data = pose_graph_->GetSubmapData(submap_id);
   if (submap_data.submap == nullptr) {
+    if (submap_texture_cache_ != nullptr) {
+      submap_texture_cache_->Erase(submap_id);
+    }
     return "Requested submap " + std::to_string(submap_id.submap_index) +
            " from trajectory " + std::to_string(submap_id.trajectory_id) +
            " but it does not exist: maybe it has been trimmed.";
   }
-  submap_data.submap->ToResponseProto(submap_data.pose, response);
+  if (submap_texture_cache_ != nullptr) {
+    submap_texture_cache_->ToResponseProto(submap_id, submap_data, response);
+  } else {
+    submap_data.submap->ToResponseProto(submap_data.pose, response);
+  }
   return "";
 }
 
 void MapBuilder::SerializeState(bool include_unfinished_submaps,
                                 io::ProtoStreamWriterInterface* const writer) {
   io::WritePbStream(*pose_graph_, all_trajectory_builder_options_, writer,
-                    include_unfinished_submaps);
+                    include_unfinished_submaps, &thread_pool_);
 }
 
 bool MapBuilder::SerializeStateToFile(bool include_unfinished_submaps,
                                       const std::string& filename) {
   io::ProtoStreamWriter writer(filename);
   io::WritePbStream(*pose_graph_, all_trajectory_builder_options_, &writer,
-                    include_unfinished_submaps);
+                    include_unfinished_submaps, &thread_pool_);
   return (writer.Close());
 }
 
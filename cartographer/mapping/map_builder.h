@@ -20,6 +20,8 @@
 #include <memory>
 
 #include "cartographer/common/thread_pool.h"
+#include "cartographer/mapping/internal/submap_texture_cache.h"
+#include "cartographer/mapping/internal/trajectory_builder_thread.h"
 #include "cartographer/mapping/map_builder_interface.h"
 #include "cartographer/mapping/pose_graph.h"
 #include "cartographer/mapping/proto/map_builder_options.pb.h"
@@ -90,12 +92,18 @@ class MapBuilder : public MapBuilderInterface {
   common::ThreadPool thread_pool_;
 
   std::unique_ptr<PoseGraph> pose_graph_;
+  // Only present if 'submap_texture_cache_size_mb' is positive.
+  std::unique_ptr<SubmapTextureCache> submap_texture_cache_;
 
   std::unique_ptr<sensor::CollatorInterface> sensor_collator_;
   std::vector<std::unique_ptr<mapping::TrajectoryBuilderInterface>>
       trajectory_builders_;
   std::vector<proto::TrajectoryBuilderOptionsWithSensorIds>
       all_trajectory_builder_options_;
+  // Only present if 'use_trajectory_builder_thread' is set. Declared last, so
+  // that it processes the remaining data and stops before anything it uses is
+  // destroyed.
+  std::unique_ptr<TrajectoryBuilderThread> trajectory_builder_thread_;
 };
 
 }  // namespace mapping
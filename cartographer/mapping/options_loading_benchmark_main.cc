@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018 The Cartographer Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_split.h"
+#include "cartographer/common/configuration_cache.h"
+#include "cartographer/common/configuration_file_resolver.h"
+#include "cartographer/common/lua_parameter_dictionary.h"
+#include "cartographer/mapping/map_builder.h"
+#include "cartographer/mapping/trajectory_builder_interface.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DEFINE_string(configuration_directories, "",
+              "Comma separated list of directories in which configuration files"
+              " are searched, the last is always the Cartographer installation"
+              " to allow including files from there.");
+DEFINE_string(cache_directory, "",
+              "Existing directory in which compiled configurations are "
+              "cached.");
+DEFINE_int32(num_iterations, 100,
+             "Number of times the options are loaded in each mode.");
+
+namespace cartographer {
+namespace mapping {
+namespace {
+
+constexpr char kMapBuilderCode[] =
+    "include \"map_builder.lua\"\n"
+    "return MAP_BUILDER";
+constexpr char kTrajectoryBuilderCode[] =
+    "include \"trajectory_builder.lua\"\n"
+    "return TRAJECTORY_BUILDER";
+
+// Returns the mean wall time in milliseconds of running 'load_options'.
+double MeasureMilliseconds(const int num_iterations,
+                           const std::function<void()>& load_options) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_iterations; ++i) {
+    load_options();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         num_iterations;
+}
+
+void Run(const std::vector<std::string>& configuration_directories,
+         const std::string& cache_directory, const int num_iterations) {
+  const auto make_file_resolver = [&configuration_directories]() {
+    return absl::make_unique<common::ConfigurationFileResolver>(
+        configuration_directories);
+  };
+
+  const double lua_milliseconds =
+      MeasureMilliseconds(num_iterations, [&make_file_resolver]() {
+        {
+          common::LuaParameterDictionary parameter_dictionary(
+              kMapBuilderCode, make_file_resolver());
+          CreateMapBuilderOptions(&parameter_dictionary);
+        }
+        common::LuaParameterDictionary parameter_dictionary(
+            kTrajectoryBuilderCode, make_file_resolver());
+        CreateTrajectoryBuilderOptions(&parameter_dictionary);
+      });
+
+  common::ConfigurationCache cache(cache_directory);
+  const auto load_cached_options = [&cache, &make_file_resolver]() {
+    cache.LoadOrCreateOptions<proto::MapBuilderOptions>(
+        kMapBuilderCode, make_file_resolver(), &CreateMapBuilderOptions);
+    cache.LoadOrCreateOptions<proto::TrajectoryBuilderOptions>(
+        kTrajectoryBuilderCode, make_file_resolver(),
+        &CreateTrajectoryBuilderOptions);
+  };
+  // Populates the cache, so that only cache hits are measured.
+  load_cached_options();
+  const double cached_milliseconds =
+      MeasureMilliseconds(num_iterations, load_cached_options);
+
+  std::cout << "Lua:    " << lua_milliseconds << " ms per startup\n"
+            << "Cached: " << cached_milliseconds << " ms per startup\n";
+}
+
+}  // namespace
+}  // namespace mapping
+}  // namespace cartographer
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  google::SetUsageMessage(
+      "Measures how long it takes to load the map builder and trajectory "
+      "builder options from Lua, and from the compiled configuration cache.");
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_cache_directory.empty() || FLAGS_num_iterations <= 0) {
+    google::ShowUsageWithFlagsRestrict(argv[0],
+                                       "options_loading_benchmark_main");
+    return EXIT_FAILURE;
+  }
+  ::cartographer::mapping::Run(
+      absl::StrSplit(FLAGS_configuration_directories, ',', absl::SkipEmpty()),
+      FLAGS_cache_directory, FLAGS_num_iterations);
+}
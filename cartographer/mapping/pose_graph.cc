@@ -85,6 +85,66 @@ void PopulateOverlappingSubmapsTrimmerOptions2D(
       options_dictionary->GetInt("min_added_submaps_count"));
 }
 
+void PopulateMemoryBudgetTrimmerOptions(
+    proto::PoseGraphOptions* const pose_graph_options,
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  constexpr char kDictionaryKey[] = "memory_budget_trimmer";
+  if (!parameter_dictionary->HasKey(kDictionaryKey)) return;
+
+  auto options_dictionary = parameter_dictionary->GetDictionary(kDictionaryKey);
+  auto* options = pose_graph_options->mutable_memory_budget_trimmer();
+  options->set_max_memory_mb(options_dictionary->GetDouble("max_memory_mb"));
+  options->set_min_submaps_to_keep_per_trajectory(
+      options_dictionary->GetNonNegativeInt(
+          "min_submaps_to_keep_per_trajectory"));
+  options->set_max_submaps_trimmed_per_call(
+      options_dictionary->GetNonNegativeInt("max_submaps_trimmed_per_call"));
+}
+
+void PopulateLandmarkRelocalizationOptions(
+    proto::PoseGraphOptions* const pose_graph_options,
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  constexpr char kDictionaryKey[] = "landmark_relocalization";
+  if (!parameter_dictionary->HasKey(kDictionaryKey)) return;
+
+  auto options_dictionary = parameter_dictionary->GetDictionary(kDictionaryKey);
+  auto* options = pose_graph_options->mutable_landmark_relocalization();
+  options->set_max_observation_time_difference(
+      options_dictionary->GetDouble("max_observation_time_difference"));
+  CHECK_GE(options->max_observation_time_difference(), 0.);
+}
+
+void PopulatePlaceRecognitionOptions(
+    proto::PoseGraphOptions* const pose_graph_options,
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  constexpr char kDictionaryKey[] = "place_recognition";
+  if (!parameter_dictionary->HasKey(kDictionaryKey)) return;
+
+  auto options_dictionary = parameter_dictionary->GetDictionary(kDictionaryKey);
+  auto* options = pose_graph_options->mutable_place_recognition();
+  options->set_max_candidate_submaps(
+      options_dictionary->GetNonNegativeInt("max_candidate_submaps"));
+  options->set_max_descriptor_distance(
+      options_dictionary->GetDouble("max_descriptor_distance"));
+  CHECK_GE(options->max_descriptor_distance(), 0.);
+}
+
+void PopulateFixedFrameAidedSearchOptions(
+    proto::PoseGraphOptions* const pose_graph_options,
+    common::LuaParameterDictionary* const parameter_dictionary) {
+  constexpr char kDictionaryKey[] = "fixed_frame_aided_search";
+  if (!parameter_dictionary->HasKey(kDictionaryKey)) return;
+
+  auto options_dictionary = parameter_dictionary->GetDictionary(kDictionaryKey);
+  auto* options = pose_graph_options->mutable_fixed_frame_aided_search();
+  options->set_num_standard_deviations(
+      options_dictionary->GetDouble("num_standard_deviations"));
+  CHECK_GT(options->num_standard_deviations(), 0.);
+  options->set_max_time_difference(
+      options_dictionary->GetDouble("max_time_difference"));
+  CHECK_GE(options->max_time_difference(), 0.);
+}
+
 proto::PoseGraphOptions CreatePoseGraphOptions(
     common::LuaParameterDictionary* const parameter_dictionary) {
   proto::PoseGraphOptions options;
@@ -111,6 +171,10 @@ proto::PoseGraphOptions CreatePoseGraphOptions(
       parameter_dictionary->GetDouble(
           "global_constraint_search_after_n_seconds"));
   PopulateOverlappingSubmapsTrimmerOptions2D(&options, parameter_dictionary);
+  PopulateMemoryBudgetTrimmerOptions(&options, parameter_dictionary);
+  PopulateLandmarkRelocalizationOptions(&options, parameter_dictionary);
+  PopulatePlaceRecognitionOptions(&options, parameter_dictionary);
+  PopulateFixedFrameAidedSearchOptions(&options, parameter_dictionary);
   return options;
 }
 
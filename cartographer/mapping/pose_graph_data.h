@@ -21,6 +21,7 @@
 #include <set>
 #include <vector>
 
+#include "cartographer/mapping/internal/constraint_store.h"
 #include "cartographer/mapping/internal/optimization/optimization_problem_2d.h"
 #include "cartographer/mapping/internal/optimization/optimization_problem_3d.h"
 #include "cartographer/mapping/internal/trajectory_connectivity_state.h"
@@ -83,7 +84,7 @@ struct PoseGraphData {
   // Set of all initial trajectory poses.
   std::map<int, PoseGraph::InitialTrajectoryPose> initial_trajectory_poses;
 
-  std::vector<PoseGraphInterface::Constraint> constraints;
+  ConstraintStore constraints;
 };
 
 }  // namespace mapping
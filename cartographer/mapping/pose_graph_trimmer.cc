@@ -21,6 +21,17 @@
 namespace cartographer {
 namespace mapping {
 
+std::vector<PoseGraphInterface::Constraint> Trimmable::GetSubmapConstraints(
+    const SubmapId& submap_id) const {
+  std::vector<PoseGraphInterface::Constraint> submap_constraints;
+  for (const PoseGraphInterface::Constraint& constraint : GetConstraints()) {
+    if (constraint.submap_id == submap_id) {
+      submap_constraints.push_back(constraint);
+    }
+  }
+  return submap_constraints;
+}
+
 PureLocalizationTrimmer::PureLocalizationTrimmer(const int trajectory_id,
                                                  const int num_submaps_to_keep)
     : trajectory_id_(trajectory_id), num_submaps_to_keep_(num_submaps_to_keep) {
@@ -38,6 +38,13 @@ class Trimmable {
   virtual const MapById<NodeId, TrajectoryNode>& GetTrajectoryNodes() const = 0;
   virtual const std::vector<PoseGraphInterface::Constraint>& GetConstraints()
       const = 0;
+  // Returns the constraints of 'submap_id'. The default implementation scans
+  // all constraints, pose graphs which index them should override it.
+  virtual std::vector<PoseGraphInterface::Constraint> GetSubmapConstraints(
+      const SubmapId& submap_id) const;
+  // Returns an estimate of the memory in bytes used by the sensor data (IMU,
+  // odometry, fixed frame poses) kept for optimizing 'trajectory_id'.
+  virtual size_t EstimateSensorDataMemoryUsage(int trajectory_id) const = 0;
 
   // Trim 'submap_id' and corresponding intra-submap nodes. They
   // will no longer take part in scan matching, loop closure, visualization.
@@ -38,6 +38,24 @@ TEST(PureLocalizationTrimmerTest, MarksSubmapsAsExpected) {
   EXPECT_EQ((SubmapId{kTrajectoryId, 1}), trimmed_submaps[1]);
 }
 
+TEST(TrimmableTest, GetSubmapConstraintsReturnsConstraintsOfSubmap) {
+  testing::FakeTrimmable fake_pose_graph;
+  for (int i = 0; i < 4; ++i) {
+    fake_pose_graph.mutable_constraints()->push_back(
+        PoseGraphInterface::Constraint{
+            SubmapId{0, i % 2}, NodeId{0, i},
+            {transform::Rigid3d::Identity(), 1., 1.},
+            PoseGraphInterface::Constraint::INTRA_SUBMAP});
+  }
+
+  const auto submap_constraints =
+      fake_pose_graph.GetSubmapConstraints(SubmapId{0, 1});
+  ASSERT_EQ(2, submap_constraints.size());
+  EXPECT_EQ((NodeId{0, 1}), submap_constraints[0].node_id);
+  EXPECT_EQ((NodeId{0, 3}), submap_constraints[1].node_id);
+  EXPECT_TRUE(fake_pose_graph.GetSubmapConstraints(SubmapId{0, 2}).empty());
+}
+
 }  // namespace
 }  // namespace mapping
 }  // namespace cartographer
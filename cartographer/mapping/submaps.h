@@ -70,6 +70,9 @@ class Submap {
       const transform::Rigid3d& global_submap_pose,
       proto::SubmapQuery::Response* response) const = 0;
 
+  // Returns an estimate of the memory used by this submap in bytes.
+  virtual size_t EstimateMemoryUsage() const = 0;
+
   // Pose of this submap in the local map frame.
   transform::Rigid3d local_pose() const { return local_pose_; }
 
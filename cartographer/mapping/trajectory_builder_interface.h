@@ -22,6 +22,7 @@
 #include <string>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "cartographer/common/lua_parameter_dictionary.h"
 #include "cartographer/common/port.h"
 #include "cartographer/common/time.h"
@@ -32,6 +33,7 @@
 #include "cartographer/sensor/landmark_data.h"
 #include "cartographer/sensor/odometry_data.h"
 #include "cartographer/sensor/timed_point_cloud_data.h"
+#include "cartographer/transform/rigid_transform.h"
 
 namespace cartographer {
 namespace mapping {
@@ -110,6 +112,13 @@ class TrajectoryBuilderInterface {
   // 'LocalTrajectoryBuilder2D/3D'.
   virtual void AddLocalSlamResultData(
       std::unique_ptr<mapping::LocalSlamResultData> local_slam_result_data) = 0;
+
+  // Returns the local pose at 'time' extrapolated from the latest local SLAM
+  // result and IMU data, or nothing if there is none yet. Unlike the methods
+  // above, this can be called from any thread. It does not lock, so it can be
+  // polled at high rates without contending with SLAM.
+  virtual absl::optional<transform::Rigid3d> ExtrapolateLocalPose(
+      common::Time time) const = 0;
 };
 
 proto::SensorId ToProto(const TrajectoryBuilderInterface::SensorId& sensor_id);
@@ -20,6 +20,7 @@
 #include "cartographer/common/time.h"
 #include "cartographer/sensor/compressed_point_cloud.h"
 #include "cartographer/transform/transform.h"
+#include "glog/logging.h"
 
 namespace cartographer {
 namespace mapping {
@@ -45,6 +46,15 @@ proto::TrajectoryNodeData ToProto(const TrajectoryNode::Data& constant_data) {
         constant_data.rotational_scan_matcher_histogram(i));
   }
   *proto.mutable_local_pose() = transform::ToProto(constant_data.local_pose);
+  const Eigen::MatrixXf& place_descriptor = constant_data.place_descriptor;
+  proto.set_place_descriptor_num_rings(place_descriptor.rows());
+  for (Eigen::MatrixXf::Index ring = 0; ring != place_descriptor.rows();
+       ++ring) {
+    for (Eigen::MatrixXf::Index sector = 0; sector != place_descriptor.cols();
+         ++sector) {
+      proto.add_place_descriptor(place_descriptor(ring, sector));
+    }
+  }
   return proto;
 }
 
@@ -55,6 +65,19 @@ TrajectoryNode::Data FromProto(const proto::TrajectoryNodeData& proto) {
     rotational_scan_matcher_histogram(i) =
         proto.rotational_scan_matcher_histogram(i);
   }
+  Eigen::MatrixXf place_descriptor;
+  if (proto.place_descriptor_num_rings() > 0) {
+    const int num_rings = proto.place_descriptor_num_rings();
+    CHECK_EQ(proto.place_descriptor_size() % num_rings, 0);
+    const int num_sectors = proto.place_descriptor_size() / num_rings;
+    place_descriptor.resize(num_rings, num_sectors);
+    for (int ring = 0; ring != num_rings; ++ring) {
+      for (int sector = 0; sector != num_sectors; ++sector) {
+        place_descriptor(ring, sector) =
+            proto.place_descriptor(ring * num_sectors + sector);
+      }
+    }
+  }
   return TrajectoryNode::Data{
       common::FromUniversal(proto.timestamp()),
       transform::ToEigen(proto.gravity_alignment()),
@@ -65,7 +88,8 @@ TrajectoryNode::Data FromProto(const proto::TrajectoryNodeData& proto) {
       sensor::CompressedPointCloud(proto.low_resolution_point_cloud())
           .Decompress(),
       rotational_scan_matcher_histogram,
-      transform::ToRigid3(proto.local_pose())};
+      transform::ToRigid3(proto.local_pose()),
+      place_descriptor};
 }
 
 }  // namespace mapping
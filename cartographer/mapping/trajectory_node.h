@@ -60,6 +60,10 @@ struct TrajectoryNode {
 
     // The node pose in the local SLAM frame.
     transform::Rigid3d local_pose;
+
+    // Used for global localization: place descriptor with rings as rows and
+    // sectors as columns. Empty if none was computed.
+    Eigen::MatrixXf place_descriptor;
   };
 
   common::Time time() const { return constant_data->time; }
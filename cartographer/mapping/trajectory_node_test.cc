@@ -41,7 +41,8 @@ TEST(TrajectoryNodeTest, ToAndFromProto) {
           .Decompress(),
       Eigen::VectorXf::Unit(20, 4),
       transform::Rigid3d({1., 2., 3.},
-                         Eigen::Quaterniond(4., 5., -6., -7.).normalized())};
+                         Eigen::Quaterniond(4., 5., -6., -7.).normalized()),
+      (Eigen::MatrixXf(2, 3) << 1.f, 0.f, 2.f, 0.f, 3.f, 4.f).finished()};
   const proto::TrajectoryNodeData proto = ToProto(expected);
   const TrajectoryNode::Data actual = FromProto(proto);
   EXPECT_EQ(expected.time, actual.time);
@@ -56,6 +57,7 @@ TEST(TrajectoryNodeTest, ToAndFromProto) {
             actual.rotational_scan_matcher_histogram);
   EXPECT_THAT(actual.local_pose,
               transform::IsNearly(expected.local_pose, 1e-9));
+  EXPECT_EQ(expected.place_descriptor, actual.place_descriptor);
 }
 
 }  // namespace
@@ -55,6 +55,7 @@ const std::vector<float>* ValueConversionTables::GetConversionTable(
     float unknown_result, float lower_bound, float upper_bound) {
   std::tuple<float, float, float> bounds =
       std::make_tuple(unknown_result, lower_bound, upper_bound);
+  absl::MutexLock locker(&mutex_);
   auto lookup_table_iterator = bounds_to_lookup_table_.find(bounds);
   if (lookup_table_iterator == bounds_to_lookup_table_.end()) {
     auto insertion_result = bounds_to_lookup_table_.emplace(
@@ -23,6 +23,9 @@
 #include "cartographer/mapping/internal/constraints/constraint_builder_2d.h"
 #include "cartographer/mapping/internal/constraints/constraint_builder_3d.h"
 #include "cartographer/mapping/internal/global_trajectory_builder.h"
+#include "cartographer/mapping/internal/memory_budget_trimmer.h"
+#include "cartographer/mapping/internal/stationary_filter.h"
+#include "cartographer/mapping/internal/trajectory_builder_thread.h"
 #include "cartographer/sensor/internal/trajectory_collator.h"
 
 namespace cartographer {
@@ -34,8 +37,11 @@ void RegisterAllMetrics(FamilyFactory* registry) {
   mapping::GlobalTrajectoryBuilderRegisterMetrics(registry);
   mapping::LocalTrajectoryBuilder2D::RegisterMetrics(registry);
   mapping::LocalTrajectoryBuilder3D::RegisterMetrics(registry);
+  mapping::MemoryBudgetTrimmer::RegisterMetrics(registry);
   mapping::PoseGraph2D::RegisterMetrics(registry);
   mapping::PoseGraph3D::RegisterMetrics(registry);
+  mapping::StationaryFilter::RegisterMetrics(registry);
+  mapping::TrajectoryBuilderThread::RegisterMetrics(registry);
   sensor::TrajectoryCollator::RegisterMetrics(registry);
 }
 
@@ -81,9 +81,7 @@ PointCloud AdaptivelyVoxelFiltered(
 PointCloud VoxelFilter::Filter(const PointCloud& point_cloud) {
   PointCloud results;
   for (const RangefinderPoint& point : point_cloud) {
-    auto it_inserted =
-        voxel_set_.insert(IndexToKey(GetCellIndex(point.position)));
-    if (it_inserted.second) {
+    if (Insert(point.position)) {
       results.push_back(point);
     }
   }
@@ -93,9 +91,7 @@ PointCloud VoxelFilter::Filter(const PointCloud& point_cloud) {
 TimedPointCloud VoxelFilter::Filter(const TimedPointCloud& timed_point_cloud) {
   TimedPointCloud results;
   for (const TimedRangefinderPoint& point : timed_point_cloud) {
-    auto it_inserted =
-        voxel_set_.insert(IndexToKey(GetCellIndex(point.position)));
-    if (it_inserted.second) {
+    if (Insert(point.position)) {
       results.push_back(point);
     }
   }
@@ -107,15 +103,17 @@ std::vector<TimedPointCloudOriginData::RangeMeasurement> VoxelFilter::Filter(
         range_measurements) {
   std::vector<TimedPointCloudOriginData::RangeMeasurement> results;
   for (const auto& range_measurement : range_measurements) {
-    auto it_inserted = voxel_set_.insert(
-        IndexToKey(GetCellIndex(range_measurement.point_time.position)));
-    if (it_inserted.second) {
+    if (Insert(range_measurement.point_time.position)) {
       results.push_back(range_measurement);
     }
   }
   return results;
 }
 
+bool VoxelFilter::Insert(const Eigen::Vector3f& position) {
+  return voxel_set_.insert(IndexToKey(GetCellIndex(position))).second;
+}
+
 VoxelFilter::KeyType VoxelFilter::IndexToKey(const Eigen::Array3i& index) {
   KeyType k_0(static_cast<uint32>(index[0]));
   KeyType k_1(static_cast<uint32>(index[1]));
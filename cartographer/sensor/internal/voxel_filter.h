@@ -50,6 +50,10 @@ class VoxelFilter {
       const std::vector<TimedPointCloudOriginData::RangeMeasurement>&
           range_measurements);
 
+  // Marks the voxel containing 'position' as occupied. Returns true if it was
+  // not occupied before, i.e. if the filter keeps a point at 'position'.
+  bool Insert(const Eigen::Vector3f& position);
+
  private:
   using KeyType = std::bitset<3 * 32>;
 
@@ -100,6 +100,10 @@ class MapByTime {
     return data_.count(trajectory_id) != 0;
   }
 
+  size_t SizeOfTrajectoryOrZero(const int trajectory_id) const {
+    return HasTrajectory(trajectory_id) ? data_.at(trajectory_id).size() : 0;
+  }
+
   class ConstIterator {
    public:
     using iterator_category = std::bidirectional_iterator_tag;
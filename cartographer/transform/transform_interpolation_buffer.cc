@@ -26,6 +26,10 @@
 namespace cartographer {
 namespace transform {
 
+TransformInterpolationBuffer::TransformInterpolationBuffer(
+    const size_t buffer_size_limit)
+    : buffer_size_limit_(buffer_size_limit) {}
+
 TransformInterpolationBuffer::TransformInterpolationBuffer(
     const mapping::proto::Trajectory& trajectory) {
   for (const mapping::proto::Trajectory::Node& node : trajectory.node()) {
@@ -40,8 +44,17 @@ void TransformInterpolationBuffer::Push(const common::Time time,
     CHECK_GE(time, latest_time()) << "New transform is older than latest.";
   }
   timestamped_transforms_.push_back(TimestampedTransform{time, transform});
+  RemoveOldTransformsIfNeeded();
+}
+
+void TransformInterpolationBuffer::SetSizeLimit(
+    const size_t buffer_size_limit) {
+  buffer_size_limit_ = buffer_size_limit;
+  RemoveOldTransformsIfNeeded();
 }
 
+void TransformInterpolationBuffer::Clear() { timestamped_transforms_.clear(); }
+
 bool TransformInterpolationBuffer::Has(const common::Time time) const {
   if (timestamped_transforms_.empty()) {
     return false;
@@ -65,6 +78,32 @@ transform::Rigid3d TransformInterpolationBuffer::Lookup(
   return Interpolate(*start, *end, time).transform;
 }
 
+std::vector<transform::Rigid3d> TransformInterpolationBuffer::LookupSorted(
+    const std::vector<common::Time>& times) const {
+  std::vector<transform::Rigid3d> transforms;
+  if (times.empty()) {
+    return transforms;
+  }
+  CHECK(Has(times.front())) << "Missing transform for: " << times.front();
+  CHECK(Has(times.back())) << "Missing transform for: " << times.back();
+  transforms.reserve(times.size());
+  auto end = timestamped_transforms_.begin();
+  common::Time previous_time = times.front();
+  for (const common::Time time : times) {
+    CHECK_LE(previous_time, time) << "Lookup times are not sorted.";
+    previous_time = time;
+    while (end->time < time) {
+      ++end;
+    }
+    if (end->time == time) {
+      transforms.push_back(end->transform);
+      continue;
+    }
+    transforms.push_back(Interpolate(*std::prev(end), *end, time).transform);
+  }
+  return transforms;
+}
+
 common::Time TransformInterpolationBuffer::earliest_time() const {
   CHECK(!empty()) << "Empty buffer.";
   return timestamped_transforms_.front().time;
@@ -79,5 +118,19 @@ bool TransformInterpolationBuffer::empty() const {
   return timestamped_transforms_.empty();
 }
 
+size_t TransformInterpolationBuffer::size_limit() const {
+  return buffer_size_limit_;
+}
+
+size_t TransformInterpolationBuffer::size() const {
+  return timestamped_transforms_.size();
+}
+
+void TransformInterpolationBuffer::RemoveOldTransformsIfNeeded() {
+  while (timestamped_transforms_.size() > buffer_size_limit_) {
+    timestamped_transforms_.pop_front();
+  }
+}
+
 }  // namespace transform
 }  // namespace cartographer
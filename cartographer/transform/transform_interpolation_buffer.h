@@ -17,6 +17,8 @@
 #ifndef CARTOGRAPHER_TRANSFORM_TRANSFORM_INTERPOLATION_BUFFER_H_
 #define CARTOGRAPHER_TRANSFORM_TRANSFORM_INTERPOLATION_BUFFER_H_
 
+#include <deque>
+#include <limits>
 #include <vector>
 
 #include "cartographer/common/time.h"
@@ -31,13 +33,23 @@ namespace transform {
 class TransformInterpolationBuffer {
  public:
   TransformInterpolationBuffer() = default;
+  // Creates a bounded buffer for online use which keeps at most
+  // 'buffer_size_limit' of the most recent transforms.
+  explicit TransformInterpolationBuffer(size_t buffer_size_limit);
   explicit TransformInterpolationBuffer(
       const mapping::proto::Trajectory& trajectory);
 
+  // Sets the transform buffer size limit and removes old transforms
+  // if it is exceeded.
+  void SetSizeLimit(size_t buffer_size_limit);
+
   // Adds a new transform to the buffer and removes the oldest transform if the
   // buffer size limit is exceeded.
   void Push(common::Time time, const transform::Rigid3d& transform);
 
+  // Clears the transform buffer.
+  void Clear();
+
   // Returns true if an interpolated transfrom can be computed at 'time'.
   bool Has(common::Time time) const;
 
@@ -45,6 +57,13 @@ class TransformInterpolationBuffer {
   // 'time' is available.
   transform::Rigid3d Lookup(common::Time time) const;
 
+  // Returns interpolated transforms at all 'times' which must be sorted in
+  // non-decreasing order. This walks the buffer once instead of searching it
+  // for every time, which makes it cheap to look up a transform per point.
+  // CHECK()s that transforms at all 'times' are available.
+  std::vector<transform::Rigid3d> LookupSorted(
+      const std::vector<common::Time>& times) const;
+
   // Returns the timestamp of the earliest transform in the buffer or 0 if the
   // buffer is empty.
   common::Time earliest_time() const;
@@ -56,8 +75,17 @@ class TransformInterpolationBuffer {
   // Returns true if the buffer is empty.
   bool empty() const;
 
+  // Returns the maximum allowed size of the transform buffer.
+  size_t size_limit() const;
+
+  // Returns the current size of the transform buffer.
+  size_t size() const;
+
  private:
-  std::vector<TimestampedTransform> timestamped_transforms_;
+  void RemoveOldTransformsIfNeeded();
+
+  std::deque<TimestampedTransform> timestamped_transforms_;
+  size_t buffer_size_limit_ = std::numeric_limits<size_t>::max();
 };
 
 }  // namespace transform
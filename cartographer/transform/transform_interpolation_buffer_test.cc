@@ -16,6 +16,8 @@
 
 #include "cartographer/transform/transform_interpolation_buffer.h"
 
+#include <vector>
+
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "cartographer/transform/rigid_transform.h"
@@ -70,6 +72,44 @@ TEST(TransformInterpolationBufferTest, testLookupSingleTransform) {
   EXPECT_THAT(interpolated, IsNearly(transform::Rigid3d::Identity(), 1e-6));
 }
 
+TEST(TransformInterpolationBufferTest, testLookupSorted) {
+  TransformInterpolationBuffer buffer;
+  for (int i = 0; i < 5; ++i) {
+    const Eigen::Vector3d translation(i, 2. * i, 0.);
+    buffer.Push(common::FromUniversal(50 * i),
+                transform::Rigid3d::Translation(translation) *
+                    transform::Rigid3d::Rotation(Eigen::AngleAxisd(
+                        0.3 * i * i, Eigen::Vector3d::UnitZ())));
+  }
+  std::vector<common::Time> times;
+  for (int time = 0; time <= 200; time += 15) {
+    times.push_back(common::FromUniversal(time));
+    times.push_back(common::FromUniversal(time));
+  }
+  times.push_back(common::FromUniversal(200));
+  const std::vector<transform::Rigid3d> transforms = buffer.LookupSorted(times);
+  ASSERT_EQ(transforms.size(), times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    EXPECT_THAT(transforms[i], IsNearly(buffer.Lookup(times[i]), 1e-9));
+  }
+}
+
+TEST(TransformInterpolationBufferTest, testSizeLimit) {
+  TransformInterpolationBuffer buffer(2);
+  EXPECT_EQ(2, buffer.size_limit());
+  buffer.Push(common::FromUniversal(50), transform::Rigid3d::Identity());
+  buffer.Push(common::FromUniversal(100), transform::Rigid3d::Identity());
+  buffer.Push(common::FromUniversal(150), transform::Rigid3d::Identity());
+  EXPECT_EQ(2, buffer.size());
+  EXPECT_EQ(common::FromUniversal(100), buffer.earliest_time());
+  EXPECT_EQ(common::FromUniversal(150), buffer.latest_time());
+  buffer.SetSizeLimit(1);
+  EXPECT_EQ(1, buffer.size());
+  EXPECT_EQ(common::FromUniversal(150), buffer.earliest_time());
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
 }  // namespace
 }  // namespace transform
 }  // namespace cartographer
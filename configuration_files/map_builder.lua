@@ -20,4 +20,6 @@ MAP_BUILDER = {
   num_background_threads = 4,
   pose_graph = POSE_GRAPH,
   collate_by_trajectory = false,
+  submap_texture_cache_size_mb = 64,
+  use_trajectory_builder_thread = false,
 }
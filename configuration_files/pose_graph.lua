@@ -89,4 +89,20 @@ POSE_GRAPH = {
   --    min_covered_area = 2,
   --    min_added_submaps_count = 5,
   --  },
+  --  memory_budget_trimmer = {
+  --    max_memory_mb = 4096.,
+  --    min_submaps_to_keep_per_trajectory = 2,
+  --    max_submaps_trimmed_per_call = 3,
+  --  },
+  --  landmark_relocalization = {
+  --    max_observation_time_difference = 1.,
+  --  },
+  --  place_recognition = {
+  --    max_candidate_submaps = 3,
+  --    max_descriptor_distance = 0.3,
+  --  },
+  --  fixed_frame_aided_search = {
+  --    num_standard_deviations = 3.,
+  --    max_time_difference = 2.,
+  --  },
 }
@@ -46,6 +46,7 @@ TRAJECTORY_BUILDER_2D = {
     occupied_space_weight = 1.,
     translation_weight = 10.,
     rotation_weight = 40.,
+    use_analytic_tsdf_cost_function = false,
     ceres_solver_options = {
       use_nonmonotonic_steps = false,
       max_num_iterations = 20,
@@ -59,6 +60,18 @@ TRAJECTORY_BUILDER_2D = {
     max_angle_radians = math.rad(1.),
   },
 
+  stationary_filter = {
+    max_distance_meters = 0.01,
+    max_angle_radians = math.rad(0.1),
+    max_num_skipped_range_data = 0,
+  },
+
+  --  place_descriptor = {
+  --    num_rings = 20,
+  --    num_sectors = 60,
+  --    max_range = 30.,
+  --  },
+
   imu_gravity_time_constant = 10.,
 
   submaps = {
@@ -59,6 +59,18 @@ TRAJECTORY_BUILDER_3D = {
     max_angle_radians = 0.004,
   },
 
+  stationary_filter = {
+    max_distance_meters = 0.01,
+    max_angle_radians = math.rad(0.1),
+    max_num_skipped_range_data = 0,
+  },
+
+  --  place_descriptor = {
+  --    num_rings = 20,
+  --    num_sectors = 60,
+  --    max_range = 60.,
+  --  },
+
   imu_gravity_time_constant = 10.,
   rotational_histogram_size = 120,
 